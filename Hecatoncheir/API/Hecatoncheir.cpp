@@ -3,6 +3,7 @@
 #include "fstream"
 
 #include <regex>
+#include <unordered_set>
 #include "def.h"
 #include "utils.h"
 #include "env/comm_def.h"
@@ -14,11 +15,13 @@
 #define HOST_CONTROLLER 1
 
 static DB_STATUS probeBlocking(int sourceRank, int tag, MPI_Comm &comm, MPI_Status &status) {
+    double startTime = MPI_Wtime();
     int mpi_ret = MPI_Probe(sourceRank, tag, comm, &status);
     if(mpi_ret != MPI_SUCCESS) {
         logger::log_error(DBERR_COMM_PROBE_FAILED, "Blocking probe failed");
         return DBERR_COMM_PROBE_FAILED;
     }
+    comm::telemetry::recordProbe(status.MPI_SOURCE, status.MPI_TAG, comm, MPI_Wtime() - startTime);
     return DBERR_OK;
 }
 
@@ -29,28 +32,158 @@ static DB_STATUS receiveResponse(int sourceRank, int sourceTag, MPI_Comm &comm,
         return DBERR_INVALID_PARAMETER;
     }
     // receive response
+    double startTime = MPI_Wtime();
     int mpi_ret = MPI_Recv(NULL, 0, MPI_CHAR, sourceRank, sourceTag, comm, &status);
     if (mpi_ret != MPI_SUCCESS) {
         logger::log_error(DBERR_COMM_RECV, "Failed to receive response with tag ", sourceTag);
         return DBERR_COMM_RECV;
     }
+    comm::telemetry::recordRecv(status.MPI_SOURCE, sourceTag, comm, 0, MPI_CHAR, MPI_Wtime() - startTime);
     return DBERR_OK;
 }
 
-static DB_STATUS receiveResult(int sourceRank, int sourceTag, MPI_Comm &comm, MPI_Status &status, hec::QResultBase* finalResults) {
+/** @brief Issued queries whose results have not arrived yet, keyed by query ID. */
+static std::unordered_map<int, hec::QResultBase*> pendingQueries;
+/** @brief Query results that have arrived but have not been claimed by wait() yet, keyed by query ID. */
+static std::unordered_map<int, hec::QResultBase*> completedQueries;
+/** @brief Result chunks received so far, for queries whose results are delivered by the workers directly. */
+static std::unordered_map<int, int> receivedChunks;
+/** @brief Result chunks the host reported as sent, for queries whose results are delivered by the workers directly. */
+static std::unordered_map<int, int> expectedChunks;
+/** @brief Queries the host reported as failed, whose result chunks are still being drained. */
+static std::unordered_set<int> failingQueries;
+/** @brief Queries that failed and have not been claimed by wait() yet. */
+static std::unordered_set<int> failedQueries;
+
+static bool isQueryResultTag(int tag) {
+    return tag == MSG_QUERY_RESULT || tag == MSG_QUERY_RESULT_CHUNK || tag == MSG_QUERY_RESULT_DELIVERED || tag == MSG_QUERY_FAILED;
+}
+
+/** @brief Marks a query whose result is delivered in chunks as complete (or failed), if all of its chunks have arrived. */
+static void completeIfDelivered(int queryID) {
+    auto expectedIt = expectedChunks.find(queryID);
+    if (expectedIt == expectedChunks.end() || receivedChunks[queryID] < expectedIt->second) {
+        return;
+    }
+    if (failingQueries.erase(queryID)) {
+        // the partial result is dropped
+        delete pendingQueries[queryID];
+        failedQueries.insert(queryID);
+    } else {
+        completedQueries[queryID] = pendingQueries[queryID];
+    }
+    pendingQueries.erase(queryID);
+    expectedChunks.erase(expectedIt);
+    receivedChunks.erase(queryID);
+}
+
+/** @brief Receives an already probed query result message: either a whole result from the host, 
+ * a result chunk from a worker, the host's notice of how many chunks were sent or its notice that the query failed. */
+static DB_STATUS receiveResult(MPI_Status &status) {
     SerializedMsg<char> msg(MPI_CHAR);
     // receive message
     DB_STATUS ret = comm::recv::receiveMessage(status, msg.type, g_global_intra_comm, msg);
     if (ret != DBERR_OK) {
         return ret;
     }
-    // unpack
-    finalResults->deserialize(msg.data, msg.count);
+    int queryID = -1;
+    int chunks = 0;
+    if (status.MPI_TAG == MSG_QUERY_RESULT_DELIVERED || status.MPI_TAG == MSG_QUERY_FAILED) {
+        std::vector<int> messageContents;
+        ret = unpack::unpackValues(msg, messageContents);
+        if (ret != DBERR_OK || messageContents.size() != 2) {
+            logger::log_error(DBERR_DESERIALIZE_FAILED, "Failed to unpack result delivery notice.");
+            msg.clear();
+            return DBERR_DESERIALIZE_FAILED;
+        }
+        queryID = messageContents[0];
+        chunks = messageContents[1];
+    } else {
+        queryID = hec::QResultBase::getQueryIDFromSerializedBuffer(msg.data, msg.count);
+    }
+    // match the result to its query
+    auto it = pendingQueries.find(queryID);
+    if (it == pendingQueries.end()) {
+        logger::log_error(DBERR_INVALID_PARAMETER, "Received result for unknown query with ID", queryID);
+        msg.clear();
+        return DBERR_INVALID_PARAMETER;
+    }
+    comm::telemetry::attributeLastRecv(queryID);
+    switch (status.MPI_TAG) {
+        case MSG_QUERY_RESULT:
+            // the whole result
+            it->second->deserialize(msg.data, msg.count);
+            completedQueries[queryID] = it->second;
+            pendingQueries.erase(it);
+            break;
+        case MSG_QUERY_RESULT_CHUNK:
+        {
+            // part of the result, merge it
+            std::unique_ptr<hec::QResultBase> chunk(it->second->cloneEmpty());
+            chunk->deserialize(msg.data, msg.count);
+            ret = mergeResultObjects(it->second, chunk.get());
+            if (ret != DBERR_OK) {
+                logger::log_error(ret, "Merging query result chunk failed.");
+                msg.clear();
+                return ret;
+            }
+            receivedChunks[queryID]++;
+            completeIfDelivered(queryID);
+            break;
+        }
+        case MSG_QUERY_RESULT_DELIVERED:
+            expectedChunks[queryID] = chunks;
+            completeIfDelivered(queryID);
+            break;
+        case MSG_QUERY_FAILED:
+            // any chunks the workers delivered are still drained before the query is marked failed
+            failingQueries.insert(queryID);
+            expectedChunks[queryID] = chunks;
+            completeIfDelivered(queryID);
+            break;
+    }
     // free memory
     msg.clear();
     return ret;
 }
 
+/** @brief Probes for the next message of the host controller that is not a query result. The results of async queries 
+ * that arrive in the meantime are received, from the host or (with tree and direct delivery) from the workers: 
+ * the host may only respond after the workers' result chunks are delivered. */
+static DB_STATUS probeHostController(MPI_Status &status) {
+    while (true) {
+        DB_STATUS ret = probeBlocking(MPI_ANY_SOURCE, MPI_ANY_TAG, g_global_intra_comm, status);
+        if (ret != DBERR_OK) {
+            return ret;
+        }
+        if (!isQueryResultTag(status.MPI_TAG)) {
+            break;
+        }
+        ret = receiveResult(status);
+        if (ret != DBERR_OK) {
+            return ret;
+        }
+    }
+    if (status.MPI_SOURCE != HOST_CONTROLLER) {
+        logger::log_error(DBERR_COMM_INVALID_MSG_TAG, "Unexpected message with tag", status.MPI_TAG, "from rank", status.MPI_SOURCE);
+        return DBERR_COMM_INVALID_MSG_TAG;
+    }
+    return DBERR_OK;
+}
+
+/** @brief Same as probeHostController, for a reply with the given tag. */
+static DB_STATUS probeHostController(int tag, MPI_Status &status) {
+    DB_STATUS ret = probeHostController(status);
+    if (ret != DBERR_OK) {
+        return ret;
+    }
+    if (status.MPI_TAG != tag) {
+        logger::log_error(DBERR_COMM_INVALID_MSG_TAG, "Expected message with tag", tag, "by host controller, got", status.MPI_TAG);
+        return DBERR_COMM_INVALID_MSG_TAG;
+    }
+    return DBERR_OK;
+}
+
 static DB_STATUS receiveResultBatch(int sourceRank, int sourceTag, MPI_Comm &comm, MPI_Status &status, std::unordered_map<int, std::unique_ptr<hec::QResultBase>> &finalResults) {
     SerializedMsg<char> msg(MPI_CHAR);
     // receive message
@@ -71,8 +204,8 @@ static DB_STATUS receiveResultBatch(int sourceRank, int sourceTag, MPI_Comm &com
 
 static DB_STATUS waitForResponse() {
     MPI_Status status;
-    // wait for response by the host controller
-    DB_STATUS ret = probeBlocking(HOST_CONTROLLER, MPI_ANY_TAG, g_global_intra_comm, status);
+    // wait for response by the host controller, receiving the results of async queries until then
+    DB_STATUS ret = probeHostController(status);
     if (ret != DBERR_OK) {
         return ret;
     }
@@ -89,31 +222,43 @@ static DB_STATUS waitForResponse() {
     return ret;
 }    
 
-static DB_STATUS waitForResult(hec::QResultBase* finalResults) {
+static DB_STATUS waitForResult(int queryID) {
+    DB_STATUS ret = DBERR_OK;
     MPI_Status status;
-    // wait for response by the host controller
-    DB_STATUS ret = probeBlocking(1, MPI_ANY_TAG, g_global_intra_comm, status);
-    if (ret != DBERR_OK) {
-        return ret;
-    }
-    switch (status.MPI_TAG) {
-        case MSG_NACK:
-            // receive response
-            ret = receiveResponse(HOST_CONTROLLER, status.MPI_TAG, g_global_intra_comm, status);
-            if (ret != DBERR_OK) {
-                return ret;
-            }
-            logger::log_error(DBERR_COMM_RECEIVED_NACK, "Query failed.");
+    // results may arrive in any order, keep receiving until this query's result (or failure) is in
+    while (completedQueries.find(queryID) == completedQueries.end()) {
+        if (failedQueries.erase(queryID)) {
+            logger::log_error(DBERR_COMM_RECEIVED_NACK, "Query", queryID, "failed.");
             return DBERR_COMM_RECEIVED_NACK;
-        case MSG_QUERY_RESULT:
-            // receive result
-            ret = receiveResult(HOST_CONTROLLER, status.MPI_TAG, g_global_intra_comm, status, finalResults);
-            if (ret != DBERR_OK) {
-                return ret;
-            }
-            break;
-        default:
-            break;
+        }
+        // wait for response by the host controller, or result chunks by the workers
+        ret = probeBlocking(MPI_ANY_SOURCE, MPI_ANY_TAG, g_global_intra_comm, status);
+        if (ret != DBERR_OK) {
+            return ret;
+        }
+        switch (status.MPI_TAG) {
+            case MSG_NACK:
+                // receive response
+                ret = receiveResponse(HOST_CONTROLLER, status.MPI_TAG, g_global_intra_comm, status);
+                if (ret != DBERR_OK) {
+                    return ret;
+                }
+                logger::log_error(DBERR_COMM_RECEIVED_NACK, "Query failed.");
+                return DBERR_COMM_RECEIVED_NACK;
+            case MSG_QUERY_RESULT:
+            case MSG_QUERY_RESULT_CHUNK:
+            case MSG_QUERY_RESULT_DELIVERED:
+            case MSG_QUERY_FAILED:
+                // receive result
+                ret = receiveResult(status);
+                if (ret != DBERR_OK) {
+                    return ret;
+                }
+                break;
+            default:
+                logger::log_error(DBERR_COMM_INVALID_MSG_TAG, "Unexpected message with tag", status.MPI_TAG, "while waiting for query result.");
+                return DBERR_COMM_INVALID_MSG_TAG;
+        }
     }
     
     return ret;
@@ -121,8 +266,8 @@ static DB_STATUS waitForResult(hec::QResultBase* finalResults) {
 
 static DB_STATUS waitForResult(std::unordered_map<int, std::unique_ptr<hec::QResultBase>> &finalResults) {
     MPI_Status status;
-    // wait for response by the host controller
-    DB_STATUS ret = probeBlocking(1, MPI_ANY_TAG, g_global_intra_comm, status);
+    // wait for response by the host controller, receiving the results of async queries until then
+    DB_STATUS ret = probeHostController(status);
     if (ret != DBERR_OK) {
         return ret;
     }
@@ -396,6 +541,9 @@ namespace hec {
             logger::log_error(DBERR_INVALID_PARAMETER, "The unpacked id list does not contain a single id.");
             return DBERR_INVALID_PARAMETER;
         }
+        if (indexes[0] < 0) {
+            logger::log_error(DBERR_INVALID_PARAMETER, "Dataset", filePath, "was not admitted: the resident datasets limit or memory budget is reached. Unload a dataset first.");
+        }
 
         return indexes[0];
     }
@@ -475,6 +623,9 @@ namespace hec {
         msgFromHost.clear();
 
         // return the ID
+        if (indexes[0] < 0) {
+            logger::log_error(DBERR_INVALID_PARAMETER, "Dataset", filePath, "was not admitted: the resident datasets limit or memory budget is reached. Unload a dataset first.");
+        }
         return indexes[0];
     }
 
@@ -563,6 +714,161 @@ namespace hec {
         return ret;
     }
 
+    int insertObjects(DatasetID datasetID, std::vector<std::pair<size_t, std::string>> &objects) {
+        SerializedMsg<char> msg(MPI_CHAR);
+        DB_STATUS ret = pack::packObjectInserts(datasetID, objects, msg);
+        if (ret != DBERR_OK) {
+            logger::log_error(ret, "Packing object inserts failed.");
+            return -1;
+        }
+        // send message to Host Controller to forward the objects to the workers
+        ret = comm::send::sendMessage(msg, HOST_CONTROLLER, MSG_INSERT_OBJECTS, g_global_intra_comm);
+        if (ret != DBERR_OK) {
+            logger::log_error(ret, "Sending insert objects message failed.");
+            return -1;
+        }
+        // free memory
+        msg.clear();
+
+        // wait for ACK
+        ret = waitForResponse();
+        if (ret != DBERR_OK) {
+            logger::log_error(ret, "Inserting objects finished with errors.");
+            return -1;
+        }
+        return ret;
+    }
+
+    int deleteObjects(DatasetID datasetID, std::vector<size_t> &recIDs) {
+        SerializedMsg<char> msg(MPI_CHAR);
+        std::vector<size_t> datasetAndRecIDs = {(size_t) datasetID};
+        datasetAndRecIDs.insert(datasetAndRecIDs.end(), recIDs.begin(), recIDs.end());
+
+        DB_STATUS ret = pack::packValues(msg, datasetAndRecIDs);
+        if (ret != DBERR_OK) {
+            logger::log_error(ret, "Packing object deletes failed.");
+            return -1;
+        }
+        // send message to Host Controller to forward the IDs to the workers
+        ret = comm::send::sendMessage(msg, HOST_CONTROLLER, MSG_DELETE_OBJECTS, g_global_intra_comm);
+        if (ret != DBERR_OK) {
+            logger::log_error(ret, "Sending delete objects message failed.");
+            return -1;
+        }
+        // free memory
+        msg.clear();
+
+        // wait for ACK
+        ret = waitForResponse();
+        if (ret != DBERR_OK) {
+            logger::log_error(ret, "Deleting objects finished with errors.");
+            return -1;
+        }
+        return ret;
+    }
+
+    /** @brief Sends the pipeline settings to the host, which applies them on every node. -1 keeps a setting. */
+    static int setPipeline(int rangeCacheEntries, int resultDelivery) {
+        SerializedMsg<char> msg(MPI_CHAR);
+        std::vector<int> settings = {rangeCacheEntries, resultDelivery};
+        DB_STATUS ret = pack::packValues(msg, settings);
+        if (ret != DBERR_OK) {
+            logger::log_error(ret, "Packing pipeline settings failed.");
+            return -1;
+        }
+        // send message to Host Controller to forward the settings to the workers
+        ret = comm::send::sendMessage(msg, HOST_CONTROLLER, MSG_SET_PIPELINE, g_global_intra_comm);
+        if (ret != DBERR_OK) {
+            logger::log_error(ret, "Sending pipeline settings message failed.");
+            return -1;
+        }
+        // free memory
+        msg.clear();
+
+        // wait for ACK
+        ret = waitForResponse();
+        if (ret != DBERR_OK) {
+            logger::log_error(ret, "Setting the pipeline finished with errors.");
+            return -1;
+        }
+        return ret;
+    }
+
+    int setRangeCache(int entries) {
+        if (entries < 0) {
+            logger::log_error(DBERR_INVALID_PARAMETER, "Range cache entries must be non-negative. Entries:", entries);
+            return -1;
+        }
+        return setPipeline(entries, -1);
+    }
+
+    int setResultDelivery(std::string resultDeliveryStr) {
+        int resultDelivery;
+        if (resultDeliveryStr == "HOST") {
+            resultDelivery = RD_HOST;
+        } else if (resultDeliveryStr == "TREE") {
+            resultDelivery = RD_TREE;
+        } else if (resultDeliveryStr == "DIRECT") {
+            resultDelivery = RD_DIRECT;
+        } else {
+            logger::log_error(DBERR_INVALID_PARAMETER, "Unknown result delivery type:", resultDeliveryStr);
+            return -1;
+        }
+        return setPipeline(-1, resultDelivery);
+    }
+
+    int saveSnapshot(DatasetID datasetID, std::string snapshotPath) {
+        SerializedMsg<char> msg(MPI_CHAR);
+        DB_STATUS ret = pack::packSnapshotRequest(datasetID, snapshotPath, msg);
+        if (ret != DBERR_OK) {
+            logger::log_error(ret, "Packing snapshot request failed.");
+            return -1;
+        }
+        // send message to Host Controller to forward the request to the workers
+        ret = comm::send::sendMessage(msg, HOST_CONTROLLER, MSG_SAVE_SNAPSHOT, g_global_intra_comm);
+        if (ret != DBERR_OK) {
+            logger::log_error(ret, "Sending save snapshot message failed.");
+            return -1;
+        }
+        // free memory
+        msg.clear();
+
+        // wait for ACK
+        ret = waitForResponse();
+        if (ret != DBERR_OK) {
+            logger::log_error(ret, "Saving snapshot finished with errors.");
+            return -1;
+        }
+        logger::log_success("Saved snapshot.");
+        return ret;
+    }
+
+    int loadSnapshot(DatasetID datasetID, std::string snapshotPath) {
+        SerializedMsg<char> msg(MPI_CHAR);
+        DB_STATUS ret = pack::packSnapshotRequest(datasetID, snapshotPath, msg);
+        if (ret != DBERR_OK) {
+            logger::log_error(ret, "Packing snapshot request failed.");
+            return -1;
+        }
+        // send message to Host Controller to forward the request to the workers
+        ret = comm::send::sendMessage(msg, HOST_CONTROLLER, MSG_LOAD_SNAPSHOT, g_global_intra_comm);
+        if (ret != DBERR_OK) {
+            logger::log_error(ret, "Sending load snapshot message failed.");
+            return -1;
+        }
+        // free memory
+        msg.clear();
+
+        // wait for ACK
+        ret = waitForResponse();
+        if (ret != DBERR_OK) {
+            logger::log_error(ret, "Loading snapshot finished with errors.");
+            return -1;
+        }
+        logger::log_success("Loaded snapshot.");
+        return ret;
+    }
+
     int load(std::vector<DatasetID> datasetIndexes) {
         // SerializedMsg<char> msg(MPI_CHAR);
         // DB_STATUS ret = pack::packValues(msg, datasetIndexes);
@@ -591,9 +897,8 @@ namespace hec {
         return DBERR_FEATURE_UNSUPPORTED;
     }
 
-    hec::QResultBase* query(Query* query) {
-        DB_STATUS ret = DBERR_OK;        
-        SerializedMsg<char> msg(MPI_CHAR);
+    /** @brief Creates the empty result object that matches the query's type and result type. */
+    static hec::QResultBase* createQueryResult(Query* query) {
         hec::QResultBase* qResPtr;        
         switch (query->getQueryType()) {
             case Q_RANGE:
@@ -661,27 +966,104 @@ namespace hec {
                 logger::log_error(DBERR_QUERY_INVALID_TYPE, "Invalid query type:", query->getQueryType());
                 return nullptr;
         }
+        return qResPtr;
+    }
+
+    QueryHandle queryAsync(Query* query) {
+        DB_STATUS ret = DBERR_OK;
+        SerializedMsg<char> msg(MPI_CHAR);
+        // results are matched back by query ID, so it must be unique among the unclaimed queries
+        if (pendingQueries.find(query->getQueryID()) != pendingQueries.end() || completedQueries.find(query->getQueryID()) != completedQueries.end() || failedQueries.find(query->getQueryID()) != failedQueries.end()) {
+            logger::log_error(DBERR_INVALID_PARAMETER, "A query with ID", query->getQueryID(), "is already in flight.");
+            return -1;
+        }
+        // create query result object
+        hec::QResultBase* qResPtr = createQueryResult(query);
+        if (qResPtr == nullptr) {
+            return -1;
+        }
+        comm::telemetry::setQueryScope(query->getQueryID());
         // pack query info
+        double startTime = MPI_Wtime();
         int res = query->serialize(&msg.data, msg.count);
         if (res < 0) {
             logger::log_error(DBERR_SERIALIZE_FAILED, "Failed to serialize query.");
-            return nullptr;
+            comm::telemetry::setQueryScope(NO_QUERY_SCOPE);
+            delete qResPtr;
+            return -1;
         }
+        comm::telemetry::recordSerialization(HOST_CONTROLLER, MSG_QUERY, g_global_intra_comm, MPI_Wtime() - startTime);
         // send the query to Host Controller
         ret = comm::send::sendMessage(msg, HOST_CONTROLLER, MSG_QUERY, g_global_intra_comm);
+        comm::telemetry::setQueryScope(NO_QUERY_SCOPE);
         if (ret != DBERR_OK) {
-            logger::log_error(ret, "Sending dataset load message failed.");
-            return nullptr;
+            logger::log_error(ret, "Sending query message failed.");
+            delete qResPtr;
+            return -1;
         }
         // free memory
         msg.clear();
+        // the result will be filled in when it arrives
+        pendingQueries[query->getQueryID()] = qResPtr;
+        return query->getQueryID();
+    }
+
+    hec::QResultBase* wait(QueryHandle handle) {
+        auto pendingIt = pendingQueries.find(handle);
+        if (pendingIt == pendingQueries.end() && completedQueries.find(handle) == completedQueries.end() && failedQueries.find(handle) == failedQueries.end()) {
+            logger::log_error(DBERR_INVALID_PARAMETER, "No query in flight with handle", handle);
+            return nullptr;
+        }
         // wait for result
-        ret = waitForResult(qResPtr);
+        DB_STATUS ret = waitForResult(handle);
         if (ret != DBERR_OK) {
             logger::log_error(ret, "Receiving query results failed.");
-            return qResPtr;
+            // drop the partial result
+            pendingIt = pendingQueries.find(handle);
+            if (pendingIt != pendingQueries.end()) {
+                delete pendingIt->second;
+                pendingQueries.erase(pendingIt);
+            }
+            receivedChunks.erase(handle);
+            expectedChunks.erase(handle);
+            failingQueries.erase(handle);
+            return nullptr;
+        }
+        hec::QResultBase* qResPtr = completedQueries[handle];
+        completedQueries.erase(handle);
+        return qResPtr;
+    }
+
+    bool test(QueryHandle handle) {
+        MPI_Status status;
+        // receive whatever results have already arrived
+        for (int tag : {MSG_QUERY_RESULT, MSG_QUERY_RESULT_CHUNK, MSG_QUERY_RESULT_DELIVERED, MSG_QUERY_FAILED}) {
+            int messageFound = 1;
+            while (messageFound) {
+                DB_STATUS ret = comm::probe(MPI_ANY_SOURCE, tag, g_global_intra_comm, status, messageFound);
+                if (ret != DBERR_OK) {
+                    return false;
+                }
+                if (messageFound) {
+                    ret = receiveResult(status);
+                    if (ret != DBERR_OK) {
+                        return false;
+                    }
+                }
+            }
+        }
+        return completedQueries.find(handle) != completedQueries.end() || failedQueries.find(handle) != failedQueries.end();
+    }
+
+    hec::QResultBase* query(Query* query) {
+        QueryHandle handle = queryAsync(query);
+        if (handle < 0) {
+            return nullptr;
+        }
+        hec::QResultBase* qResPtr = wait(handle);
+        if (qResPtr != nullptr) {
+            logger::log_success("Evaluated query!");
         }
-        logger::log_success("Evaluated query!");
         return qResPtr;
     }
 
@@ -733,6 +1115,120 @@ namespace hec {
         return finalResults;
     }
 
+    std::vector<hec::CommStats> getCommStats(bool reset) {
+        std::vector<hec::CommStats> allStats;
+        SerializedMsg<char> msg(MPI_CHAR);
+        // pack the reset flag
+        int resetFlag = reset;
+        DB_STATUS ret = pack::packValues(msg, resetFlag);
+        if (ret != DBERR_OK) {
+            logger::log_error(ret, "Failed to pack telemetry request.");
+            return allStats;
+        }
+        // send the request to the host controller
+        ret = comm::send::sendMessage(msg, HOST_CONTROLLER, MSG_TELEMETRY, g_global_intra_comm);
+        if (ret != DBERR_OK) {
+            logger::log_error(ret, "Sending telemetry request failed.");
+            return allStats;
+        }
+        msg.clear();
+        // wait for the gathered counters, results of in-flight queries are kept for wait()
+        MPI_Status status;
+        ret = probeHostController(MSG_TELEMETRY, status);
+        if (ret != DBERR_OK) {
+            return allStats;
+        }
+        SerializedMsg<char> statsMsg(MPI_CHAR);
+        ret = comm::recv::receiveMessage(status, statsMsg.type, g_global_intra_comm, statsMsg);
+        if (ret != DBERR_OK) {
+            return allStats;
+        }
+        ret = unpack::unpackValues(statsMsg, allStats);
+        if (ret != DBERR_OK) {
+            logger::log_error(ret, "Failed to unpack telemetry.");
+            allStats.clear();
+            return allStats;
+        }
+        statsMsg.clear();
+        // add the driver's own
+        std::vector<hec::CommStats> driverStats = comm::telemetry::collect(reset);
+        allStats.insert(allStats.end(), driverStats.begin(), driverStats.end());
+        return allStats;
+    }
+
+    std::vector<hec::MemoryFootprint> getMemoryFootprint(DatasetID datasetID) {
+        std::vector<hec::MemoryFootprint> footprints;
+        SerializedMsg<char> msg(MPI_CHAR);
+        int datasetIndex = datasetID;
+        DB_STATUS ret = pack::packValues(msg, datasetIndex);
+        if (ret != DBERR_OK) {
+            logger::log_error(ret, "Failed to pack memory footprint request.");
+            return footprints;
+        }
+        // send the request to the host controller
+        ret = comm::send::sendMessage(msg, HOST_CONTROLLER, MSG_MEMORY_FOOTPRINT, g_global_intra_comm);
+        if (ret != DBERR_OK) {
+            logger::log_error(ret, "Sending memory footprint request failed.");
+            return footprints;
+        }
+        msg.clear();
+        // wait for the gathered footprints
+        MPI_Status status;
+        ret = probeHostController(MSG_MEMORY_FOOTPRINT, status);
+        if (ret != DBERR_OK) {
+            return footprints;
+        }
+        SerializedMsg<char> footprintMsg(MPI_CHAR);
+        ret = comm::recv::receiveMessage(status, footprintMsg.type, g_global_intra_comm, footprintMsg);
+        if (ret != DBERR_OK) {
+            return footprints;
+        }
+        ret = unpack::unpackValues(footprintMsg, footprints);
+        if (ret != DBERR_OK) {
+            logger::log_error(ret, "Failed to unpack memory footprints.");
+            footprints.clear();
+        }
+        footprintMsg.clear();
+        return footprints;
+    }
+
+    std::vector<hec::ObjectRecord> lookupObjects(DatasetID datasetID, const std::vector<size_t> &recIDs, bool withGeometry) {
+        std::vector<hec::ObjectRecord> records;
+        SerializedMsg<char> msg(MPI_CHAR);
+        std::vector<size_t> request = {(size_t) datasetID, (size_t) withGeometry};
+        request.insert(request.end(), recIDs.begin(), recIDs.end());
+        DB_STATUS ret = pack::packValues(msg, request);
+        if (ret != DBERR_OK) {
+            logger::log_error(ret, "Failed to pack object lookup request.");
+            return records;
+        }
+        // send the request to the host controller
+        ret = comm::send::sendMessage(msg, HOST_CONTROLLER, MSG_LOOKUP_OBJECTS, g_global_intra_comm);
+        if (ret != DBERR_OK) {
+            logger::log_error(ret, "Sending object lookup request failed.");
+            return records;
+        }
+        msg.clear();
+        // wait for the fetched objects
+        MPI_Status status;
+        ret = probeHostController(MSG_LOOKUP_OBJECTS, status);
+        if (ret != DBERR_OK) {
+            return records;
+        }
+        SerializedMsg<char> recordsMsg(MPI_CHAR);
+        ret = comm::recv::receiveMessage(status, recordsMsg.type, g_global_intra_comm, recordsMsg);
+        if (ret != DBERR_OK) {
+            return records;
+        }
+        ret = unpack::unpackObjectRecords(recordsMsg, records);
+        if (ret != DBERR_OK) {
+            logger::log_error(ret, "Failed to unpack fetched objects.");
+            records.clear();
+        }
+        recordsMsg.clear();
+        return records;
+    }
+
     namespace range_queries 
     {
         static int loadQueriesFromWKT(std::string &filePath, int datasetID, hec::QueryResultType resultType, std::vector<hec::Query*> &batchQueries) {
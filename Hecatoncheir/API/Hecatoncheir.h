@@ -61,18 +61,76 @@ namespace hec {
     /** @brief Run a query described by the passed object. */
     hec::QResultBase* query(Query* query);
 
+    /** @brief Issue a query without waiting for its result. 
+     * Several queries may be in flight at the same time, as long as their query IDs are distinct.
+     * @return A handle to pass to wait()/test(), or -1 on failure.
+     */
+    QueryHandle queryAsync(Query* query);
+
+    /** @brief Block until the result of the query with the given handle has arrived and return it. 
+     * The caller takes ownership of the returned result object. Returns nullptr if the query failed. */
+    hec::QResultBase* wait(QueryHandle handle);
+
+    /** @brief Check without blocking whether the result of the query with the given handle has arrived (or the query failed). */
+    bool test(QueryHandle handle);
+
     /** @brief Run queries in batches. */
     std::unordered_map<int, std::unique_ptr<hec::QResultBase>> query(std::vector<Query*> &queryBatch, hec::QueryType batchType);
 
     /** @brief Build index of indexType for the given datasets. */
     int buildIndex(std::vector<DatasetID> datasetIndexes, IndexType indexType);
 
+    /** @brief Insert objects into the built index of the given dataset, without rebuilding it. 
+     * @param objects (recID, WKT geometry) pairs. The geometries must lie in the dataset's dataspace.
+     */
+    int insertObjects(DatasetID datasetID, std::vector<std::pair<size_t, std::string>> &objects);
+
+    /** @brief Remove the objects with the given recIDs from the built index of the given dataset, without rebuilding it. */
+    int deleteObjects(DatasetID datasetID, std::vector<size_t> &recIDs);
+
+    /** @brief Set the max cached range windows per dataset on every worker, 0 disables the range cache (the default).
+     * Shrinking it drops the cached windows.
+     */
+    int setRangeCache(int entries);
+
+    /** @brief Set how the workers' query results reach the driver: "HOST" (merged by the host), "TREE" (merged among the workers)
+     * or "DIRECT" (merged by the driver). Overrides Pipeline.resultDelivery of the configuration.
+     */
+    int setResultDelivery(std::string resultDeliveryStr);
+
+    /** @brief Save the objects, built index and APRIL of the given dataset into per-node snapshot files.
+     * Each node writes its own file, at snapshotPath suffixed by its rank.
+     */
+    int saveSnapshot(DatasetID datasetID, std::string snapshotPath);
+
+    /** @brief Restore the given prepared dataset from the per-node snapshot files at snapshotPath,
+     * instead of partitioning it and building its index. The cluster must have the same number of nodes
+     * and partitioning grid as when the snapshot was saved.
+     */
+    int loadSnapshot(DatasetID datasetID, std::string snapshotPath);
+
     /** @brief Load a batch of range queries from the given filepath. */
     std::vector<hec::Query*> loadRangeQueriesFromFile(std::string filePath, std::string fileTypeStr, int datasetID, hec::QueryResultType resultType);
     
     /** @brief Load a batch of knn queries from the given filepath */
     std::vector<hec::Query*> loadKNNQueriesFromFile(std::string filePath, std::string fileTypeStr, int datasetID, int k);
 
+    /** @brief Get the communication counters of every rank (driver included), per query, message tag and peer.
+     * Queries still in flight are completed by the host first.
+     * @param[in] reset: if true, the counters are reset after being reported.
+     */
+    std::vector<hec::CommStats> getCommStats(bool reset);
+
+    /** @brief Get the approximate memory held by the given dataset on every worker, per component 
+     * (geometry, MBRs, index, APRIL, maps). Queries still in flight are completed by the host first. */
+    std::vector<hec::MemoryFootprint> getMemoryFootprint(DatasetID datasetID);
+
+    /** @brief Fetch the objects with the given rec IDs of a partitioned dataset, in the requested order. 
+     * The host sends each ID only to the worker that holds the object. IDs that do not exist are left out.
+     * @param[in] withGeometry: if true, the records hold the objects' WKT as well as their MBR.
+     */
+    std::vector<hec::ObjectRecord> lookupObjects(DatasetID datasetID, const std::vector<size_t> &recIDs, bool withGeometry);
+
 
     namespace time {
         /** @brief get a timestamp in Hecatoncheir's environment. */
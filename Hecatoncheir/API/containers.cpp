@@ -559,6 +559,13 @@ namespace hec
         return this->queryResultType;
     }
 
+    int QResultBase::getQueryIDFromSerializedBuffer(const char *buffer, int bufferSize) {
+        int res;
+        // query id
+        memcpy(&res, buffer, sizeof(int));
+        return res;
+    }
+
     QueryType QResultBase::getQueryTypeFromSerializedBuffer(const char *buffer, int bufferSize) {
         int position = sizeof(int); // move position accordingly
         QueryType res;
@@ -593,6 +600,10 @@ namespace hec
         // printf("%ld,%ld\n", idR, idS);
     }
 
+    void QResultCount::addResults(size_t count) {
+        this->resultCount += count;
+    }
+
     int QResultCount::calculateBufferSize() {
         int size = 0;
         size += sizeof(int);                                                // query ID
@@ -812,7 +823,7 @@ namespace hec
     }
 
     QResultBase* QResultCollect::cloneEmpty() {
-        QResultBase* newPtr = new hec::QPairResultCollect(queryID, queryType, queryResultType);
+        QResultBase* newPtr = new hec::QResultCollect(queryID, queryType, queryResultType);
         return newPtr;
     }
 
@@ -42,6 +42,7 @@ namespace hec
     enum IndexType {
         IT_UNIFORM_GRID,
         IT_TWO_LAYER,
+        IT_RTREE,
     };
 
     struct SupportedQueryResultTypes {
@@ -98,6 +99,7 @@ namespace hec
         virtual void serialize(char **buffer, int &bufferSize) = 0;
         virtual void deserialize(const char *buffer, int bufferSize) = 0;
 
+        static int getQueryIDFromSerializedBuffer(const char *buffer, int bufferSize);
         static QueryType getQueryTypeFromSerializedBuffer(const char *buffer, int bufferSize);
         static QueryResultType getResultTypeFromSerializedBuffer(const char *buffer, int bufferSize);
 
@@ -140,6 +142,8 @@ namespace hec
         QResultCount(int queryID, QueryType queryType, QueryResultType queryResultType);
         void addResult(size_t id) override;
         void addResult(size_t idR, size_t idS) override;
+        /** @brief Adds the given number of results at once. */
+        void addResults(size_t count);
         int calculateBufferSize() override;
         void serialize(char **buffer, int &bufferSize) override;
         void deserialize(const char *buffer, int bufferSize) override;
@@ -249,6 +253,59 @@ namespace hec
     /** @brief unique identifier for each prepared/loaded dataset. */
     typedef int DatasetID;
 
+    /** @brief handle of a query issued with queryAsync(). It is the query's ID. */
+    typedef int QueryHandle;
+
+    /** @brief Communication counters of a single rank, for one (query, message tag, peer) triplet.
+     * queryID is -1 for traffic that does not belong to a query. Peers are global ranks (0 = driver, 1 = host).
+     * Times are in seconds. */
+    struct CommStats {
+        int rank = -1;
+        int queryID = -1;
+        int tag = -1;
+        int peer = -1;
+        size_t sentMessages = 0;
+        size_t sentBytes = 0;
+        size_t recvMessages = 0;
+        size_t recvBytes = 0;
+        /** @brief time spent inside blocking sends. */
+        double sendTime = 0;
+        /** @brief time spent blocked in probes, waiting for a message to arrive. */
+        double probeTime = 0;
+        /** @brief time spent inside receives. */
+        double recvTime = 0;
+        /** @brief time spent serializing the message payloads. */
+        double serializationTime = 0;
+    };
+
+    /** @brief Approximate memory held by one dataset on a single worker, per component, in bytes.
+     * Estimated from the sizes and capacities of the containers. The rank is global (0 = driver, 1 = host). */
+    struct MemoryFootprint {
+        int rank = -1;
+        int datasetID = -1;
+        size_t objectCount = 0;
+        /** @brief entries in the partitions, replicas included. */
+        size_t indexEntryCount = 0;
+        /** @brief the objects and their vertices. */
+        size_t geometryBytes = 0;
+        /** @brief the objects' MBRs and the MBR arrays of the partitions. */
+        size_t mbrBytes = 0;
+        /** @brief partition contents, pending updates, sub-grids, R-tree nodes, the partition directory and the range cache. */
+        size_t indexBytes = 0;
+        /** @brief the objects' APRIL intervals. */
+        size_t aprilBytes = 0;
+        /** @brief the dataset's rec ID maps and sets. */
+        size_t mapBytes = 0;
+    };
+
+    /** @brief An object fetched by its rec ID: its MBR and (if requested) its geometry as WKT. */
+    struct ObjectRecord {
+        size_t recID = 0;
+        double xMin = 0, yMin = 0, xMax = 0, yMax = 0;
+        /** @brief empty if the geometry was not requested. */
+        std::string wkt;
+    };
+
     /** @brief Base query class. */
     struct Query {
     protected:
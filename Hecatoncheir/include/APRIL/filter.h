@@ -6,6 +6,10 @@
 #include "APRIL/join.h"
 #include "refinement/topology.h"
 
+/** @brief Most raster cells of a range query window's MBR that are rasterized for APRIL. 
+ * Larger windows are refined without APRIL, since their rasterization buffer grows with their area. */
+#define APRIL_WINDOW_MAX_CELLS (1ULL << 24)
+
 /** @brief APRIL related methods. */
 namespace APRIL
 {
@@ -33,6 +37,24 @@ namespace APRIL
          * @param[out] queryOutput Where the query result is appended.
          */
         DB_STATUS IntermediateFilterEntrypoint(Shape* objR, Shape* objS, hec::QResultBase* queryOutput);
+
+        /**
+        @brief Rasterizes a range query window once, with the dataset's APRIL configuration, if its candidates can be filtered with APRIL:
+         * the intermediate filter must be enabled, the dataset must have APRIL (non-point data) and the window must be a region
+         * within the raster bounds, of at most APRIL_WINDOW_MAX_CELLS raster cells. Otherwise the window is left without APRIL.
+         * @param[in] dataset The queried dataset.
+         * @param[in,out] window The query window, with its MBR set.
+         */
+        DB_STATUS createWindowAPRIL(Dataset* dataset, Shape* window);
+
+        /**
+        @brief APRIL intermediate filter for a range query candidate, whose window holds APRIL (see createWindowAPRIL).
+         * True hits are reported and true negatives dropped without refinement.
+         * @param[in] window The query window.
+         * @param[in] obj The candidate object, whose MBR intersects the window's.
+         * @param[out] queryOutput Where the query result is appended.
+         */
+        DB_STATUS RangeFilterEntrypoint(Shape* window, Shape* obj, hec::QResultBase* queryOutput);
     }
 }
 
@@ -31,6 +31,9 @@ namespace APRIL
 
         /** @brief Sets the raster bounds for the intervalization space of APRIL */
         DB_STATUS setRasterBounds(DataspaceMetadata &dataspaceMetadata);
+
+        /** @brief Returns the raster bounds of the intervalization space of APRIL (inverted if never set). */
+        const DataspaceMetadata& getRasterBounds();
         
         /** @brief Disk-based APRIL generation methods, for very large datasets or when there's limited memory. */
         namespace disk
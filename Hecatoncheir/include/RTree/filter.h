@@ -0,0 +1,53 @@
+#ifndef D_RTREE_FILTER_H
+#define D_RTREE_FILTER_H
+
+#include "containers.h"
+#include "../API/containers.h"
+
+/** @brief The packed R-tree MBR filter methods. */
+namespace rtree
+{
+    /** @brief Begins the query processing specified by the query object and stores the result in the query result object. 
+     * Distance joins are evaluated by the uniform grid's distance filter, on the same partitions.
+     */
+    DB_STATUS processQuery(hec::Query* query, std::unique_ptr<hec::QResultBase>& queryResult);
+
+    /** @brief Returns whether the point lies in the partition with the given ID. 
+     * A result is only reported by the partition that contains its reference point (the bottom-left corner of the MBRs' intersection),
+     * since the objects are stored in every partition they overlap. */
+    inline bool referencePointInPartition(double x, double y, int partitionID) {
+        int i = std::floor((x - g_config.datasetOptions.dataspaceMetadata.xMinGlobal) / g_config.partitioningMethod->getPartPartionExtentX());
+        int j = std::floor((y - g_config.datasetOptions.dataspaceMetadata.yMinGlobal) / g_config.partitioningMethod->getPartPartionExtentY());
+        return g_config.partitioningMethod->getPartitionID(i, j, g_config.partitioningMethod->getGlobalPPD()) == partitionID;
+    }
+
+    /** @brief Returns whether the two boxes intersect (touching included). */
+    inline bool intersects(double xMinA, double yMinA, double xMaxA, double yMaxA, double xMinB, double yMinB, double xMaxB, double yMaxB) {
+        return !(xMinA > xMaxB || xMaxA < xMinB || yMinA > yMaxB || yMaxA < yMinB);
+    }
+
+    namespace range_filter
+    {
+        /** @brief Evaluates a range query on the R-tree index. 
+         * Forwards the candidates to refinement (no intermediate filter). */
+        DB_STATUS evaluate(hec::RangeQuery *rangeQuery, std::unique_ptr<hec::QResultBase>& queryResult);
+    }
+
+    namespace knn_filter
+    {
+        /** @brief Evaluates a knn query on the R-tree index, best-first over the trees of all partitions. */
+        DB_STATUS evaluate(hec::KNNQuery *knnQuery, std::unique_ptr<hec::QResultBase>& queryResult);
+    }
+
+    namespace join_filter
+    {
+        /** @brief MBR join filter on the R-tree index, with a synchronized traversal of the common partitions' trees. 
+         * @param topology If set, the candidate pairs are forwarded based on their MBR relation (find relation), 
+         * otherwise as intersection join candidates.
+         */
+        DB_STATUS evaluate(hec::PredicateJoinQuery *joinQuery, bool topology, std::unique_ptr<hec::QResultBase>& queryResult);
+    }
+}
+
+
+#endif
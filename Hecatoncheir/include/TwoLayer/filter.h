@@ -17,6 +17,11 @@ namespace twolayer
         /** @brief MBR range query filter (non-point data) 
          * Forwards pairs to refinement (no intermediate filter). */
         DB_STATUS evaluate(hec::RangeQuery *rangeQuery, std::unique_ptr<hec::QResultBase>& queryResult);
+
+        /** @brief Evaluates a batch of range queries on the same dataset with shared scans: every partition class is swept once 
+         * against all the windows that need it. Partitions are scanned in parallel, each thread into its own results per query.
+         * @param queryResults The empty result object of each query, at the same position. */
+        DB_STATUS evaluateBatch(Dataset* dataset, std::vector<hec::RangeQuery*> &rangeQueries, std::vector<hec::QResultBase*> &queryResults);
     }
     
 
@@ -25,6 +30,9 @@ namespace twolayer
         /** @brief MBR intersection join filter (non-point data). 
          * Forwards pairs to either an intermediate filter (APRIL) or refinement. */
         DB_STATUS evaluate(hec::PredicateJoinQuery *joinQuery, std::unique_ptr<hec::QResultBase>& queryResult);
+
+        /** @brief Forwards a candidate pair with intersecting MBRs to the intermediate filter or refinement. */
+        DB_STATUS forwardPair(Shape* objR, Shape* objS, hec::QResultBase* queryResult);
     }
 
     namespace topological_join_filter
@@ -32,6 +40,9 @@ namespace twolayer
         /** @brief Specialized MBR join filter that considers MBRs in a topological manner for more-than-intersection join predicates. 
          * Forwards pairs to either an intermediate filter (APRIL) or refinement. */
         DB_STATUS evaluate(hec::PredicateJoinQuery *joinQuery, std::unique_ptr<hec::QResultBase>& queryResult);
+
+        /** @brief Classifies the MBR relation of a candidate pair with intersecting MBRs and forwards it accordingly. */
+        DB_STATUS relateMBRs(Shape* objR, Shape* objS, hec::QResultBase* queryResult);
     }
 
 }
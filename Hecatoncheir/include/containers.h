@@ -9,12 +9,17 @@
 
 #include <unistd.h>
 #include <vector>
+#include <algorithm>
 #include <stdio.h>
 #include <math.h>
 #include <any>
 #include <cstring>
 #include <variant>
 #include <optional>
+#include <deque>
+#include <unordered_set>
+#include <mutex>
+#include <memory>
 
 #include "def.h"
 #include "utils.h"
@@ -1349,6 +1354,16 @@ public:
         }, shape);
     }
 
+    /** @brief Returns the geometry as WKT, with enough digits to read back the same coordinates. */
+    std::string getWKT() const {
+        return std::visit([](auto&& arg) {
+            std::ostringstream ss;
+            ss.precision(std::numeric_limits<double>::max_digits10);
+            ss << boost::geometry::wkt(arg.geometry);
+            return ss.str();
+        }, shape);
+    }
+
     DB_STATUS serializeCoordinates(double** buffer, int &bufferSize) {
         return std::visit([&buffer, &bufferSize](auto&& arg) {
             return arg.serializeCoordinates(buffer, bufferSize);
@@ -1395,6 +1410,20 @@ public:
         }, shape);
     }
 
+    /** @brief Returns true if the geometry covers its whole (non-degenerate) MBR, i.e. it is an axis-aligned rectangle. 
+     * Then every object whose MBR lies inside the MBR intersects the geometry. The MBR must be set. */
+    bool coversMBR() const {
+        double mbrArea = (mbr.pMax.x - mbr.pMin.x) * (mbr.pMax.y - mbr.pMin.y);
+        if (!(mbrArea > 0)) {
+            return false;
+        }
+        double area = std::visit([](auto&& arg) -> double {
+            return std::abs(boost::geometry::area(arg.geometry));
+        }, shape);
+        // a valid geometry inside its MBR with the same area is the MBR
+        return area >= mbrArea * (1 - 1e-12);
+    }
+
     /** @brief Performs a point-in-polygon test with the given point (see derived method definitions). */
     bool pipTest(const bg_point_xy& point) const {
         return std::visit([&point](auto&& arg) -> bool {
@@ -1566,10 +1595,116 @@ namespace shape_factory
     DB_STATUS createEmpty(DataType dataType, Shape &object);
 }
 
+/** @brief A dataset object's position in the index structures: objects below the dataset's object count 
+ * are its loaded objects at that position, the ones from there on its inserted objects in insertion order. 
+ * Kept in 32 bits, half the size of a pointer. Translated to the object's recID only when reported. */
+typedef uint32_t ObjectHandle;
+
+/** @brief Resolves object handles to the dataset's objects. */
+struct ObjectStore {
+    std::vector<Shape>* objects = nullptr;
+    std::deque<Shape>* insertedObjects = nullptr;
+
+    inline Shape* get(ObjectHandle handle) const {
+        return handle < objects->size() ? &(*objects)[handle] : &(*insertedObjects)[handle - objects->size()];
+    }
+};
+
+/** @brief A list of object handles that reads as a list of objects: 
+ * its positions and iterators resolve the handles through the store. */
+struct ObjectList {
+    const ObjectStore* store = nullptr;
+    std::vector<ObjectHandle> handles;
+
+    /** @brief Random access iterator over the list's objects, yielding Shape pointers by value. */
+    struct iterator {
+        using iterator_category = std::random_access_iterator_tag;
+        using value_type = Shape*;
+        using difference_type = std::ptrdiff_t;
+        using pointer = Shape**;
+        using reference = Shape*;
+
+        const ObjectStore* store = nullptr;
+        const ObjectHandle* ptr = nullptr;
+
+        iterator() = default;
+        iterator(const ObjectStore* store, const ObjectHandle* ptr) : store(store), ptr(ptr) {}
+
+        inline Shape* operator*() const { return store->get(*ptr); }
+        inline Shape* operator[](difference_type n) const { return store->get(ptr[n]); }
+        inline iterator& operator++() { ++ptr; return *this; }
+        inline iterator operator++(int) { iterator it = *this; ++ptr; return it; }
+        inline iterator& operator--() { --ptr; return *this; }
+        inline iterator operator--(int) { iterator it = *this; --ptr; return it; }
+        inline iterator& operator+=(difference_type n) { ptr += n; return *this; }
+        inline iterator& operator-=(difference_type n) { ptr -= n; return *this; }
+        inline iterator operator+(difference_type n) const { return iterator(store, ptr + n); }
+        inline iterator operator-(difference_type n) const { return iterator(store, ptr - n); }
+        inline difference_type operator-(const iterator &other) const { return ptr - other.ptr; }
+        inline bool operator==(const iterator &other) const { return ptr == other.ptr; }
+        inline bool operator!=(const iterator &other) const { return ptr != other.ptr; }
+        inline bool operator<(const iterator &other) const { return ptr < other.ptr; }
+        inline bool operator<=(const iterator &other) const { return ptr <= other.ptr; }
+        inline bool operator>(const iterator &other) const { return ptr > other.ptr; }
+        inline bool operator>=(const iterator &other) const { return ptr >= other.ptr; }
+    };
+
+    inline size_t size() const { return handles.size(); }
+    inline bool empty() const { return handles.empty(); }
+    inline Shape* operator[](size_t position) const { return store->get(handles[position]); }
+    inline Shape* at(size_t position) const { return store->get(handles.at(position)); }
+    inline iterator begin() const { return iterator(store, handles.data()); }
+    inline iterator end() const { return iterator(store, handles.data() + handles.size()); }
+    inline void push_back(ObjectHandle handle) { handles.push_back(handle); }
+    inline void resize(size_t count) { handles.resize(count); }
+    inline void reserve(size_t count) { handles.reserve(count); }
+    inline size_t capacity() const { return handles.capacity(); }
+    inline void clear() { handles.clear(); }
+
+    /** @brief Sorts the positions [first, size()) by comparing their objects. */
+    template <typename Compare>
+    void sort(Compare compare, size_t first = 0) {
+        const ObjectStore* s = store;
+        std::sort(handles.begin() + first, handles.end(), [s, &compare](ObjectHandle a, ObjectHandle b) {
+            return compare(s->get(a), s->get(b));
+        });
+    }
+
+    /** @brief Stable sorts the list by comparing its objects. */
+    template <typename Compare>
+    void stableSort(Compare compare) {
+        const ObjectStore* s = store;
+        std::stable_sort(handles.begin(), handles.end(), [s, &compare](ObjectHandle a, ObjectHandle b) {
+            return compare(s->get(a), s->get(b));
+        });
+    }
+
+    /** @brief Merges the sorted positions [0, middle) and [middle, size()) by comparing their objects. */
+    template <typename Compare>
+    void inplaceMerge(size_t middle, Compare compare) {
+        const ObjectStore* s = store;
+        std::inplace_merge(handles.begin(), handles.begin() + middle, handles.end(), [s, &compare](ObjectHandle a, ObjectHandle b) {
+            return compare(s->get(a), s->get(b));
+        });
+    }
+};
+
 namespace qresult_factory
 {
     int createNew(int queryID, hec::QueryType queryType, hec::QueryResultType resultType, std::unique_ptr<hec::QResultBase> &object);
     int createNew(hec::Query* query, std::unique_ptr<hec::QResultBase> &object);
+
+    /** @brief Reports all the given objects as results of a single-object query: 
+     * count results add their number at once, the rest add each object's ID. */
+    inline void addAll(const ObjectList &objects, hec::QResultBase* queryResult) {
+        if (queryResult->getResultType() == hec::QR_COUNT) {
+            static_cast<hec::QResultCount*>(queryResult)->addResults(objects.size());
+            return;
+        }
+        for (Shape* obj : objects) {
+            queryResult->addResult(obj->recID);
+        }
+    }
 }
 
 /** @brief Holds information about sections, i.e. APRIL partitions.
@@ -1608,6 +1743,132 @@ struct DataspaceMetadata {
     DB_STATUS deserialize(const double *buffer, int bufferSize);
 };
 
+/** @brief A single rank's share of a dataset's metadata, computed over the part of the dataset file it scanned.
+ * The shares of all ranks are combined collectively (min/max for the extent, sum for the counts).
+ */
+struct DatasetMetadataPart {
+    double xMin = std::numeric_limits<int>::max();
+    double yMin = std::numeric_limits<int>::max();
+    double xMax = -std::numeric_limits<int>::max();
+    double yMax = -std::numeric_limits<int>::max();
+    size_t objects = 0;
+    size_t vertices = 0;
+    /** @brief Set if this rank could not scan its part (e.g. the dataset file is not accessible). */
+    bool failed = false;
+
+    /** @brief Merges another (thread's) part into this one. */
+    void merge(const DatasetMetadataPart &other);
+};
+
+/** @brief Structure-of-arrays copy of the MBRs of a partition's (class) contents, in the same order as the contents. 
+ * The filters scan these arrays (vectorized where available) and only dereference the Shape objects of the surviving candidates.
+ */
+struct MBRArrays {
+    std::vector<double> xMin;
+    std::vector<double> yMin;
+    std::vector<double> xMax;
+    std::vector<double> yMax;
+    /** @brief The union MBR of all the MBRs (inverted, i.e. disjoint with everything, when empty). */
+    double boundXMin = std::numeric_limits<double>::infinity();
+    double boundYMin = std::numeric_limits<double>::infinity();
+    double boundXMax = -std::numeric_limits<double>::infinity();
+    double boundYMax = -std::numeric_limits<double>::infinity();
+    /** @brief Whether the arrays are in ascending yMin order, as the two-layer classes A and C keep them. */
+    bool sortedOnY = true;
+    /** @brief The sums of the MBRs' coordinates, for their average extents. */
+    double sumXMin = 0, sumYMin = 0, sumXMax = 0, sumYMax = 0;
+
+    /** @brief (Re)builds the arrays from the objects, in their current order. */
+    void build(const ObjectList &objects);
+
+    void clear();
+
+    inline size_t size() const {
+        return xMin.size();
+    }
+
+    inline size_t memoryBytes() const {
+        return (xMin.capacity() + yMin.capacity() + xMax.capacity() + yMax.capacity()) * sizeof(double);
+    }
+
+    /** @brief Returns whether the union MBR intersects the given box (touching included). 
+     * If not, none of the MBRs does and the contents can be skipped. */
+    inline bool boundIntersects(double boxXMin, double boxYMin, double boxXMax, double boxYMax) const {
+        return !(boundXMin > boxXMax || boundXMax < boxXMin || boundYMin > boxYMax || boundYMax < boxYMin);
+    }
+
+    /** @brief Returns whether the union MBRs of the two arrays intersect (touching included). */
+    inline bool boundIntersects(const MBRArrays &other) const {
+        return boundIntersects(other.boundXMin, other.boundYMin, other.boundXMax, other.boundYMax);
+    }
+
+    /** @brief Returns whether the union MBR lies inside the given box (touching included), i.e. all MBRs do. */
+    inline bool boundWithin(double boxXMin, double boxYMin, double boxXMax, double boxYMax) const {
+        return boundXMin >= boxXMin && boundXMax <= boxXMax && boundYMin >= boxYMin && boundYMax <= boxYMax;
+    }
+
+    /** @brief For arrays sorted on yMin, returns the first position with yMin above boxYMax, or size() if none is. 
+     * No position from there on intersects a box with that top side. */
+    inline size_t endOnY(double boxYMax) const {
+        return std::upper_bound(yMin.begin(), yMin.end(), boxYMax) - yMin.begin();
+    }
+
+    /** @brief Appends to positions every position whose MBR intersects the given box (touching included). 
+     * Pass infinite bounds for the sides that need no check. */
+    void intersecting(double boxXMin, double boxYMin, double boxXMax, double boxYMax, std::vector<uint32_t> &positions) const;
+
+    /** @brief Same as above, over the positions [first, last) only. */
+    void intersecting(size_t first, size_t last, double boxXMin, double boxYMin, double boxXMax, double boxYMax, std::vector<uint32_t> &positions) const;
+
+    /** @brief Plane sweep step over arrays sorted on yMin: starting from position first, appends every position 
+     * whose MBR x extent overlaps [boxXMin, boxXMax], up to the first position with yMin above boxYMax. 
+     * Pass infinite bounds for the x sides that need no check. */
+    void sweep(size_t first, double boxXMin, double boxXMax, double boxYMax, std::vector<uint32_t> &positions) const;
+
+    /** @brief Same as sweep, over arrays sorted on xMin: the y extent is checked, up to the first position with xMin above boxXMax. */
+    void sweepX(size_t first, double boxYMin, double boxYMax, double boxXMax, std::vector<uint32_t> &positions) const;
+
+    /** @brief Returns whether a plane sweep of these MBRs against the other ones checks fewer pairs on X than on Y.
+     * A sweep checks about the pairs whose projections on its axis overlap: the sum of the average extents 
+     * over the span of the union MBR on that axis. If otherCrossesLeft, the other MBRs all start left of these 
+     * (two-layer class C against A), and an X sweep checks the ones of these starting before the others' average right side. */
+    bool preferSweepOnX(const MBRArrays &other, bool otherCrossesLeft) const;
+};
+
+/** @brief Partitions whose pending updates reach this many objects are merged right away. */
+#define PARTITION_DELTA_MERGE_THRESHOLD 1024
+
+/** @brief The pending updates of a partition's contents (or of one class of it): 
+ * the inserted objects that are not merged yet, unsorted, and a tombstone bitmap over the merged contents. */
+struct PartitionDelta {
+    std::vector<ObjectHandle> inserted;
+    std::vector<uint64_t> tombstones;
+    size_t removedCount = 0;
+
+    /** @brief Number of inserted and removed objects not merged into the contents yet. */
+    inline size_t pending() const {
+        return inserted.size() + removedCount;
+    }
+
+    inline bool isRemoved(size_t position) const {
+        return (position >> 6) < tombstones.size() && (tombstones[position >> 6] >> (position & 63)) & 1;
+    }
+
+    /** @brief Removes the object, either from the inserted objects or by marking its position in the contents. 
+     * If sortedOnY, the contents are sorted on the MBRs' bottom y and are binary searched. */
+    DB_STATUS remove(const ObjectList &contents, ObjectHandle handle, bool sortedOnY);
+
+    /** @brief Drops the removed objects from the contents and appends the inserted ones (merged in order, if sortedOnY). 
+     * Clears the pending updates. */
+    void merge(ObjectList &contents, bool sortedOnY);
+
+    inline size_t memoryBytes() const {
+        return inserted.capacity() * sizeof(ObjectHandle) + tombstones.capacity() * sizeof(uint64_t);
+    }
+
+    void clear();
+};
+
 struct PartitionBase {
     int partitionID;
     virtual ~PartitionBase() = default;
@@ -1617,66 +1878,281 @@ struct PartitionBase {
      *        This method is virtual because subclasses implement it differently.
      * @param classType Either A, B, C, or D (if applicable). May be ignored by some implementations.
      */
-    virtual std::vector<Shape*>* getContents(TwoLayerClass classType = CLASS_A) = 0;
+    virtual ObjectList* getContents(TwoLayerClass classType = CLASS_A) = 0;
 
     /** 
      * @brief Adds an object to the partition. 
      *        This method is virtual because subclasses implement it differently.
-     * @param objectRef Pointer to the shape to be added.
+     * @param handle The handle of the object to be added.
      * @param classType Either A, B, C, or D (if applicable). May be ignored by some implementations.
      */
-    virtual void addObject(Shape* objectRef, TwoLayerClass classType = CLASS_A) = 0;
+    virtual void addObject(ObjectHandle handle, TwoLayerClass classType = CLASS_A) = 0;
+
+    /** 
+     * @brief Returns the MBR arrays of the contents for the given class type, 
+     *        or nullptr if the partition doesn't keep them or they are out of date with the contents.
+     */
+    virtual MBRArrays* getMBRs(TwoLayerClass classType = CLASS_A) {
+        return nullptr;
+    }
+
+    /** @brief Builds the MBR arrays from the current contents (if the partition keeps them). */
+    virtual void buildMBRs() {}
+
+    /** @brief Returns the contents sorted on the MBRs' left x, or nullptr if the partition doesn't keep them or they are out of date. */
+    virtual ObjectList* getContentsSortedOnX() {
+        return nullptr;
+    }
+
+    /** @brief Returns the MBR arrays of getContentsSortedOnX(), or nullptr if the partition doesn't keep them or they are out of date. */
+    virtual MBRArrays* getMBRsSortedOnX() {
+        return nullptr;
+    }
+
+    /** @brief Sets bounds to the union MBR of the contents (of all classes) and returns true, 
+     * or returns false if the partition doesn't keep it or it is out of date with the contents. 
+     * Empty contents give an inverted MBR, disjoint with everything. */
+    virtual bool getContentBounds(MBR &bounds) {
+        return false;
+    }
+
+    /** @brief Returns false if the content bounds of both partitions are known and disjoint, i.e. no pair of their objects intersects. */
+    bool contentBoundsIntersect(PartitionBase* other);
+
+    /** @brief Inserts an object into a built partition. It is kept apart from the contents until the next mergeUpdates(). */
+    virtual DB_STATUS insertObject(ObjectHandle handle, TwoLayerClass classType = CLASS_A) {
+        logger::log_error(DBERR_FEATURE_UNSUPPORTED, "Updates are not supported by the partition type.");
+        return DBERR_FEATURE_UNSUPPORTED;
+    }
+
+    /** @brief Removes an object from a built partition. It stays in the contents until the next mergeUpdates(). */
+    virtual DB_STATUS removeObject(ObjectHandle handle, TwoLayerClass classType = CLASS_A) {
+        logger::log_error(DBERR_FEATURE_UNSUPPORTED, "Updates are not supported by the partition type.");
+        return DBERR_FEATURE_UNSUPPORTED;
+    }
+
+    /** @brief Returns the number of inserted and removed objects that are not merged into the contents yet. */
+    virtual size_t pendingUpdates() {
+        return 0;
+    }
+
+    /** @brief Merges the pending updates into the contents, keeping their order, and rebuilds the MBR arrays. */
+    virtual void mergeUpdates() {}
+
+    /** @brief Adds the memory held by the partition's contents, MBR arrays and pending updates to the footprint. */
+    virtual void measureMemory(hec::MemoryFootprint &footprint) const = 0;
 };
 
 
 struct PartitionTwoLayer : public PartitionBase {
     /** @brief Contains the list of objects (Shape) of each class for this partition. */
-    std::vector<Shape*> classIndex[4];
+    ObjectList classIndex[4];
+    /** @brief The MBRs of each class' objects, in the same order. */
+    MBRArrays classMBRs[4];
+    /** @brief The pending updates of each class. */
+    PartitionDelta classDelta[4];
+    /** @brief Class A sorted on the MBRs' left x and its MBR arrays, for the X sweeps of the joins. 
+     * Only built if the adaptive sweep is enabled. Class A is the only one whose objects all start inside the partition on both axes. */
+    ObjectList classIndexX;
+    MBRArrays classMBRsX;
 
     /**
      * @brief Constructor that initializes the partition ID and the 4 class containers.
      */
-    PartitionTwoLayer(int id) {
+    PartitionTwoLayer(int id, const ObjectStore* store) {
         partitionID = id;
         for (auto& it : classIndex) {
-            it.clear();
+            it.store = store;
         }
+        classIndexX.store = store;
     }
 
     /** 
      * @brief Returns a reference to the partition's contents for the given class type.
      *        Throws an exception if the class type is invalid.
      */
-    std::vector<Shape*>* getContents(TwoLayerClass classType) override;
+    ObjectList* getContents(TwoLayerClass classType) override;
 
     /** 
      * @brief Adds an object to the partition for the specified class type.
      */
-    void addObject(Shape* objectRef, TwoLayerClass classType) override;
+    void addObject(ObjectHandle handle, TwoLayerClass classType) override;
+
+    MBRArrays* getMBRs(TwoLayerClass classType) override;
+
+    void buildMBRs() override;
+
+    bool getContentBounds(MBR &bounds) override;
+
+    DB_STATUS insertObject(ObjectHandle handle, TwoLayerClass classType) override;
+
+    DB_STATUS removeObject(ObjectHandle handle, TwoLayerClass classType) override;
+
+    size_t pendingUpdates() override;
+
+    /** @brief Classes A and C stay sorted on Y. */
+    void mergeUpdates() override;
+
+    ObjectList* getContentsSortedOnX() override;
+
+    MBRArrays* getMBRsSortedOnX() override;
+
+    void measureMemory(hec::MemoryFootprint &footprint) const override;
+
+private:
+    /** @brief (Re)builds the X-sorted order of class A, if the adaptive sweep is enabled. */
+    void buildXOrder();
 };
 
 
+/** @brief Uniform grid cells holding more objects than this are subdivided into a sub-grid. */
+#define UG_SUBGRID_THRESHOLD 1024
+/** @brief The targeted average number of objects per sub-cell. */
+#define UG_SUBGRID_CELL_CAPACITY 64
+/** @brief Max sub-cells per dimension of a sub-grid. */
+#define UG_SUBGRID_MAX_CELLS_PER_DIM 256
+
+/** @brief Nested grid over an overloaded uniform grid cell. The cell's contents are grouped by the sub-cell that holds 
+ * the bottom-left corner of their MBR (clamped to the cell), in row-major order: 
+ * sub-cell (i,j) holds the positions [offsets[i+j*cellsPerDim], offsets[i+j*cellsPerDim+1]). */
+struct UGSubGrid {
+    int cellsPerDim = 0;
+    double xMin = 0, yMin = 0;
+    double cellExtentX = 0, cellExtentY = 0;
+    /** @brief The largest MBR width and height of the contents. An object may reach this far past its sub-cell. */
+    double maxWidth = 0, maxHeight = 0;
+    std::vector<uint32_t> offsets;
+
+    inline bool empty() const {
+        return cellsPerDim == 0;
+    }
+
+    /** @brief The sub-cell column of the x coordinate, clamped to the sub-grid. */
+    inline int column(double x) const {
+        double i = std::floor((x - xMin) / cellExtentX);
+        return i < 0 ? 0 : (i >= cellsPerDim ? cellsPerDim - 1 : (int) i);
+    }
+
+    /** @brief The sub-cell row of the y coordinate, clamped to the sub-grid. */
+    inline int row(double y) const {
+        double j = std::floor((y - yMin) / cellExtentY);
+        return j < 0 ? 0 : (j >= cellsPerDim ? cellsPerDim - 1 : (int) j);
+    }
+
+    void clear();
+};
+
 struct PartitionUniformGrid : public PartitionBase {
     /** @brief Contains the list of all objects (Shape) in this partition. */
-    std::vector<Shape*> classIndex;
+    ObjectList classIndex;
+    /** @brief The MBRs of the objects, in the same order. */
+    MBRArrays mbrs;
+    /** @brief The pending updates of the partition. */
+    PartitionDelta delta;
+    /** @brief The sub-grid of the cell, empty unless the cell holds more than UG_SUBGRID_THRESHOLD objects. */
+    UGSubGrid subGrid;
 
     /**
      * @brief Constructor that initializes the partition ID.
      */
-    PartitionUniformGrid(int id) {
+    PartitionUniformGrid(int id, const ObjectStore* store) {
         partitionID = id;
+        classIndex.store = store;
     }
 
     /** 
      * @brief Returns a reference to the partition's contents.
      *        Ignores the class type since UniformGridIndex doesn't use it.
      */
-    std::vector<Shape*>* getContents(TwoLayerClass classType = CLASS_A) override;
+    ObjectList* getContents(TwoLayerClass classType = CLASS_A) override;
 
     /** 
      * @brief Adds an object to the partition. Ignores the class type.
      */
-    void addObject(Shape* objectRef, TwoLayerClass classType = CLASS_A) override;
+    void addObject(ObjectHandle handle, TwoLayerClass classType = CLASS_A) override;
+
+    MBRArrays* getMBRs(TwoLayerClass classType = CLASS_A) override;
+
+    /** @brief Builds the sub-grid (if the cell is overloaded, this regroups the contents) and the MBR arrays. */
+    void buildMBRs() override;
+
+    bool getContentBounds(MBR &bounds) override;
+
+    DB_STATUS insertObject(ObjectHandle handle, TwoLayerClass classType = CLASS_A) override;
+
+    DB_STATUS removeObject(ObjectHandle handle, TwoLayerClass classType = CLASS_A) override;
+
+    size_t pendingUpdates() override;
+
+    void mergeUpdates() override;
+
+    /** @brief Appends to positions every position whose MBR intersects the given box (touching included), 
+     * visiting only the sub-cells that may hold such objects. Requires the MBR arrays (see getMBRs). */
+    void intersecting(double boxXMin, double boxYMin, double boxXMax, double boxYMax, std::vector<uint32_t> &positions) const;
+
+    void measureMemory(hec::MemoryFootprint &footprint) const override;
+
+private:
+    void buildSubGrid();
+};
+
+/** @brief Max entries per node of the packed R-trees. */
+#define RTREE_NODE_CAPACITY 16
+
+/** @brief A node of a packed R-tree. Its children are the entries [first, first+count) of the level below, or of the objects for leaves. */
+struct RTreeNode {
+    double xMin, yMin, xMax, yMax;
+    uint32_t first;
+    uint32_t count;
+    /** @brief The objects under the node whose MBR's bottom-left corner lies in the partition, 
+     * i.e. the ones the partition reports for any window that contains their MBR. */
+    uint32_t owned;
+};
+
+struct PartitionRTree : public PartitionBase {
+    /** @brief Contains the list of all objects (Shape) in this partition, in leaf order after the bulk load. */
+    ObjectList classIndex;
+    /** @brief The tree nodes in flat storage, level by level from the leaves up. The root is the last node. */
+    std::vector<RTreeNode> nodes;
+    /** @brief The position of the first node of each level in nodes (leaves at 0), followed by the nodes' count. */
+    std::vector<uint32_t> levelOffsets;
+
+    /**
+     * @brief Constructor that initializes the partition ID.
+     */
+    PartitionRTree(int id, const ObjectStore* store) {
+        partitionID = id;
+        classIndex.store = store;
+    }
+
+    /** 
+     * @brief Returns a reference to the partition's contents.
+     *        Ignores the class type since RTreeIndex doesn't use it.
+     */
+    ObjectList* getContents(TwoLayerClass classType = CLASS_A) override;
+
+    /** 
+     * @brief Adds an object to the partition. Ignores the class type. The tree must be (re)loaded afterwards.
+     */
+    void addObject(ObjectHandle handle, TwoLayerClass classType = CLASS_A) override;
+
+    /** @brief Bulk loads the tree over the partition's objects with Sort-Tile-Recursive packing. Reorders the objects. */
+    void bulkLoad();
+
+    /** @brief Returns whether the node at the given position is a leaf. */
+    inline bool isLeaf(uint32_t node) const {
+        return node < levelOffsets[1];
+    }
+
+    /** @brief Returns the position of the root node. The tree must be loaded and non-empty. */
+    inline uint32_t getRoot() const {
+        return nodes.size() - 1;
+    }
+
+    /** @brief The root node's MBR, once the tree is loaded. */
+    bool getContentBounds(MBR &bounds) override;
+
+    void measureMemory(hec::MemoryFootprint &footprint) const override;
 };
 
 
@@ -1724,8 +2200,12 @@ struct PartitioningMethod {
     PartitioningType type;
     /** @brief The number of partitions per dimension */
     int distPartitionsPerDim;
-    /** @brief The batch size for the data distribution, in number of objects. */             
+    /** @brief The batch size for the data distribution, in number of objects. Only used if batchBytes is 0. */             
     int batchSize;
+    /** @brief The target serialized size of each batch for the data distribution, in bytes. */
+    size_t batchBytes = DEFAULT_BATCH_BYTES;
+    /** @brief If set, each batch's byte budget is tuned at runtime based on the measured send throughput. */
+    bool adaptiveBatching = false;
     /** @brief The distribution (coarse) grid's dataspace metadata. */
     DataspaceMetadata distGridDataspaceMetadata;
     // The X,Y extents of a single partition in the distribution grid
@@ -1745,6 +2225,16 @@ struct PartitioningMethod {
         return batchSize;
     }
 
+    /** @brief Returns the target batch size in bytes. */
+    size_t getBatchBytes() {
+        return batchBytes;
+    }
+
+    /** @brief Returns whether the batch byte budget is tuned at runtime. */
+    bool isAdaptiveBatching() {
+        return adaptiveBatching;
+    }
+
     /** @brief Abstract method. Gets the partition's indices for the given partition ID , as defined by the derived partitioning method. */
     void getDistributionGridPartitionIndices(int partitionID, int &i, int &j) {
         j = partitionID / distPartitionsPerDim;
@@ -1899,13 +2389,21 @@ struct ApproximationMetadata {
     }
 };
 
+/** @brief Default max number of cached range windows per dataset, on each worker.
+ * Off: the cache only pays off on repeated windows, and a miss stores a copy of its candidates. */
+#define DEFAULT_RANGE_CACHE_ENTRIES 0
+
 /** @brief Holds all the query related metadata in the configuration.
  */
 struct QueryPipelineMetadata {
-    hec::QueryType queryType;
     int MBRFilter = 1;
     int IntermediateFilter = 1;
     int Refinement = 1;
+    /** @brief If set, the two-layer joins pick the plane sweep axis per partition pair. Otherwise they always sweep on Y. */
+    int adaptiveSweep = 1;
+    /** @brief The max cached range windows per dataset on each worker, 0 (the default) disables the range cache. */
+    int rangeCacheEntries = DEFAULT_RANGE_CACHE_ENTRIES;
+    ResultDeliveryType resultDelivery = RD_HOST;
 };
 
 /** @brief Holds all the system related metadata in the configuration.
@@ -1925,11 +2423,17 @@ struct Batch {
     // serializable
     size_t objectCount = 0;
     std::vector<Shape> objects;
+    size_t bufferSize = BATCH_HEADER_BYTES;   // serialized size of the batch so far
     // unserializable/unclearable (todo: make const?)
     int destRank = -1;   // destination node rank
-    size_t maxObjectCount = 0; 
+    size_t maxObjectCount = 0;      // flush threshold in objects (if maxBufferSize is 0)
+    size_t maxBufferSize = 0;       // flush threshold in serialized bytes
     MPI_Comm* comm; // communicator that the batch will be send through
     int tag = -1;        // MPI tag = indicates spatial data type
+    // adaptive byte budget state
+    bool adaptive = false;
+    double lastThroughput = 0;
+    int adaptDirection = 1;
 
     Batch();
     Batch(DatasetIndex datasetID, int destRank, int tag, MPI_Comm* comm) {
@@ -1943,6 +2447,13 @@ struct Batch {
     void addObjectToBatch(Shape &object);
     void setDestNodeRank(int destRank);
 
+    /** @brief Returns true if the batch has reached its byte budget (or its object count, if no budget is set) and should be sent. */
+    bool isFull();
+
+    /** @brief Adaptive mode only: doubles or halves the byte budget after a send of sentBytes that took sendTime seconds, 
+     * moving in the direction that improves throughput. The budget stays within [BATCH_MIN_BYTES, BATCH_MAX_BYTES]. */
+    void adaptBufferSize(size_t sentBytes, double sendTime);
+
     // calculate the size needed for the serialization buffer
     int calculateBufferSize();
 
@@ -1995,16 +2506,70 @@ struct DJBatch {
     static DB_STATUS probeSerializedForDestRank(const char *buffer, int bufferSize, int &destRank);
 };
 
+/** @brief Bits of the partition IDs that index inside a partition directory block. */
+#define PARTITION_DIRECTORY_BLOCK_BITS 12
+
+/** @brief Maps (non-negative) partition IDs to positions in an index's partitions vector by direct array indexing.
+ * The ID space is split into blocks of 2^PARTITION_DIRECTORY_BLOCK_BITS IDs that are allocated on first use, 
+ * so large grids only pay for the regions they populate. A bitmap of the occupied IDs lets scans over ID ranges 
+ * skip empty partitions a word (64 IDs) at a time.
+ */
+struct PartitionDirectory {
+private:
+    std::vector<std::unique_ptr<int32_t[]>> blocks;
+    std::vector<uint64_t> occupied;
+public:
+    /** @brief Returns the position stored for the partition ID, or -1 if there is none. */
+    inline int32_t find(int partitionID) const {
+        if (partitionID < 0) {
+            return -1;
+        }
+        size_t block = (size_t) partitionID >> PARTITION_DIRECTORY_BLOCK_BITS;
+        if (block >= blocks.size() || blocks[block] == nullptr) {
+            return -1;
+        }
+        return blocks[block][partitionID & ((1 << PARTITION_DIRECTORY_BLOCK_BITS) - 1)];
+    }
+
+    /** @brief Stores the position for the partition ID. */
+    void insert(int partitionID, int32_t position);
+
+    /** @brief Returns the first occupied partition ID in [first, last), or last if there is none. */
+    int nextOccupied(int first, int last) const;
+
+    size_t memoryBytes() const;
+
+    void clear();
+};
+
 /** @brief Abstract base class for all index structures. */
 class BaseIndex {
 protected:
     std::vector<PartitionBase*> partitions;
-    std::unordered_map<int, size_t> partitionMap;
+    PartitionDirectory partitionDirectory;
+    /** @brief Partitions that got updates since the last mergeUpdates() (may repeat). */
+    std::vector<PartitionBase*> updatedPartitions;
+    /** @brief Resolves the object handles that the partitions hold. */
+    ObjectStore objectStore;
 public:
-    virtual DB_STATUS addObject(Shape *objectRef) = 0;
+    virtual DB_STATUS addObject(ObjectHandle handle) = 0;
 
-    /** @brief Sorts all objects in the index along the Y-axis. */
-    virtual void sortPartitionsOnY() = 0;
+    /** @brief Sets the dataset objects that the index's object handles refer to. Must be called before any object is added. */
+    inline void setObjectStore(std::vector<Shape>* objects, std::deque<Shape>* insertedObjects) {
+        objectStore.objects = objects;
+        objectStore.insertedObjects = insertedObjects;
+    }
+
+    /** @brief Returns the object of the given handle. */
+    inline Shape* getObject(ObjectHandle handle) const {
+        return objectStore.get(handle);
+    }
+
+    /** @brief Returns the index type. */
+    virtual hec::IndexType getType() = 0;
+
+    /** @brief Sorts all objects in the index along the Y-axis, with the given number of threads. */
+    virtual void sortPartitionsOnY(int threads = MAX_THREADS) = 0;
 
     /** @brief returns the partitions */
     std::vector<PartitionBase*>* getPartitions();
@@ -2015,11 +2580,39 @@ public:
         return DBERR_FORBIDDEN_METHOD_CALL;
     }
 
+    /** @brief Returns the partitions that the object overlaps with and the object's class in each of them. 
+     * Indexes without classes (uniform grid) return CLASS_A for all partitions. */
+    virtual DB_STATUS getPartitionsAndClasses(Shape* objectRef, std::vector<int> &partitionIDs, std::vector<TwoLayerClass> &partitionClasses);
+
     /** @brief returns or creates (empty) the partition with the given id */
     virtual PartitionBase* getOrCreatePartition(int partitionID) = 0;
 
+    /** @brief Adds all objects of the object store (not the inserted ones) to the index in parallel, with the given number of threads. 
+     * The contents of each partition end up in the same order as if the objects were added one by one with addObject. */
+    DB_STATUS addObjects(int threads = MAX_THREADS);
+
+    /** @brief Inserts an object into the built index, in the delta of every partition (class) it belongs to. 
+     * @param[out] partitionCount The number of local partitions that received the object (0 if it belongs to other nodes).
+     */
+    DB_STATUS insertObject(ObjectHandle handle, int &partitionCount);
+
+    /** @brief Removes an object of the built index from every partition (class) it belongs to. */
+    DB_STATUS removeObject(ObjectHandle handle);
+
+    /** @brief Merges the pending updates of all updated partitions into their contents. Must run before queries read the index. */
+    void mergeUpdates();
+
     /** @brief returns the partition with the given id if it exists */
-    PartitionBase* getPartition(int partitionID);
+    inline PartitionBase* getPartition(int partitionID) {
+        int32_t position = partitionDirectory.find(partitionID);
+        return position < 0 ? nullptr : partitions[position];
+    }
+
+    /** @brief Returns the first existing partition ID in [first, last), or last if there is none. 
+     * Useful for scanning the consecutive partition IDs of a grid row. */
+    inline int nextPartitionID(int first, int last) const {
+        return partitionDirectory.nextOccupied(first, last);
+    }
 
     /** @brief returns the partition for the given x,y coordinates in the given dataspace metadata setting, as defined by the given partitioning method */
     PartitionBase* getPartition(double x, double y, DataspaceMetadata* dataspaceMetadata, PartitioningMethod* partitioningMethod);
@@ -2041,6 +2634,12 @@ public:
         return DBERR_FORBIDDEN_METHOD_CALL;
     }
 
+    /** @brief Builds the MBR arrays of all partitions. Must be called once their contents are final (and sorted). */
+    void buildMBRArrays(int threads = MAX_THREADS);
+
+    /** @brief Adds the memory held by the partitions and the partition directory to the footprint. */
+    void measureMemory(hec::MemoryFootprint &footprint) const;
+
     /** @brief clears all index contents */
     DB_STATUS clear();
 
@@ -2049,7 +2648,7 @@ public:
 
 /** @brief Holds all two-layer related index information.
  * @param partitions A vector containing each individual non-empty partition.
- * @param partitionMap A map that holds the positions of each partition (by ID) in the 'partitions' vector.
+ * @param partitionDirectory Holds the positions of each partition (by ID) in the 'partitions' vector.
  */
 struct TwoLayerIndex : public BaseIndex {
 private:
@@ -2060,15 +2659,21 @@ private:
     static DB_STATUS getPartitionsForMBR(Shape* objectRef, std::vector<int> &partitionIDs, std::vector<TwoLayerClass> &partionClasses);
 public:
     TwoLayerIndex(){};
-    
-    DB_STATUS addObject(Shape *objectRef) override;
+
+    DB_STATUS addObject(ObjectHandle handle) override;
+
+    hec::IndexType getType() override {
+        return hec::IT_TWO_LAYER;
+    }
+
+    DB_STATUS getPartitionsAndClasses(Shape* objectRef, std::vector<int> &partitionIDs, std::vector<TwoLayerClass> &partitionClasses) override;
 
     PartitionBase* getOrCreatePartition(int partitionID) override;
 
     /**
     @brief Sorts all objects in all partitions on the Y axis
      */
-    void sortPartitionsOnY() override;
+    void sortPartitionsOnY(int threads = MAX_THREADS) override;
 
     /** @brief Evaluate the given query and store results in the queryResult object. */
     DB_STATUS evaluateQuery(hec::Query* query, std::unique_ptr<hec::QResultBase>& queryResult) override;
@@ -2076,7 +2681,7 @@ public:
 
 /** @brief Holds all two-layer related index information.
  * @param partitions A vector containing each individual non-empty partition.
- * @param partitionMap A map that holds the positions of each partition (by ID) in the 'partitions' vector.
+ * @param partitionDirectory Holds the positions of each partition (by ID) in the 'partitions' vector.
  */
 struct UniformGridIndex : public BaseIndex {
     
@@ -2089,14 +2694,18 @@ private:
     UniformGridIndex(){};
     
     DB_STATUS getPartitionsForMBR(Shape* objectRef, std::vector<int> &partitionIDs) override;
-    DB_STATUS addObject(Shape *objectRef) override;
+    DB_STATUS addObject(ObjectHandle handle) override;
+
+    hec::IndexType getType() override {
+        return hec::IT_UNIFORM_GRID;
+    }
 
     PartitionBase* getOrCreatePartition(int partitionID) override;
 
     /**
     @brief Sorts all objects in all partitions on the Y axis
      */
-    void sortPartitionsOnY() override;
+    void sortPartitionsOnY(int threads = MAX_THREADS) override;
 
     /** @brief Evaluate the given query and store results in the queryResult object. */
     DB_STATUS evaluateQuery(hec::Query* query, std::unique_ptr<hec::QResultBase>& queryResult) override;
@@ -2106,6 +2715,117 @@ private:
     DB_STATUS evaluateDJBatch(hec::Query* query, DJBatch& batch, const std::unique_ptr<hec::QResultBase>& queryResult) override;
 };
 
+/** @brief Holds a packed Sort-Tile-Recursive R-tree per partition, for skewed non-point data.
+ * Uses the uniform grid's partitioning (objects are stored in every local partition they overlap), 
+ * so duplicate results are avoided with the reference point of the MBRs' intersection.
+ */
+struct RTreeIndex : public UniformGridIndex {
+public:
+    RTreeIndex(){};
+
+    hec::IndexType getType() override {
+        return hec::IT_RTREE;
+    }
+
+    PartitionBase* getOrCreatePartition(int partitionID) override;
+
+    /**
+    @brief Bulk loads the trees of all partitions. The trees replace the Y-sorted arrays of the other indexes.
+     */
+    void sortPartitionsOnY(int threads = MAX_THREADS) override;
+
+    /** @brief Evaluate the given query and store results in the queryResult object. */
+    DB_STATUS evaluateQuery(hec::Query* query, std::unique_ptr<hec::QResultBase>& queryResult) override;
+
+    /** @brief Evaluate the given DISTANCE JOIN query with the uniform grid filter. 
+     * Only for points: the filter has no duplicate elimination for objects stored in more than one partition.
+     */
+    DB_STATUS evaluateQuery(hec::Query* query, std::unordered_map<int, DJBatch> &borderObjectsMap, std::unique_ptr<hec::QResultBase>& queryResult) override;
+};
+
+/** @brief Maps the rec IDs of a partitioned dataset to a worker that holds the object (host only).
+ * Rec IDs are mostly the objects' line numbers in the dataset file, so the map is a dense array of worker ranks.
+ * Rec IDs past its end (e.g. of inserted objects) are kept in an overflow hash map.
+ */
+struct ObjectDirectory {
+private:
+    /** @brief the lowest worker rank (in the worker communicator) that holds each object, 0 if unknown */
+    std::vector<uint16_t> owners;
+    /** @brief the owners of the rec IDs that do not fit in the array */
+    std::unordered_map<size_t, uint16_t> overflowOwners;
+
+    void setOverflowOwner(size_t recID, int rank);
+
+public:
+    /** @brief Clears the directory and sizes its array for the rec IDs [0, recIDCount), all unknown. */
+    void reset(size_t recIDCount);
+
+    /** @brief Records a worker that holds the object. Safe to call concurrently for different rec IDs. */
+    inline void setOwner(size_t recID, int rank) {
+        if (recID < owners.size()) {
+            owners[recID] = rank;
+        } else {
+            setOverflowOwner(recID, rank);
+        }
+    }
+
+    /** @brief Returns the worker rank that holds the object, or 0 if unknown (the object may be on any worker). */
+    inline int getOwner(size_t recID) const {
+        if (recID < owners.size()) {
+            return owners[recID];
+        }
+        auto it = overflowOwners.find(recID);
+        return it != overflowOwners.end() ? it->second : 0;
+    }
+
+    /** @brief Marks the object's owner as unknown. */
+    inline void forget(size_t recID) {
+        if (recID < owners.size()) {
+            owners[recID] = 0;
+        } else {
+            overflowOwners.erase(recID);
+        }
+    }
+
+    size_t memoryBytes() const;
+
+    void clear();
+};
+
+/** @brief Caches the local objects whose MBRs intersect each recent rectangle range window of a dataset (worker only).
+ * All of them are kept, unrefined and whether this node reports them or not, so that a window inside a cached one 
+ * is answered from it with each node's own reference point rule. Cleared on every change of the dataset's contents.
+ */
+struct RangeCache {
+private:
+    struct Entry {
+        MBR window;
+        std::shared_ptr<const std::vector<ObjectHandle>> objects;
+        uint64_t lastUse;
+    };
+    std::vector<Entry> entries;
+    uint64_t useClock = 0;
+    /** @brief Range queries of a batch are evaluated concurrently. */
+    mutable std::mutex mutex;
+
+public:
+    RangeCache() = default;
+    /** @brief Moves the entries (the mutex is not movable). */
+    RangeCache(RangeCache &&other) noexcept;
+    RangeCache& operator=(RangeCache &&other) noexcept;
+
+    /** @brief Returns the objects of the smallest cached window that contains the given one (and sets contains), 
+     * or else of the cached window that overlaps most of it (at least half its area), or nullptr. */
+    std::shared_ptr<const std::vector<ObjectHandle>> find(const MBR &window, MBR &cachedWindow, bool &contains);
+
+    /** @brief Caches the objects of the window. The cached windows inside it are dropped, and the least recently used ones beyond the capacity are evicted. */
+    void insert(const MBR &window, std::shared_ptr<const std::vector<ObjectHandle>> objects, int capacity);
+
+    void clear();
+
+    size_t memoryBytes() const;
+};
+
 /**
  * @brief All dataset related information.
  */
@@ -2114,10 +2834,22 @@ struct Dataset{
     DatasetMetadata metadata;
     // unique object count
     size_t totalObjects = 0;
+    // total vertices of the valid objects (0 if unknown)
+    size_t totalVertices = 0;
     // vector of objects
     std::vector<Shape> objects;
     // map of object id-position in the objects vector
     std::unordered_map<size_t,size_t> objectPosMap;
+    // objects inserted after the index was built (a deque, so that references to them stay valid), indexed by the object handles that follow the objects'
+    std::deque<Shape> insertedObjects;
+    // map of object id-inserted object's handle in the index
+    std::unordered_map<size_t,ObjectHandle> insertedObjectMap;
+    // ids of the objects removed from the index that are still in the objects vector
+    std::unordered_set<size_t> removedObjectIDs;
+    // the worker of each object, filled by the host while partitioning
+    ObjectDirectory objectDirectory;
+    // the objects of recent range windows (workers)
+    RangeCache rangeCache;
     // the index
     std::unique_ptr<BaseIndex> index;
     // approximations (only april is supported)
@@ -2131,6 +2863,7 @@ struct Dataset{
 
     Dataset(){
         this->totalObjects = 0;
+        this->totalVertices = 0;
     }
     Dataset(DatasetMetadata &metadata) {
         if (metadata.dataspaceMetadata.boundsSet) {
@@ -2141,6 +2874,7 @@ struct Dataset{
         metadata.datasetName = getFileNameFromPath(metadata.path);
         this->metadata = metadata;
         this->totalObjects = 0;
+        this->totalVertices = 0;
     }
 
     /** @brief Adds a Shape object to the dataset. No indexing will take place with this method. */
@@ -2149,12 +2883,37 @@ struct Dataset{
     /** @brief Returns a reference to the object with the given ID. */
     Shape* getObject(size_t recID);
 
-    /** @brief Indexes the dataset using the specified index type. Requires data to be already loaded within the dataset. */
-    DB_STATUS buildIndex(hec::IndexType indexType);
+    /** @brief Returns the live object with the given ID (inserted objects included), or nullptr if this node does not hold it. */
+    Shape* findObject(size_t recID);
+
+    /** @brief Evaluates a range query on the index. Rectangle windows are answered from (and added to) the range cache: 
+     * a window inside a cached one filters its objects, one that mostly overlaps a cached one only scans the rest of its area. */
+    DB_STATUS evaluateRangeQuery(hec::RangeQuery* rangeQuery, std::unique_ptr<hec::QResultBase> &queryResult);
+
+    /** @brief Folds the inserted and removed objects of the previous index into the objects, dropping that index.
+     * Moves the objects, so it must not run concurrently with anything that references them. */
+    void foldUpdates();
+
+    /** @brief Indexes the dataset using the specified index type, with the given number of threads. Requires data to be already loaded within the dataset. */
+    DB_STATUS buildIndex(hec::IndexType indexType, int threads = MAX_THREADS);
 
     /** @brief Builds APRIL for the stored objects. */
     DB_STATUS buildAPRIL();
 
+    /** @brief Builds APRIL for the stored objects on the raster bounds already set. 
+     * Touches only the objects' APRIL, so it may run concurrently with the index build of the same dataset. */
+    DB_STATUS createAPRIL(int threads = MAX_THREADS);
+
+    /** @brief Inserts an object into the built index. The object is kept only if it belongs to this node's partitions. 
+     * @param buildAPRIL Whether to create the object's APRIL approximation. */
+    DB_STATUS insertObject(Shape &object, bool buildAPRIL);
+
+    /** @brief Removes the object with the given ID from the built index, if this node holds it. */
+    DB_STATUS removeObject(size_t recID);
+
+    /** @brief Estimates the memory held by the dataset's objects, APRIL, maps and index on this node. */
+    void measureMemory(hec::MemoryFootprint &footprint);
+
     /** @brief Calculate the size needed for the dataset serialization. */
     int calculateBufferSize();
     /** @brief Serializes the dataset object (only the important stuff). */
@@ -2177,41 +2936,66 @@ struct Dataset{
 };
 
 
+/** @brief Default max number of resident datasets (prepared and not unloaded). */
+#define DEFAULT_MAX_RESIDENT_DATASETS 8
+
 /** @brief Holds the dataset(s) related metadata in the configuration.
+ * A catalog of resident datasets, by ID. Queries name any of them, so switching between pairs needs no reload.
+ * IDs of unloaded datasets are reused. The global dataspace is the union of the resident datasets' bounds:
+ * datasets partitioned after others must lie within it (partition them together otherwise).
  */
 struct DatasetOptions {
 private:
-    std::optional<Dataset> R;  // Uses std::optional to indicate presence/absence
-    std::optional<Dataset> S;
+    /** @brief The resident datasets by ID, nullptr for free IDs. Held by pointer, so that references stay valid. */
+    std::vector<std::unique_ptr<Dataset>> datasets;
 
 public:
     DataspaceMetadata dataspaceMetadata;
+    /** @brief Preparing more datasets than this fails until some are unloaded. */
+    int maxResidentDatasets = DEFAULT_MAX_RESIDENT_DATASETS;
+    /** @brief Per worker memory budget of the resident datasets in bytes (0 = unlimited). 
+     * New datasets are not admitted while a worker exceeds it. */
+    size_t residentMemoryBudget = 0;
 
     void clear();
 
     DB_STATUS unloadDataset(int datasetIndex);
 
+    /** @brief Returns the dataset with ID 0 (the R dataset of the configuration file actions). */
     Dataset* getDatasetR();
 
+    /** @brief Returns the dataset with ID 1 (the S dataset of the configuration file actions). */
     Dataset* getDatasetS();
 
     Dataset* getDatasetByIdx(int datasetIndex);
 
+    /** @brief Returns the resident datasets, by increasing ID. */
+    std::vector<Dataset*> getDatasets();
+
+    /** @brief Returns the number of resident datasets. */
+    int getResidentCount();
+
+    /** @brief Merges the pending updates into the indexes of the loaded datasets. */
+    void mergeIndexUpdates();
+
     /**
-    @brief adds a Dataset to the configuration's dataset metadata
+    @brief adds a Dataset to the configuration's dataset metadata, with the given ID
      */
     DB_STATUS addDataset(DatasetIndex datasetIdx, Dataset&& dataset);
 
     /**
-     * @brief Add a dataset to the configuration. 
-     * Whether this dataset is R or S, is automatically determined by the current state.
-     * If its the first dataset to be added its R, otherwise its S.
+     * @brief Add a dataset to the configuration, with the lowest free ID.
      * Returns the id that was assigned to the dataset.
-     * Returns error if R is null but S is already set.
+     * Returns error if maxResidentDatasets datasets are already resident.
      */
     DB_STATUS addDataset(Dataset&& dataset, int &id);
 
     void updateDataspace();
+
+    /** @brief Updates the global dataspace after the metadata of the given datasets changed.
+     * Fails if the global dataspace changes while other resident datasets are already placed in it,
+     * since their partitions would no longer match the grids. */
+    DB_STATUS updateDataspace(const std::vector<int> &changedIndexes);
     void updateDatasetDataspaceToGlobal();
 
     void print();
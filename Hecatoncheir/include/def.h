@@ -37,6 +37,13 @@ extern std::string WORKER_EXECUTABLE_PATH;
 
 #define EPS 1e-08
 
+/** @brief Partitioning batch byte budget: default and bounds (bytes). */
+#define DEFAULT_BATCH_BYTES (16 * 1024 * 1024)
+#define BATCH_MIN_BYTES (256 * 1024)
+#define BATCH_MAX_BYTES (256 * 1024 * 1024)
+/** @brief Serialized size of a batch's header (data type + object count). */
+#define BATCH_HEADER_BYTES (sizeof(DataType) + sizeof(size_t))
+
 extern int g_world_size;
 extern int g_workers_size;
 extern int g_node_rank;
@@ -111,6 +118,7 @@ enum DB_STATUS {
     DBERR_COMM_WRONG_MESSAGE_ORDER = DBBASE + 2007,
     DBERR_COMM_PROBE_FAILED = DBBASE + 2008,
     DBERR_COMM_RECEIVED_NACK = DBBASE + 2009,
+    DBERR_COMM_COLLECTIVE = DBBASE + 2010,
     
     // processes/mpi
     DBERR_MPI_INIT_FAILED = DBBASE + 3000,
@@ -258,5 +266,15 @@ enum SystemSetupType {
     SYS_CLUSTER,
 };
 
+/** @enum ResultDeliveryType @brief How the workers' query results reach the driver. */
+enum ResultDeliveryType {
+    /** @brief Workers send their results to the host, which merges them and sends the total to the driver. */
+    RD_HOST,
+    /** @brief Workers merge their results pairwise in a binary tree. The root sends the total to the driver. */
+    RD_TREE,
+    /** @brief Every worker sends its result directly to the driver, which merges them. */
+    RD_DIRECT,
+};
+
 
 #endif
\ No newline at end of file
@@ -9,15 +9,20 @@
 #include "env/pack.h"
 #include "storage/write.h"
 #include "storage/utils.h"
+#include "storage/snapshot.h"
 #include "APRIL/generate.h"
 #include "TwoLayer/filter.h"
 
 #include <unordered_set>
+#include <array>
 #include "omp.h"
 
 namespace comm
 {
     #define QUERY_BATCH_SIZE 1000
+    #define MAX_INFLIGHT_QUERIES 64
+    /** @brief Min range queries of a batch on the same two-layer dataset, for them to share their partition scans. */
+    #define SHARED_SCAN_MIN_QUERIES 16
 
     /**
      * @brief Probes for a message in a communicator (blocking).
@@ -49,18 +54,79 @@ namespace comm
          */
         DB_STATUS prepareDataset(SerializedMsg<char> &msg, int &datasetID);
 
+        /** @brief
+         * Computes the metadata (extent, object and vertex counts) of the datasets in the message collectively.
+         * Every node of the worker communicator (host included) scans its part of each dataset file and
+         * the parts are combined with MPI_Allreduce, so that all nodes agree on the metadata and the global dataspace.
+         * @param msg Contains the packed {dataset index, compute extent} pairs.
+         * @param[out] agreed False if any node could not scan its part. The metadata is left untouched in that case.
+         */
+        DB_STATUS reduceDatasetMetadata(SerializedMsg<char> &msg, bool &agreed);
+
         /** @brief 
          * Builds the index for the dataset specified in the serialized msg.
          * @param msg Contains a serialized message specifying the indexing parameters.
          */
         DB_STATUS buildIndex(SerializedMsg<char> &msg);
 
+        /** @brief
+         * Inserts the objects of the message into the built index of their dataset. 
+         * Each node keeps only the objects that belong to its partitions.
+         * @param msg Contains the packed dataset index and (rec ID, WKT) pairs.
+         */
+        DB_STATUS insertObjects(SerializedMsg<char> &msg);
+
+        /** @brief
+         * Removes the objects of the message from the built index of their dataset, if the node holds them.
+         * @param msg Contains the packed dataset index, followed by the objects' rec IDs.
+         */
+        DB_STATUS deleteObjects(SerializedMsg<char> &msg);
+
+        /** @brief
+         * Applies the query pipeline settings of the message to this node. A negative value keeps the current setting.
+         * Turning the range cache off (or shrinking it) clears the cached windows of all datasets.
+         * @param msg Contains the packed range cache entries and result delivery type.
+         */
+        DB_STATUS setPipeline(SerializedMsg<char> &msg);
+
+        /** @brief
+         * Saves this node's snapshot of the dataset's objects, built index and APRIL.
+         * @param msg Contains the packed dataset index and snapshot path.
+         */
+        DB_STATUS saveSnapshot(SerializedMsg<char> &msg);
+
+        /** @brief
+         * Restores the dataset's objects, built index and APRIL from this node's snapshot.
+         * APRIL is generated if the snapshot did not hold it and the intermediate filter is enabled.
+         * @param msg Contains the packed dataset index and snapshot path.
+         */
+        DB_STATUS loadSnapshot(SerializedMsg<char> &msg);
+
+        /** @brief
+         * Returns the index the query is evaluated on: the one of its dataset (of its R dataset for joins).
+         * Logs an error and returns nullptr if that dataset is not resident or not indexed.
+         */
+        BaseIndex* getQueryIndex(hec::Query* query);
+
+        /** @brief
+         * Evaluates the query on the index of its dataset (range queries through the dataset's range cache).
+         * Logs an error and returns DBERR_INVALID_PARAMETER if that dataset is not resident or not indexed.
+         */
+        DB_STATUS evaluateOnIndex(hec::Query* query, std::unique_ptr<hec::QResultBase> &queryResult);
+
         /** @brief
          * Unpacks a message containing a join query and executes it, storing the results in the queryResult object.
          * Use this method for JOIN and kNN queries.
          */
         DB_STATUS evaluateQuery(SerializedMsg<char> &msg, std::unique_ptr<hec::QResultBase> &queryResult);
         
+        /** @brief
+         * Evaluates several queries that were in flight at the same time, storing each one's results in queryResults at the same position.
+         * Range and kNN queries are evaluated concurrently, joins one after the other.
+         * A query that fails does not stop the others: its error code is stored in queryStatus at its position.
+         */
+        DB_STATUS evaluateQueries(std::vector<hec::Query*> &queries, std::vector<std::unique_ptr<hec::QResultBase>> &queryResults, std::vector<DB_STATUS> &queryStatus);
+        
         /** @brief
          * Unpacks a message containing a distance join query and executes it, storing the results in the queryResult object.
          * It also identifies and buffers all objects that lie on border areas of the partitions in the grid, because they will be exchanged later.
@@ -74,7 +140,8 @@ namespace comm
          */
         DB_STATUS batchRangeQueries(SerializedMsg<char> &msg, std::unordered_map<int, std::unique_ptr<hec::QResultBase>> &batchResults);
 
-        /** @brief evaluates a batch of range queries. stores results in the batchResults object. */
+        /** @brief evaluates a batch of range queries. stores results in the batchResults object. 
+         * The range queries of a two-layer dataset share their partition scans if they are at least SHARED_SCAN_MIN_QUERIES. */
         DB_STATUS batchRangeQueries(std::vector<hec::Query*> &queryBatch, std::unordered_map<int, std::unique_ptr<hec::QResultBase>> &batchResults);
 
     }  
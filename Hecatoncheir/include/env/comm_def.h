@@ -18,12 +18,19 @@ typedef enum MsgType {
     MSG_INSTR_FIN = MSG_INSTR_BEGIN,
     MSG_INSTR_BATCH_FINISHED = MSG_BASE + 2001,
     MSG_QUERY_DJ_FIN = MSG_BASE + 2002,
+    /** @brief host-internal, sent by the host to itself on the worker communicator when a driver message is waiting */
+    MSG_DRIVER_PENDING = MSG_BASE + 2003,
 
     
     MSG_INSTR_END,
 
     /* SETUP */
     MSG_SYS_INFO = MSG_BASE + 3000,
+    MSG_TELEMETRY = MSG_BASE + 3001,
+    /** @brief {dataset index} request for the workers' memory footprint of the dataset */
+    MSG_MEMORY_FOOTPRINT = MSG_BASE + 3002,
+    /** @brief {range cache entries, result delivery} query pipeline settings to change at runtime, -1 keeps a setting */
+    MSG_SET_PIPELINE = MSG_BASE + 3003,
 
     /* BATCHES */
     MSG_BATCH_BEGIN = MSG_BASE + 4000,
@@ -54,6 +61,16 @@ typedef enum MsgType {
     MSG_QUERY_DJ_COUNT = MSG_BASE + 6007,
     MSG_QUERY_DJ_BATCH = MSG_BASE + 6008,
     MSG_QUERY_DJ_REQUEST_INIT = MSG_BASE + 6009,
+    /** @brief (part of) a query result, sent to the driver by a worker */
+    MSG_QUERY_RESULT_CHUNK = MSG_BASE + 6010,
+    /** @brief a partial query result, sent to the parent worker in the result merge tree */
+    MSG_QUERY_RESULT_MERGE = MSG_BASE + 6011,
+    /** @brief {query ID, chunks} the number of result chunks sent to the driver for a query */
+    MSG_QUERY_RESULT_DELIVERED = MSG_BASE + 6012,
+    /** @brief a single query whose result must always be sent back to the host, regardless of the result delivery type */
+    MSG_QUERY_HOST_GATHERED = MSG_BASE + 6013,
+    /** @brief {query ID, chunks} the query failed on a worker, sent in place of its result or delivery notice */
+    MSG_QUERY_FAILED = MSG_BASE + 6014,
 
     /* DATA */
     MSG_LOAD_DATASET = MSG_BASE + 7000,
@@ -66,6 +83,18 @@ typedef enum MsgType {
     MSG_GLOBAL_DATASPACE = MSG_BASE + 7007,
     MSG_DATASET_METADATA = MSG_BASE + 7008,
     MSG_BUILD_INDEX = MSG_BASE + 7009,
+    /** @brief {dataset index, compute extent} pairs whose metadata all nodes compute collectively */
+    MSG_DATASET_METADATA_REDUCE = MSG_BASE + 7010,
+    /** @brief {dataset index, (rec ID, WKT) pairs} objects to insert into a built index */
+    MSG_INSERT_OBJECTS = MSG_BASE + 7011,
+    /** @brief {dataset index, rec IDs} objects to remove from a built index */
+    MSG_DELETE_OBJECTS = MSG_BASE + 7012,
+    /** @brief {dataset index, path} save each node's snapshot of a built dataset */
+    MSG_SAVE_SNAPSHOT = MSG_BASE + 7013,
+    /** @brief {dataset index, path} restore each node's snapshot into a prepared dataset */
+    MSG_LOAD_SNAPSHOT = MSG_BASE + 7014,
+    /** @brief {dataset index, with geometry, rec IDs} fetch objects by rec ID from the workers that hold them */
+    MSG_LOOKUP_OBJECTS = MSG_BASE + 7015,
     
     /* ERRORS */
     MSG_ERR_BEGIN = MSG_BASE + 10000,
@@ -114,6 +114,15 @@ namespace pack
     /** @brief Packs a batch of queries into a serialized message. */
     DB_STATUS packQueryBatch(std::vector<hec::Query*> *batch, SerializedMsg<char> &batchMsg);
 
+    /** @brief Packs the objects (rec ID, WKT) to insert into the given dataset into a serialized message. */
+    DB_STATUS packObjectInserts(int datasetID, const std::vector<std::pair<size_t, std::string>> &objects, SerializedMsg<char> &msg);
+
+    /** @brief Packs fetched objects (rec ID, MBR, WKT) into a serialized message. */
+    DB_STATUS packObjectRecords(const std::vector<hec::ObjectRecord> &records, SerializedMsg<char> &msg);
+
+    /** @brief Packs a snapshot save/load request (dataset ID and snapshot path) into a serialized message. */
+    DB_STATUS packSnapshotRequest(int datasetID, const std::string &snapshotPath, SerializedMsg<char> &msg);
+
     /** @brief Packs a batch of results into a serialized message. */
     DB_STATUS packBatchResults(std::unordered_map<int, std::unique_ptr<hec::QResultBase>> &batchResults, SerializedMsg<char> &batchMsg);
 
@@ -170,6 +179,15 @@ namespace unpack
     /** @brief unpacks a shape appropriately based on its type. */
     DB_STATUS unpackShape(SerializedMsg<char> &msg, Shape &shape);
 
+    /** @brief Unpacks a message of objects (rec ID, WKT) to insert into the dataset with the returned ID. */
+    DB_STATUS unpackObjectInserts(SerializedMsg<char> &msg, int &datasetID, std::vector<std::pair<size_t, std::string>> &objects);
+
+    /** @brief Unpacks a message of fetched objects (rec ID, MBR, WKT), appending them to the records. */
+    DB_STATUS unpackObjectRecords(SerializedMsg<char> &msg, std::vector<hec::ObjectRecord> &records);
+
+    /** @brief Unpacks a snapshot save/load request message. */
+    DB_STATUS unpackSnapshotRequest(SerializedMsg<char> &msg, int &datasetID, std::string &snapshotPath);
+
     /** @brief unpacks a message containg the results of a batch of queries. */
     DB_STATUS unpackBatchResults(SerializedMsg<char> &msg, std::unordered_map<int, std::unique_ptr<hec::QResultBase>> &batchResults);
     
@@ -2,6 +2,7 @@
 #define D_COMM_RECV_H
 
 #include "containers.h"
+#include "env/telemetry.h"
 
 /** @brief System inter- and intra- communication methods. */
 namespace comm
@@ -49,11 +50,13 @@ namespace comm
             msg.data = (T*) malloc(msg.count * sizeof(T));
 
             // // receive the message
+            double startTime = MPI_Wtime();
             mpi_ret = MPI_Recv(msg.data, msg.count, dataType, status.MPI_SOURCE, status.MPI_TAG, comm, &status);
             if (mpi_ret != MPI_SUCCESS) {
                 logger::log_error(DBERR_COMM_RECV, "Failed to receive msg pack with tag", status.MPI_TAG);
                 return DBERR_COMM_RECV;
             }
+            telemetry::recordRecv(status.MPI_SOURCE, status.MPI_TAG, comm, msg.count, dataType, MPI_Wtime() - startTime);
 
             return ret;
         }
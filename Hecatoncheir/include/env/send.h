@@ -4,6 +4,7 @@
 #include "containers.h"
 #include "proc.h"
 #include "comm_def.h"
+#include "env/telemetry.h"
 
 /** @brief System inter- and intra- communication methods. */
 namespace comm
@@ -52,11 +53,13 @@ namespace comm
         template <typename T>
         DB_STATUS sendMessage(SerializedMsg<T> &msg, int destRank, int tag, MPI_Comm &comm) {
             // send the serialized message
+            double startTime = MPI_Wtime();
             int mpi_ret = MPI_Send(msg.data, msg.count, msg.type, destRank, tag, comm);
             if (mpi_ret != MPI_SUCCESS) {
                 logger::log_error(DBERR_COMM_SEND, "Sending serialized message failed.");
                 return DBERR_COMM_SEND;
             }
+            telemetry::recordSend(destRank, tag, comm, msg.count, msg.type, MPI_Wtime() - startTime);
             return DBERR_OK;
         }
     }
@@ -0,0 +1,42 @@
+#ifndef D_COMM_TELEMETRY_H
+#define D_COMM_TELEMETRY_H
+
+#include "containers.h"
+
+#define NO_QUERY_SCOPE -1
+
+namespace comm
+{
+    /** @brief Per-rank communication counters (messages, bytes, blocking and serialization time),
+     * kept per query, message tag and peer. Peers are recorded as global ranks. */
+    namespace telemetry
+    {
+        /** @brief Sets the query that subsequent traffic of this rank is attributed to. 
+         * Use NO_QUERY_SCOPE for traffic that does not belong to a query. */
+        void setQueryScope(int queryID);
+
+        /** @brief Returns the query that traffic is currently attributed to. */
+        int getQueryScope();
+
+        /** @brief Records a sent message of 'count' elements of 'dataType', that took 'time' seconds to send. */
+        void recordSend(int destRank, int tag, MPI_Comm comm, int count, MPI_Datatype dataType, double time);
+
+        /** @brief Records a received message of 'count' elements of 'dataType', that took 'time' seconds to receive. */
+        void recordRecv(int sourceRank, int tag, MPI_Comm comm, int count, MPI_Datatype dataType, double time);
+
+        /** @brief Moves the last message received by the calling thread to the given query.
+         * Used where the query a message belongs to is only known after the message has been received (e.g. results). */
+        void attributeLastRecv(int queryID);
+
+        /** @brief Records the time spent blocked in a probe until a message from 'sourceRank' with 'tag' arrived. */
+        void recordProbe(int sourceRank, int tag, MPI_Comm comm, double time);
+
+        /** @brief Records the time spent serializing a message that will be sent to 'destRank' with 'tag'. */
+        void recordSerialization(int destRank, int tag, MPI_Comm comm, double time);
+
+        /** @brief Returns the counters of this rank, optionally resetting them. */
+        std::vector<hec::CommStats> collect(bool reset);
+    }
+}
+
+#endif
@@ -21,6 +21,13 @@ namespace storage
          * The dataset's path, file type and data type must be set already in the object. */
         DB_STATUS calculateDatasetMetadata(Dataset* dataset);
 
+        /** @brief Calculates this rank's part of the metadata for the input dataset.
+         * The dataset file is split in partCount equal byte ranges and the one at partIndex is scanned (by all threads). 
+         * The ranges only depend on partIndex and partCount, not on the rank's thread count.
+         * @param[in] computeExtent If false, the objects are only counted and not parsed (no extent and vertices).
+         */
+        DB_STATUS calculateDatasetMetadataPart(Dataset* dataset, int partIndex, int partCount, bool computeExtent, DatasetMetadataPart &part);
+
         /** @brief Methods for the partitioned data loading. */
         namespace partitionFile
         {
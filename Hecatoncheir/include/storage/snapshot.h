@@ -0,0 +1,66 @@
+#ifndef D_STORAGE_SNAPSHOT_H
+#define D_STORAGE_SNAPSHOT_H
+
+#include "containers.h"
+
+/** @brief Magic number at the beginning of every snapshot file ("HECSNAP\0"). */
+#define SNAPSHOT_MAGIC 0x0050414E53434548ULL
+/** @brief Version of the snapshot file layout. Must be bumped on every incompatible layout change. */
+#define SNAPSHOT_VERSION 1
+
+/** @brief Disk-related methods for storing system metadata and data. */
+namespace storage
+{
+    /** @brief Per-node snapshots of a dataset's objects, built index and APRIL, restored without repartitioning or reindexing. */
+    namespace snapshot
+    {
+        /** @brief The fixed-size header at the beginning of a snapshot file.
+         * The payload that follows is a sequence of flat arrays, each padded to 8 bytes:
+         * rec IDs, MBRs (xMin, yMin, xMax, yMax per object), vertex offsets and coordinates (x, y per vertex),
+         * APRIL A-list offsets, F-list offsets and intervals, partition IDs, class offsets (classCount per partition)
+         * and the positions of the objects of every partition class, in their indexed order.
+         */
+        struct SnapshotHeader {
+            uint64_t magic;
+            uint32_t version;
+            int32_t indexType;
+            int32_t dataType;
+            int32_t nodeRank;
+            int32_t worldSize;
+            int32_t globalPPD;
+            int32_t distributionPPD;
+            int32_t aprilN;
+            /** @brief Whether the objects' APRIL intervals are stored. */
+            int32_t hasAPRIL;
+            /** @brief The stored classes per partition (4 for the two-layer index, 1 otherwise). */
+            int32_t classCount;
+            /** @brief The global dataspace the partitions were built for. */
+            double xMinGlobal, yMinGlobal, xMaxGlobal, yMaxGlobal;
+            uint64_t objectCount;
+            uint64_t vertexCount;
+            /** @brief Total uint32 elements of the A-lists and F-lists. */
+            uint64_t intervalCount;
+            uint64_t partitionCount;
+            /** @brief Total object positions over all partition classes. */
+            uint64_t entryCount;
+            uint64_t payloadBytes;
+            /** @brief FNV-1a checksum of the payload, over 64-bit words. */
+            uint64_t checksum;
+        };
+
+        /** @brief Returns this node's snapshot file path for the given snapshot path. */
+        std::string getNodeSnapshotPath(const std::string &snapshotPath);
+
+        /** @brief Writes the dataset's objects, built index and (if enabled) APRIL into this node's snapshot file.
+         * Pending index updates are merged first. */
+        DB_STATUS writeSnapshot(Dataset* dataset, const std::string &snapshotPath);
+
+        /** @brief Memory-maps this node's snapshot file, validates it against the current configuration and
+         * restores the dataset's objects, index and APRIL from it. Sets the global dataspace the snapshot was built for.
+         * @param[out] hasAPRIL Whether the snapshot held the objects' APRIL.
+         */
+        DB_STATUS loadSnapshot(Dataset* dataset, const std::string &snapshotPath, bool &hasAPRIL);
+    }
+}
+
+#endif
@@ -231,7 +231,7 @@ namespace APRIL
             // fetch the APRIL of R and S for this section
             int iFilterResult = INCONCLUSIVE;
             // use appropriate query function
-            switch (g_config.queryPipeline.queryType) {
+            switch (queryResult->getQueryType()) {
                 case hec::Q_RANGE:
                     ret = APRIL::generation::memory::createAPRILforObject(objS, objS->getSpatialType(), g_config.approximationMetadata.aprilConfig, objS->aprilData);
                     if (ret != DBERR_OK) {
@@ -290,7 +290,7 @@ namespace APRIL
                     break;
                 default:
                     // not supported/unknown
-                    logger::log_error(DBERR_QUERY_INVALID_TYPE, "Unsupported query for standard APRIL intermediate filter. Query type:", mapping::queryTypeIntToStr(g_config.queryPipeline.queryType));
+                    logger::log_error(DBERR_QUERY_INVALID_TYPE, "Unsupported query for standard APRIL intermediate filter. Query type:", mapping::queryTypeIntToStr(queryResult->getQueryType()));
                     return DBERR_QUERY_INVALID_TYPE;
             }
             // if true negative or true hit, return
@@ -302,7 +302,7 @@ namespace APRIL
                 return ret;
             }
             // refine based on query type
-            switch (g_config.queryPipeline.queryType) {
+            switch (queryResult->getQueryType()) {
                 case hec::Q_RANGE:
                     refinement::relate::refineIntersectionJoin(objR, objS, queryResult);
                     break;
@@ -332,10 +332,59 @@ namespace APRIL
                     break;
                 default:
                     // not supported/unknown
-                    logger::log_error(DBERR_QUERY_INVALID_TYPE, "Unsupported query for refinement. Query type:", mapping::queryTypeIntToStr(g_config.queryPipeline.queryType));
+                    logger::log_error(DBERR_QUERY_INVALID_TYPE, "Unsupported query for refinement. Query type:", mapping::queryTypeIntToStr(queryResult->getQueryType()));
                     return DBERR_QUERY_INVALID_TYPE;
             }
             return ret;
         }
+
+        DB_STATUS createWindowAPRIL(Dataset* dataset, Shape* window) {
+            if (!g_config.queryPipeline.IntermediateFilter || dataset->metadata.dataType == DT_POINT) {
+                return DBERR_OK;
+            }
+            DataType windowType = window->getSpatialType();
+            if (windowType != DT_POLYGON && windowType != DT_BOX) {
+                return DBERR_OK;
+            }
+            // the rasterization clamps the vertices outside the raster bounds, which would distort the window
+            const DataspaceMetadata &bounds = APRIL::generation::getRasterBounds();
+            const MBR &mbr = window->mbr;
+            if (!(mbr.pMin.x >= bounds.xMinGlobal && mbr.pMin.y >= bounds.yMinGlobal && mbr.pMax.x <= bounds.xMaxGlobal && mbr.pMax.y <= bounds.yMaxGlobal)
+                || !(mbr.pMax.x > mbr.pMin.x && mbr.pMax.y > mbr.pMin.y)) {
+                return DBERR_OK;
+            }
+            double cellsPerDim = dataset->aprilConfig.getCellsPerDim();
+            double cellsX = std::ceil((mbr.pMax.x - mbr.pMin.x) / (bounds.xMaxGlobal - bounds.xMinGlobal) * cellsPerDim) + 2;
+            double cellsY = std::ceil((mbr.pMax.y - mbr.pMin.y) / (bounds.yMaxGlobal - bounds.yMinGlobal) * cellsPerDim) + 2;
+            if (cellsX * cellsY > (double) APRIL_WINDOW_MAX_CELLS) {
+                return DBERR_OK;
+            }
+            DB_STATUS ret = APRIL::generation::memory::createAPRILforObject(window, windowType, dataset->aprilConfig, window->aprilData);
+            if (ret != DBERR_OK) {
+                logger::log_error(ret, "Failed to create APRIL for the range query window.");
+                return ret;
+            }
+            return ret;
+        }
+
+        DB_STATUS RangeFilterEntrypoint(Shape* window, Shape* obj, hec::QResultBase* queryResult) {
+            DB_STATUS ret = DBERR_OK;
+            int iFilterResult = INCONCLUSIVE;
+            if (!obj->aprilData.intervalsALL.empty()) {
+                ret = uncompressed::standard::intersectionJoinAPRIL(&obj->aprilData, &window->aprilData, iFilterResult);
+                if (ret != DBERR_OK) {
+                    logger::log_error(ret, "APRIL range filter failed for object", obj->recID);
+                    return ret;
+                }
+            }
+            if (iFilterResult == TRUE_HIT) {
+                queryResult->addResult(obj->recID);
+                return ret;
+            } else if (iFilterResult == TRUE_NEGATIVE) {
+                return ret;
+            }
+            // inconclusive, refine (the window goes first)
+            return refinement::relate::refinementEntrypoint(window, obj, hec::Q_RANGE, queryResult);
+        }
     }
 }
\ No newline at end of file
@@ -18,6 +18,10 @@ namespace APRIL
             // logger::log_success("Raster bounds set:", dataspaceMetadata.xMinGlobal, dataspaceMetadata.yMinGlobal, dataspaceMetadata.xMaxGlobal, dataspaceMetadata.yMaxGlobal);
             return DBERR_OK;
         }
+
+        const DataspaceMetadata& getRasterBounds() {
+            return rasterDataspaceMetadata;
+        }
         
 
         static inline bool checkY(double &y1, double &OGy1, double &OGy2, uint32_t &startCellY, uint32_t &endCellY){
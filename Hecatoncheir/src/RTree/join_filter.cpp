@@ -0,0 +1,110 @@
+#include <omp.h>
+#include "RTree/filter.h"
+#include "TwoLayer/filter.h"
+
+namespace rtree
+{
+    namespace join_filter
+    {
+        /** @brief Synchronized traversal of the two partitions' trees. 
+         * Forwards every object pair with intersecting MBRs whose reference point lies in this partition. */
+        static DB_STATUS joinPartitions(PartitionRTree* partitionR, PartitionRTree* partitionS, bool topology, hec::QResultBase* queryResult) {
+            DB_STATUS ret = DBERR_OK;
+            if (partitionR->nodes.empty() || partitionS->nodes.empty()) {
+                return ret;
+            }
+            std::vector<std::pair<uint32_t, uint32_t>> stack;
+            stack.emplace_back(partitionR->getRoot(), partitionS->getRoot());
+            while (!stack.empty()) {
+                auto [r, s] = stack.back();
+                stack.pop_back();
+                RTreeNode &nodeR = partitionR->nodes[r];
+                RTreeNode &nodeS = partitionS->nodes[s];
+                bool leafR = partitionR->isLeaf(r);
+                bool leafS = partitionS->isLeaf(s);
+                if (!leafR && !leafS) {
+                    // descend both
+                    for (uint32_t childR=nodeR.first; childR<nodeR.first+nodeR.count; childR++) {
+                        RTreeNode &cR = partitionR->nodes[childR];
+                        if (!intersects(cR.xMin, cR.yMin, cR.xMax, cR.yMax, nodeS.xMin, nodeS.yMin, nodeS.xMax, nodeS.yMax)) {
+                            continue;
+                        }
+                        for (uint32_t childS=nodeS.first; childS<nodeS.first+nodeS.count; childS++) {
+                            RTreeNode &cS = partitionS->nodes[childS];
+                            if (intersects(cR.xMin, cR.yMin, cR.xMax, cR.yMax, cS.xMin, cS.yMin, cS.xMax, cS.yMax)) {
+                                stack.emplace_back(childR, childS);
+                            }
+                        }
+                    }
+                } else if (!leafR) {
+                    // descend R only (S is already at leaf level)
+                    for (uint32_t childR=nodeR.first; childR<nodeR.first+nodeR.count; childR++) {
+                        RTreeNode &cR = partitionR->nodes[childR];
+                        if (intersects(cR.xMin, cR.yMin, cR.xMax, cR.yMax, nodeS.xMin, nodeS.yMin, nodeS.xMax, nodeS.yMax)) {
+                            stack.emplace_back(childR, s);
+                        }
+                    }
+                } else if (!leafS) {
+                    // descend S only (R is already at leaf level)
+                    for (uint32_t childS=nodeS.first; childS<nodeS.first+nodeS.count; childS++) {
+                        RTreeNode &cS = partitionS->nodes[childS];
+                        if (intersects(nodeR.xMin, nodeR.yMin, nodeR.xMax, nodeR.yMax, cS.xMin, cS.yMin, cS.xMax, cS.yMax)) {
+                            stack.emplace_back(r, childS);
+                        }
+                    }
+                } else {
+                    // both leaves, compare objects
+                    for (uint32_t posR=nodeR.first; posR<nodeR.first+nodeR.count; posR++) {
+                        Shape* objR = partitionR->classIndex[posR];
+                        for (uint32_t posS=nodeS.first; posS<nodeS.first+nodeS.count; posS++) {
+                            Shape* objS = partitionS->classIndex[posS];
+                            if (!intersects(objR->mbr.pMin.x, objR->mbr.pMin.y, objR->mbr.pMax.x, objR->mbr.pMax.y, objS->mbr.pMin.x, objS->mbr.pMin.y, objS->mbr.pMax.x, objS->mbr.pMax.y)) {
+                                continue;
+                            }
+                            // report only in the partition of the reference point
+                            if (!referencePointInPartition(std::max(objR->mbr.pMin.x, objS->mbr.pMin.x), std::max(objR->mbr.pMin.y, objS->mbr.pMin.y), partitionR->partitionID)) {
+                                continue;
+                            }
+                            if (topology) {
+                                ret = twolayer::topological_join_filter::relateMBRs(objR, objS, queryResult);
+                            } else {
+                                ret = twolayer::intersection_join_filter::forwardPair(objR, objS, queryResult);
+                            }
+                            if (ret != DBERR_OK) {
+                                return ret;
+                            }
+                        }
+                    }
+                }
+            }
+            return ret;
+        }
+
+        DB_STATUS evaluate(hec::PredicateJoinQuery *joinQuery, bool topology, std::unique_ptr<hec::QResultBase>& queryResult) {
+            DB_STATUS ret = DBERR_OK;
+            Dataset* R = g_config.datasetOptions.getDatasetByIdx(joinQuery->getDatasetRid());
+            Dataset* S = g_config.datasetOptions.getDatasetByIdx(joinQuery->getDatasetSid());
+            #pragma omp parallel num_threads(MAX_THREADS) reduction(query_output_reduction:queryResult)
+            {
+                DB_STATUS local_ret = DBERR_OK;
+                // loop common partitions
+                std::vector<PartitionBase *>* partitions = R->index->getPartitions();
+                #pragma omp for schedule(dynamic)
+                for (int i=0; i<partitions->size(); i++) {
+                    PartitionRTree* partitionR = dynamic_cast<PartitionRTree*>(partitions->at(i));
+                    PartitionRTree* partitionS = dynamic_cast<PartitionRTree*>(S->index->getPartition(partitions->at(i)->partitionID));
+                    if (partitionR == nullptr || partitionS == nullptr || !partitionR->contentBoundsIntersect(partitionS)) {
+                        continue;
+                    }
+                    local_ret = joinPartitions(partitionR, partitionS, topology, queryResult.get());
+                    if (local_ret != DBERR_OK) {
+                        logger::log_error(local_ret, "R-tree join failed for partition", partitionR->partitionID);
+                        #pragma omp cancel for
+                        ret = local_ret;
+                    }
+                }
+            }
+            return ret;
+        }
+    }
+}
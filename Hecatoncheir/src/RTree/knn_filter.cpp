@@ -0,0 +1,81 @@
+#include <queue>
+#include <unordered_set>
+#include "RTree/filter.h"
+
+namespace rtree
+{
+    namespace knn_filter
+    {
+        /** @brief A tree node (or partition root) in the best-first search, keyed by its distance to the query point. */
+        struct SearchEntry {
+            double distance;
+            PartitionRTree* partition;
+            uint32_t node;
+
+            bool operator>(const SearchEntry &other) const {
+                return distance > other.distance;
+            }
+        };
+
+        DB_STATUS evaluate(hec::KNNQuery *knnQuery, std::unique_ptr<hec::QResultBase>& queryResult) {
+            Shape qPoint;
+            Dataset* dataset = g_config.datasetOptions.getDatasetByIdx(knnQuery->getDatasetID());
+            // create query shape
+            DB_STATUS ret = shape_factory::createEmpty(DT_POINT, qPoint);
+            if (ret != DBERR_OK) {
+                logger::log_error(DBERR_INVALID_GEOMETRY, "Couldn't create shape object from knn query.");
+                return DBERR_INVALID_GEOMETRY;
+            }
+            ret = qPoint.setFromWKT(knnQuery->getWKT());
+            if (ret != DBERR_OK) {
+                logger::log_error(DBERR_INVALID_GEOMETRY, "Couldn't set knn query shape from query WKT. WKT:", knnQuery->getWKT());
+                return DBERR_INVALID_GEOMETRY;
+            }
+
+            // seed with the roots of all partitions
+            std::priority_queue<SearchEntry, std::vector<SearchEntry>, std::greater<SearchEntry>> queue;
+            std::vector<PartitionBase*>* partitions = dataset->index->getPartitions();
+            for (auto &partitionBase : *partitions) {
+                PartitionRTree* partition = dynamic_cast<PartitionRTree*>(partitionBase);
+                if (partition == nullptr || partition->nodes.empty()) {
+                    continue;
+                }
+                RTreeNode &root = partition->nodes[partition->getRoot()];
+                queue.push({qPoint.distanceToPartition(root.xMin, root.yMin, root.xMax, root.yMax), partition, partition->getRoot()});
+            }
+
+            // non-point objects are replicated across partitions
+            bool replicated = dataset->metadata.dataType != DT_POINT;
+            std::unordered_set<size_t> visited;
+            while (!queue.empty()) {
+                SearchEntry entry = queue.top();
+                queue.pop();
+                // nothing closer than the current k-th result remains
+                if (!queryResult->checkDistance(entry.distance)) {
+                    break;
+                }
+                RTreeNode &node = entry.partition->nodes[entry.node];
+                if (!entry.partition->isLeaf(entry.node)) {
+                    for (uint32_t child=node.first; child<node.first+node.count; child++) {
+                        RTreeNode &childNode = entry.partition->nodes[child];
+                        double distance = qPoint.distanceToPartition(childNode.xMin, childNode.yMin, childNode.xMax, childNode.yMax);
+                        if (queryResult->checkDistance(distance)) {
+                            queue.push({distance, entry.partition, child});
+                        }
+                    }
+                    continue;
+                }
+                for (uint32_t pos=node.first; pos<node.first+node.count; pos++) {
+                    Shape* obj = entry.partition->classIndex[pos];
+                    if (replicated && !visited.insert(obj->recID).second) {
+                        continue;
+                    }
+                    // add result (the heap handles insertions automatically)
+                    queryResult->addResult(obj->recID, obj->distance(qPoint));
+                }
+            }
+
+            return ret;
+        }
+    }
+}
@@ -0,0 +1,118 @@
+#include "RTree/filter.h"
+#include "refinement/topology.h"
+#include "APRIL/filter.h"
+
+namespace rtree
+{
+    namespace range_filter
+    {
+        static inline DB_STATUS forwardPair(Shape* obj, Shape* window, hec::QResultBase* queryResult) {
+            DB_STATUS ret = DBERR_OK;
+            if (!window->aprilData.intervalsALL.empty()) {
+                // APRIL intermediate filter, refines only the inconclusive
+                return APRIL::standard::RangeFilterEntrypoint(window, obj, queryResult);
+            }
+            // forward to refinement (the window goes first)
+            ret = refinement::relate::refinementEntrypoint(window, obj, hec::Q_RANGE, queryResult);
+            if (ret != DBERR_OK) {
+                logger::log_error(ret, "Refinement failed.");
+                return ret;
+            }
+            return ret;
+        }
+
+        /** @brief Searches the partition's tree for the objects intersecting the window. 
+         * Count queries with a rectangle window add the owned objects of every node inside the window at once. */
+        static DB_STATUS searchPartition(PartitionRTree* partition, Shape* window, bool windowIsBox, hec::QResultBase* queryResult) {
+            DB_STATUS ret = DBERR_OK;
+            if (partition->nodes.empty()) {
+                return ret;
+            }
+            hec::QResultCount* countResult = (windowIsBox && queryResult->getResultType() == hec::QR_COUNT) ? static_cast<hec::QResultCount*>(queryResult) : nullptr;
+            std::vector<uint32_t> stack;
+            stack.push_back(partition->getRoot());
+            while (!stack.empty()) {
+                RTreeNode &node = partition->nodes[stack.back()];
+                bool leaf = partition->isLeaf(stack.back());
+                stack.pop_back();
+                if (!intersects(node.xMin, node.yMin, node.xMax, node.yMax, window->mbr.pMin.x, window->mbr.pMin.y, window->mbr.pMax.x, window->mbr.pMax.y)) {
+                    continue;
+                }
+                if (countResult != nullptr && node.xMin >= window->mbr.pMin.x && node.yMin >= window->mbr.pMin.y && node.xMax <= window->mbr.pMax.x && node.yMax <= window->mbr.pMax.y) {
+                    // every object under the node lies inside the window, and its reference point is its MBR's corner
+                    countResult->addResults(node.owned);
+                    continue;
+                }
+                if (!leaf) {
+                    for (uint32_t child=node.first; child<node.first+node.count; child++) {
+                        stack.push_back(child);
+                    }
+                    continue;
+                }
+                for (uint32_t pos=node.first; pos<node.first+node.count; pos++) {
+                    Shape* obj = partition->classIndex[pos];
+                    if (!intersects(obj->mbr.pMin.x, obj->mbr.pMin.y, obj->mbr.pMax.x, obj->mbr.pMax.y, window->mbr.pMin.x, window->mbr.pMin.y, window->mbr.pMax.x, window->mbr.pMax.y)) {
+                        continue;
+                    }
+                    // report only in the partition of the reference point
+                    if (!referencePointInPartition(std::max(obj->mbr.pMin.x, window->mbr.pMin.x), std::max(obj->mbr.pMin.y, window->mbr.pMin.y), partition->partitionID)) {
+                        continue;
+                    }
+                    ret = forwardPair(obj, window, queryResult);
+                    if (ret != DBERR_OK) {
+                        return ret;
+                    }
+                }
+            }
+            return ret;
+        }
+
+        DB_STATUS evaluate(hec::RangeQuery *rangeQuery, std::unique_ptr<hec::QResultBase>& queryResult) {
+            DB_STATUS ret = DBERR_OK;
+            Dataset* dataset = g_config.datasetOptions.getDatasetByIdx(rangeQuery->getDatasetID());
+            // create shape object for window
+            Shape window;
+            ret = shape_factory::createEmpty((DataType) rangeQuery->getShapeType(), window);
+            if (ret != DBERR_OK) {
+                return ret;
+            }
+            ret = window.setFromWKT(rangeQuery->getWKT());
+            if (ret != DBERR_OK) {
+                logger::log_error(ret, "Setting window shape from WKT failed. WKT:", rangeQuery->getWKT());
+                return ret;
+            }
+            window.setMBR();
+            bool windowIsBox = window.coversMBR();
+            // rasterize the window once for the APRIL filter of its candidates
+            ret = APRIL::standard::createWindowAPRIL(dataset, &window);
+            if (ret != DBERR_OK) {
+                return ret;
+            }
+
+            // get cells range (clamped to the dataspace)
+            int globalPPD = g_config.partitioningMethod->getGlobalPPD();
+            int partitionMinX = std::max(0, (int) std::floor((window.mbr.pMin.x - g_config.datasetOptions.dataspaceMetadata.xMinGlobal) / g_config.partitioningMethod->getPartPartionExtentX()));
+            int partitionMinY = std::max(0, (int) std::floor((window.mbr.pMin.y - g_config.datasetOptions.dataspaceMetadata.yMinGlobal) / g_config.partitioningMethod->getPartPartionExtentY()));
+            int partitionMaxX = std::min(globalPPD - 1, (int) std::floor((window.mbr.pMax.x - g_config.datasetOptions.dataspaceMetadata.xMinGlobal) / g_config.partitioningMethod->getPartPartionExtentX()));
+            int partitionMaxY = std::min(globalPPD - 1, (int) std::floor((window.mbr.pMax.y - g_config.datasetOptions.dataspaceMetadata.yMinGlobal) / g_config.partitioningMethod->getPartPartionExtentY()));
+
+            for (int j=partitionMinY; j<=partitionMaxY; j++) {
+                // the row's partition IDs are consecutive, visit only the existing ones
+                int rowFirst = g_config.partitioningMethod->getPartitionID(partitionMinX, j, globalPPD);
+                int rowLast = g_config.partitioningMethod->getPartitionID(partitionMaxX, j, globalPPD) + 1;
+                for (int partitionID = dataset->index->nextPartitionID(rowFirst, rowLast); partitionID < rowLast; partitionID = dataset->index->nextPartitionID(partitionID + 1, rowLast)) {
+                    PartitionRTree* partition = dynamic_cast<PartitionRTree*>(dataset->index->getPartition(partitionID));
+                    if (partition == nullptr) {
+                        continue;
+                    }
+                    ret = searchPartition(partition, &window, windowIsBox, queryResult.get());
+                    if (ret != DBERR_OK) {
+                        logger::log_error(ret, "R-tree range search failed for partition", partitionID);
+                        return ret;
+                    }
+                }
+            }
+            return ret;
+        }
+    }
+}
@@ -5,9 +5,6 @@ namespace twolayer
 {   
     DB_STATUS processQuery(hec::Query* query, std::unique_ptr<hec::QResultBase>& queryResult) {
         DB_STATUS ret = DBERR_OK;
-        // set to global config
-        g_config.queryPipeline.queryType = (hec::QueryType) query->getQueryType();
-
         // switch based on query type
         switch (query->getQueryType()) {
             case hec::Q_RANGE:
@@ -6,7 +6,7 @@ namespace twolayer
 {
     namespace intersection_join_filter
     {
-        static inline DB_STATUS forwardPair(Shape* objR, Shape* objS, hec::QResultBase* queryResult) {
+        DB_STATUS forwardPair(Shape* objR, Shape* objS, hec::QResultBase* queryResult) {
             DB_STATUS ret = DBERR_OK;
             // check if intermediate filter is enabled
             if (g_config.queryPipeline.IntermediateFilter) {
@@ -18,7 +18,7 @@ namespace twolayer
                 }
             } else {
                 // forward to refinement
-                ret = refinement::relate::refinementEntrypoint(objR, objS, g_config.queryPipeline.queryType, queryResult);
+                ret = refinement::relate::refinementEntrypoint(objR, objS, queryResult->getQueryType(), queryResult);
                 if (ret != DBERR_OK) {
                     logger::log_error(ret, "Refinement failed.");
                     return ret;
@@ -28,7 +28,7 @@ namespace twolayer
         }
 
         
-        static inline DB_STATUS internal_sweepRollY_1(std::vector<Shape*>::iterator &rec, std::vector<Shape*>::iterator &firstFS, std::vector<Shape*>::iterator &lastFS, int flag, hec::QResultBase* queryResult) {
+        static inline DB_STATUS internal_sweepRollY_1(ObjectList::iterator &rec, ObjectList::iterator &firstFS, ObjectList::iterator &lastFS, int flag, hec::QResultBase* queryResult) {
             DB_STATUS ret = DBERR_OK;
             auto pivot = firstFS;
             while ((pivot < lastFS) && ((*rec)->mbr.pMax.y >= (*pivot)->mbr.pMin.y)) {     
@@ -60,7 +60,7 @@ namespace twolayer
         }
 
         
-        static inline DB_STATUS internal_sweepRollY_2(std::vector<Shape*>::iterator &rec, std::vector<Shape*>::iterator &firstFS, std::vector<Shape*>::iterator &lastFS, int flag, hec::QResultBase* queryResult) {
+        static inline DB_STATUS internal_sweepRollY_2(ObjectList::iterator &rec, ObjectList::iterator &firstFS, ObjectList::iterator &lastFS, int flag, hec::QResultBase* queryResult) {
             DB_STATUS ret = DBERR_OK;
             auto pivot = firstFS;
             while ((pivot < lastFS) && ((*rec)->mbr.pMax.y >= (*pivot)->mbr.pMin.y)) {               
@@ -92,7 +92,7 @@ namespace twolayer
         }
 
         
-        static inline DB_STATUS internal_sweepRollY_3_1(std::vector<Shape*>::iterator &rec, std::vector<Shape*>::iterator &firstFS, std::vector<Shape*>::iterator &lastFS, int flag, hec::QResultBase* queryResult) {
+        static inline DB_STATUS internal_sweepRollY_3_1(ObjectList::iterator &rec, ObjectList::iterator &firstFS, ObjectList::iterator &lastFS, int flag, hec::QResultBase* queryResult) {
             DB_STATUS ret = DBERR_OK;
             auto pivot = firstFS;
             while ((pivot < lastFS) && ((*rec)->mbr.pMax.y >= (*pivot)->mbr.pMin.y)) {    
@@ -125,7 +125,7 @@ namespace twolayer
         }
 
         
-        static inline DB_STATUS internal_sweepRollY_3_2(std::vector<Shape*>::iterator &rec, std::vector<Shape*>::iterator &firstFS, std::vector<Shape*>::iterator &lastFS, int flag, hec::QResultBase* queryResult) {
+        static inline DB_STATUS internal_sweepRollY_3_2(ObjectList::iterator &rec, ObjectList::iterator &firstFS, ObjectList::iterator &lastFS, int flag, hec::QResultBase* queryResult) {
             DB_STATUS ret = DBERR_OK;
             auto pivot = firstFS;
             while ((pivot < lastFS) && ((*rec)->mbr.pMax.y >= (*pivot)->mbr.pMin.y)) {    
@@ -157,7 +157,7 @@ namespace twolayer
         }
 
         
-        static inline DB_STATUS internal_sweepRollY_4(std::vector<Shape*>::iterator &rec, std::vector<Shape*>::iterator &firstFS, std::vector<Shape*>::iterator &lastFS, int flag, hec::QResultBase* queryResult) {
+        static inline DB_STATUS internal_sweepRollY_4(ObjectList::iterator &rec, ObjectList::iterator &firstFS, ObjectList::iterator &lastFS, int flag, hec::QResultBase* queryResult) {
             DB_STATUS ret = DBERR_OK;
             auto pivot = firstFS;
             while ((pivot < lastFS) && ((*rec)->mbr.pMax.y >= (*pivot)->mbr.pMin.y)) {  
@@ -189,7 +189,7 @@ namespace twolayer
         }
 
         
-        static inline DB_STATUS internal_sweepRollY_5(std::vector<Shape*>::iterator &rec, std::vector<Shape*>::iterator &firstFS, std::vector<Shape*>::iterator &lastFS, int flag, hec::QResultBase* queryResult) {
+        static inline DB_STATUS internal_sweepRollY_5(ObjectList::iterator &rec, ObjectList::iterator &firstFS, ObjectList::iterator &lastFS, int flag, hec::QResultBase* queryResult) {
             DB_STATUS ret = DBERR_OK;
             auto pivot = firstFS;
             while ((pivot < lastFS) && ((*rec)->mbr.pMax.y >= (*pivot)->mbr.pMin.y)) {     
@@ -222,15 +222,86 @@ namespace twolayer
         }
 
         
-        static inline DB_STATUS sweepRollY_1(std::vector<Shape*>* objectsR, std::vector<Shape*>* objectsS, hec::QResultBase* queryResult) {
+        /** @brief Sweeps rec against the pivots' MBR arrays from position first and forwards the surviving pairs. 
+         * checkLeft/checkRight select the x tests, same as in the internal_sweepRollY_* variants. */
+        static inline DB_STATUS internal_sweepRollY_MBRs(Shape* rec, bool checkLeft, bool checkRight, ObjectList* pivots, MBRArrays* pivotMBRs, size_t first, int flag, std::vector<uint32_t> &candidates, hec::QResultBase* queryResult) {
+            DB_STATUS ret = DBERR_OK;
+            double xMin = checkLeft ? rec->mbr.pMin.x : -std::numeric_limits<double>::infinity();
+            double xMax = checkRight ? rec->mbr.pMax.x : std::numeric_limits<double>::infinity();
+            candidates.clear();
+            pivotMBRs->sweep(first, xMin, xMax, rec->mbr.pMax.y, candidates);
+            for (auto &pos : candidates) {
+                if (flag) {
+                    // pivot is R, rec is S
+                    ret = forwardPair((*pivots)[pos], rec, queryResult);
+                } else {
+                    // rec is R, pivot is S
+                    ret = forwardPair(rec, (*pivots)[pos], queryResult);
+                }
+                if (ret != DBERR_OK) {
+                    return ret;
+                }
+            }
+            return ret;
+        }
+
+        
+        /** @brief Sweeps rec against the pivots' X-sorted MBR arrays from position first and forwards the surviving pairs. */
+        static inline DB_STATUS internal_sweepRollX_MBRs(Shape* rec, ObjectList* pivots, MBRArrays* pivotMBRs, size_t first, int flag, std::vector<uint32_t> &candidates, hec::QResultBase* queryResult) {
+            DB_STATUS ret = DBERR_OK;
+            candidates.clear();
+            pivotMBRs->sweepX(first, rec->mbr.pMin.y, rec->mbr.pMax.y, rec->mbr.pMax.x, candidates);
+            for (auto &pos : candidates) {
+                if (flag) {
+                    // pivot is R, rec is S
+                    ret = forwardPair((*pivots)[pos], rec, queryResult);
+                } else {
+                    // rec is R, pivot is S
+                    ret = forwardPair(rec, (*pivots)[pos], queryResult);
+                }
+                if (ret != DBERR_OK) {
+                    return ret;
+                }
+            }
+            return ret;
+        }
+
+        
+        static inline DB_STATUS sweepRollY_1(ObjectList* objectsR, MBRArrays* mbrsR, ObjectList* objectsS, MBRArrays* mbrsS, hec::QResultBase* queryResult) {
             if (objectsR == nullptr || objectsS == nullptr) {
                 return DBERR_OK;
             }
             if (objectsR->size() == 0 || objectsS->size() == 0) {
                 return DBERR_OK;
             }
+            if (mbrsR != nullptr && mbrsS != nullptr && !mbrsR->boundIntersects(*mbrsS)) {
+                // the contents' union MBRs are disjoint
+                return DBERR_OK;
+            }
             DB_STATUS ret = DBERR_OK;
-            std::vector<Shape*>::iterator r = objectsR->begin();
+            if (mbrsR != nullptr && mbrsS != nullptr) {
+                // sweep on the MBR arrays
+                std::vector<uint32_t> candidates;
+                size_t r = 0;
+                size_t s = 0;
+                while ((r < objectsR->size()) && (s < objectsS->size())) {
+                    if (mbrsR->yMin[r] < mbrsS->yMin[s]) {
+                        ret = internal_sweepRollY_MBRs(objectsR->at(r), true, true, objectsS, mbrsS, s, 0, candidates, queryResult);
+                        if (ret != DBERR_OK) {
+                            return ret;
+                        }
+                        r++;
+                    } else {
+                        ret = internal_sweepRollY_MBRs(objectsS->at(s), true, true, objectsR, mbrsR, r, 1, candidates, queryResult);
+                        if (ret != DBERR_OK) {
+                            return ret;
+                        }
+                        s++;
+                    }
+                }
+                return ret;
+            }
+            ObjectList::iterator r = objectsR->begin();
             auto s = objectsS->begin();
             auto lastR = objectsR->end();
             auto lastS = objectsS->end();
@@ -255,14 +326,29 @@ namespace twolayer
         }
 
         
-        static inline DB_STATUS sweepRollY_2(std::vector<Shape*>* objectsR, std::vector<Shape*>* objectsS, int flag, hec::QResultBase* queryResult) {
+        static inline DB_STATUS sweepRollY_2(ObjectList* objectsR, MBRArrays* mbrsR, ObjectList* objectsS, MBRArrays* mbrsS, int flag, hec::QResultBase* queryResult) {
             if (objectsR == nullptr || objectsS == nullptr) {
                 return DBERR_OK;
             }
             if (objectsR->size() == 0 || objectsS->size() == 0) {
                 return DBERR_OK;
             }
+            if (mbrsR != nullptr && mbrsS != nullptr && !mbrsR->boundIntersects(*mbrsS)) {
+                // the contents' union MBRs are disjoint
+                return DBERR_OK;
+            }
             DB_STATUS ret = DBERR_OK;
+            if (mbrsS != nullptr) {
+                // sweep on the MBR arrays
+                std::vector<uint32_t> candidates;
+                for (Shape* rec : *objectsR) {
+                    ret = internal_sweepRollY_MBRs(rec, true, true, objectsS, mbrsS, 0, flag, candidates, queryResult);
+                    if (ret != DBERR_OK) {
+                        return ret;
+                    }
+                }
+                return ret;
+            }
             auto r = objectsR->begin();
             auto s = objectsS->begin();
             auto lastR = objectsR->end();
@@ -278,14 +364,41 @@ namespace twolayer
         }
 
         
-        static inline DB_STATUS sweepRollY_3(std::vector<Shape*>* objectsR, std::vector<Shape*>* objectsS, int flag, hec::QResultBase* queryResult) {
+        static inline DB_STATUS sweepRollY_3(ObjectList* objectsR, MBRArrays* mbrsR, ObjectList* objectsS, MBRArrays* mbrsS, int flag, hec::QResultBase* queryResult) {
             if (objectsR == nullptr || objectsS == nullptr) {
                 return DBERR_OK;
             }
             if (objectsR->size() == 0 || objectsS->size() == 0) {
                 return DBERR_OK;
             }
+            if (mbrsR != nullptr && mbrsS != nullptr && !mbrsR->boundIntersects(*mbrsS)) {
+                // the contents' union MBRs are disjoint
+                return DBERR_OK;
+            }
             DB_STATUS ret = DBERR_OK;
+            if (mbrsR != nullptr && mbrsS != nullptr) {
+                // sweep on the MBR arrays
+                std::vector<uint32_t> candidates;
+                size_t r = 0;
+                size_t s = 0;
+                while ((r < objectsR->size()) && (s < objectsS->size())) {
+                    if (mbrsR->yMin[r] < mbrsS->yMin[s]) {
+                        ret = internal_sweepRollY_MBRs(objectsR->at(r), true, false, objectsS, mbrsS, s, flag, candidates, queryResult);
+                        if (ret != DBERR_OK) {
+                            return ret;
+                        }
+                        r++;
+                    } else {
+                        // warning: dont remove flag^1, it is required to define which is r and which is s
+                        ret = internal_sweepRollY_MBRs(objectsS->at(s), false, true, objectsR, mbrsR, r, flag^1, candidates, queryResult);
+                        if (ret != DBERR_OK) {
+                            return ret;
+                        }
+                        s++;
+                    }
+                }
+                return ret;
+            }
             auto r = objectsR->begin();
             auto s = objectsS->begin();
             auto lastR = objectsR->end();
@@ -312,14 +425,107 @@ namespace twolayer
         }
 
         
-        static inline DB_STATUS sweepRollY_4(std::vector<Shape*>* objectsR, std::vector<Shape*>* objectsS, int flag, hec::QResultBase* queryResult) {
+        /** @brief Same as sweepRollY_1, over the class A contents and MBR arrays sorted on X. */
+        static inline DB_STATUS sweepRollX_1(ObjectList* objectsR, MBRArrays* mbrsR, ObjectList* objectsS, MBRArrays* mbrsS, hec::QResultBase* queryResult) {
+            if (objectsR->size() == 0 || objectsS->size() == 0) {
+                return DBERR_OK;
+            }
+            if (!mbrsR->boundIntersects(*mbrsS)) {
+                // the contents' union MBRs are disjoint
+                return DBERR_OK;
+            }
+            DB_STATUS ret = DBERR_OK;
+            std::vector<uint32_t> candidates;
+            size_t r = 0;
+            size_t s = 0;
+            while ((r < objectsR->size()) && (s < objectsS->size())) {
+                if (mbrsR->xMin[r] < mbrsS->xMin[s]) {
+                    ret = internal_sweepRollX_MBRs(objectsR->at(r), objectsS, mbrsS, s, 0, candidates, queryResult);
+                    if (ret != DBERR_OK) {
+                        return ret;
+                    }
+                    r++;
+                } else {
+                    ret = internal_sweepRollX_MBRs(objectsS->at(s), objectsR, mbrsR, r, 1, candidates, queryResult);
+                    if (ret != DBERR_OK) {
+                        return ret;
+                    }
+                    s++;
+                }
+            }
+            return ret;
+        }
+
+        /** @brief Same as sweepRollY_3, sweeping each class C object over the class A MBR arrays sorted on X. 
+         * The C objects start left of the partition, so the A objects past their right side end the sweep. */
+        static inline DB_STATUS sweepRollX_3(ObjectList* objectsA, MBRArrays* mbrsA, ObjectList* objectsC, MBRArrays* mbrsC, int flag, hec::QResultBase* queryResult) {
+            if (objectsA->size() == 0 || objectsC->size() == 0) {
+                return DBERR_OK;
+            }
+            if (!mbrsA->boundIntersects(*mbrsC)) {
+                // the contents' union MBRs are disjoint
+                return DBERR_OK;
+            }
+            DB_STATUS ret = DBERR_OK;
+            std::vector<uint32_t> candidates;
+            for (Shape* rec : *objectsC) {
+                // warning: dont remove flag^1, it is required to define which is r and which is s
+                ret = internal_sweepRollX_MBRs(rec, objectsA, mbrsA, 0, flag^1, candidates, queryResult);
+                if (ret != DBERR_OK) {
+                    return ret;
+                }
+            }
+            return ret;
+        }
+
+        /** @brief R_A - S_A: sweeps on X if both partitions keep their class A sorted on X and it checks fewer pairs, otherwise on Y. */
+        static inline DB_STATUS sweepRoll_1(PartitionBase* partitionR, PartitionBase* partitionS, hec::QResultBase* queryResult) {
+            MBRArrays* mbrsR = partitionR->getMBRs(CLASS_A);
+            MBRArrays* mbrsS = partitionS->getMBRs(CLASS_A);
+            MBRArrays* mbrsRX = partitionR->getMBRsSortedOnX();
+            MBRArrays* mbrsSX = partitionS->getMBRsSortedOnX();
+            if (mbrsR != nullptr && mbrsS != nullptr && mbrsRX != nullptr && mbrsSX != nullptr && mbrsR->preferSweepOnX(*mbrsS, false)) {
+                return sweepRollX_1(partitionR->getContentsSortedOnX(), mbrsRX, partitionS->getContentsSortedOnX(), mbrsSX, queryResult);
+            }
+            return sweepRollY_1(partitionR->getContents(CLASS_A), mbrsR, partitionS->getContents(CLASS_A), mbrsS, queryResult);
+        }
+
+        /** @brief A - C: sweeps on X if partitionA keeps its class A sorted on X and it checks fewer pairs, otherwise on Y. 
+         * flag is 0 if partitionA is R's, 1 if it is S'. */
+        static inline DB_STATUS sweepRoll_3(PartitionBase* partitionA, PartitionBase* partitionC, int flag, hec::QResultBase* queryResult) {
+            MBRArrays* mbrsA = partitionA->getMBRs(CLASS_A);
+            MBRArrays* mbrsC = partitionC->getMBRs(CLASS_C);
+            MBRArrays* mbrsAX = partitionA->getMBRsSortedOnX();
+            if (mbrsA != nullptr && mbrsC != nullptr && mbrsAX != nullptr && mbrsA->preferSweepOnX(*mbrsC, true)) {
+                return sweepRollX_3(partitionA->getContentsSortedOnX(), mbrsAX, partitionC->getContents(CLASS_C), mbrsC, flag, queryResult);
+            }
+            return sweepRollY_3(partitionA->getContents(CLASS_A), mbrsA, partitionC->getContents(CLASS_C), mbrsC, flag, queryResult);
+        }
+
+        
+        static inline DB_STATUS sweepRollY_4(ObjectList* objectsR, MBRArrays* mbrsR, ObjectList* objectsS, MBRArrays* mbrsS, int flag, hec::QResultBase* queryResult) {
             if (objectsR == nullptr || objectsS == nullptr) {
                 return DBERR_OK;
             }
             if (objectsR->size() == 0 || objectsS->size() == 0) {
                 return DBERR_OK;
             }
+            if (mbrsR != nullptr && mbrsS != nullptr && !mbrsR->boundIntersects(*mbrsS)) {
+                // the contents' union MBRs are disjoint
+                return DBERR_OK;
+            }
             DB_STATUS ret = DBERR_OK;
+            if (mbrsS != nullptr) {
+                // sweep on the MBR arrays
+                std::vector<uint32_t> candidates;
+                for (Shape* rec : *objectsR) {
+                    ret = internal_sweepRollY_MBRs(rec, true, false, objectsS, mbrsS, 0, flag, candidates, queryResult);
+                    if (ret != DBERR_OK) {
+                        return ret;
+                    }
+                }
+                return ret;
+            }
             auto r = objectsR->begin();
             auto s = objectsS->begin();
             auto lastR = objectsR->end();
@@ -337,14 +543,29 @@ namespace twolayer
         }
 
         
-        inline DB_STATUS sweepRollY_5(std::vector<Shape*>* objectsR, std::vector<Shape*>* objectsS, int flag, hec::QResultBase* queryResult) {
+        inline DB_STATUS sweepRollY_5(ObjectList* objectsR, MBRArrays* mbrsR, ObjectList* objectsS, MBRArrays* mbrsS, int flag, hec::QResultBase* queryResult) {
             if (objectsR == nullptr || objectsS == nullptr) {
                 return DBERR_OK;
             }
             if (objectsR->size() == 0 || objectsS->size() == 0) {
                 return DBERR_OK;
             }
+            if (mbrsR != nullptr && mbrsS != nullptr && !mbrsR->boundIntersects(*mbrsS)) {
+                // the contents' union MBRs are disjoint
+                return DBERR_OK;
+            }
             DB_STATUS ret = DBERR_OK;
+            if (mbrsS != nullptr) {
+                // sweep on the MBR arrays
+                std::vector<uint32_t> candidates;
+                for (Shape* rec : *objectsR) {
+                    ret = internal_sweepRollY_MBRs(rec, false, true, objectsS, mbrsS, 0, flag, candidates, queryResult);
+                    if (ret != DBERR_OK) {
+                        return ret;
+                    }
+                }
+                return ret;
+            }
             auto r = objectsR->begin();
             auto s = objectsS->begin();
             auto lastR = objectsR->end();
@@ -375,7 +596,8 @@ namespace twolayer
                     /** @todo optimize: get the partitions with the fewer contents and begin from there, instead of getting R's always */
                     PartitionBase* partitionR = partitions->at(i);
                     PartitionBase* partitionS = S->index->getPartition(partitions->at(i)->partitionID);
-                    if (partitionS != nullptr) {
+                    // skip partitions whose contents lie apart
+                    if (partitionS != nullptr && partitionR->contentBoundsIntersect(partitionS)) {
                         // common partition found
                         // printf("Comparing partitions %ld and %ld \n", partitionR->partitionID, partitionS->partitionID);
                         // if (partitionR->partitionID == 651299 || partitionR->partitionID == 651300) {
@@ -387,7 +609,7 @@ namespace twolayer
                         //     logger::log_task("RA-SA");
                         // }
                         // printf("RA-SA\n");
-                        local_ret = sweepRollY_1(partitionR->getContents(CLASS_A), partitionS->getContents(CLASS_A), queryResult.get());
+                        local_ret = sweepRoll_1(partitionR, partitionS, queryResult.get());
                         if (local_ret != DBERR_OK) {
                             logger::log_error(local_ret, "R_A - S_A sweep roll failed");
                             #pragma omp cancel for
@@ -398,7 +620,7 @@ namespace twolayer
                         // if (partitionR->partitionID == 651299 || partitionR->partitionID == 651300) {
                         //     logger::log_task("RA-SB");
                         // }
-                        local_ret = sweepRollY_2(partitionS->getContents(CLASS_B), partitionR->getContents(CLASS_A), 1, queryResult.get());
+                        local_ret = sweepRollY_2(partitionS->getContents(CLASS_B), partitionS->getMBRs(CLASS_B), partitionR->getContents(CLASS_A), partitionR->getMBRs(CLASS_A), 1, queryResult.get());
                         if (local_ret != DBERR_OK) {
                             logger::log_error(local_ret, "S_B - R_A sweep roll failed");
                             #pragma omp cancel for
@@ -409,7 +631,7 @@ namespace twolayer
                         // if (partitionR->partitionID == 651299 || partitionR->partitionID == 651300) {
                         //     logger::log_task("RA-SC");
                         // }
-                        local_ret = sweepRollY_3(partitionR->getContents(CLASS_A), partitionS->getContents(CLASS_C), 0, queryResult.get());
+                        local_ret = sweepRoll_3(partitionR, partitionS, 0, queryResult.get());
                         if (local_ret != DBERR_OK) {
                             logger::log_error(local_ret, "R_A - S_C sweep roll failed");
                             #pragma omp cancel for
@@ -420,7 +642,7 @@ namespace twolayer
                         //     logger::log_task("RA-SD");
                         // }
                         // printf("SD-RA\n");
-                        local_ret = sweepRollY_5(partitionS->getContents(CLASS_D), partitionR->getContents(CLASS_A), 1, queryResult.get());
+                        local_ret = sweepRollY_5(partitionS->getContents(CLASS_D), partitionS->getMBRs(CLASS_D), partitionR->getContents(CLASS_A), partitionR->getMBRs(CLASS_A), 1, queryResult.get());
                         if (local_ret != DBERR_OK) {
                             logger::log_error(local_ret, "S_D - R_A sweep roll failed");
                             #pragma omp cancel for
@@ -431,7 +653,7 @@ namespace twolayer
                         //     logger::log_task("RB-SA");
                         // }
                         // printf("RA-SA\n");
-                        local_ret = sweepRollY_2(partitionR->getContents(CLASS_B), partitionS->getContents(CLASS_A), 0, queryResult.get());
+                        local_ret = sweepRollY_2(partitionR->getContents(CLASS_B), partitionR->getMBRs(CLASS_B), partitionS->getContents(CLASS_A), partitionS->getMBRs(CLASS_A), 0, queryResult.get());
                         if (local_ret != DBERR_OK) {
                             logger::log_error(local_ret, "R_B - S_A sweep roll failed");
                             #pragma omp cancel for
@@ -442,7 +664,7 @@ namespace twolayer
                         //     logger::log_task("RB-SC");
                         // }
                         // printf("RB-SC\n");
-                        local_ret = sweepRollY_4(partitionR->getContents(CLASS_B), partitionS->getContents(CLASS_C), 0, queryResult.get());
+                        local_ret = sweepRollY_4(partitionR->getContents(CLASS_B), partitionR->getMBRs(CLASS_B), partitionS->getContents(CLASS_C), partitionS->getMBRs(CLASS_C), 0, queryResult.get());
                         if (local_ret != DBERR_OK) {
                             logger::log_error(local_ret, "R_B - S_C sweep roll failed");
                             #pragma omp cancel for
@@ -453,7 +675,7 @@ namespace twolayer
                         //     logger::log_task("RC-SA");
                         // }
                         // printf("SA-RC\n");
-                        local_ret = sweepRollY_3(partitionS->getContents(CLASS_A), partitionR->getContents(CLASS_C), 1, queryResult.get());
+                        local_ret = sweepRoll_3(partitionS, partitionR, 1, queryResult.get());
                         if (local_ret != DBERR_OK) {
                             logger::log_error(ret, "S_A - R_C sweep roll failed");
                             #pragma omp cancel for
@@ -464,7 +686,7 @@ namespace twolayer
                         //     logger::log_task("RC-SB");
                         // }
                         // printf("SB-RC\n");
-                        local_ret = sweepRollY_4(partitionS->getContents(CLASS_B), partitionR->getContents(CLASS_C), 1, queryResult.get());
+                        local_ret = sweepRollY_4(partitionS->getContents(CLASS_B), partitionS->getMBRs(CLASS_B), partitionR->getContents(CLASS_C), partitionR->getMBRs(CLASS_C), 1, queryResult.get());
                         if (local_ret != DBERR_OK) {
                             logger::log_error(local_ret, "S_B - R_C sweep roll failed");
                             #pragma omp cancel for
@@ -475,7 +697,7 @@ namespace twolayer
                         //     logger::log_task("RD-SA");
                         // }
                         // printf("RD-SA\n");
-                        local_ret = sweepRollY_5(partitionR->getContents(CLASS_D), partitionS->getContents(CLASS_A), 0, queryResult.get());
+                        local_ret = sweepRollY_5(partitionR->getContents(CLASS_D), partitionR->getMBRs(CLASS_D), partitionS->getContents(CLASS_A), partitionS->getMBRs(CLASS_A), 0, queryResult.get());
                         if (local_ret != DBERR_OK) {
                             logger::log_error(local_ret, "R_D - S_A sweep roll failed");
                             #pragma omp cancel for
@@ -6,10 +6,14 @@ namespace twolayer
 {
     namespace range_filter
     {
-        static inline DB_STATUS forwardPair(Shape* objR, Shape* objS, hec::QResultBase* queryResult) {
+        static inline DB_STATUS forwardPair(Shape* obj, Shape* window, hec::QResultBase* queryResult) {
             DB_STATUS ret = DBERR_OK;
-            // forward to refinement
-            ret = refinement::relate::refinementEntrypoint(objR, objS, g_config.queryPipeline.queryType, queryResult);
+            if (!window->aprilData.intervalsALL.empty()) {
+                // APRIL intermediate filter, refines only the inconclusive
+                return APRIL::standard::RangeFilterEntrypoint(window, obj, queryResult);
+            }
+            // forward to refinement (the window goes first)
+            ret = refinement::relate::refinementEntrypoint(window, obj, hec::Q_RANGE, queryResult);
             if (ret != DBERR_OK) {
                 logger::log_error(ret, "Refinement failed.");
                 return ret;
@@ -17,7 +21,42 @@ namespace twolayer
             return ret;
         }
 
-        static inline DB_STATUS internal_RangeCorners(std::vector<Shape*>::iterator &firstFS, Shape* window, std::vector<Shape*>::iterator &lastFS, hec::QResultBase* queryResult) {
+        /** @brief Forwards the objects whose MBRs pass the window tests on the MBR arrays. 
+         * Each flag enables the test against that side of the window, same as in the internal_Range* variants. 
+         * If windowIsBox, the objects whose MBRs lie inside the window are results without refinement, 
+         * all of them at once if the union MBR does. On arrays sorted on Y, the scan ends at the window's top side. */
+        static inline DB_STATUS internal_RangeMBRs(ObjectList* objects, MBRArrays* mbrs, Shape* window, bool windowIsBox, bool checkXMin, bool checkYMin, bool checkXMax, bool checkYMax, hec::QResultBase* queryResult) {
+            DB_STATUS ret = DBERR_OK;
+            const MBR &box = window->mbr;
+            if (!mbrs->boundIntersects(box.pMin.x, box.pMin.y, box.pMax.x, box.pMax.y)) {
+                // no content reaches the window
+                return ret;
+            }
+            if (windowIsBox && mbrs->boundWithin(box.pMin.x, box.pMin.y, box.pMax.x, box.pMax.y)) {
+                // all contents lie inside the window (counts add the class size at once)
+                qresult_factory::addAll(*objects, queryResult);
+                return ret;
+            }
+            const double inf = std::numeric_limits<double>::infinity();
+            size_t last = (checkYMax && mbrs->sortedOnY) ? mbrs->endOnY(box.pMax.y) : mbrs->size();
+            std::vector<uint32_t> candidates;
+            mbrs->intersecting(0, last, checkXMin ? box.pMin.x : -inf, checkYMin ? box.pMin.y : -inf, 
+                               checkXMax ? box.pMax.x : inf, checkYMax ? box.pMax.y : inf, candidates);
+            for (auto &pos : candidates) {
+                if (windowIsBox && mbrs->xMin[pos] >= box.pMin.x && mbrs->xMax[pos] <= box.pMax.x && mbrs->yMin[pos] >= box.pMin.y && mbrs->yMax[pos] <= box.pMax.y) {
+                    // inside the window
+                    queryResult->addResult((*objects)[pos]->recID);
+                    continue;
+                }
+                ret = forwardPair((*objects)[pos], window, queryResult);
+                if (ret != DBERR_OK) {
+                    return ret;
+                }
+            }
+            return ret;
+        }
+
+        static inline DB_STATUS internal_RangeCorners(ObjectList::iterator &firstFS, Shape* window, ObjectList::iterator &lastFS, hec::QResultBase* queryResult) {
             DB_STATUS ret = DBERR_OK;
             auto pivot = firstFS;
             while(pivot < lastFS) {
@@ -34,7 +73,7 @@ namespace twolayer
             return ret;
         }
 
-        static inline DB_STATUS internal_RangeB_Class(std::vector<Shape*>::iterator &firstFS, Shape* window, std::vector<Shape*>::iterator &lastFS, hec::QResultBase* queryResult) {
+        static inline DB_STATUS internal_RangeB_Class(ObjectList::iterator &firstFS, Shape* window, ObjectList::iterator &lastFS, hec::QResultBase* queryResult) {
             DB_STATUS ret = DBERR_OK;
             auto pivot = firstFS;
             while(pivot < lastFS) {
@@ -51,7 +90,7 @@ namespace twolayer
             return ret;
         }
 
-        static inline DB_STATUS internal_RangeC_Class(std::vector<Shape*>::iterator &firstFS, Shape* window, std::vector<Shape*>::iterator &lastFS, hec::QResultBase* queryResult) {
+        static inline DB_STATUS internal_RangeC_Class(ObjectList::iterator &firstFS, Shape* window, ObjectList::iterator &lastFS, hec::QResultBase* queryResult) {
             DB_STATUS ret = DBERR_OK;
             auto pivot = firstFS;
             while(pivot < lastFS) {
@@ -69,7 +108,7 @@ namespace twolayer
             return ret;
         }
 
-        static inline DB_STATUS internal_RangeCorners_ABCD(std::vector<Shape*>::iterator &firstFS, Shape* window, std::vector<Shape*>::iterator &lastFS, hec::QResultBase* queryResult) {
+        static inline DB_STATUS internal_RangeCorners_ABCD(ObjectList::iterator &firstFS, Shape* window, ObjectList::iterator &lastFS, hec::QResultBase* queryResult) {
             DB_STATUS ret = DBERR_OK;
             auto pivot = firstFS;
             while(pivot < lastFS) {
@@ -88,7 +127,7 @@ namespace twolayer
         }
 
         
-        static inline DB_STATUS RangeCorners(std::vector<Shape*>* objectsR, Shape* objectS, hec::QResultBase* queryResult) {
+        static inline DB_STATUS RangeCorners(ObjectList* objectsR, MBRArrays* mbrsR, Shape* objectS, bool windowIsBox, hec::QResultBase* queryResult) {
             if (objectsR == nullptr || objectS == nullptr) {
                 return DBERR_OK;
             }
@@ -96,6 +135,9 @@ namespace twolayer
                 return DBERR_OK;
             }
             DB_STATUS ret = DBERR_OK;
+            if (mbrsR != nullptr) {
+                return internal_RangeMBRs(objectsR, mbrsR, objectS, windowIsBox, true, true, true, true, queryResult);
+            }
             auto r = objectsR->begin();
             auto lastR = objectsR->end();
 
@@ -108,7 +150,7 @@ namespace twolayer
             return ret;
         }
 
-        static inline DB_STATUS RangeCorners_ABCD(std::vector<Shape*>* objectsR, Shape* objectS, hec::QResultBase* queryResult) {
+        static inline DB_STATUS RangeCorners_ABCD(ObjectList* objectsR, MBRArrays* mbrsR, Shape* objectS, bool windowIsBox, hec::QResultBase* queryResult) {
             if (objectsR == nullptr || objectS == nullptr) {
                 return DBERR_OK;
             }
@@ -116,6 +158,9 @@ namespace twolayer
                 return DBERR_OK;
             }
             DB_STATUS ret = DBERR_OK;
+            if (mbrsR != nullptr) {
+                return internal_RangeMBRs(objectsR, mbrsR, objectS, windowIsBox, true, true, false, false, queryResult);
+            }
             auto r = objectsR->begin();
             auto lastR = objectsR->end();
 
@@ -128,7 +173,7 @@ namespace twolayer
             return ret;
         }
 
-        static inline DB_STATUS internal_RangeCorners_AB(std::vector<Shape*>::iterator &firstFS, Shape* window, std::vector<Shape*>::iterator &lastFS, hec::QResultBase* queryResult) {
+        static inline DB_STATUS internal_RangeCorners_AB(ObjectList::iterator &firstFS, Shape* window, ObjectList::iterator &lastFS, hec::QResultBase* queryResult) {
             DB_STATUS ret = DBERR_OK;
             auto pivot = firstFS;
             while(pivot < lastFS) {
@@ -146,7 +191,7 @@ namespace twolayer
             return ret;
         }
 
-        static inline DB_STATUS internal_RangeCorners_AC(std::vector<Shape*>::iterator &firstFS, Shape* window, std::vector<Shape*>::iterator &lastFS, hec::QResultBase* queryResult) {
+        static inline DB_STATUS internal_RangeCorners_AC(ObjectList::iterator &firstFS, Shape* window, ObjectList::iterator &lastFS, hec::QResultBase* queryResult) {
             DB_STATUS ret = DBERR_OK;
             auto pivot = firstFS;
             while(pivot < lastFS) {
@@ -165,7 +210,7 @@ namespace twolayer
         }
 
 
-        static inline DB_STATUS RangeCorners_AB(std::vector<Shape*>* objectsR, Shape* objectS, hec::QResultBase* queryResult) {
+        static inline DB_STATUS RangeCorners_AB(ObjectList* objectsR, MBRArrays* mbrsR, Shape* objectS, bool windowIsBox, hec::QResultBase* queryResult) {
             if (objectsR == nullptr || objectS == nullptr) {
                 return DBERR_OK;
             }
@@ -173,6 +218,9 @@ namespace twolayer
                 return DBERR_OK;
             }
             DB_STATUS ret = DBERR_OK;
+            if (mbrsR != nullptr) {
+                return internal_RangeMBRs(objectsR, mbrsR, objectS, windowIsBox, false, true, true, false, queryResult);
+            }
             auto r = objectsR->begin();
             auto lastR = objectsR->end();
 
@@ -185,7 +233,7 @@ namespace twolayer
             return ret;
         }
 
-        static inline DB_STATUS RangeCorners_AC(std::vector<Shape*>* objectsR, Shape* objectS, hec::QResultBase* queryResult) {
+        static inline DB_STATUS RangeCorners_AC(ObjectList* objectsR, MBRArrays* mbrsR, Shape* objectS, bool windowIsBox, hec::QResultBase* queryResult) {
             if (objectsR == nullptr || objectS == nullptr) {
                 return DBERR_OK;
             }
@@ -193,6 +241,9 @@ namespace twolayer
                 return DBERR_OK;
             }
             DB_STATUS ret = DBERR_OK;
+            if (mbrsR != nullptr) {
+                return internal_RangeMBRs(objectsR, mbrsR, objectS, windowIsBox, true, false, false, true, queryResult);
+            }
             auto r = objectsR->begin();
             auto lastR = objectsR->end();
 
@@ -205,7 +256,7 @@ namespace twolayer
             return ret;
         }
 
-        static inline DB_STATUS internal_RangeCorners_A(std::vector<Shape*>::iterator &firstFS, Shape* window, std::vector<Shape*>::iterator &lastFS, hec::QResultBase* queryResult) {
+        static inline DB_STATUS internal_RangeCorners_A(ObjectList::iterator &firstFS, Shape* window, ObjectList::iterator &lastFS, hec::QResultBase* queryResult) {
             DB_STATUS ret = DBERR_OK;
             auto pivot = firstFS;
             while(pivot < lastFS) {
@@ -223,7 +274,7 @@ namespace twolayer
             return ret;
         }
 
-        static inline DB_STATUS RangeCorners_A(std::vector<Shape*>* objectsR, Shape* objectS, hec::QResultBase* queryResult) {
+        static inline DB_STATUS RangeCorners_A(ObjectList* objectsR, MBRArrays* mbrsR, Shape* objectS, bool windowIsBox, hec::QResultBase* queryResult) {
             if (objectsR == nullptr || objectS == nullptr) {
                 return DBERR_OK;
             }
@@ -231,6 +282,9 @@ namespace twolayer
                 return DBERR_OK;
             }
             DB_STATUS ret = DBERR_OK;
+            if (mbrsR != nullptr) {
+                return internal_RangeMBRs(objectsR, mbrsR, objectS, windowIsBox, false, false, true, true, queryResult);
+            }
             auto r = objectsR->begin();
             auto lastR = objectsR->end();
 
@@ -243,7 +297,7 @@ namespace twolayer
             return ret;
         }
 
-        static inline DB_STATUS internal_RangeBorders_A_Horizontally(std::vector<Shape*>::iterator &firstFS, Shape* window, std::vector<Shape*>::iterator &lastFS, hec::QResultBase* queryResult) {
+        static inline DB_STATUS internal_RangeBorders_A_Horizontally(ObjectList::iterator &firstFS, Shape* window, ObjectList::iterator &lastFS, hec::QResultBase* queryResult) {
             DB_STATUS ret = DBERR_OK;
             auto pivot = firstFS;
             while(pivot < lastFS) {
@@ -261,7 +315,7 @@ namespace twolayer
             return ret;
         }
 
-        static inline DB_STATUS RangeBorders_A_Horizontally(std::vector<Shape*>* objectsR, Shape* objectS, hec::QResultBase* queryResult) {
+        static inline DB_STATUS RangeBorders_A_Horizontally(ObjectList* objectsR, MBRArrays* mbrsR, Shape* objectS, bool windowIsBox, hec::QResultBase* queryResult) {
             if (objectsR == nullptr || objectS == nullptr) {
                 return DBERR_OK;
             }
@@ -269,6 +323,9 @@ namespace twolayer
                 return DBERR_OK;
             }
             DB_STATUS ret = DBERR_OK;
+            if (mbrsR != nullptr) {
+                return internal_RangeMBRs(objectsR, mbrsR, objectS, windowIsBox, false, false, false, true, queryResult);
+            }
             auto r = objectsR->begin();
             auto lastR = objectsR->end();
 
@@ -281,7 +338,7 @@ namespace twolayer
             return ret;
         }
 
-        static inline DB_STATUS internal_RangeBorders_AC(std::vector<Shape*>::iterator &firstFS, Shape* window, std::vector<Shape*>::iterator &lastFS, hec::QResultBase* queryResult) {
+        static inline DB_STATUS internal_RangeBorders_AC(ObjectList::iterator &firstFS, Shape* window, ObjectList::iterator &lastFS, hec::QResultBase* queryResult) {
             DB_STATUS ret = DBERR_OK;
             auto pivot = firstFS;
             while(pivot < lastFS) {
@@ -299,7 +356,7 @@ namespace twolayer
             return ret;
         }
 
-        static inline DB_STATUS RangeBorders_AC(std::vector<Shape*>* objectsR, Shape* objectS, hec::QResultBase* queryResult) {
+        static inline DB_STATUS RangeBorders_AC(ObjectList* objectsR, MBRArrays* mbrsR, Shape* objectS, bool windowIsBox, hec::QResultBase* queryResult) {
             if (objectsR == nullptr || objectS == nullptr) {
                 return DBERR_OK;
             }
@@ -307,6 +364,9 @@ namespace twolayer
                 return DBERR_OK;
             }
             DB_STATUS ret = DBERR_OK;
+            if (mbrsR != nullptr) {
+                return internal_RangeMBRs(objectsR, mbrsR, objectS, windowIsBox, true, false, false, false, queryResult);
+            }
             auto r = objectsR->begin();
             auto lastR = objectsR->end();
 
@@ -319,7 +379,7 @@ namespace twolayer
             return ret;
         }
         
-        static inline DB_STATUS internal_RangeBorders_AB(std::vector<Shape*>::iterator &firstFS, Shape* window, std::vector<Shape*>::iterator &lastFS, hec::QResultBase* queryResult) {
+        static inline DB_STATUS internal_RangeBorders_AB(ObjectList::iterator &firstFS, Shape* window, ObjectList::iterator &lastFS, hec::QResultBase* queryResult) {
             DB_STATUS ret = DBERR_OK;
             auto pivot = firstFS;
             while(pivot < lastFS) {
@@ -336,7 +396,7 @@ namespace twolayer
             return ret;
         }
 
-        static inline DB_STATUS RangeBorders_AB(std::vector<Shape*>* objectsR, Shape* objectS, hec::QResultBase* queryResult) {
+        static inline DB_STATUS RangeBorders_AB(ObjectList* objectsR, MBRArrays* mbrsR, Shape* objectS, bool windowIsBox, hec::QResultBase* queryResult) {
             if (objectsR == nullptr || objectS == nullptr) {
                 return DBERR_OK;
             }
@@ -344,6 +404,9 @@ namespace twolayer
                 return DBERR_OK;
             }
             DB_STATUS ret = DBERR_OK;
+            if (mbrsR != nullptr) {
+                return internal_RangeMBRs(objectsR, mbrsR, objectS, windowIsBox, false, true, false, false, queryResult);
+            }
             auto r = objectsR->begin();
             auto lastR = objectsR->end();
 
@@ -356,7 +419,7 @@ namespace twolayer
             return ret;
         }
 
-        static inline DB_STATUS RangeB_Class(std::vector<Shape*>* objectsR, Shape* objectS, hec::QResultBase* queryResult) {
+        static inline DB_STATUS RangeB_Class(ObjectList* objectsR, MBRArrays* mbrsR, Shape* objectS, bool windowIsBox, hec::QResultBase* queryResult) {
             if (objectsR == nullptr || objectS == nullptr) {
                 return DBERR_OK;
             }
@@ -364,6 +427,9 @@ namespace twolayer
                 return DBERR_OK;
             }
             DB_STATUS ret = DBERR_OK;
+            if (mbrsR != nullptr) {
+                return internal_RangeMBRs(objectsR, mbrsR, objectS, windowIsBox, false, true, false, true, queryResult);
+            }
             auto r = objectsR->begin();
             auto lastR = objectsR->end();
 
@@ -376,7 +442,7 @@ namespace twolayer
             return ret;
         }
 
-        static inline DB_STATUS RangeC_Class(std::vector<Shape*>* objectsR, Shape* objectS, hec::QResultBase* queryResult) {
+        static inline DB_STATUS RangeC_Class(ObjectList* objectsR, MBRArrays* mbrsR, Shape* objectS, bool windowIsBox, hec::QResultBase* queryResult) {
             if (objectsR == nullptr || objectS == nullptr) {
                 return DBERR_OK;
             }
@@ -384,6 +450,9 @@ namespace twolayer
                 return DBERR_OK;
             }
             DB_STATUS ret = DBERR_OK;
+            if (mbrsR != nullptr) {
+                return internal_RangeMBRs(objectsR, mbrsR, objectS, windowIsBox, true, false, true, false, queryResult);
+            }
             auto r = objectsR->begin();
             auto lastR = objectsR->end();
 
@@ -396,7 +465,7 @@ namespace twolayer
             return ret;
         }
 
-        static inline DB_STATUS internal_RangeBorders_A_Vertically(std::vector<Shape*>::iterator &firstFS, Shape* window, std::vector<Shape*>::iterator &lastFS, hec::QResultBase* queryResult) {
+        static inline DB_STATUS internal_RangeBorders_A_Vertically(ObjectList::iterator &firstFS, Shape* window, ObjectList::iterator &lastFS, hec::QResultBase* queryResult) {
             DB_STATUS ret = DBERR_OK;
             auto pivot = firstFS;
             while(pivot < lastFS) {
@@ -414,7 +483,7 @@ namespace twolayer
             return ret;
         }
 
-        static inline DB_STATUS RangeBorders_A_Vertically(std::vector<Shape*>* objectsR, Shape* objectS, hec::QResultBase* queryResult) {
+        static inline DB_STATUS RangeBorders_A_Vertically(ObjectList* objectsR, MBRArrays* mbrsR, Shape* objectS, bool windowIsBox, hec::QResultBase* queryResult) {
             if (objectsR == nullptr || objectS == nullptr) {
                 return DBERR_OK;
             }
@@ -422,6 +491,9 @@ namespace twolayer
                 return DBERR_OK;
             }
             DB_STATUS ret = DBERR_OK;
+            if (mbrsR != nullptr) {
+                return internal_RangeMBRs(objectsR, mbrsR, objectS, windowIsBox, false, false, true, false, queryResult);
+            }
             auto r = objectsR->begin();
             auto lastR = objectsR->end();
 
@@ -449,12 +521,24 @@ namespace twolayer
                 return ret;
             }
             window.setMBR();
+            // a rectangle window holds every object whose MBR it contains
+            bool windowIsBox = window.coversMBR();
+            // rasterize the window once for the APRIL filter of its candidates
+            ret = APRIL::standard::createWindowAPRIL(dataset, &window);
+            if (ret != DBERR_OK) {
+                return ret;
+            }
             
-            // get cells range
-            int partitionMinX = std::floor((window.mbr.pMin.x - g_config.datasetOptions.dataspaceMetadata.xMinGlobal) / g_config.partitioningMethod->getPartPartionExtentX());
-            int partitionMinY = std::floor((window.mbr.pMin.y - g_config.datasetOptions.dataspaceMetadata.yMinGlobal) / g_config.partitioningMethod->getPartPartionExtentY());
-            int partitionMaxX = std::floor((window.mbr.pMax.x - g_config.datasetOptions.dataspaceMetadata.xMinGlobal) / g_config.partitioningMethod->getPartPartionExtentX());
-            int partitionMaxY = std::floor((window.mbr.pMax.y - g_config.datasetOptions.dataspaceMetadata.yMinGlobal) / g_config.partitioningMethod->getPartPartionExtentY());
+            // get cells range (clamped to the dataspace, the partition IDs of cells outside it belong to other cells)
+            int globalPPD = g_config.partitioningMethod->getGlobalPPD();
+            int partitionMinX = std::max(0, (int) std::floor((window.mbr.pMin.x - g_config.datasetOptions.dataspaceMetadata.xMinGlobal) / g_config.partitioningMethod->getPartPartionExtentX()));
+            int partitionMinY = std::max(0, (int) std::floor((window.mbr.pMin.y - g_config.datasetOptions.dataspaceMetadata.yMinGlobal) / g_config.partitioningMethod->getPartPartionExtentY()));
+            int partitionMaxX = std::min(globalPPD - 1, (int) std::floor((window.mbr.pMax.x - g_config.datasetOptions.dataspaceMetadata.xMinGlobal) / g_config.partitioningMethod->getPartPartionExtentX()));
+            int partitionMaxY = std::min(globalPPD - 1, (int) std::floor((window.mbr.pMax.y - g_config.datasetOptions.dataspaceMetadata.yMinGlobal) / g_config.partitioningMethod->getPartPartionExtentY()));
+            if (partitionMinX > partitionMaxX || partitionMinY > partitionMaxY) {
+                // the window lies outside the dataspace
+                return ret;
+            }
             
             int partitionID = -1;
             PartitionBase* partition = nullptr;
@@ -466,7 +550,7 @@ namespace twolayer
                     // valid partition
                     // check A,B,C,D
                     for (int tl_class=CLASS_A; tl_class<=CLASS_D; tl_class++) {    
-                        ret = RangeCorners(partition->getContents((TwoLayerClass) tl_class), &window, queryResult.get());
+                        ret = RangeCorners(partition->getContents((TwoLayerClass) tl_class), partition->getMBRs((TwoLayerClass) tl_class), &window, windowIsBox, queryResult.get());
                         if (ret != DBERR_OK) {
                             return ret;
                         }
@@ -480,7 +564,7 @@ namespace twolayer
                     // valid partition
                     // check A,B,C,D
                     for (int tl_class=CLASS_A; tl_class<=CLASS_D; tl_class++) {    
-                        ret = RangeCorners(partition->getContents((TwoLayerClass) tl_class), &window, queryResult.get());
+                        ret = RangeCorners(partition->getContents((TwoLayerClass) tl_class), partition->getMBRs((TwoLayerClass) tl_class), &window, windowIsBox, queryResult.get());
                         if (ret != DBERR_OK) {
                             return ret;
                         }
@@ -493,7 +577,7 @@ namespace twolayer
                     if (partition != nullptr) {
                         // range B class, check A,B
                         for (int tl_class=CLASS_A; tl_class<=CLASS_B; tl_class++) {    
-                            ret = RangeB_Class(partition->getContents((TwoLayerClass) tl_class), &window, queryResult.get());
+                            ret = RangeB_Class(partition->getContents((TwoLayerClass) tl_class), partition->getMBRs((TwoLayerClass) tl_class), &window, windowIsBox, queryResult.get());
                             if (ret != DBERR_OK) {
                                 return ret;
                             }
@@ -506,7 +590,7 @@ namespace twolayer
                 if (partition != nullptr) {
                     // check A,B
                     for (int tl_class=CLASS_A; tl_class<=CLASS_B; tl_class++) {    
-                        ret = RangeCorners(partition->getContents((TwoLayerClass) tl_class), &window, queryResult.get());
+                        ret = RangeCorners(partition->getContents((TwoLayerClass) tl_class), partition->getMBRs((TwoLayerClass) tl_class), &window, windowIsBox, queryResult.get());
                         if (ret != DBERR_OK) {
                             return ret;
                         }
@@ -520,7 +604,7 @@ namespace twolayer
                     // valid partition
                     // check A,B,C,D
                     for (int tl_class=CLASS_A; tl_class<=CLASS_D; tl_class++) {    
-                        ret = RangeCorners(partition->getContents((TwoLayerClass) tl_class), &window, queryResult.get());
+                        ret = RangeCorners(partition->getContents((TwoLayerClass) tl_class), partition->getMBRs((TwoLayerClass) tl_class), &window, windowIsBox, queryResult.get());
                         if (ret != DBERR_OK) {
                             return ret;
                         }
@@ -532,11 +616,11 @@ namespace twolayer
                     partition = dataset->index->getPartition(partitionID);
                     if (partition != nullptr) {
                         // check A,C
-                        ret = RangeC_Class(partition->getContents((TwoLayerClass) CLASS_A), &window, queryResult.get());
+                        ret = RangeC_Class(partition->getContents((TwoLayerClass) CLASS_A), partition->getMBRs((TwoLayerClass) CLASS_A), &window, windowIsBox, queryResult.get());
                         if (ret != DBERR_OK) {
                             return ret;
                         }
-                        ret = RangeC_Class(partition->getContents((TwoLayerClass) CLASS_C), &window, queryResult.get());
+                        ret = RangeC_Class(partition->getContents((TwoLayerClass) CLASS_C), partition->getMBRs((TwoLayerClass) CLASS_C), &window, windowIsBox, queryResult.get());
                         if (ret != DBERR_OK) {
                             return ret;
                         }
@@ -547,12 +631,12 @@ namespace twolayer
                 partition = dataset->index->getPartition(partitionID);
                 if (partition != nullptr) {
                     // check A
-                    ret = RangeCorners(partition->getContents((TwoLayerClass) CLASS_A), &window, queryResult.get());
+                    ret = RangeCorners(partition->getContents((TwoLayerClass) CLASS_A), partition->getMBRs((TwoLayerClass) CLASS_A), &window, windowIsBox, queryResult.get());
                     if (ret != DBERR_OK) {
                         return ret;
                     }
                     // check C
-                    ret = RangeCorners(partition->getContents((TwoLayerClass) CLASS_C), &window, queryResult.get());
+                    ret = RangeCorners(partition->getContents((TwoLayerClass) CLASS_C), partition->getMBRs((TwoLayerClass) CLASS_C), &window, windowIsBox, queryResult.get());
                     if (ret != DBERR_OK) {
                         return ret;
                     }
@@ -565,7 +649,7 @@ namespace twolayer
                 if (partition != nullptr) {
                     // valid partition
                     for (int tl_class=CLASS_A; tl_class<=CLASS_D; tl_class++) {    
-                        ret = RangeCorners_ABCD(partition->getContents((TwoLayerClass) tl_class), &window, queryResult.get());
+                        ret = RangeCorners_ABCD(partition->getContents((TwoLayerClass) tl_class), partition->getMBRs((TwoLayerClass) tl_class), &window, windowIsBox, queryResult.get());
                         if (ret != DBERR_OK) {
                             return ret;
                         }
@@ -578,7 +662,7 @@ namespace twolayer
                     partition = dataset->index->getPartition(partitionID);
                     if (partition != nullptr) {
                         for (int tl_class=CLASS_A; tl_class<=CLASS_B; tl_class++) {    
-                            ret = RangeBorders_AB(partition->getContents((TwoLayerClass) tl_class), &window, queryResult.get());
+                            ret = RangeBorders_AB(partition->getContents((TwoLayerClass) tl_class), partition->getMBRs((TwoLayerClass) tl_class), &window, windowIsBox, queryResult.get());
                             if (ret != DBERR_OK) {
                                 return ret;
                             }
@@ -591,7 +675,7 @@ namespace twolayer
                 if (partition != nullptr) {
                     for (int tl_class=CLASS_A; tl_class<=CLASS_B; tl_class++) {    
                         // range borders AB
-                        ret = RangeCorners_AB(partition->getContents((TwoLayerClass) tl_class), &window, queryResult.get());
+                        ret = RangeCorners_AB(partition->getContents((TwoLayerClass) tl_class), partition->getMBRs((TwoLayerClass) tl_class), &window, windowIsBox, queryResult.get());
                         if (ret != DBERR_OK) {
                             return ret;
                         }
@@ -605,11 +689,11 @@ namespace twolayer
                     partitionID = g_config.partitioningMethod->getPartitionID(partitionMinX, j, g_config.partitioningMethod->getGlobalPPD());
                     partition = dataset->index->getPartition(partitionID);
                     if (partition != nullptr) {
-                        ret = RangeBorders_AC(partition->getContents(CLASS_A), &window, queryResult.get());
+                        ret = RangeBorders_AC(partition->getContents(CLASS_A), partition->getMBRs(CLASS_A), &window, windowIsBox, queryResult.get());
                         if (ret != DBERR_OK) {
                             return ret;
                         }
-                        ret = RangeBorders_AC(partition->getContents(CLASS_C), &window, queryResult.get());
+                        ret = RangeBorders_AC(partition->getContents(CLASS_C), partition->getMBRs(CLASS_C), &window, windowIsBox, queryResult.get());
                         if (ret != DBERR_OK) {
                             return ret;
                         }
@@ -621,10 +705,11 @@ namespace twolayer
                         partitionID = g_config.partitioningMethod->getPartitionID(i, j, g_config.partitioningMethod->getGlobalPPD());
                         partition = dataset->index->getPartition(partitionID);
                         if (partition != nullptr) {
-                            /** @todo GET ONLY A RESULTS, NO CHECKS */
-                            std::vector<Shape*>* contents = partition->getContents(CLASS_A);
-                            for (auto &it: *contents) {
-                                queryResult->addResult(it->recID);
+                            // the cell lies inside the window's MBR, but an object's MBR reaching the window does not
+                            // mean its geometry does: report the contained MBRs of box windows, refine the rest
+                            ret = internal_RangeMBRs(partition->getContents(CLASS_A), partition->getMBRs(CLASS_A), &window, windowIsBox, false, false, false, false, queryResult.get());
+                            if (ret != DBERR_OK) {
+                                return ret;
                             }
                         }
                     }
@@ -633,7 +718,7 @@ namespace twolayer
                     partitionID = g_config.partitioningMethod->getPartitionID(partitionMaxX, j, g_config.partitioningMethod->getGlobalPPD());
                     partition = dataset->index->getPartition(partitionID);
                     if (partition != nullptr) {
-                        ret = RangeBorders_A_Vertically(partition->getContents(CLASS_A), &window, queryResult.get());
+                        ret = RangeBorders_A_Vertically(partition->getContents(CLASS_A), partition->getMBRs(CLASS_A), &window, windowIsBox, queryResult.get());
                         if (ret != DBERR_OK) {
                             return ret;
                         }
@@ -645,11 +730,11 @@ namespace twolayer
                 partitionID = g_config.partitioningMethod->getPartitionID(partitionMinX, partitionMaxY, g_config.partitioningMethod->getGlobalPPD());
                 partition = dataset->index->getPartition(partitionID);
                 if (partition != nullptr) {
-                    ret = RangeCorners_AC(partition->getContents(CLASS_A), &window, queryResult.get());
+                    ret = RangeCorners_AC(partition->getContents(CLASS_A), partition->getMBRs(CLASS_A), &window, windowIsBox, queryResult.get());
                     if (ret != DBERR_OK) {
                         return ret;
                     }
-                    ret = RangeCorners_AC(partition->getContents(CLASS_C), &window, queryResult.get());
+                    ret = RangeCorners_AC(partition->getContents(CLASS_C), partition->getMBRs(CLASS_C), &window, windowIsBox, queryResult.get());
                     if (ret != DBERR_OK) {
                         return ret;
                     }
@@ -661,7 +746,7 @@ namespace twolayer
                     partition = dataset->index->getPartition(partitionID);
                     if (partition != nullptr) {
                         // check A horizontally
-                        ret = RangeBorders_A_Horizontally(partition->getContents(CLASS_A), &window, queryResult.get());
+                        ret = RangeBorders_A_Horizontally(partition->getContents(CLASS_A), partition->getMBRs(CLASS_A), &window, windowIsBox, queryResult.get());
                         if (ret != DBERR_OK) {
                             return ret;
                         }
@@ -674,7 +759,7 @@ namespace twolayer
                 partition = dataset->index->getPartition(partitionID);
                 if (partition != nullptr) {  
                     // check A corners  
-                    ret = RangeCorners_A(partition->getContents(CLASS_A), &window, queryResult.get());
+                    ret = RangeCorners_A(partition->getContents(CLASS_A), partition->getMBRs(CLASS_A), &window, windowIsBox, queryResult.get());
                     if (ret != DBERR_OK) {
                         return ret;
                     }
@@ -683,5 +768,201 @@ namespace twolayer
             
             return ret;
         }
+
+        /** @brief A window of a batch, with the classes it needs from one partition. */
+        struct BatchWindow {
+            int query;
+            /** @brief Bit c is set for class c. */
+            int classMask;
+        };
+
+        /** @brief The classes a window needs from a partition (see evaluate): objects that start before the partition
+         * on an axis are reported by the previous partition on that axis, unless the window starts in this one. */
+        static inline int windowClassMask(int i, int j, int partitionMinX, int partitionMinY) {
+            if (i == partitionMinX && j == partitionMinY) {
+                return (1 << CLASS_A) | (1 << CLASS_B) | (1 << CLASS_C) | (1 << CLASS_D);
+            } else if (j == partitionMinY) {
+                return (1 << CLASS_A) | (1 << CLASS_B);
+            } else if (i == partitionMinX) {
+                return (1 << CLASS_A) | (1 << CLASS_C);
+            }
+            return 1 << CLASS_A;
+        }
+
+        /** @brief Reports the object for the window, refining it unless its MBR lies inside a rectangle window. */
+        static inline DB_STATUS reportPair(Shape* obj, const MBR &objMBR, Shape* window, bool windowIsBox, hec::QResultBase* queryResult) {
+            const MBR &box = window->mbr;
+            if (windowIsBox && objMBR.pMin.x >= box.pMin.x && objMBR.pMax.x <= box.pMax.x && objMBR.pMin.y >= box.pMin.y && objMBR.pMax.y <= box.pMax.y) {
+                queryResult->addResult(obj->recID);
+                return DBERR_OK;
+            }
+            if (!window->aprilData.intervalsALL.empty()) {
+                return APRIL::standard::RangeFilterEntrypoint(window, obj, queryResult);
+            }
+            DB_STATUS ret = refinement::relate::refinementEntrypoint(window, obj, hec::Q_RANGE, queryResult);
+            if (ret != DBERR_OK) {
+                logger::log_error(ret, "Refinement failed.");
+            }
+            return ret;
+        }
+
+        /** @brief Scans one partition class against all the given windows (sorted on their bottom side) at once: 
+         * a plane sweep of the windows against the contents, if these are sorted on Y, a pass per window otherwise. */
+        static DB_STATUS sharedScanClass(ObjectList* objects, MBRArrays* mbrs, std::vector<int> &windowOrder, std::vector<Shape> &windows, 
+                                         std::vector<bool> &windowIsBox, std::vector<hec::QResultBase*> &queryResults) {
+            DB_STATUS ret = DBERR_OK;
+            if (mbrs == nullptr || !mbrs->sortedOnY) {
+                for (auto &q : windowOrder) {
+                    const MBR &box = windows[q].mbr;
+                    for (Shape* obj : *objects) {
+                        if (obj->mbr.pMin.x > box.pMax.x || obj->mbr.pMax.x < box.pMin.x || obj->mbr.pMin.y > box.pMax.y || obj->mbr.pMax.y < box.pMin.y) {
+                            continue;
+                        }
+                        ret = reportPair(obj, obj->mbr, &windows[q], windowIsBox[q], queryResults[q]);
+                        if (ret != DBERR_OK) {
+                            return ret;
+                        }
+                    }
+                }
+                return ret;
+            }
+            std::vector<uint32_t> positions;
+            size_t i = 0, k = 0;
+            while (i < mbrs->size() && k < windowOrder.size()) {
+                if (mbrs->yMin[i] < windows[windowOrder[k]].mbr.pMin.y) {
+                    // the object starts first: it meets the windows that start within its y extent
+                    for (size_t w=k; w<windowOrder.size() && windows[windowOrder[w]].mbr.pMin.y <= mbrs->yMax[i]; w++) {
+                        int q = windowOrder[w];
+                        if (mbrs->xMin[i] > windows[q].mbr.pMax.x || mbrs->xMax[i] < windows[q].mbr.pMin.x) {
+                            continue;
+                        }
+                        ret = reportPair((*objects)[i], (*objects)[i]->mbr, &windows[q], windowIsBox[q], queryResults[q]);
+                        if (ret != DBERR_OK) {
+                            return ret;
+                        }
+                    }
+                    i++;
+                } else {
+                    // the window starts first: it meets the objects that start within its y extent
+                    int q = windowOrder[k];
+                    positions.clear();
+                    mbrs->sweep(i, windows[q].mbr.pMin.x, windows[q].mbr.pMax.x, windows[q].mbr.pMax.y, positions);
+                    for (auto &pos : positions) {
+                        ret = reportPair((*objects)[pos], (*objects)[pos]->mbr, &windows[q], windowIsBox[q], queryResults[q]);
+                        if (ret != DBERR_OK) {
+                            return ret;
+                        }
+                    }
+                    k++;
+                }
+            }
+            return ret;
+        }
+
+        DB_STATUS evaluateBatch(Dataset* dataset, std::vector<hec::RangeQuery*> &rangeQueries, std::vector<hec::QResultBase*> &queryResults) {
+            DB_STATUS ret = DBERR_OK;
+            // create the windows
+            std::vector<Shape> windows(rangeQueries.size());
+            std::vector<bool> windowIsBox(rangeQueries.size());
+            for (int q=0; q<rangeQueries.size(); q++) {
+                ret = shape_factory::createEmpty((DataType) rangeQueries[q]->getShapeType(), windows[q]);
+                if (ret != DBERR_OK) {
+                    return ret;
+                }
+                ret = windows[q].setFromWKT(rangeQueries[q]->getWKT());
+                if (ret != DBERR_OK) {
+                    logger::log_error(ret, "Setting window shape from WKT failed. WKT:", rangeQueries[q]->getWKT());
+                    return ret;
+                }
+                windows[q].setMBR();
+                windowIsBox[q] = windows[q].coversMBR();
+                ret = APRIL::standard::createWindowAPRIL(dataset, &windows[q]);
+                if (ret != DBERR_OK) {
+                    return ret;
+                }
+            }
+
+            // bucket the windows by the existing partitions of their cells (clamped to the dataspace)
+            PartitioningMethod* partitioning = g_config.partitioningMethod;
+            DataspaceMetadata &dataspace = g_config.datasetOptions.dataspaceMetadata;
+            int globalPPD = partitioning->getGlobalPPD();
+            std::unordered_map<int, std::vector<BatchWindow>> partitionWindows;
+            for (int q=0; q<rangeQueries.size(); q++) {
+                const MBR &box = windows[q].mbr;
+                int partitionMinX = std::max(0, (int) std::floor((box.pMin.x - dataspace.xMinGlobal) / partitioning->getPartPartionExtentX()));
+                int partitionMinY = std::max(0, (int) std::floor((box.pMin.y - dataspace.yMinGlobal) / partitioning->getPartPartionExtentY()));
+                int partitionMaxX = std::min(globalPPD - 1, (int) std::floor((box.pMax.x - dataspace.xMinGlobal) / partitioning->getPartPartionExtentX()));
+                int partitionMaxY = std::min(globalPPD - 1, (int) std::floor((box.pMax.y - dataspace.yMinGlobal) / partitioning->getPartPartionExtentY()));
+                for (int j=partitionMinY; j<=partitionMaxY; j++) {
+                    int rowFirst = partitioning->getPartitionID(partitionMinX, j, globalPPD);
+                    int rowLast = partitioning->getPartitionID(partitionMaxX, j, globalPPD) + 1;
+                    for (int partitionID = dataset->index->nextPartitionID(rowFirst, rowLast); partitionID < rowLast; partitionID = dataset->index->nextPartitionID(partitionID + 1, rowLast)) {
+                        int i = partitionID - rowFirst + partitionMinX;
+                        partitionWindows[partitionID].push_back({q, windowClassMask(i, j, partitionMinX, partitionMinY)});
+                    }
+                }
+            }
+            // in partition order
+            std::vector<std::pair<int, std::vector<BatchWindow>>> buckets(std::make_move_iterator(partitionWindows.begin()), std::make_move_iterator(partitionWindows.end()));
+            std::sort(buckets.begin(), buckets.end(), [](const auto &a, const auto &b) {
+                return a.first < b.first;
+            });
+
+            // scan every partition once, each thread into its own results per query
+            std::vector<std::vector<std::unique_ptr<hec::QResultBase>>> threadResults(MAX_THREADS);
+            #pragma omp parallel num_threads(MAX_THREADS)
+            {
+                int tid = omp_get_thread_num();
+                auto &localResults = threadResults[tid];
+                localResults.resize(rangeQueries.size());
+                std::vector<hec::QResultBase*> localResultPtrs(rangeQueries.size());
+                for (int q=0; q<rangeQueries.size(); q++) {
+                    localResults[q].reset(queryResults[q]->cloneEmpty());
+                    localResultPtrs[q] = localResults[q].get();
+                }
+                std::vector<int> windowOrder;
+                #pragma omp for schedule(dynamic)
+                for (int b=0; b<buckets.size(); b++) {
+                    PartitionBase* partition = dataset->index->getPartition(buckets[b].first);
+                    for (int tl_class=CLASS_A; tl_class<=CLASS_D; tl_class++) {
+                        ObjectList* contents = partition->getContents((TwoLayerClass) tl_class);
+                        if (contents == nullptr || contents->empty()) {
+                            continue;
+                        }
+                        windowOrder.clear();
+                        for (auto &window : buckets[b].second) {
+                            if (window.classMask & (1 << tl_class)) {
+                                windowOrder.push_back(window.query);
+                            }
+                        }
+                        if (windowOrder.empty()) {
+                            continue;
+                        }
+                        std::sort(windowOrder.begin(), windowOrder.end(), [&](int a, int b) {
+                            return windows[a].mbr.pMin.y < windows[b].mbr.pMin.y;
+                        });
+                        DB_STATUS local_ret = sharedScanClass(contents, partition->getMBRs((TwoLayerClass) tl_class), windowOrder, windows, windowIsBox, localResultPtrs);
+                        if (local_ret != DBERR_OK) {
+                            #pragma omp critical
+                            ret = local_ret;
+                        }
+                    }
+                }
+            }
+            if (ret != DBERR_OK) {
+                logger::log_error(ret, "Shared scan of the range batch failed.");
+                return ret;
+            }
+            // merge the threads' results of each query
+            for (auto &localResults : threadResults) {
+                for (int q=0; q<localResults.size(); q++) {
+                    ret = mergeResultObjects(queryResults[q], localResults[q].get());
+                    if (ret != DBERR_OK) {
+                        return ret;
+                    }
+                }
+            }
+            return ret;
+        }
     } // range query mbr filter
 }
\ No newline at end of file
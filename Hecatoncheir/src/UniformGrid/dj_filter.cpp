@@ -1,5 +1,6 @@
 #include "UniformGrid/filter.h"
 #include <omp.h>
+#include <numeric>
 
 namespace uniform_grid
 {
@@ -27,6 +28,19 @@ namespace uniform_grid
             return DBERR_OK;
         }
 
+        /** @brief Sets positions to the positions of the partition's objects whose MBR lies within the given distance of the MBR, 
+         * descending into the cell's sub-grid, if any. Without MBR arrays, all positions are returned. */
+        static inline void getCandidatePositions(PartitionBase* partition, const MBR &mbr, double distance, std::vector<uint32_t> &positions) {
+            positions.clear();
+            PartitionUniformGrid* cell = dynamic_cast<PartitionUniformGrid*>(partition);
+            if (cell == nullptr || cell->getMBRs() == nullptr) {
+                positions.resize(partition->getContents()->size());
+                std::iota(positions.begin(), positions.end(), 0);
+                return;
+            }
+            cell->intersecting(mbr.pMin.x - distance, mbr.pMin.y - distance, mbr.pMax.x + distance, mbr.pMax.y + distance, positions);
+        }
+
         DB_STATUS evaluate(hec::DistanceJoinQuery *distanceJoinQuery, std::unordered_map<int, DJBatch>& borderObjectsMap, std::unique_ptr<hec::QResultBase>& queryResult) {
             DB_STATUS ret = DBERR_OK;
             Dataset* R = g_config.datasetOptions.getDatasetByIdx(distanceJoinQuery->getDatasetRid());
@@ -43,15 +57,16 @@ namespace uniform_grid
                 DB_STATUS local_ret = DBERR_OK;
                 int overlapPartitionID; 
                 int nodeRank;
+                std::vector<uint32_t> candidates;
                 #pragma omp for
                 for (int i = 0; i < partitions->size(); i++) {
                     PartitionBase* partitionR = partitions->at(i);
                     int iFine = partitionR->partitionID % g_config.partitioningMethod->getGlobalPPD(); 
                     int jFine = partitionR->partitionID / g_config.partitioningMethod->getGlobalPPD(); 
 
-                    std::vector<Shape*>* objectsR = partitionR->getContents();
+                    ObjectList* objectsR = partitionR->getContents();
                     if (objectsR != nullptr) {
-                        for (auto &obj : *objectsR) {
+                        for (Shape* obj : *objectsR) {
                             //  Check if this R object needs to be distributed
                             std::vector<std::pair<int,int>> overlappingPartitionOffsets = obj->getOverlappingPartitionOffsets(
                                 iFine, jFine, distanceJoinQuery->getDistanceValue(),
@@ -74,9 +89,11 @@ namespace uniform_grid
                                     // no distribution needed, evaluate locally against other local partitions
                                     PartitionBase* partitionS = S->index->getPartition(overlapPartitionID);
                                     if (partitionS != nullptr) {
-                                        std::vector<Shape*>* objectsS = partitionS->getContents();
+                                        ObjectList* objectsS = partitionS->getContents();
                                         if (objectsS != nullptr) {
-                                            for (auto &objectS : *objectsS) {
+                                            getCandidatePositions(partitionS, obj->mbr, distanceJoinQuery->getDistanceValue(), candidates);
+                                            for (auto &pos : candidates) {
+                                                Shape* objectS = (*objectsS)[pos];
                                                 if (obj->distance(*objectS) <= distanceJoinQuery->getDistanceValue()) {
                                                     queryResult->addResult(obj->recID, objectS->recID);
                                                 }
@@ -118,9 +135,9 @@ namespace uniform_grid
                     int iFine = partitionS->partitionID % g_config.partitioningMethod->getGlobalPPD(); 
                     int jFine = partitionS->partitionID / g_config.partitioningMethod->getGlobalPPD(); 
 
-                    std::vector<Shape*>* objectsS = partitionS->getContents();
+                    ObjectList* objectsS = partitionS->getContents();
                     if (objectsS != nullptr) {
-                        for (auto &obj : *objectsS) {
+                        for (Shape* obj : *objectsS) {
                             std::vector<std::pair<int,int>> overlappingPartitionOffsets = obj->getOverlappingPartitionOffsets(
                                 iFine, jFine, distanceJoinQuery->getDistanceValue(),
                                 g_config.partitioningMethod->getPartPartionExtentX(),
@@ -165,6 +182,7 @@ namespace uniform_grid
             Dataset* S = g_config.datasetOptions.getDatasetByIdx(distanceJoinQuery->getDatasetSid());
             int overlapPartitionID; 
             int nodeRank;
+            std::vector<uint32_t> candidates;
             // R objects in batch
             /** @todo: parallelize */
             for (auto& objectR: batch.objectsR) {
@@ -189,9 +207,11 @@ namespace uniform_grid
                         // no distribution needed, evaluate locally against other local partitions
                         PartitionBase* partitionS = S->index->getPartition(overlapPartitionID);
                         if (partitionS != nullptr) {
-                            std::vector<Shape*>* objectsS = partitionS->getContents();
+                            ObjectList* objectsS = partitionS->getContents();
                             if (objectsS != nullptr) {
-                                for (auto &objectS : *objectsS) {
+                                getCandidatePositions(partitionS, objectR.second.mbr, distanceJoinQuery->getDistanceValue(), candidates);
+                                for (auto &pos : candidates) {
+                                    Shape* objectS = (*objectsS)[pos];
                                     if (objectR.second.distance(*objectS) <= distanceJoinQuery->getDistanceValue()) {
                                         queryResult->addResult(objectR.second.recID, objectS->recID);
                                     }
@@ -226,9 +246,11 @@ namespace uniform_grid
                         // no distribution needed, evaluate locally against other local partitions
                         PartitionBase* partitionR = R->index->getPartition(overlapPartitionID);
                         if (partitionR != nullptr) {
-                            std::vector<Shape*>* objectsR = partitionR->getContents();
+                            ObjectList* objectsR = partitionR->getContents();
                             if (objectsR != nullptr) {
-                                for (auto &objectR : *objectsR) {
+                                getCandidatePositions(partitionR, objectS.second.mbr, distanceJoinQuery->getDistanceValue(), candidates);
+                                for (auto &pos : candidates) {
+                                    Shape* objectR = (*objectsR)[pos];
                                     if (objectR->distance(objectS.second) <= distanceJoinQuery->getDistanceValue()) {
                                         queryResult->addResult(objectR->recID, objectS.second.recID);
                                     }
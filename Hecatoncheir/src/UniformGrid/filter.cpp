@@ -4,9 +4,6 @@ namespace uniform_grid
 {
     DB_STATUS processQuery(hec::Query* query, std::unordered_map<int, DJBatch>& borderObjectsMap, std::unique_ptr<hec::QResultBase>& queryResult) {
         DB_STATUS ret = DBERR_OK;
-        // set to global config
-        g_config.queryPipeline.queryType = (hec::QueryType) query->getQueryType();
-
         // switch based on query type
         switch (query->getQueryType()) {
             case hec::Q_DISTANCE_JOIN:
@@ -30,9 +27,6 @@ namespace uniform_grid
 
     DB_STATUS processQuery(hec::Query* query, std::unique_ptr<hec::QResultBase>& queryResult) {
         DB_STATUS ret = DBERR_OK;
-        // set to global config
-        g_config.queryPipeline.queryType = (hec::QueryType) query->getQueryType();
-
         // switch based on query type
         switch (query->getQueryType()) {
             case hec::Q_RANGE:
@@ -3,7 +3,43 @@
 namespace uniform_grid
 {
     namespace knn_filter
-    {        
+    {
+        /** @brief Evaluates the contents of a subdivided cell, visiting its sub-cells by increasing distance from the query point 
+         * and stopping at the first one that is farther than the current k-th neighbor. */
+        static void evaluateSubGrid(Shape &qPoint, PartitionUniformGrid* cell, std::unique_ptr<hec::QResultBase>& queryResult) {
+            const UGSubGrid &subGrid = cell->subGrid;
+            const double inf = std::numeric_limits<double>::infinity();
+            std::vector<std::pair<double, int>> subCells;
+            subCells.reserve(subGrid.offsets.size() - 1);
+            for (int j=0; j<subGrid.cellsPerDim; j++) {
+                for (int i=0; i<subGrid.cellsPerDim; i++) {
+                    int subCell = i + j * subGrid.cellsPerDim;
+                    if (subGrid.offsets[subCell] == subGrid.offsets[subCell + 1]) {
+                        continue;
+                    }
+                    // the objects reach up to the max width/height past their sub-cell, 
+                    // and the outer sub-cells also hold the corners clamped to the sub-grid
+                    double xStart = (i == 0) ? -inf : subGrid.xMin + i * subGrid.cellExtentX;
+                    double yStart = (j == 0) ? -inf : subGrid.yMin + j * subGrid.cellExtentY;
+                    double xEnd = (i == subGrid.cellsPerDim - 1) ? inf : subGrid.xMin + (i + 1) * subGrid.cellExtentX + subGrid.maxWidth;
+                    double yEnd = (j == subGrid.cellsPerDim - 1) ? inf : subGrid.yMin + (j + 1) * subGrid.cellExtentY + subGrid.maxHeight;
+                    subCells.emplace_back(qPoint.distanceToPartition(xStart, yStart, xEnd, yEnd), subCell);
+                }
+            }
+            std::sort(subCells.begin(), subCells.end());
+            ObjectList* contents = cell->getContents();
+            for (auto &[distanceToSubCell, subCell] : subCells) {
+                if (!queryResult->checkDistance(distanceToSubCell)) {
+                    // the rest of the sub-cells are even farther
+                    break;
+                }
+                for (uint32_t pos = subGrid.offsets[subCell]; pos < subGrid.offsets[subCell + 1]; pos++) {
+                    Shape* obj = (*contents)[pos];
+                    queryResult->addResult(obj->recID, obj->distance(qPoint));
+                }
+            }
+        }
+
         DB_STATUS evaluate(hec::KNNQuery *knnQuery, std::unique_ptr<hec::QResultBase>& queryResult) {
             Shape qPoint;
             Dataset* dataset = g_config.datasetOptions.getDatasetByIdx(knnQuery->getDatasetID());
@@ -29,22 +65,36 @@ namespace uniform_grid
                 int jFine = partition->partitionID / g_config.partitioningMethod->getGlobalPPD(); 
                 double xFineStart = g_config.datasetOptions.dataspaceMetadata.xMinGlobal + iFine * g_config.partitioningMethod->getPartPartionExtentX();
                 double yFineStart = g_config.datasetOptions.dataspaceMetadata.yMinGlobal + jFine * g_config.partitioningMethod->getPartPartionExtentY();
-                double xFineEnd = xFineStart + g_config.partitioningMethod->getDistPartionExtentX();
-                double yFineEnd = yFineStart + g_config.partitioningMethod->getDistPartionExtentY();                
-                // calculate query point distance to fine partition
+                double xFineEnd = xFineStart + g_config.partitioningMethod->getPartPartionExtentX();
+                double yFineEnd = yFineStart + g_config.partitioningMethod->getPartPartionExtentY();
+                // calculate query point distance to fine partition, or to its contents if their bounds are known (tighter)
                 double distanceToPartition = qPoint.distanceToPartition(xFineStart, yFineStart, xFineEnd, yFineEnd);
+                MBR contentBounds;
+                if (partition->getContentBounds(contentBounds)) {
+                    if (contentBounds.pMin.x > contentBounds.pMax.x) {
+                        // empty partition
+                        continue;
+                    }
+                    distanceToPartition = qPoint.distanceToPartition(contentBounds.pMin.x, contentBounds.pMin.y, contentBounds.pMax.x, contentBounds.pMax.y);
+                }
                 // if the distance to partition is larger than the current max in heap, skip this partition entirely
                 if (!queryResult->checkDistance(distanceToPartition)) {
                     continue;
                 }
     
                 // get partition contents
-                std::vector<Shape *>* contents = partition->getContents();
+                ObjectList* contents = partition->getContents();
                 if (contents == nullptr) {
                     continue;
                 }
+                PartitionUniformGrid* cell = dynamic_cast<PartitionUniformGrid*>(partition);
+                if (cell != nullptr && !cell->subGrid.empty() && cell->getMBRs() != nullptr) {
+                    // overloaded cell, descend into its sub-grid
+                    evaluateSubGrid(qPoint, cell, queryResult);
+                    continue;
+                }
                 // loop contents
-                for (auto &obj: *contents) {
+                for (Shape* obj: *contents) {
                     double distance = obj->distance(qPoint);
                     // add result (the heap handles insertions automatically)
                     queryResult->addResult(obj->recID, distance);
@@ -1,5 +1,6 @@
 #include "UniformGrid/filter.h"
 #include "refinement/topology.h"
+#include "APRIL/filter.h"
 #include "env/partitioning.h"
 
 #include <omp.h>
@@ -11,8 +12,12 @@ namespace uniform_grid
     {
         static inline DB_STATUS forwardPair(Shape* objR, Shape* objS, hec::QResultBase* queryResult) {
             DB_STATUS ret = DBERR_OK;
+            if (!objR->aprilData.intervalsALL.empty()) {
+                // APRIL intermediate filter (the window holds APRIL), refines only the inconclusive
+                return APRIL::standard::RangeFilterEntrypoint(objR, objS, queryResult);
+            }
             // forward to refinement
-            ret = refinement::relate::refinementEntrypoint(objR, objS, g_config.queryPipeline.queryType, queryResult);
+            ret = refinement::relate::refinementEntrypoint(objR, objS, hec::Q_RANGE, queryResult);
             if (ret != DBERR_OK) {
                 logger::log_error(ret, "Refinement failed.");
                 return ret;
@@ -20,7 +25,7 @@ namespace uniform_grid
             return ret;
         }
     
-        /** @brief Evaluates the contents of the given partition against the provided window. All objects are geometrically refined, 
+        /** @brief Evaluates the contents of the given partition against the provided window. All objects whose MBR intersects the window MBR are geometrically refined, 
          * thus, this method should be used only for partitions that are partially covered by the window in both axes.
          */
         static DB_STATUS comparePartialPartition(Shape &window, PartitionBase* partition, hec::QResultBase* queryResult) {
@@ -30,13 +35,27 @@ namespace uniform_grid
                 return ret;
             }
             // get partition contents
-            std::vector<Shape *>* contents = partition->getContents();
+            ObjectList* contents = partition->getContents();
             if (contents == nullptr) {
                 // empty partition
                 return ret;
             }
+            if (partition->getMBRs() != nullptr) {
+                // refine only the objects whose MBR intersects the window's MBR (descends into the cell's sub-grid, if any)
+                std::vector<uint32_t> candidates;
+                PartitionUniformGrid* cell = dynamic_cast<PartitionUniformGrid*>(partition);
+                cell->intersecting(window.mbr.pMin.x, window.mbr.pMin.y, window.mbr.pMax.x, window.mbr.pMax.y, candidates);
+                for (auto &pos : candidates) {
+                    ret = forwardPair(&window, (*contents)[pos], queryResult);
+                    if (ret != DBERR_OK) {
+                        logger::log_error(ret, "Evaluation failed for window and object with id", (*contents)[pos]->recID);
+                        return ret;
+                    }
+                }
+                return ret;
+            }
             // loop contents
-            for (auto &it: *contents) {
+            for (Shape* it: *contents) {
                 // all contents need to be refined
                 ret = forwardPair(&window, it, queryResult);
                 if (ret != DBERR_OK) {
@@ -63,11 +82,16 @@ namespace uniform_grid
             }
             window.setMBR();
             
-            // get cells range
-            int partitionMinX = std::floor((window.mbr.pMin.x - g_config.datasetOptions.dataspaceMetadata.xMinGlobal) / g_config.partitioningMethod->getPartPartionExtentX());
-            int partitionMinY = std::floor((window.mbr.pMin.y - g_config.datasetOptions.dataspaceMetadata.yMinGlobal) / g_config.partitioningMethod->getPartPartionExtentY());
-            int partitionMaxX = std::floor((window.mbr.pMax.x - g_config.datasetOptions.dataspaceMetadata.xMinGlobal) / g_config.partitioningMethod->getPartPartionExtentX());
-            int partitionMaxY = std::floor((window.mbr.pMax.y - g_config.datasetOptions.dataspaceMetadata.yMinGlobal) / g_config.partitioningMethod->getPartPartionExtentY());
+            // get cells range (clamped to the dataspace, the partition IDs of cells outside it belong to other cells)
+            int globalPPD = g_config.partitioningMethod->getGlobalPPD();
+            int partitionMinX = std::max(0, (int) std::floor((window.mbr.pMin.x - g_config.datasetOptions.dataspaceMetadata.xMinGlobal) / g_config.partitioningMethod->getPartPartionExtentX()));
+            int partitionMinY = std::max(0, (int) std::floor((window.mbr.pMin.y - g_config.datasetOptions.dataspaceMetadata.yMinGlobal) / g_config.partitioningMethod->getPartPartionExtentY()));
+            int partitionMaxX = std::min(globalPPD - 1, (int) std::floor((window.mbr.pMax.x - g_config.datasetOptions.dataspaceMetadata.xMinGlobal) / g_config.partitioningMethod->getPartPartionExtentX()));
+            int partitionMaxY = std::min(globalPPD - 1, (int) std::floor((window.mbr.pMax.y - g_config.datasetOptions.dataspaceMetadata.yMinGlobal) / g_config.partitioningMethod->getPartPartionExtentY()));
+            if (partitionMinX > partitionMaxX || partitionMinY > partitionMaxY) {
+                // the window lies outside the dataspace
+                return ret;
+            }
             
             int partitionID = -1;
             PartitionBase* partition = nullptr;
@@ -145,26 +169,22 @@ namespace uniform_grid
                         return ret;
                     }
                 }
-                // keep all the rest of the partitions' contents directly
+                // keep all the rest of the partitions' contents directly (counts add the partition's size at once)
                 for (int i=partitionMinX+1; i<partitionMaxX; i++) {
                     for (int j=partitionMinY+1; j<partitionMaxY; j++) {
-                        partitionID = g_config.partitioningMethod->getPartitionID(partitionMaxX, j, g_config.partitioningMethod->getGlobalPPD());
+                        partitionID = g_config.partitioningMethod->getPartitionID(i, j, g_config.partitioningMethod->getGlobalPPD());
                         partition = dataset->index->getPartition(partitionID);
                         if (partition == nullptr) {
                             // not assigned partition
-                            return ret;
+                            continue;
                         }
                         // get partition contents
-                        std::vector<Shape *>* contents = partition->getContents();
+                        ObjectList* contents = partition->getContents();
                         if (contents == nullptr) {
                             // empty partition
-                            return ret;
-                        }
-                        // loop contents
-                        for (auto &it: *contents) {
-                            // keep contents directly
-                            queryResult->addResult(it->recID);
+                            continue;
                         }
+                        qresult_factory::addAll(*contents, queryResult);
                     }     
                 }
             }
@@ -187,6 +207,11 @@ namespace uniform_grid
                 return DBERR_INVALID_GEOMETRY;
             }
             window.setMBR();
+            // rasterize the window once for the APRIL filter of its candidates (non-point datasets)
+            ret = APRIL::standard::createWindowAPRIL(dataset, &window);
+            if (ret != DBERR_OK) {
+                return ret;
+            }
             
             // get cells range
             int partitionMinX = std::floor((window.mbr.pMin.x - g_config.datasetOptions.dataspaceMetadata.xMinGlobal) / g_config.partitioningMethod->getPartPartionExtentX());
@@ -194,32 +219,27 @@ namespace uniform_grid
             int partitionMaxX = std::floor((window.mbr.pMax.x - g_config.datasetOptions.dataspaceMetadata.xMinGlobal) / g_config.partitioningMethod->getPartPartionExtentX());
             int partitionMaxY = std::floor((window.mbr.pMax.y - g_config.datasetOptions.dataspaceMetadata.yMinGlobal) / g_config.partitioningMethod->getPartPartionExtentY());
             
+            // clamp to the grid, so that the rows don't wrap around
+            partitionMinX = std::max(0, partitionMinX);
+            partitionMinY = std::max(0, partitionMinY);
+            partitionMaxX = std::min(g_config.partitioningMethod->getGlobalPPD() - 1, partitionMaxX);
+            partitionMaxY = std::min(g_config.partitioningMethod->getGlobalPPD() - 1, partitionMaxY);
+            
             // loop partitions
             int partitionID = -1;
             PartitionBase* partition = nullptr;
-            for (int i=partitionMinX; i<=partitionMaxX; i++) {
-                for (int j=partitionMinY; j<=partitionMaxY; j++) {
+            for (int j=partitionMinY; j<=partitionMaxY; j++) {
+                // the row's partition IDs are consecutive, visit only the existing ones
+                int rowFirst = g_config.partitioningMethod->getPartitionID(partitionMinX, j, g_config.partitioningMethod->getGlobalPPD());
+                int rowLast = g_config.partitioningMethod->getPartitionID(partitionMaxX, j, g_config.partitioningMethod->getGlobalPPD()) + 1;
+                for (partitionID = dataset->index->nextPartitionID(rowFirst, rowLast); partitionID < rowLast; partitionID = dataset->index->nextPartitionID(partitionID + 1, rowLast)) {
                     // get partition
-                    partitionID = g_config.partitioningMethod->getPartitionID(i, j, g_config.partitioningMethod->getGlobalPPD());
                     partition = dataset->index->getPartition(partitionID);
-                    if (partition == nullptr) {
-                        continue;
-                    }
-                    
-                    // get partition contents
-                    std::vector<Shape *>* contents = partition->getContents();
-                    if (contents == nullptr) {
-                        continue;
-                    }
-    
-                    // loop contents
-                    for (auto &it: *contents) {
-                        // contents->at(i)->printGeometry();
-                        ret = forwardPair(&window, it, queryResult);
-                        if (ret != DBERR_OK) {
-                            logger::log_error(ret, "Evaluation failed for window and object with id", it->recID);
-                            return ret;
-                        }
+                    // refine the objects whose MBR intersects the window's MBR
+                    ret = comparePartialPartition(window, partition, queryResult);
+                    if (ret != DBERR_OK) {
+                        logger::log_error(ret, "Query evaluation failed for polygon query. Partition ID:", partitionID);
+                        return ret;
                     }
                 }
             }
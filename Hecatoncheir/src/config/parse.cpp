@@ -72,6 +72,20 @@ namespace parser
         return DBERR_INVALID_PARAMETER;
     }
 
+    static DB_STATUS resultDeliveryTypeStrToInt(std::string &str, int &resultDelivery) {
+        if (str == "HOST") {
+            resultDelivery = RD_HOST;
+            return DBERR_OK;
+        } else if (str == "TREE") {
+            resultDelivery = RD_TREE;
+            return DBERR_OK;
+        } else if (str == "DIRECT") {
+            resultDelivery = RD_DIRECT;
+            return DBERR_OK;
+        }
+        return DBERR_INVALID_PARAMETER;
+    }
+
     static DB_STATUS loadAPRILconfig() {
         ApproximationMetadata approxMetadata(AT_APRIL);
         int N = system_config_pt.get<int>("APRIL.N");
@@ -180,6 +194,14 @@ namespace parser
             return DBERR_INVALID_PARAMETER;
         }
 
+        // batch size in bytes (0 = use the object count instead)
+        size_t batchBytes = system_config_pt.get<size_t>("Partitioning.batchBytes", DEFAULT_BATCH_BYTES);
+        if (batchBytes > 0 && (batchBytes < BATCH_MIN_BYTES || batchBytes > BATCH_MAX_BYTES)) {
+            logger::log_error(DBERR_INVALID_PARAMETER, "Batch bytes must be 0 or in the range", BATCH_MIN_BYTES, "-", BATCH_MAX_BYTES, ". Batch bytes:", batchBytes);
+            return DBERR_INVALID_PARAMETER;
+        }
+        bool adaptiveBatching = system_config_pt.get<int>("Partitioning.adaptiveBatching", 0);
+
         // partitioning type
         std::string partitioningTypeStr = system_config_pt.get<std::string>("Partitioning.type");
         PartitioningType partitioningType;
@@ -214,6 +236,9 @@ namespace parser
             g_config.partitioningMethod = new TwoGridPartitioning(partitioningType, batchSize, dgppdNum, ppdNum);
         }
 
+        g_config.partitioningMethod->batchBytes = batchBytes;
+        g_config.partitioningMethod->adaptiveBatching = adaptiveBatching;
+
         // node assignment to cells
         std::string assignmentFuncStr = system_config_pt.get<std::string>("Partitioning.assignmentFunc");
         if (assignmentFuncStr == "OP") {
@@ -407,6 +432,35 @@ namespace parser
             logger::log_error(DBERR_CONFIG_FILE, "Refinement setting in configuration file must be 0 or 1");
             return DBERR_CONFIG_FILE;
         }
+        g_config.queryPipeline.adaptiveSweep = system_config_pt.get<int>("Pipeline.adaptiveSweep", 1);
+        if (g_config.queryPipeline.adaptiveSweep != 0 && g_config.queryPipeline.adaptiveSweep != 1) {
+            logger::log_error(DBERR_CONFIG_FILE, "adaptiveSweep setting in configuration file must be 0 or 1");
+            return DBERR_CONFIG_FILE;
+        }
+        g_config.queryPipeline.rangeCacheEntries = system_config_pt.get<int>("Pipeline.rangeCache", DEFAULT_RANGE_CACHE_ENTRIES);
+        if (g_config.queryPipeline.rangeCacheEntries < 0) {
+            logger::log_error(DBERR_CONFIG_FILE, "rangeCache setting in configuration file must not be negative");
+            return DBERR_CONFIG_FILE;
+        }
+        std::string resultDeliveryStr = system_config_pt.get<std::string>("Pipeline.resultDelivery", "HOST");
+        int resultDelivery;
+        if (resultDeliveryTypeStrToInt(resultDeliveryStr, resultDelivery) != DBERR_OK) {
+            logger::log_error(DBERR_CONFIG_FILE, "Unknown result delivery setting in configuration file:", resultDeliveryStr);
+            return DBERR_CONFIG_FILE;
+        }
+        g_config.queryPipeline.resultDelivery = (ResultDeliveryType) resultDelivery;
+        // load dataset residency limits
+        g_config.datasetOptions.maxResidentDatasets = system_config_pt.get<int>("Datasets.maxResident", DEFAULT_MAX_RESIDENT_DATASETS);
+        if (g_config.datasetOptions.maxResidentDatasets < 1) {
+            logger::log_error(DBERR_CONFIG_FILE, "maxResident setting in configuration file must be at least 1");
+            return DBERR_CONFIG_FILE;
+        }
+        int residentMemoryMB = system_config_pt.get<int>("Datasets.residentMemoryMB", 0);
+        if (residentMemoryMB < 0) {
+            logger::log_error(DBERR_CONFIG_FILE, "residentMemoryMB setting in configuration file must be non-negative");
+            return DBERR_CONFIG_FILE;
+        }
+        g_config.datasetOptions.residentMemoryBudget = (size_t) residentMemoryMB * 1024 * 1024;
         // set to configuration
         g_config.options.nodeCount = sysOpsStmt.nodeCount;
         g_config.options.nodefilePath = sysOpsStmt.nodefilePath;
@@ -1,9 +1,15 @@
 #include "containers.h"
 
+#if defined(__AVX512F__) || defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
 #include "APRIL/generate.h"
+#include "APRIL/filter.h"
 
 #include "TwoLayer/filter.h"
 #include "UniformGrid/filter.h"
+#include "RTree/filter.h"
 
 /* CONFIGURATION */
 
@@ -116,20 +122,580 @@ int AprilConfig::getCellsPerDim() {
     return cellsPerDim;
 }
 
-std::vector<Shape*>* PartitionTwoLayer::getContents(TwoLayerClass classType) {
+void MBRArrays::build(const ObjectList &objects) {
+    xMin.resize(objects.size());
+    yMin.resize(objects.size());
+    xMax.resize(objects.size());
+    yMax.resize(objects.size());
+    boundXMin = std::numeric_limits<double>::infinity();
+    boundYMin = std::numeric_limits<double>::infinity();
+    boundXMax = -std::numeric_limits<double>::infinity();
+    boundYMax = -std::numeric_limits<double>::infinity();
+    sumXMin = sumYMin = sumXMax = sumYMax = 0;
+    sortedOnY = true;
+    for (size_t i=0; i<objects.size(); i++) {
+        xMin[i] = objects[i]->mbr.pMin.x;
+        yMin[i] = objects[i]->mbr.pMin.y;
+        xMax[i] = objects[i]->mbr.pMax.x;
+        yMax[i] = objects[i]->mbr.pMax.y;
+        boundXMin = std::min(boundXMin, xMin[i]);
+        boundYMin = std::min(boundYMin, yMin[i]);
+        boundXMax = std::max(boundXMax, xMax[i]);
+        boundYMax = std::max(boundYMax, yMax[i]);
+        sumXMin += xMin[i];
+        sumYMin += yMin[i];
+        sumXMax += xMax[i];
+        sumYMax += yMax[i];
+        sortedOnY = sortedOnY && (i == 0 || yMin[i-1] <= yMin[i]);
+    }
+}
+
+void MBRArrays::clear() {
+    xMin.clear();
+    yMin.clear();
+    xMax.clear();
+    yMax.clear();
+    boundXMin = std::numeric_limits<double>::infinity();
+    boundYMin = std::numeric_limits<double>::infinity();
+    boundXMax = -std::numeric_limits<double>::infinity();
+    boundYMax = -std::numeric_limits<double>::infinity();
+    sumXMin = sumYMin = sumXMax = sumYMax = 0;
+    sortedOnY = true;
+}
+
+/** @brief Sets bounds to the union MBR of the arrays' union MBRs. */
+static inline void setUnionBounds(const MBRArrays &mbrs, MBR &bounds) {
+    bounds.pMin.x = std::min(bounds.pMin.x, mbrs.boundXMin);
+    bounds.pMin.y = std::min(bounds.pMin.y, mbrs.boundYMin);
+    bounds.pMax.x = std::max(bounds.pMax.x, mbrs.boundXMax);
+    bounds.pMax.y = std::max(bounds.pMax.y, mbrs.boundYMax);
+}
+
+/** @brief Appends the positions of the set bits of mask, offset by base. */
+static inline void appendMaskPositions(unsigned int mask, size_t base, std::vector<uint32_t> &positions) {
+    while (mask) {
+        positions.push_back(base + __builtin_ctz(mask));
+        mask &= mask - 1;
+    }
+}
+
+void MBRArrays::intersecting(double boxXMin, double boxYMin, double boxXMax, double boxYMax, std::vector<uint32_t> &positions) const {
+    if (!boundIntersects(boxXMin, boxYMin, boxXMax, boxYMax)) {
+        return;
+    }
+    intersecting(0, size(), boxXMin, boxYMin, boxXMax, boxYMax, positions);
+}
+
+void MBRArrays::intersecting(size_t first, size_t last, double boxXMin, double boxYMin, double boxXMax, double boxYMax, std::vector<uint32_t> &positions) const {
+    size_t count = last;
+    size_t i = first;
+    // the comparisons are the negations of the disjointness tests, so that they match the scalar loop exactly
+#if defined(__AVX512F__)
+    const __m512d bXMin = _mm512_set1_pd(boxXMin);
+    const __m512d bYMin = _mm512_set1_pd(boxYMin);
+    const __m512d bXMax = _mm512_set1_pd(boxXMax);
+    const __m512d bYMax = _mm512_set1_pd(boxYMax);
+    for (; i+8<=count; i+=8) {
+        __mmask8 mask = _mm512_cmp_pd_mask(_mm512_loadu_pd(&xMax[i]), bXMin, _CMP_NLT_UQ);
+        mask = _mm512_mask_cmp_pd_mask(mask, _mm512_loadu_pd(&xMin[i]), bXMax, _CMP_NGT_UQ);
+        mask = _mm512_mask_cmp_pd_mask(mask, _mm512_loadu_pd(&yMax[i]), bYMin, _CMP_NLT_UQ);
+        mask = _mm512_mask_cmp_pd_mask(mask, _mm512_loadu_pd(&yMin[i]), bYMax, _CMP_NGT_UQ);
+        appendMaskPositions(mask, i, positions);
+    }
+#elif defined(__AVX2__)
+    const __m256d bXMin = _mm256_set1_pd(boxXMin);
+    const __m256d bYMin = _mm256_set1_pd(boxYMin);
+    const __m256d bXMax = _mm256_set1_pd(boxXMax);
+    const __m256d bYMax = _mm256_set1_pd(boxYMax);
+    for (; i+4<=count; i+=4) {
+        __m256d pass = _mm256_cmp_pd(_mm256_loadu_pd(&xMax[i]), bXMin, _CMP_NLT_UQ);
+        pass = _mm256_and_pd(pass, _mm256_cmp_pd(_mm256_loadu_pd(&xMin[i]), bXMax, _CMP_NGT_UQ));
+        pass = _mm256_and_pd(pass, _mm256_cmp_pd(_mm256_loadu_pd(&yMax[i]), bYMin, _CMP_NLT_UQ));
+        pass = _mm256_and_pd(pass, _mm256_cmp_pd(_mm256_loadu_pd(&yMin[i]), bYMax, _CMP_NGT_UQ));
+        appendMaskPositions(_mm256_movemask_pd(pass), i, positions);
+    }
+#endif
+    // scalar (remainder)
+    for (; i<count; i++) {
+        if (xMax[i] < boxXMin || xMin[i] > boxXMax || yMax[i] < boxYMin || yMin[i] > boxYMax) {
+            continue;
+        }
+        positions.push_back(i);
+    }
+}
+
+/** @brief The plane sweep over arrays sorted on key: appends the positions from first whose side extent [sideMin, sideMax] 
+ * overlaps [boxSideMin, boxSideMax], up to the first position with key above boxKeyMax. */
+static inline void sweepSorted(const double* key, const double* sideMin, const double* sideMax, size_t count, size_t first, double boxSideMin, double boxSideMax, double boxKeyMax, std::vector<uint32_t> &positions) {
+    size_t i = first;
+#if defined(__AVX512F__)
+    const __m512d bSideMin = _mm512_set1_pd(boxSideMin);
+    const __m512d bSideMax = _mm512_set1_pd(boxSideMax);
+    const __m512d bKeyMax = _mm512_set1_pd(boxKeyMax);
+    for (; i+8<=count; i+=8) {
+        __mmask8 stop = _mm512_cmp_pd_mask(_mm512_loadu_pd(&key[i]), bKeyMax, _CMP_NLE_UQ);
+        __mmask8 mask = _mm512_cmp_pd_mask(_mm512_loadu_pd(&sideMax[i]), bSideMin, _CMP_NLT_UQ);
+        mask = _mm512_mask_cmp_pd_mask(mask, _mm512_loadu_pd(&sideMin[i]), bSideMax, _CMP_NGT_UQ);
+        if (stop) {
+            // keep only the positions before the first one past the sweep line
+            appendMaskPositions(mask & ((stop & -stop) - 1), i, positions);
+            return;
+        }
+        appendMaskPositions(mask, i, positions);
+    }
+#elif defined(__AVX2__)
+    const __m256d bSideMin = _mm256_set1_pd(boxSideMin);
+    const __m256d bSideMax = _mm256_set1_pd(boxSideMax);
+    const __m256d bKeyMax = _mm256_set1_pd(boxKeyMax);
+    for (; i+4<=count; i+=4) {
+        unsigned int stop = _mm256_movemask_pd(_mm256_cmp_pd(_mm256_loadu_pd(&key[i]), bKeyMax, _CMP_NLE_UQ));
+        __m256d pass = _mm256_cmp_pd(_mm256_loadu_pd(&sideMax[i]), bSideMin, _CMP_NLT_UQ);
+        pass = _mm256_and_pd(pass, _mm256_cmp_pd(_mm256_loadu_pd(&sideMin[i]), bSideMax, _CMP_NGT_UQ));
+        unsigned int mask = _mm256_movemask_pd(pass);
+        if (stop) {
+            // keep only the positions before the first one past the sweep line
+            appendMaskPositions(mask & ((stop & -stop) - 1), i, positions);
+            return;
+        }
+        appendMaskPositions(mask, i, positions);
+    }
+#endif
+    // scalar (remainder)
+    for (; i<count; i++) {
+        if (!(key[i] <= boxKeyMax)) {
+            return;
+        }
+        if (sideMax[i] < boxSideMin || sideMin[i] > boxSideMax) {
+            continue;
+        }
+        positions.push_back(i);
+    }
+}
+
+void MBRArrays::sweep(size_t first, double boxXMin, double boxXMax, double boxYMax, std::vector<uint32_t> &positions) const {
+    sweepSorted(yMin.data(), xMin.data(), xMax.data(), size(), first, boxXMin, boxXMax, boxYMax, positions);
+}
+
+void MBRArrays::sweepX(size_t first, double boxYMin, double boxYMax, double boxXMax, std::vector<uint32_t> &positions) const {
+    sweepSorted(xMin.data(), yMin.data(), yMax.data(), size(), first, boxYMin, boxYMax, boxXMax, positions);
+}
+
+/** @brief Returns the fraction of the span covered by the extent, in [0,1]. */
+static inline double spanFraction(double extent, double span) {
+    if (!(span > 0)) {
+        return 1;
+    }
+    return std::min(1.0, std::max(0.0, extent / span));
+}
+
+bool MBRArrays::preferSweepOnX(const MBRArrays &other, bool otherCrossesLeft) const {
+    if (size() == 0 || other.size() == 0) {
+        return false;
+    }
+    double spanY = std::max(boundYMax, other.boundYMax) - std::min(boundYMin, other.boundYMin);
+    double costY = spanFraction((sumYMax - sumYMin) / size() + (other.sumYMax - other.sumYMin) / other.size(), spanY);
+    double costX;
+    if (otherCrossesLeft) {
+        // the ones of these starting left of the other MBRs' right side, on average
+        costX = spanFraction(other.sumXMax / other.size() - boundXMin, boundXMax - boundXMin);
+    } else {
+        double spanX = std::max(boundXMax, other.boundXMax) - std::min(boundXMin, other.boundXMin);
+        costX = spanFraction((sumXMax - sumXMin) / size() + (other.sumXMax - other.sumXMin) / other.size(), spanX);
+    }
+    return costX < costY;
+}
+
+DB_STATUS PartitionDelta::remove(const ObjectList &contents, ObjectHandle handle, bool sortedOnY) {
+    // not merged yet
+    auto it = std::find(inserted.begin(), inserted.end(), handle);
+    if (it != inserted.end()) {
+        *it = inserted.back();
+        inserted.pop_back();
+        return DBERR_OK;
+    }
+    // find its position in the contents
+    Shape* objectRef = contents.store->get(handle);
+    size_t position = 0;
+    if (sortedOnY) {
+        position = std::lower_bound(contents.begin(), contents.end(), objectRef->mbr.pMin.y, [](const Shape* a, double y) {
+            return a->mbr.pMin.y < y;
+        }) - contents.begin();
+    }
+    for (; position<contents.size(); position++) {
+        if (sortedOnY && contents[position]->mbr.pMin.y > objectRef->mbr.pMin.y) {
+            break;
+        }
+        if (contents.handles[position] == handle && !isRemoved(position)) {
+            if ((position >> 6) >= tombstones.size()) {
+                tombstones.resize((position >> 6) + 1, 0);
+            }
+            tombstones[position >> 6] |= (uint64_t) 1 << (position & 63);
+            removedCount++;
+            return DBERR_OK;
+        }
+    }
+    logger::log_error(DBERR_INVALID_KEY, "Object", objectRef->recID, "is not in the partition.");
+    return DBERR_INVALID_KEY;
+}
+
+void PartitionDelta::merge(ObjectList &contents, bool sortedOnY) {
+    // drop the removed objects
+    if (removedCount > 0) {
+        size_t kept = 0;
+        for (size_t i=0; i<contents.size(); i++) {
+            if (!isRemoved(i)) {
+                contents.handles[kept++] = contents.handles[i];
+            }
+        }
+        contents.resize(kept);
+    }
+    // append the inserted objects
+    size_t mergedCount = contents.size();
+    contents.handles.insert(contents.handles.end(), inserted.begin(), inserted.end());
+    if (sortedOnY) {
+        auto compareByY = [](const Shape* a, const Shape* b) {
+            return a->mbr.pMin.y < b->mbr.pMin.y;
+        };
+        contents.sort(compareByY, mergedCount);
+        contents.inplaceMerge(mergedCount, compareByY);
+    }
+    clear();
+}
+
+void PartitionDelta::clear() {
+    inserted.clear();
+    tombstones.clear();
+    removedCount = 0;
+}
+
+ObjectList* PartitionTwoLayer::getContents(TwoLayerClass classType) {
     return &classIndex[classType];
 }
 
-void PartitionTwoLayer::addObject(Shape *objectRef, TwoLayerClass classType) {
-    classIndex[classType].push_back(objectRef);
+void PartitionTwoLayer::addObject(ObjectHandle handle, TwoLayerClass classType) {
+    classIndex[classType].push_back(handle);
+}
+
+MBRArrays* PartitionTwoLayer::getMBRs(TwoLayerClass classType) {
+    if (classMBRs[classType].size() != classIndex[classType].size()) {
+        // not built, or stale
+        return nullptr;
+    }
+    return &classMBRs[classType];
+}
+
+void PartitionTwoLayer::buildMBRs() {
+    for (int i=CLASS_A; i<=CLASS_D; i++) {
+        classMBRs[i].build(classIndex[i]);
+    }
+    buildXOrder();
+}
+
+void PartitionTwoLayer::buildXOrder() {
+    if (!g_config.queryPipeline.adaptiveSweep) {
+        classIndexX.clear();
+        classMBRsX.clear();
+        return;
+    }
+    classIndexX = classIndex[CLASS_A];
+    classIndexX.stableSort([](const Shape* a, const Shape* b) {
+        return a->mbr.pMin.x < b->mbr.pMin.x;
+    });
+    classMBRsX.build(classIndexX);
+}
+
+ObjectList* PartitionTwoLayer::getContentsSortedOnX() {
+    if (classIndexX.size() != classIndex[CLASS_A].size() || classMBRsX.size() != classIndexX.size()) {
+        // not built, or stale
+        return nullptr;
+    }
+    return &classIndexX;
+}
+
+MBRArrays* PartitionTwoLayer::getMBRsSortedOnX() {
+    if (getContentsSortedOnX() == nullptr) {
+        return nullptr;
+    }
+    return &classMBRsX;
+}
+
+bool PartitionBase::contentBoundsIntersect(PartitionBase* other) {
+    MBR bounds, otherBounds;
+    if (!this->getContentBounds(bounds) || !other->getContentBounds(otherBounds)) {
+        return true;
+    }
+    return !(bounds.pMin.x > otherBounds.pMax.x || bounds.pMax.x < otherBounds.pMin.x || bounds.pMin.y > otherBounds.pMax.y || bounds.pMax.y < otherBounds.pMin.y);
+}
+
+bool PartitionTwoLayer::getContentBounds(MBR &bounds) {
+    const double inf = std::numeric_limits<double>::infinity();
+    bounds.pMin = Point(inf, inf);
+    bounds.pMax = Point(-inf, -inf);
+    for (int i=CLASS_A; i<=CLASS_D; i++) {
+        if (getMBRs((TwoLayerClass) i) == nullptr) {
+            return false;
+        }
+        setUnionBounds(classMBRs[i], bounds);
+    }
+    return true;
+}
+
+DB_STATUS PartitionTwoLayer::insertObject(ObjectHandle handle, TwoLayerClass classType) {
+    classDelta[classType].inserted.push_back(handle);
+    return DBERR_OK;
+}
+
+DB_STATUS PartitionTwoLayer::removeObject(ObjectHandle handle, TwoLayerClass classType) {
+    return classDelta[classType].remove(classIndex[classType], handle, classType == CLASS_A || classType == CLASS_C);
+}
+
+size_t PartitionTwoLayer::pendingUpdates() {
+    size_t pending = 0;
+    for (auto &it : classDelta) {
+        pending += it.pending();
+    }
+    return pending;
+}
+
+void PartitionTwoLayer::mergeUpdates() {
+    for (int i=CLASS_A; i<=CLASS_D; i++) {
+        if (classDelta[i].pending() > 0) {
+            classDelta[i].merge(classIndex[i], i == CLASS_A || i == CLASS_C);
+            classMBRs[i].build(classIndex[i]);
+            if (i == CLASS_A) {
+                buildXOrder();
+            }
+        }
+    }
+}
+
+void PartitionTwoLayer::measureMemory(hec::MemoryFootprint &footprint) const {
+    footprint.indexBytes += sizeof(PartitionTwoLayer);
+    for (int i=CLASS_A; i<=CLASS_D; i++) {
+        footprint.indexEntryCount += classIndex[i].size();
+        footprint.indexBytes += classIndex[i].capacity() * sizeof(ObjectHandle) + classDelta[i].memoryBytes();
+        footprint.mbrBytes += classMBRs[i].memoryBytes();
+    }
+    footprint.indexBytes += classIndexX.capacity() * sizeof(ObjectHandle);
+    footprint.mbrBytes += classMBRsX.memoryBytes();
+}
+
+ObjectList* PartitionUniformGrid::getContents(TwoLayerClass classType) {
+    return &classIndex;
+}
+
+void PartitionUniformGrid::addObject(ObjectHandle handle, TwoLayerClass classType) {
+    classIndex.push_back(handle);
+}
+
+MBRArrays* PartitionUniformGrid::getMBRs(TwoLayerClass classType) {
+    if (mbrs.size() != classIndex.size()) {
+        // not built, or stale
+        return nullptr;
+    }
+    return &mbrs;
+}
+
+void UGSubGrid::clear() {
+    cellsPerDim = 0;
+    maxWidth = 0;
+    maxHeight = 0;
+    offsets.clear();
+}
+
+void PartitionUniformGrid::buildMBRs() {
+    buildSubGrid();
+    mbrs.build(classIndex);
+}
+
+bool PartitionUniformGrid::getContentBounds(MBR &bounds) {
+    if (getMBRs() == nullptr) {
+        return false;
+    }
+    const double inf = std::numeric_limits<double>::infinity();
+    bounds.pMin = Point(inf, inf);
+    bounds.pMax = Point(-inf, -inf);
+    setUnionBounds(mbrs, bounds);
+    return true;
+}
+
+void PartitionUniformGrid::buildSubGrid() {
+    subGrid.clear();
+    if (classIndex.size() <= UG_SUBGRID_THRESHOLD) {
+        return;
+    }
+    PartitioningMethod* partitioning = g_config.partitioningMethod;
+    int iFine = partitionID % partitioning->getGlobalPPD();
+    int jFine = partitionID / partitioning->getGlobalPPD();
+    int cellsPerDim = std::ceil(std::sqrt((double) classIndex.size() / UG_SUBGRID_CELL_CAPACITY));
+    subGrid.cellsPerDim = std::min(cellsPerDim, UG_SUBGRID_MAX_CELLS_PER_DIM);
+    subGrid.xMin = g_config.datasetOptions.dataspaceMetadata.xMinGlobal + iFine * partitioning->getPartPartionExtentX();
+    subGrid.yMin = g_config.datasetOptions.dataspaceMetadata.yMinGlobal + jFine * partitioning->getPartPartionExtentY();
+    subGrid.cellExtentX = partitioning->getPartPartionExtentX() / subGrid.cellsPerDim;
+    subGrid.cellExtentY = partitioning->getPartPartionExtentY() / subGrid.cellsPerDim;
+    // count the objects per sub-cell
+    std::vector<uint32_t> subCells(classIndex.size());
+    subGrid.offsets.assign(subGrid.cellsPerDim * subGrid.cellsPerDim + 1, 0);
+    for (size_t i=0; i<classIndex.size(); i++) {
+        const MBR &mbr = classIndex[i]->mbr;
+        subGrid.maxWidth = std::max(subGrid.maxWidth, mbr.pMax.x - mbr.pMin.x);
+        subGrid.maxHeight = std::max(subGrid.maxHeight, mbr.pMax.y - mbr.pMin.y);
+        subCells[i] = subGrid.column(mbr.pMin.x) + subGrid.row(mbr.pMin.y) * subGrid.cellsPerDim;
+        subGrid.offsets[subCells[i] + 1]++;
+    }
+    for (size_t c=1; c<subGrid.offsets.size(); c++) {
+        subGrid.offsets[c] += subGrid.offsets[c-1];
+    }
+    // regroup the contents by sub-cell, keeping their relative order
+    std::vector<uint32_t> next(subGrid.offsets.begin(), subGrid.offsets.end() - 1);
+    std::vector<ObjectHandle> grouped(classIndex.size());
+    for (size_t i=0; i<classIndex.size(); i++) {
+        grouped[next[subCells[i]]++] = classIndex.handles[i];
+    }
+    classIndex.handles.swap(grouped);
+}
+
+void PartitionUniformGrid::intersecting(double boxXMin, double boxYMin, double boxXMax, double boxYMax, std::vector<uint32_t> &positions) const {
+    if (!mbrs.boundIntersects(boxXMin, boxYMin, boxXMax, boxYMax)) {
+        // no content reaches the box
+        return;
+    }
+    if (subGrid.empty()) {
+        mbrs.intersecting(boxXMin, boxYMin, boxXMax, boxYMax, positions);
+        return;
+    }
+    // objects whose corner lies up to the max width/height below the box may still reach it
+    int iMin = subGrid.column(boxXMin - subGrid.maxWidth);
+    int iMax = subGrid.column(boxXMax);
+    int jMin = subGrid.row(boxYMin - subGrid.maxHeight);
+    int jMax = subGrid.row(boxYMax);
+    for (int j=jMin; j<=jMax; j++) {
+        // the row's sub-cells in the range are consecutive in the contents
+        size_t first = subGrid.offsets[iMin + j * subGrid.cellsPerDim];
+        size_t last = subGrid.offsets[iMax + 1 + j * subGrid.cellsPerDim];
+        mbrs.intersecting(first, last, boxXMin, boxYMin, boxXMax, boxYMax, positions);
+    }
+}
+
+DB_STATUS PartitionUniformGrid::insertObject(ObjectHandle handle, TwoLayerClass classType) {
+    delta.inserted.push_back(handle);
+    return DBERR_OK;
+}
+
+DB_STATUS PartitionUniformGrid::removeObject(ObjectHandle handle, TwoLayerClass classType) {
+    return delta.remove(classIndex, handle, false);
+}
+
+size_t PartitionUniformGrid::pendingUpdates() {
+    return delta.pending();
 }
 
-std::vector<Shape*>* PartitionUniformGrid::getContents(TwoLayerClass classType) {
+void PartitionUniformGrid::mergeUpdates() {
+    if (delta.pending() > 0) {
+        delta.merge(classIndex, false);
+        buildMBRs();
+    }
+}
+
+void PartitionUniformGrid::measureMemory(hec::MemoryFootprint &footprint) const {
+    footprint.indexEntryCount += classIndex.size();
+    footprint.indexBytes += sizeof(PartitionUniformGrid) + classIndex.capacity() * sizeof(ObjectHandle) + delta.memoryBytes() + subGrid.offsets.capacity() * sizeof(uint32_t);
+    footprint.mbrBytes += mbrs.memoryBytes();
+}
+
+ObjectList* PartitionRTree::getContents(TwoLayerClass classType) {
     return &classIndex;
 }
 
-void PartitionUniformGrid::addObject(Shape *objectRef, TwoLayerClass classType) {
-    classIndex.push_back(objectRef);
+void PartitionRTree::addObject(ObjectHandle handle, TwoLayerClass classType) {
+    classIndex.push_back(handle);
+}
+
+/** @brief Sort-Tile-Recursive ordering of the entries in [first, last): 
+ * sorted on the x center into vertical slices, and each slice sorted on the y center, 
+ * so that every RTREE_NODE_CAPACITY consecutive entries form a node. */
+template <typename Iterator, typename CenterX, typename CenterY>
+static void orderSTR(Iterator first, Iterator last, CenterX centerX, CenterY centerY) {
+    size_t count = last - first;
+    size_t nodeCount = (count + RTREE_NODE_CAPACITY - 1) / RTREE_NODE_CAPACITY;
+    size_t sliceCount = std::ceil(std::sqrt((double) nodeCount));
+    size_t sliceSize = sliceCount * RTREE_NODE_CAPACITY;
+    std::sort(first, last, [&](const auto &a, const auto &b) { return centerX(a) < centerX(b); });
+    for (size_t i=0; i<count; i+=sliceSize) {
+        std::sort(first + i, first + std::min(i + sliceSize, count), [&](const auto &a, const auto &b) { return centerY(a) < centerY(b); });
+    }
+}
+
+void PartitionRTree::bulkLoad() {
+    nodes.clear();
+    levelOffsets.clear();
+    if (classIndex.empty()) {
+        return;
+    }
+    // leaves
+    const ObjectStore* store = classIndex.store;
+    orderSTR(classIndex.handles.begin(), classIndex.handles.end(), 
+        [store](ObjectHandle handle) { const Shape* obj = store->get(handle); return obj->mbr.pMin.x + obj->mbr.pMax.x; },
+        [store](ObjectHandle handle) { const Shape* obj = store->get(handle); return obj->mbr.pMin.y + obj->mbr.pMax.y; });
+    levelOffsets.push_back(0);
+    for (size_t i=0; i<classIndex.size(); i+=RTREE_NODE_CAPACITY) {
+        RTreeNode node{classIndex[i]->mbr.pMin.x, classIndex[i]->mbr.pMin.y, classIndex[i]->mbr.pMax.x, classIndex[i]->mbr.pMax.y, (uint32_t) i, 0, 0};
+        node.count = std::min((size_t) RTREE_NODE_CAPACITY, classIndex.size() - i);
+        for (size_t j=i; j<i+node.count; j++) {
+            node.xMin = std::min(node.xMin, classIndex[j]->mbr.pMin.x);
+            node.yMin = std::min(node.yMin, classIndex[j]->mbr.pMin.y);
+            node.xMax = std::max(node.xMax, classIndex[j]->mbr.pMax.x);
+            node.yMax = std::max(node.yMax, classIndex[j]->mbr.pMax.y);
+            if (rtree::referencePointInPartition(classIndex[j]->mbr.pMin.x, classIndex[j]->mbr.pMin.y, partitionID)) {
+                node.owned++;
+            }
+        }
+        nodes.push_back(node);
+    }
+    // upper levels, until a single root remains
+    size_t levelBegin = 0;
+    size_t levelEnd = nodes.size();
+    while (levelEnd - levelBegin > 1) {
+        orderSTR(nodes.begin() + levelBegin, nodes.begin() + levelEnd, 
+            [](const RTreeNode &node) { return node.xMin + node.xMax; },
+            [](const RTreeNode &node) { return node.yMin + node.yMax; });
+        levelOffsets.push_back(levelEnd);
+        for (size_t i=levelBegin; i<levelEnd; i+=RTREE_NODE_CAPACITY) {
+            RTreeNode parent = nodes[i];
+            parent.first = i;
+            parent.count = std::min((size_t) RTREE_NODE_CAPACITY, levelEnd - i);
+            for (size_t j=i+1; j<i+parent.count; j++) {
+                parent.xMin = std::min(parent.xMin, nodes[j].xMin);
+                parent.yMin = std::min(parent.yMin, nodes[j].yMin);
+                parent.xMax = std::max(parent.xMax, nodes[j].xMax);
+                parent.yMax = std::max(parent.yMax, nodes[j].yMax);
+                parent.owned += nodes[j].owned;
+            }
+            nodes.push_back(parent);
+        }
+        levelBegin = levelEnd;
+        levelEnd = nodes.size();
+    }
+    levelOffsets.push_back(nodes.size());
+}
+
+bool PartitionRTree::getContentBounds(MBR &bounds) {
+    const double inf = std::numeric_limits<double>::infinity();
+    bounds.pMin = Point(inf, inf);
+    bounds.pMax = Point(-inf, -inf);
+    if (nodes.empty()) {
+        // not loaded, unless there is nothing to load
+        return classIndex.empty();
+    }
+    const RTreeNode &root = nodes[getRoot()];
+    bounds.pMin = Point(root.xMin, root.yMin);
+    bounds.pMax = Point(root.xMax, root.yMax);
+    return true;
+}
+
+void PartitionRTree::measureMemory(hec::MemoryFootprint &footprint) const {
+    footprint.indexEntryCount += classIndex.size();
+    footprint.indexBytes += sizeof(PartitionRTree) + classIndex.capacity() * sizeof(ObjectHandle) + nodes.capacity() * sizeof(RTreeNode) + levelOffsets.capacity() * sizeof(uint32_t);
 }
 
 int DatasetMetadata::calculateBufferSize() {
@@ -253,6 +819,22 @@ Shape* Dataset::getObject(size_t recID) {
     return &objects[objectPosMap[recID]];
 }
 
+Shape* Dataset::findObject(size_t recID) {
+    // an inserted object replaces the stored one with the same ID
+    auto insertedIt = this->insertedObjectMap.find(recID);
+    if (insertedIt != this->insertedObjectMap.end()) {
+        return this->index->getObject(insertedIt->second);
+    }
+    if (this->removedObjectIDs.find(recID) != this->removedObjectIDs.end()) {
+        return nullptr;
+    }
+    auto posIt = this->objectPosMap.find(recID);
+    if (posIt == this->objectPosMap.end()) {
+        return nullptr;
+    }
+    return &this->objects[posIt->second];
+}
+
 DB_STATUS Dataset::storeObject(Shape &object) {
     // add object to the objects and map its pos
     objectPosMap[object.recID] = objects.size();
@@ -261,39 +843,83 @@ DB_STATUS Dataset::storeObject(Shape &object) {
     return DBERR_OK;
 }
 
-DB_STATUS Dataset::buildIndex(hec::IndexType indexType) {
+void Dataset::foldUpdates() {
+    if (!this->insertedObjects.empty() || !this->removedObjectIDs.empty()) {
+        // fold the updates of the previous index into the objects
+        std::vector<Shape> liveObjects;
+        liveObjects.reserve(this->objects.size() + this->insertedObjects.size());
+        for (auto &it : this->objects) {
+            if (this->removedObjectIDs.find(it.recID) == this->removedObjectIDs.end()) {
+                liveObjects.push_back(std::move(it));
+            }
+        }
+        // the inserted objects' handles follow the objects'
+        ObjectHandle handle = this->objects.size();
+        for (auto &it : this->insertedObjects) {
+            auto insertedIt = this->insertedObjectMap.find(it.recID);
+            if (insertedIt != this->insertedObjectMap.end() && insertedIt->second == handle) {
+                liveObjects.push_back(std::move(it));
+            }
+            handle++;
+        }
+        this->index.reset();
+        this->objects = std::move(liveObjects);
+        this->insertedObjects.clear();
+        this->insertedObjectMap.clear();
+        this->removedObjectIDs.clear();
+        this->objectPosMap.clear();
+        for (size_t i=0; i<this->objects.size(); i++) {
+            this->objectPosMap[this->objects[i].recID] = i;
+        }
+        this->totalObjects = this->objects.size();
+    }
+}
+
+DB_STATUS Dataset::buildIndex(hec::IndexType indexType, int threads) {
     DB_STATUS ret = DBERR_OK;
+    this->rangeCache.clear();
+    this->foldUpdates();
     switch (indexType) {
         case hec::IT_TWO_LAYER:
             /** non-point geometries */
             this->index = std::make_unique<TwoLayerIndex>();
+            this->index->setObjectStore(&this->objects, &this->insertedObjects);
             // add objects to index
-            for(auto &object : this->objects) {
-                ret = index->addObject(&object);
-                if (ret != DBERR_OK) {
-                    logger::log_error(ret, "Failed to add object", object.recID, "to index.");
-                    return ret;
-                }
+            ret = index->addObjects(threads);
+            if (ret != DBERR_OK) {
+                return ret;
             }
             // sort
-            this->index->sortPartitionsOnY();
+            this->index->sortPartitionsOnY(threads);
+            break;
+        case hec::IT_RTREE:
+            /** skewed non-point geometries */
+            this->index = std::make_unique<RTreeIndex>();
+            this->index->setObjectStore(&this->objects, &this->insertedObjects);
+            // add objects to index
+            ret = index->addObjects(threads);
+            if (ret != DBERR_OK) {
+                return ret;
+            }
+            // bulk load the trees
+            this->index->sortPartitionsOnY(threads);
             break;
         case hec::IT_UNIFORM_GRID:
             /** point geometries - no april */
             this->index = std::make_unique<UniformGridIndex>();
+            this->index->setObjectStore(&this->objects, &this->insertedObjects);
             // add objects to index
-            for(auto &object : this->objects) {
-                ret = index->addObject(&object);
-                if (ret != DBERR_OK) {
-                    logger::log_error(ret, "Failed to add object", object.recID, "to index.");
-                    return ret;
-                }
+            ret = index->addObjects(threads);
+            if (ret != DBERR_OK) {
+                return ret;
             }
             break;
         default:
             logger::log_error(DBERR_INVALID_INDEX_TYPE, "Invalid index type for build index.");
             return DBERR_INVALID_INDEX_TYPE;
     }
+    // MBR arrays for the filters, in the final order of the contents
+    this->index->buildMBRArrays(threads);
     return ret;
 }
 
@@ -310,8 +936,15 @@ DB_STATUS Dataset::buildAPRIL() {
     if (ret != DBERR_OK) {
         return ret;
     }
+    return this->createAPRIL();
+}
 
-    #pragma omp parallel num_threads(MAX_THREADS)
+DB_STATUS Dataset::createAPRIL(int threads) {
+    DB_STATUS ret = DBERR_OK;
+    if (this->metadata.dataType == DT_POINT) {
+        return DBERR_OK;
+    }
+    #pragma omp parallel num_threads(threads)
     {
         DB_STATUS local_ret = DBERR_OK;
         #pragma omp for
@@ -333,12 +966,267 @@ DB_STATUS Dataset::buildAPRIL() {
     return ret;
 }
 
+DB_STATUS Dataset::insertObject(Shape &object, bool buildAPRIL) {
+    if (this->index == nullptr) {
+        logger::log_error(DBERR_INVALID_OPERATION, "Objects can only be inserted after the index is built.");
+        return DBERR_INVALID_OPERATION;
+    }
+    if ((this->objectPosMap.find(object.recID) != this->objectPosMap.end() && this->removedObjectIDs.find(object.recID) == this->removedObjectIDs.end()) 
+        || this->insertedObjectMap.find(object.recID) != this->insertedObjectMap.end()) {
+        logger::log_error(DBERR_DUPLICATE_ENTRY, "Object", object.recID, "already exists.");
+        return DBERR_DUPLICATE_ENTRY;
+    }
+    if (this->objects.size() + this->insertedObjects.size() >= UINT32_MAX) {
+        logger::log_error(DBERR_OUT_OF_BOUNDS, "Too many objects for 32-bit object handles. Rebuild the index to drop the removed ones.");
+        return DBERR_OUT_OF_BOUNDS;
+    }
+    this->insertedObjects.push_back(object);
+    Shape* objectRef = &this->insertedObjects.back();
+    ObjectHandle handle = this->objects.size() + this->insertedObjects.size() - 1;
+    int partitionCount = 0;
+    DB_STATUS ret = this->index->insertObject(handle, partitionCount);
+    if (ret != DBERR_OK) {
+        logger::log_error(ret, "Failed to insert object", object.recID, "to index.");
+        return ret;
+    }
+    if (partitionCount == 0) {
+        // belongs to other nodes
+        this->insertedObjects.pop_back();
+        return DBERR_OK;
+    }
+    if (buildAPRIL && this->metadata.dataType != DT_POINT) {
+        ret = APRIL::generation::memory::createAPRILforObject(objectRef, this->metadata.dataType, this->aprilConfig, objectRef->aprilData);
+        if (ret != DBERR_OK) {
+            logger::log_error(ret, "Failed to create APRIL for object", object.recID);
+            return ret;
+        }
+    }
+    this->insertedObjectMap[object.recID] = handle;
+    this->totalObjects++;
+    this->rangeCache.clear();
+    return DBERR_OK;
+}
+
+DB_STATUS Dataset::removeObject(size_t recID) {
+    if (this->index == nullptr) {
+        logger::log_error(DBERR_INVALID_OPERATION, "Objects can only be removed after the index is built.");
+        return DBERR_INVALID_OPERATION;
+    }
+    ObjectHandle handle;
+    auto posIt = this->objectPosMap.find(recID);
+    auto insertedIt = this->insertedObjectMap.find(recID);
+    if (insertedIt != this->insertedObjectMap.end()) {
+        handle = insertedIt->second;
+    } else if (posIt != this->objectPosMap.end() && this->removedObjectIDs.find(recID) == this->removedObjectIDs.end()) {
+        handle = posIt->second;
+    } else {
+        // not held by this node
+        return DBERR_OK;
+    }
+    DB_STATUS ret = this->index->removeObject(handle);
+    if (ret != DBERR_OK) {
+        logger::log_error(ret, "Failed to remove object", recID, "from index.");
+        return ret;
+    }
+    // the object's memory is reclaimed when the index is rebuilt
+    if (insertedIt != this->insertedObjectMap.end()) {
+        this->insertedObjectMap.erase(insertedIt);
+    } else {
+        this->removedObjectIDs.insert(recID);
+    }
+    this->totalObjects--;
+    this->rangeCache.clear();
+    return DBERR_OK;
+}
+
+/** @brief Appends to candidates the handles of the local objects whose MBR intersects the box, from every partition (class) of the box's cells. 
+ * Objects stored in several of those partitions are appended once per partition. */
+static void collectBoxCandidates(BaseIndex* index, double xMin, double yMin, double xMax, double yMax, std::vector<ObjectHandle> &candidates) {
+    DataspaceMetadata* dataspace = &g_config.datasetOptions.dataspaceMetadata;
+    PartitioningMethod* partitioning = g_config.partitioningMethod;
+    int globalPPD = partitioning->getGlobalPPD();
+    int partitionMinX = std::max(0, (int) std::floor((xMin - dataspace->xMinGlobal) / partitioning->getPartPartionExtentX()));
+    int partitionMinY = std::max(0, (int) std::floor((yMin - dataspace->yMinGlobal) / partitioning->getPartPartionExtentY()));
+    // an object placed on the distribution grid may start in the next cell when its left (bottom) side lies on a cell boundary,
+    // so include that cell if the box's right (top) side is on the boundary too
+    int partitionMaxX = std::min(globalPPD - 1, (int) std::floor((xMax - dataspace->xMinGlobal) / partitioning->getPartPartionExtentX() * (1 + 1e-12)));
+    int partitionMaxY = std::min(globalPPD - 1, (int) std::floor((yMax - dataspace->yMinGlobal) / partitioning->getPartPartionExtentY() * (1 + 1e-12)));
+    int classCount = index->getType() == hec::IT_TWO_LAYER ? 4 : 1;
+    std::vector<uint32_t> positions;
+    for (int j=partitionMinY; j<=partitionMaxY; j++) {
+        int rowFirst = partitioning->getPartitionID(partitionMinX, j, globalPPD);
+        int rowLast = partitioning->getPartitionID(partitionMaxX, j, globalPPD) + 1;
+        for (int partitionID = index->nextPartitionID(rowFirst, rowLast); partitionID < rowLast; partitionID = index->nextPartitionID(partitionID + 1, rowLast)) {
+            PartitionBase* partition = index->getPartition(partitionID);
+            if (partition == nullptr) {
+                continue;
+            }
+            for (int classType=0; classType<classCount; classType++) {
+                ObjectList* contents = partition->getContents((TwoLayerClass) classType);
+                if (contents == nullptr || contents->empty()) {
+                    continue;
+                }
+                MBRArrays* mbrs = partition->getMBRs((TwoLayerClass) classType);
+                if (mbrs != nullptr) {
+                    positions.clear();
+                    mbrs->intersecting(xMin, yMin, xMax, yMax, positions);
+                    for (auto &pos : positions) {
+                        candidates.push_back(contents->handles[pos]);
+                    }
+                    continue;
+                }
+                for (size_t pos=0; pos<contents->size(); pos++) {
+                    Shape* obj = (*contents)[pos];
+                    if (rtree::intersects(obj->mbr.pMin.x, obj->mbr.pMin.y, obj->mbr.pMax.x, obj->mbr.pMax.y, xMin, yMin, xMax, yMax)) {
+                        candidates.push_back(contents->handles[pos]);
+                    }
+                }
+            }
+        }
+    }
+}
+
+/** @brief Returns whether this node reports the object for the window: 
+ * the distribution cell of their reference point (see rtree::referencePointInPartition) is assigned to it. */
+static bool ownsReferencePoint(const MBR &objectMBR, const MBR &window) {
+    DataspaceMetadata* dataspace = &g_config.datasetOptions.dataspaceMetadata;
+    PartitioningMethod* partitioning = g_config.partitioningMethod;
+    // on the distribution grid's extent, same as the objects' placement (see getPartitionsAndClasses), so that the node holds the object
+    // (clamped, since a reference point on the dataspace's max edge falls one cell past the grid)
+    int distributionPPD = partitioning->getDistributionPPD();
+    int i = std::min(distributionPPD - 1, (int) std::floor((std::max(objectMBR.pMin.x, window.pMin.x) - dataspace->xMinGlobal) / partitioning->getDistPartionExtentX()));
+    int j = std::min(distributionPPD - 1, (int) std::floor((std::max(objectMBR.pMin.y, window.pMin.y) - dataspace->yMinGlobal) / partitioning->getDistPartionExtentY()));
+    int distPartitionID = partitioning->getPartitionID(i, j, distributionPPD);
+    return partitioning->getNodeRankForPartitionID(distPartitionID) == g_node_rank;
+}
+
+DB_STATUS Dataset::evaluateRangeQuery(hec::RangeQuery* rangeQuery, std::unique_ptr<hec::QResultBase> &queryResult) {
+    DB_STATUS ret = DBERR_OK;
+    if (this->index == nullptr) {
+        logger::log_error(DBERR_INVALID_OPERATION, "Range queries can only be evaluated after the index is built.");
+        return DBERR_INVALID_OPERATION;
+    }
+    if (g_config.queryPipeline.rangeCacheEntries == 0 || rangeQuery->getResultType() == hec::QR_COUNT) {
+        // counts skip the cache: the index answers the covered partitions from their summaries
+        return this->index->evaluateQuery(rangeQuery, queryResult);
+    }
+    Shape window;
+    ret = shape_factory::createEmpty((DataType) rangeQuery->getShapeType(), window);
+    if (ret != DBERR_OK) {
+        return ret;
+    }
+    ret = window.setFromWKT(rangeQuery->getWKT());
+    if (ret != DBERR_OK) {
+        logger::log_error(ret, "Setting window shape from WKT failed. WKT:", rangeQuery->getWKT());
+        return ret;
+    }
+    window.setMBR();
+    if (!window.coversMBR()) {
+        // only rectangle windows are cached: their objects are exactly the ones of any window inside them
+        return this->index->evaluateQuery(rangeQuery, queryResult);
+    }
+    const MBR &box = window.mbr;
+    // rasterize the window once for the APRIL filter of its candidates
+    ret = APRIL::standard::createWindowAPRIL(this, &window);
+    if (ret != DBERR_OK) {
+        return ret;
+    }
+
+    // candidates: from the cache and/or the partitions
+    MBR cachedWindow;
+    bool contains = false;
+    std::shared_ptr<const std::vector<ObjectHandle>> cached = this->rangeCache.find(box, cachedWindow, contains);
+    std::vector<ObjectHandle> candidates;
+    if (cached != nullptr) {
+        for (auto &handle : *cached) {
+            Shape* obj = this->index->getObject(handle);
+            if (rtree::intersects(obj->mbr.pMin.x, obj->mbr.pMin.y, obj->mbr.pMax.x, obj->mbr.pMax.y, box.pMin.x, box.pMin.y, box.pMax.x, box.pMax.y)) {
+                candidates.push_back(handle);
+            }
+        }
+    }
+    if (cached == nullptr) {
+        collectBoxCandidates(this->index.get(), box.pMin.x, box.pMin.y, box.pMax.x, box.pMax.y, candidates);
+    } else if (!contains) {
+        // scan only the rest of the window: its parts left, right, below and above the cached window
+        double midYMin = std::max(box.pMin.y, cachedWindow.pMin.y);
+        double midYMax = std::min(box.pMax.y, cachedWindow.pMax.y);
+        if (box.pMin.x < cachedWindow.pMin.x) {
+            collectBoxCandidates(this->index.get(), box.pMin.x, midYMin, cachedWindow.pMin.x, midYMax, candidates);
+        }
+        if (box.pMax.x > cachedWindow.pMax.x) {
+            collectBoxCandidates(this->index.get(), cachedWindow.pMax.x, midYMin, box.pMax.x, midYMax, candidates);
+        }
+        if (box.pMin.y < cachedWindow.pMin.y) {
+            collectBoxCandidates(this->index.get(), box.pMin.x, box.pMin.y, box.pMax.x, cachedWindow.pMin.y, candidates);
+        }
+        if (box.pMax.y > cachedWindow.pMax.y) {
+            collectBoxCandidates(this->index.get(), box.pMin.x, cachedWindow.pMax.y, box.pMax.x, box.pMax.y, candidates);
+        }
+    }
+    if (cached == nullptr || !contains) {
+        std::sort(candidates.begin(), candidates.end());
+        candidates.erase(std::unique(candidates.begin(), candidates.end()), candidates.end());
+    }
+
+    // report the objects of this node's reference points, refining the ones not inside the window
+    for (auto &handle : candidates) {
+        Shape* obj = this->index->getObject(handle);
+        if (!ownsReferencePoint(obj->mbr, box)) {
+            continue;
+        }
+        bool inside = obj->mbr.pMin.x >= box.pMin.x && obj->mbr.pMax.x <= box.pMax.x && obj->mbr.pMin.y >= box.pMin.y && obj->mbr.pMax.y <= box.pMax.y;
+        if (inside) {
+            queryResult->addResult(obj->recID);
+        } else if (!window.aprilData.intervalsALL.empty()) {
+            ret = APRIL::standard::RangeFilterEntrypoint(&window, obj, queryResult.get());
+            if (ret != DBERR_OK) {
+                return ret;
+            }
+        } else if (window.intersects(*obj)) {
+            queryResult->addResult(obj->recID);
+        }
+    }
+    if (cached == nullptr || !contains) {
+        this->rangeCache.insert(box, std::make_shared<const std::vector<ObjectHandle>>(std::move(candidates)), g_config.queryPipeline.rangeCacheEntries);
+    }
+    return ret;
+}
+
+/** @brief Estimated memory of a node-based hash table: the bucket array and a node (next pointer, element) per element. */
+template <typename HashTable>
+static size_t hashTableBytes(const HashTable &table) {
+    return table.bucket_count() * sizeof(void*) + table.size() * (sizeof(void*) + sizeof(typename HashTable::value_type));
+}
+
+void Dataset::measureMemory(hec::MemoryFootprint &footprint) {
+    footprint.objectCount += this->objects.size() + this->insertedObjectMap.size() - this->removedObjectIDs.size();
+    // the removed objects keep their memory until the index is rebuilt
+    auto measureObject = [&](Shape &object) {
+        footprint.geometryBytes += sizeof(Shape) - sizeof(MBR) - sizeof(AprilData) + object.getVertexCount() * 2 * sizeof(double);
+        footprint.mbrBytes += sizeof(MBR);
+        footprint.aprilBytes += sizeof(AprilData) + (object.aprilData.intervalsALL.capacity() + object.aprilData.intervalsFULL.capacity()) * sizeof(uint32_t);
+    };
+    for (auto &it : this->objects) {
+        measureObject(it);
+    }
+    for (auto &it : this->insertedObjects) {
+        measureObject(it);
+    }
+    footprint.geometryBytes += (this->objects.capacity() - this->objects.size()) * sizeof(Shape);
+    footprint.mapBytes += hashTableBytes(this->objectPosMap) + hashTableBytes(this->insertedObjectMap) + hashTableBytes(this->removedObjectIDs) + this->objectDirectory.memoryBytes();
+    if (this->index != nullptr) {
+        this->index->measureMemory(footprint);
+    }
+    footprint.indexBytes += this->rangeCache.memoryBytes();
+}
+
 int Dataset::calculateBufferSize() {
     int size = 0;
     // dataset index
     size += sizeof(DatasetIndex);
-    // total objects
-    size += sizeof(size_t);
+    // total objects + total vertices
+    size += 2 * sizeof(size_t);
     // dataset's dataspace metadata (MBR)
     size += 4 * sizeof(double);
     
@@ -367,6 +1255,9 @@ DB_STATUS Dataset::serialize(char **buffer, int &bufferSize) {
     // add total objects
     memcpy(localBuffer + position, &totalObjects, sizeof(size_t));
     position += sizeof(size_t);
+    // add total vertices
+    memcpy(localBuffer + position, &totalVertices, sizeof(size_t));
+    position += sizeof(size_t);
     // add dataset's dataspace MBR
     memcpy(localBuffer + position, &metadata.dataspaceMetadata.xMinGlobal, sizeof(double));
     position += sizeof(double);
@@ -391,6 +1282,9 @@ DB_STATUS Dataset::deserialize(const char *buffer, int bufferSize) {
     // dataset data type
     memcpy(&totalObjects, buffer + position, sizeof(size_t));
     position += sizeof(size_t);
+    // total vertices
+    memcpy(&totalVertices, buffer + position, sizeof(size_t));
+    position += sizeof(size_t);
     // dataset dataspace MBR
     memcpy(&xMin, buffer + position, sizeof(double));
     position += sizeof(double);
@@ -502,10 +1396,123 @@ void Dataset::clear() {
     // delete objects
     this->objects.clear();
     this->objectPosMap.clear();
+    this->insertedObjects.clear();
+    this->insertedObjectMap.clear();
+    this->removedObjectIDs.clear();
+    this->objectDirectory.clear();
+    this->rangeCache.clear();
     this->sectionMap.clear();
     this->recToSectionIdMap.clear();
 }
 
+void ObjectDirectory::reset(size_t recIDCount) {
+    owners.assign(recIDCount, 0);
+    overflowOwners.clear();
+}
+
+void ObjectDirectory::setOverflowOwner(size_t recID, int rank) {
+    #pragma omp critical(object_directory_overflow)
+    {
+        overflowOwners[recID] = rank;
+    }
+}
+
+size_t ObjectDirectory::memoryBytes() const {
+    return owners.capacity() * sizeof(uint16_t) + hashTableBytes(overflowOwners);
+}
+
+void ObjectDirectory::clear() {
+    owners.clear();
+    owners.shrink_to_fit();
+    overflowOwners.clear();
+}
+
+RangeCache::RangeCache(RangeCache &&other) noexcept {
+    std::lock_guard<std::mutex> lock(other.mutex);
+    this->entries = std::move(other.entries);
+    this->useClock = other.useClock;
+}
+
+RangeCache& RangeCache::operator=(RangeCache &&other) noexcept {
+    if (this != &other) {
+        std::scoped_lock lock(this->mutex, other.mutex);
+        this->entries = std::move(other.entries);
+        this->useClock = other.useClock;
+    }
+    return *this;
+}
+
+/** @brief The area of the boxes' intersection, 0 if they are disjoint. */
+static double overlapArea(const MBR &a, const MBR &b) {
+    double width = std::min(a.pMax.x, b.pMax.x) - std::max(a.pMin.x, b.pMin.x);
+    double height = std::min(a.pMax.y, b.pMax.y) - std::max(a.pMin.y, b.pMin.y);
+    return (width > 0 && height > 0) ? width * height : 0;
+}
+
+std::shared_ptr<const std::vector<ObjectHandle>> RangeCache::find(const MBR &window, MBR &cachedWindow, bool &contains) {
+    std::lock_guard<std::mutex> lock(this->mutex);
+    double windowArea = (window.pMax.x - window.pMin.x) * (window.pMax.y - window.pMin.y);
+    Entry* best = nullptr;
+    double bestArea = 0;
+    contains = false;
+    for (auto &entry : this->entries) {
+        double entryArea = (entry.window.pMax.x - entry.window.pMin.x) * (entry.window.pMax.y - entry.window.pMin.y);
+        bool entryContains = entry.window.pMin.x <= window.pMin.x && entry.window.pMin.y <= window.pMin.y && entry.window.pMax.x >= window.pMax.x && entry.window.pMax.y >= window.pMax.y;
+        if (entryContains) {
+            // the smallest containing window has the fewest objects to filter
+            if (!contains || entryArea < bestArea) {
+                best = &entry;
+                bestArea = entryArea;
+                contains = true;
+            }
+        } else if (!contains) {
+            // the largest overlap leaves the least area to scan
+            double area = overlapArea(entry.window, window);
+            if (area >= windowArea / 2 && area > bestArea) {
+                best = &entry;
+                bestArea = area;
+            }
+        }
+    }
+    if (best == nullptr) {
+        return nullptr;
+    }
+    best->lastUse = ++this->useClock;
+    cachedWindow = best->window;
+    return best->objects;
+}
+
+void RangeCache::insert(const MBR &window, std::shared_ptr<const std::vector<ObjectHandle>> objects, int capacity) {
+    std::lock_guard<std::mutex> lock(this->mutex);
+    // the new window answers every query of the cached windows inside it
+    this->entries.erase(std::remove_if(this->entries.begin(), this->entries.end(), [&](const Entry &entry) {
+        return window.pMin.x <= entry.window.pMin.x && window.pMin.y <= entry.window.pMin.y && window.pMax.x >= entry.window.pMax.x && window.pMax.y >= entry.window.pMax.y;
+    }), this->entries.end());
+    while (!this->entries.empty() && this->entries.size() >= (size_t) capacity) {
+        auto lru = std::min_element(this->entries.begin(), this->entries.end(), [](const Entry &a, const Entry &b) {
+            return a.lastUse < b.lastUse;
+        });
+        this->entries.erase(lru);
+    }
+    if (capacity > 0) {
+        this->entries.push_back(Entry{window, std::move(objects), ++this->useClock});
+    }
+}
+
+void RangeCache::clear() {
+    std::lock_guard<std::mutex> lock(this->mutex);
+    this->entries.clear();
+}
+
+size_t RangeCache::memoryBytes() const {
+    std::lock_guard<std::mutex> lock(this->mutex);
+    size_t bytes = this->entries.capacity() * sizeof(Entry);
+    for (auto &entry : this->entries) {
+        bytes += entry.objects->capacity() * sizeof(ObjectHandle);
+    }
+    return bytes;
+}
+
 DataspaceMetadata::DataspaceMetadata() {
     xMinGlobal = std::numeric_limits<int>::max();
     yMinGlobal = std::numeric_limits<int>::max();
@@ -540,6 +1547,16 @@ void DataspaceMetadata::clear() {
     boundsSet = false;
 }
 
+void DatasetMetadataPart::merge(const DatasetMetadataPart &other) {
+    xMin = std::min(xMin, other.xMin);
+    yMin = std::min(yMin, other.yMin);
+    xMax = std::max(xMax, other.xMax);
+    yMax = std::max(yMax, other.yMax);
+    objects += other.objects;
+    vertices += other.vertices;
+    failed = failed || other.failed;
+}
+
 void DataspaceMetadata::print() {
     printf("MBR: (%f,%f),(%f,%f)\n", xMinGlobal, yMinGlobal, xMaxGlobal, yMaxGlobal);
     printf("xExtent: %f, yExtent: %f, maxExtent: %f\n", xExtent, yExtent, maxExtent);
@@ -883,29 +1900,288 @@ DB_STATUS DJBatch::probeSerializedForDestRank(const char *buffer, int bufferSize
 }
 
 
+/** PARTITION DIRECTORY */
+
+void PartitionDirectory::insert(int partitionID, int32_t position) {
+    size_t block = (size_t) partitionID >> PARTITION_DIRECTORY_BLOCK_BITS;
+    if (block >= blocks.size()) {
+        blocks.resize(block + 1);
+    }
+    if (blocks[block] == nullptr) {
+        blocks[block] = std::make_unique<int32_t[]>(1 << PARTITION_DIRECTORY_BLOCK_BITS);
+        std::fill_n(blocks[block].get(), 1 << PARTITION_DIRECTORY_BLOCK_BITS, -1);
+    }
+    blocks[block][partitionID & ((1 << PARTITION_DIRECTORY_BLOCK_BITS) - 1)] = position;
+    // mark as occupied
+    size_t word = (size_t) partitionID >> 6;
+    if (word >= occupied.size()) {
+        occupied.resize(word + 1, 0);
+    }
+    occupied[word] |= (uint64_t) 1 << (partitionID & 63);
+}
+
+int PartitionDirectory::nextOccupied(int first, int last) const {
+    if (first < 0) {
+        first = 0;
+    }
+    while (first < last) {
+        size_t word = (size_t) first >> 6;
+        if (word >= occupied.size()) {
+            return last;
+        }
+        // occupied IDs of this word, from first on
+        uint64_t bits = occupied[word] >> (first & 63);
+        if (bits) {
+            int id = first + __builtin_ctzll(bits);
+            return id < last ? id : last;
+        }
+        // skip to the next word
+        first = (int) ((word + 1) << 6);
+    }
+    return last;
+}
+
+size_t PartitionDirectory::memoryBytes() const {
+    size_t bytes = blocks.capacity() * sizeof(std::unique_ptr<int32_t[]>) + occupied.capacity() * sizeof(uint64_t);
+    for (auto &it : blocks) {
+        if (it != nullptr) {
+            bytes += ((size_t) 1 << PARTITION_DIRECTORY_BLOCK_BITS) * sizeof(int32_t);
+        }
+    }
+    return bytes;
+}
+
+void PartitionDirectory::clear() {
+    blocks.clear();
+    occupied.clear();
+}
+
 /** BASE INDEX */
 
 std::vector<PartitionBase*>* BaseIndex::getPartitions() {
     return &partitions;
 }
 
-PartitionBase* BaseIndex::getPartition(int partitionID) {
-    auto it = partitionMap.find(partitionID);
-    if (it != partitionMap.end()) {
-        return partitions[it->second];
-    }
-    return nullptr;
-}
 
 PartitionBase* BaseIndex::getPartition(double x, double y, DataspaceMetadata* dataspaceMetadata, PartitioningMethod* partitioningMethod) {
     int fineMinX = std::floor((x - dataspaceMetadata->xMinGlobal) / partitioningMethod->getPartPartionExtentX());
     int fineMinY = std::floor((y - dataspaceMetadata->yMinGlobal) / partitioningMethod->getPartPartionExtentY());
     int partitionID = partitioningMethod->getPartitionID(fineMinX, fineMinY, partitioningMethod->getGlobalPPD());
-    auto it = partitionMap.find(partitionID);
-    if (it != partitionMap.end()) {
-        return partitions[it->second];
+    return getPartition(partitionID);
+}
+
+DB_STATUS BaseIndex::getPartitionsAndClasses(Shape* objectRef, std::vector<int> &partitionIDs, std::vector<TwoLayerClass> &partitionClasses) {
+    DB_STATUS ret = getPartitionsForMBR(objectRef, partitionIDs);
+    if (ret != DBERR_OK) {
+        return ret;
+    }
+    partitionClasses.assign(partitionIDs.size(), CLASS_A);
+    return DBERR_OK;
+}
+
+namespace
+{
+/** @brief An object's placement in a partition class, during the parallel index build. */
+struct BuildAssignment {
+    int partitionID;
+    TwoLayerClass classType;
+    ObjectHandle handle;
+};
+
+/** @brief A run of consecutive assignments of a chunk that go to the same partition class,
+ * and the position in that class' contents where the run is placed. */
+struct BuildRun {
+    size_t begin;
+    size_t end;
+    PartitionBase* partition;
+    size_t offset;
+};
+}
+
+DB_STATUS BaseIndex::addObjects(int threads) {
+    DB_STATUS ret = DBERR_OK;
+    std::vector<Shape> &objects = *objectStore.objects;
+    if (objects.size() >= UINT32_MAX) {
+        logger::log_error(DBERR_OUT_OF_BOUNDS, "Too many objects for 32-bit object handles:", objects.size());
+        return DBERR_OUT_OF_BOUNDS;
+    }
+    // contiguous chunks of objects, one per thread
+    int chunkCount = std::max(1, std::min<int>(threads, objects.size()));
+    std::vector<std::vector<BuildAssignment>> assignments(chunkCount);
+    std::vector<std::vector<int>> chunkPartitionIDs(chunkCount);
+    std::vector<DB_STATUS> chunkRet(chunkCount, DBERR_OK);
+
+    // assign the objects of each chunk to partitions/classes, and group the assignments by partition and class.
+    // Objects are visited in order and the grouping keeps it, so every group is in object order.
+    #pragma omp parallel for num_threads(threads) schedule(dynamic)
+    for (int c=0; c<chunkCount; c++) {
+        size_t first = objects.size() * c / chunkCount;
+        size_t last = objects.size() * (c+1) / chunkCount;
+        std::vector<int> partitionIDs;
+        std::vector<TwoLayerClass> partitionClasses;
+        for (size_t i=first; i<last; i++) {
+            partitionIDs.clear();
+            partitionClasses.clear();
+            DB_STATUS local_ret = getPartitionsAndClasses(&objects[i], partitionIDs, partitionClasses);
+            if (local_ret == DBERR_OK && partitionIDs.size() != partitionClasses.size()) {
+                logger::log_error(DBERR_INVALID_PARAMETER, "Partition IDs and classes should match in number.");
+                local_ret = DBERR_INVALID_PARAMETER;
+            }
+            if (local_ret != DBERR_OK) {
+                logger::log_error(local_ret, "Failed to add object", objects[i].recID, "to index.");
+                chunkRet[c] = local_ret;
+                break;
+            }
+            for (int j=0; j<partitionIDs.size(); j++) {
+                assignments[c].push_back({partitionIDs[j], partitionClasses[j], (ObjectHandle) i});
+            }
+        }
+        std::stable_sort(assignments[c].begin(), assignments[c].end(), [](const BuildAssignment &a, const BuildAssignment &b) {
+            return a.partitionID < b.partitionID || (a.partitionID == b.partitionID && a.classType < b.classType);
+        });
+    }
+    for (auto &it : chunkRet) {
+        if (it != DBERR_OK) {
+            return it;
+        }
+    }
+
+    // create the partitions and reserve a contiguous slot range for each run, chunk by chunk,
+    // so that the runs of earlier chunks come first. Cost depends on the number of runs, not objects.
+    std::vector<std::vector<BuildRun>> runs(chunkCount);
+    std::vector<size_t> classSizes;
+    for (int c=0; c<chunkCount; c++) {
+        std::vector<BuildAssignment> &chunk = assignments[c];
+        for (size_t begin=0; begin<chunk.size(); ) {
+            size_t end = begin + 1;
+            while (end < chunk.size() && chunk[end].partitionID == chunk[begin].partitionID && chunk[end].classType == chunk[begin].classType) {
+                end++;
+            }
+            PartitionBase* partition = this->getOrCreatePartition(chunk[begin].partitionID);
+            if (partition == nullptr) {
+                logger::log_error(DBERR_INVALID_PARAMETER, "Failed to get partition for object", objects[chunk[begin].handle].recID);
+                return DBERR_INVALID_PARAMETER;
+            }
+            // per partition class sizes, starting from any existing contents
+            while (classSizes.size() < partitions.size() * 4) {
+                PartitionBase* newPartition = partitions[classSizes.size() / 4];
+                classSizes.push_back(newPartition->getContents((TwoLayerClass) (classSizes.size() % 4))->size());
+            }
+            size_t &classSize = classSizes[partitionDirectory.find(chunk[begin].partitionID) * 4 + chunk[begin].classType];
+            runs[c].push_back({begin, end, partition, classSize});
+            classSize += end - begin;
+            begin = end;
+        }
+    }
+
+    // pre-size the partition contents
+    #pragma omp parallel for num_threads(threads) schedule(dynamic)
+    for (int i=0; i<partitions.size(); i++) {
+        for (int classType=CLASS_A; classType<=CLASS_D; classType++) {
+            ObjectList* contents = partitions[i]->getContents((TwoLayerClass) classType);
+            // indexes without classes return the same contents for all of them
+            if (contents->size() < classSizes[i * 4 + classType]) {
+                contents->resize(classSizes[i * 4 + classType]);
+            }
+        }
+    }
+
+    // place the runs into their slots, no two runs overlap
+    #pragma omp parallel for num_threads(threads) schedule(dynamic)
+    for (int c=0; c<chunkCount; c++) {
+        for (auto &run : runs[c]) {
+            ObjectList* contents = run.partition->getContents(assignments[c][run.begin].classType);
+            for (size_t k=run.begin; k<run.end; k++) {
+                contents->handles[run.offset + k - run.begin] = assignments[c][k].handle;
+            }
+        }
+    }
+    return ret;
+}
+
+DB_STATUS BaseIndex::insertObject(ObjectHandle handle, int &partitionCount) {
+    Shape* objectRef = objectStore.get(handle);
+    std::vector<int> partitionIDs;
+    std::vector<TwoLayerClass> partitionClasses;
+    DB_STATUS ret = getPartitionsAndClasses(objectRef, partitionIDs, partitionClasses);
+    if (ret != DBERR_OK) {
+        return ret;
+    }
+    partitionCount = partitionIDs.size();
+    for (int i=0; i<partitionIDs.size(); i++) {
+        PartitionBase* partition = this->getOrCreatePartition(partitionIDs[i]);
+        if (partition == nullptr) {
+            logger::log_error(DBERR_INVALID_PARAMETER, "Failed to get partition for object", objectRef->recID);
+            return DBERR_INVALID_PARAMETER;
+        }
+        if (partition->pendingUpdates() == 0) {
+            updatedPartitions.push_back(partition);
+        }
+        ret = partition->insertObject(handle, partitionClasses[i]);
+        if (ret != DBERR_OK) {
+            return ret;
+        }
+        if (partition->pendingUpdates() >= PARTITION_DELTA_MERGE_THRESHOLD) {
+            partition->mergeUpdates();
+        }
+    }
+    return ret;
+}
+
+DB_STATUS BaseIndex::removeObject(ObjectHandle handle) {
+    Shape* objectRef = objectStore.get(handle);
+    std::vector<int> partitionIDs;
+    std::vector<TwoLayerClass> partitionClasses;
+    DB_STATUS ret = getPartitionsAndClasses(objectRef, partitionIDs, partitionClasses);
+    if (ret != DBERR_OK) {
+        return ret;
+    }
+    for (int i=0; i<partitionIDs.size(); i++) {
+        PartitionBase* partition = this->getPartition(partitionIDs[i]);
+        if (partition == nullptr) {
+            logger::log_error(DBERR_INVALID_KEY, "Object", objectRef->recID, "is not in the index.");
+            return DBERR_INVALID_KEY;
+        }
+        if (partition->pendingUpdates() == 0) {
+            updatedPartitions.push_back(partition);
+        }
+        ret = partition->removeObject(handle, partitionClasses[i]);
+        if (ret != DBERR_OK) {
+            return ret;
+        }
+        if (partition->pendingUpdates() >= PARTITION_DELTA_MERGE_THRESHOLD) {
+            partition->mergeUpdates();
+        }
+    }
+    return ret;
+}
+
+void BaseIndex::mergeUpdates() {
+    if (updatedPartitions.empty()) {
+        return;
+    }
+    // a partition that was merged at the threshold and updated again is listed twice
+    std::sort(updatedPartitions.begin(), updatedPartitions.end());
+    updatedPartitions.erase(std::unique(updatedPartitions.begin(), updatedPartitions.end()), updatedPartitions.end());
+    #pragma omp parallel for num_threads(MAX_THREADS) schedule(dynamic)
+    for (int i=0; i<updatedPartitions.size(); i++) {
+        updatedPartitions[i]->mergeUpdates();
+    }
+    updatedPartitions.clear();
+}
+
+void BaseIndex::buildMBRArrays(int threads) {
+    #pragma omp parallel for num_threads(threads) schedule(dynamic)
+    for (int i=0; i<partitions.size(); i++) {
+        partitions[i]->buildMBRs();
+    }
+}
+
+void BaseIndex::measureMemory(hec::MemoryFootprint &footprint) const {
+    footprint.indexBytes += partitions.capacity() * sizeof(PartitionBase*) + updatedPartitions.capacity() * sizeof(PartitionBase*) + partitionDirectory.memoryBytes();
+    for (auto &it : partitions) {
+        it->measureMemory(footprint);
     }
-    return nullptr;
 }
 
 DB_STATUS BaseIndex::clear() {
@@ -916,7 +2192,8 @@ DB_STATUS BaseIndex::clear() {
         }
         partitions.clear();
     }
-    partitionMap.clear();
+    partitionDirectory.clear();
+    updatedPartitions.clear();
     return DBERR_OK;
 }
 
@@ -1041,19 +2318,28 @@ DB_STATUS TwoLayerIndex::getPartitionsForMBR(Shape* objectRef, std::vector<int>
 }
 
 PartitionBase* TwoLayerIndex::getOrCreatePartition(int partitionID) {
-    auto it = partitionMap.find(partitionID);
-    if (it != partitionMap.end()) {
+    int32_t position = partitionDirectory.find(partitionID);
+    if (position >= 0) {
         // exists
-        return partitions[it->second];
+        return partitions[position];
+    }
+    if (partitionID < 0) {
+        logger::log_error(DBERR_INVALID_PARAMETER, "Invalid partition ID:", partitionID);
+        return nullptr;
     }
     // create new partition
-    partitionMap[partitionID] = partitions.size();
-    partitions.push_back(new PartitionTwoLayer(partitionID));
-    return partitions[partitionMap[partitionID]];
+    partitionDirectory.insert(partitionID, partitions.size());
+    partitions.push_back(new PartitionTwoLayer(partitionID, &objectStore));
+    return partitions.back();
 }
 
 
-DB_STATUS TwoLayerIndex::addObject(Shape *objectRef) {
+DB_STATUS TwoLayerIndex::getPartitionsAndClasses(Shape* objectRef, std::vector<int> &partitionIDs, std::vector<TwoLayerClass> &partitionClasses) {
+    return getPartitionsForMBR(objectRef, partitionIDs, partitionClasses);
+}
+
+DB_STATUS TwoLayerIndex::addObject(ObjectHandle handle) {
+    Shape* objectRef = objectStore.get(handle);
     // find partitions and clases
     std::vector<int> partitionIDs;
     std::vector<TwoLayerClass> partitionClasses;
@@ -1069,22 +2355,25 @@ DB_STATUS TwoLayerIndex::addObject(Shape *objectRef) {
 
     for (int i=0; i<partitionIDs.size(); i++) {
         PartitionBase* partition = this->getOrCreatePartition(partitionIDs[i]);
-        partition->addObject(objectRef, partitionClasses[i]);
+        if (partition == nullptr) {
+            logger::log_error(DBERR_INVALID_PARAMETER, "Failed to get partition for object", objectRef->recID);
+            return DBERR_INVALID_PARAMETER;
+        }
+        partition->addObject(handle, partitionClasses[i]);
     }
     
     return ret;
 }
 
-void TwoLayerIndex::sortPartitionsOnY() {
+void TwoLayerIndex::sortPartitionsOnY(int threads) {
     std::vector<PartitionBase*>* partitions = this->getPartitions();
+    #pragma omp parallel for num_threads(threads) schedule(dynamic)
     for(int i=0; i<partitions->size(); i++) {
         // sort A
-        std::vector<Shape*>* contentsA = partitions->at(i)->getContents(CLASS_A);
-        std::sort(contentsA->begin(), contentsA->end(), compareByY);
+        partitions->at(i)->getContents(CLASS_A)->sort(compareByY);
 
         // sort C
-        std::vector<Shape*>* contentsC = partitions->at(i)->getContents(CLASS_C);
-        std::sort(contentsC->begin(), contentsC->end(), compareByY);
+        partitions->at(i)->getContents(CLASS_C)->sort(compareByY);
     }
 }
 
@@ -1097,20 +2386,77 @@ DB_STATUS TwoLayerIndex::evaluateQuery(hec::Query* query, std::unique_ptr<hec::Q
     return ret;
 }
 
+/**
+ * R-TREE INDEX
+ */
+
+PartitionBase* RTreeIndex::getOrCreatePartition(int partitionID) {
+    int32_t position = partitionDirectory.find(partitionID);
+    if (position >= 0) {
+        // exists
+        return partitions[position];
+    }
+    if (partitionID < 0) {
+        logger::log_error(DBERR_INVALID_PARAMETER, "Invalid partition ID:", partitionID);
+        return nullptr;
+    }
+    // create new partition
+    partitionDirectory.insert(partitionID, partitions.size());
+    partitions.push_back(new PartitionRTree(partitionID, &objectStore));
+    return partitions.back();
+}
+
+void RTreeIndex::sortPartitionsOnY(int threads) {
+    std::vector<PartitionBase*>* partitions = this->getPartitions();
+    #pragma omp parallel for num_threads(threads) schedule(dynamic)
+    for(int i=0; i<partitions->size(); i++) {
+        static_cast<PartitionRTree*>(partitions->at(i))->bulkLoad();
+    }
+}
+
+DB_STATUS RTreeIndex::evaluateQuery(hec::Query* query, std::unique_ptr<hec::QResultBase>& queryResult) {
+    DB_STATUS ret = rtree::processQuery(query, queryResult);
+    if (ret != DBERR_OK) {
+        logger::log_error(ret, "Failed to process query with id:", query->getQueryID());
+        return ret;
+    }
+    return ret;
+}
+
+DB_STATUS RTreeIndex::evaluateQuery(hec::Query* query, std::unordered_map<int, DJBatch> &borderObjectsMap, std::unique_ptr<hec::QResultBase>& queryResult) {
+    hec::DistanceJoinQuery* distanceQuery = dynamic_cast<hec::DistanceJoinQuery*>(query);
+    if (distanceQuery == nullptr) {
+        logger::log_error(DBERR_INVALID_PARAMETER, "Query", query->getQueryID(), "is not a distance join.");
+        return DBERR_INVALID_PARAMETER;
+    }
+    Dataset* R = g_config.datasetOptions.getDatasetByIdx(distanceQuery->getDatasetRid());
+    Dataset* S = g_config.datasetOptions.getDatasetByIdx(distanceQuery->getDatasetSid());
+    if (R->metadata.dataType != DT_POINT || S->metadata.dataType != DT_POINT) {
+        // replicated objects would pair up in every partition they share
+        logger::log_error(DBERR_FEATURE_UNSUPPORTED, "Distance joins on the R-tree index support points only. Query:", query->getQueryID());
+        return DBERR_FEATURE_UNSUPPORTED;
+    }
+    return UniformGridIndex::evaluateQuery(query, borderObjectsMap, queryResult);
+}
+
 /**
  * UNIFORM GRID INDEX
  */
 
 PartitionBase* UniformGridIndex::getOrCreatePartition(int partitionID) {
-    auto it = partitionMap.find(partitionID);
-    if (it != partitionMap.end()) {
+    int32_t position = partitionDirectory.find(partitionID);
+    if (position >= 0) {
         // exists
-        return partitions[it->second];
+        return partitions[position];
+    }
+    if (partitionID < 0) {
+        logger::log_error(DBERR_INVALID_PARAMETER, "Invalid partition ID:", partitionID);
+        return nullptr;
     }
     // create new partition
-    partitionMap[partitionID] = partitions.size();
-    partitions.push_back(new PartitionUniformGrid(partitionID));
-    return partitions[partitionMap[partitionID]];
+    partitionDirectory.insert(partitionID, partitions.size());
+    partitions.push_back(new PartitionUniformGrid(partitionID, &objectStore));
+    return partitions.back();
 }
 
 DB_STATUS UniformGridIndex::getPartitionsForMBR(Shape* objectRef, std::vector<int> &partitionIDs){
@@ -1173,8 +2519,9 @@ DB_STATUS UniformGridIndex::getPartitionsForMBR(Shape* objectRef, std::vector<in
     return DBERR_OK;
 }
 
-DB_STATUS UniformGridIndex::addObject(Shape *objectRef) {
+DB_STATUS UniformGridIndex::addObject(ObjectHandle handle) {
     DB_STATUS ret = DBERR_OK;
+    Shape* objectRef = objectStore.get(handle);
     
     // find partitions and clases
     std::vector<int> partitionIDs;
@@ -1185,18 +2532,22 @@ DB_STATUS UniformGridIndex::addObject(Shape *objectRef) {
 
     for (int i=0; i<partitionIDs.size(); i++) {
         PartitionBase* partition = this->getOrCreatePartition(partitionIDs[i]);
-        partition->addObject(objectRef);
+        if (partition == nullptr) {
+            logger::log_error(DBERR_INVALID_PARAMETER, "Failed to get partition for object", objectRef->recID);
+            return DBERR_INVALID_PARAMETER;
+        }
+        partition->addObject(handle);
     }
 
     return ret;
 
 }
 
-void UniformGridIndex::sortPartitionsOnY() {
+void UniformGridIndex::sortPartitionsOnY(int threads) {
     std::vector<PartitionBase*>* partitions = this->getPartitions();
+    #pragma omp parallel for num_threads(threads) schedule(dynamic)
     for(int i=0; i<partitions->size(); i++) {
-        std::vector<Shape*>* contents = partitions->at(i)->getContents();
-        std::sort(contents->begin(), contents->end(), compareByY);
+        partitions->at(i)->getContents()->sort(compareByY);
     }
 }
 
@@ -1246,66 +2597,74 @@ DB_STATUS UniformGridIndex::evaluateDJBatch(hec::Query* query, DJBatch& batch, c
  */
 
 void DatasetOptions::clear() {
-    R.reset();
-    S.reset();
+    datasets.clear();
     dataspaceMetadata.clear();
 }
 
 Dataset* DatasetOptions::getDatasetR() {
-    return R.has_value() ? &R.value() : nullptr;
+    return getDatasetByIdx(DATASET_R);
 }
 
 Dataset* DatasetOptions::getDatasetS() {
-    return S.has_value() ? &S.value() : nullptr;
+    return getDatasetByIdx(DATASET_S);
 }
 
 DB_STATUS DatasetOptions::unloadDataset(int datasetIndex) {
-    switch (datasetIndex) {
-        case DATASET_R:
-            if (R.has_value()) {
-                R->clear();
-                R.reset();
-                // this->print();
-                return DBERR_OK;
-            }
-            break;
-        case DATASET_S:
-            if (S.has_value()) {
-                S->clear();
-                S.reset();
-                // this->print();
-                return DBERR_OK;
-            }
-            break;
-        default:
-            logger::log_error(DBERR_INVALID_PARAMETER, "Invalid dataset index:", datasetIndex);
-            return DBERR_INVALID_PARAMETER;
+    if (datasetIndex < 0) {
+        logger::log_error(DBERR_INVALID_PARAMETER, "Invalid dataset index:", datasetIndex);
+        return DBERR_INVALID_PARAMETER;
+    }
+    Dataset* dataset = getDatasetByIdx(datasetIndex);
+    if (dataset == nullptr) {
+        logger::log_warning("No dataset is loaded with ID", datasetIndex);
+        return DBERR_OK;
+    }
+    dataset->clear();
+    datasets[datasetIndex].reset();
+    // drop the trailing free IDs
+    while (!datasets.empty() && datasets.back() == nullptr) {
+        datasets.pop_back();
     }
-    
-    logger::log_warning("No dataset is loaded with ID", datasetIndex);
     return DBERR_OK;
 }
 
 void DatasetOptions::print() {
     logger::log_task("Current DatasetOptions status");
-    if (R) {
-        printf("  R is loaded. Id: %d, name: %s\n", R->metadata.internalID, R->metadata.datasetName.c_str());
-    } else {
-        printf("  R is empty.");
+    for (auto &it : getDatasets()) {
+        printf("  Dataset %d is loaded, name: %s\n", it->metadata.internalID, it->metadata.datasetName.c_str());
     }
+}
 
-    if (S) {
-        printf("  S is loaded. Id: %d, name: %s\n", S->metadata.internalID, S->metadata.datasetName.c_str());
-    } else {
-        printf("  S is empty.");
+Dataset* DatasetOptions::getDatasetByIdx(int datasetIndex) {
+    if (datasetIndex < 0 || datasetIndex >= (int) datasets.size()) {
+        return nullptr;
     }
+    return datasets[datasetIndex].get();
 }
 
-Dataset* DatasetOptions::getDatasetByIdx(int datasetIndex) {
-    switch (datasetIndex) {
-        case DATASET_R: return R.has_value() ? &R.value() : nullptr;
-        case DATASET_S: return S.has_value() ? &S.value() : nullptr;
-        default: return nullptr;
+std::vector<Dataset*> DatasetOptions::getDatasets() {
+    std::vector<Dataset*> resident;
+    for (auto &it : datasets) {
+        if (it != nullptr) {
+            resident.push_back(it.get());
+        }
+    }
+    return resident;
+}
+
+int DatasetOptions::getResidentCount() {
+    int count = 0;
+    for (auto &it : datasets) {
+        count += it != nullptr;
+    }
+    return count;
+}
+
+void DatasetOptions::mergeIndexUpdates() {
+    for (auto &dataset : getDatasets()) {
+        if (dataset->index != nullptr) {
+            dataset->index->mergeUpdates();
+        }
     }
 }
 
@@ -1313,47 +2672,34 @@ Dataset* DatasetOptions::getDatasetByIdx(int datasetIndex) {
 @brief adds a Dataset to the configuration's dataset metadata
  */
 DB_STATUS DatasetOptions::addDataset(DatasetIndex datasetIdx, Dataset&& dataset) {
-    switch (datasetIdx) {
-        case DATASET_R:
-            if (R.has_value()) {
-                logger::log_error(DBERR_INVALID_PARAMETER, "Dataset R already exists");
-                return DBERR_INVALID_PARAMETER;
-            }
-            R = std::move(dataset);
-            R->metadata.internalID = DATASET_R;
-            break;
-        case DATASET_S:
-            if (S.has_value()) {
-                logger::log_error(DBERR_INVALID_PARAMETER, "Dataset S already exists");
-                return DBERR_INVALID_PARAMETER;
-            }
-            S = std::move(dataset);
-            S->metadata.internalID = DATASET_S;
-            break;
-        default:
-            logger::log_error(DBERR_INVALID_PARAMETER, "Invalid dataset index");
-            return DBERR_INVALID_PARAMETER;
+    if ((int) datasetIdx < 0) {
+        logger::log_error(DBERR_INVALID_PARAMETER, "Invalid dataset index");
+        return DBERR_INVALID_PARAMETER;
     }
+    if (getDatasetByIdx(datasetIdx) != nullptr) {
+        logger::log_error(DBERR_INVALID_PARAMETER, "Dataset with index", (int) datasetIdx, "already exists");
+        return DBERR_INVALID_PARAMETER;
+    }
+    if (datasetIdx >= (int) datasets.size()) {
+        datasets.resize(datasetIdx + 1);
+    }
+    datasets[datasetIdx] = std::make_unique<Dataset>(std::move(dataset));
+    datasets[datasetIdx]->metadata.internalID = datasetIdx;
     return DBERR_OK;
 }
 
 
 DB_STATUS DatasetOptions::addDataset(Dataset&& dataset, int &id) {
-    if (!R.has_value()) {
-        R = std::move(dataset);
-        R->metadata.internalID = DATASET_R;
-        id = DATASET_R;
-        // logger::log_success("Set R dataset id to", R->metadata.internalID);
-    } else if (!S.has_value()) {
-        S = std::move(dataset);
-        S->metadata.internalID = DATASET_S;
-        id = DATASET_S;
-        // logger::log_success("Set S dataset id to", S->metadata.internalID);
-    } else {
-        logger::log_error(DBERR_INVALID_PARAMETER, "Both R and S datasets exist:", R->metadata.datasetName, S->metadata.datasetName);
+    if (getResidentCount() >= maxResidentDatasets) {
+        logger::log_error(DBERR_INVALID_PARAMETER, "Max resident datasets reached:", maxResidentDatasets, "Unload a dataset first.");
         return DBERR_INVALID_PARAMETER;
     }
-    return DBERR_OK;
+    // lowest free ID
+    id = 0;
+    while (id < (int) datasets.size() && datasets[id] != nullptr) {
+        id++;
+    }
+    return addDataset((DatasetIndex) id, std::move(dataset));
 }
 
 
@@ -1365,16 +2711,8 @@ void DatasetOptions::updateDataspace() {
     dataspaceMetadata.yMaxGlobal = std::numeric_limits<double>::lowest();
 
     // Update bounds based on available datasets
-    if (R) {
-        const auto& meta = R->metadata.dataspaceMetadata;
-        dataspaceMetadata.xMinGlobal = std::min(dataspaceMetadata.xMinGlobal, meta.xMinGlobal);
-        dataspaceMetadata.yMinGlobal = std::min(dataspaceMetadata.yMinGlobal, meta.yMinGlobal);
-        dataspaceMetadata.xMaxGlobal = std::max(dataspaceMetadata.xMaxGlobal, meta.xMaxGlobal);
-        dataspaceMetadata.yMaxGlobal = std::max(dataspaceMetadata.yMaxGlobal, meta.yMaxGlobal);
-    }
-    
-    if (S) {
-        const auto& meta = S->metadata.dataspaceMetadata;
+    for (auto &it : getDatasets()) {
+        const auto& meta = it->metadata.dataspaceMetadata;
         dataspaceMetadata.xMinGlobal = std::min(dataspaceMetadata.xMinGlobal, meta.xMinGlobal);
         dataspaceMetadata.yMinGlobal = std::min(dataspaceMetadata.yMinGlobal, meta.yMinGlobal);
         dataspaceMetadata.xMaxGlobal = std::max(dataspaceMetadata.xMaxGlobal, meta.xMaxGlobal);
@@ -1386,16 +2724,31 @@ void DatasetOptions::updateDataspace() {
     dataspaceMetadata.yExtent = dataspaceMetadata.yMaxGlobal - dataspaceMetadata.yMinGlobal;
     dataspaceMetadata.maxExtent = std::max(dataspaceMetadata.xExtent, dataspaceMetadata.yExtent);
 
-    // Update both datasets' bounds
+    // Update all datasets' bounds
     updateDatasetDataspaceToGlobal();
 }
 
-void DatasetOptions::updateDatasetDataspaceToGlobal() {
-    if (R) {
-        R->metadata.dataspaceMetadata = dataspaceMetadata;
+DB_STATUS DatasetOptions::updateDataspace(const std::vector<int> &changedIndexes) {
+    // datasets with computed metadata outside the changed ones are placed in the current global dataspace
+    bool placed = false;
+    for (auto &it : getDatasets()) {
+        if (it->totalObjects > 0 && std::find(changedIndexes.begin(), changedIndexes.end(), (int) it->metadata.internalID) == changedIndexes.end()) {
+            placed = true;
+        }
+    }
+    DataspaceMetadata previous = dataspaceMetadata;
+    updateDataspace();
+    if (placed && (previous.xMinGlobal != dataspaceMetadata.xMinGlobal || previous.yMinGlobal != dataspaceMetadata.yMinGlobal || 
+                   previous.xMaxGlobal != dataspaceMetadata.xMaxGlobal || previous.yMaxGlobal != dataspaceMetadata.yMaxGlobal)) {
+        logger::log_error(DBERR_INVALID_PARAMETER, "The datasets extend the global dataspace of the resident datasets. Partition them together or unload the resident datasets first.");
+        return DBERR_INVALID_PARAMETER;
     }
-    if (S) {
-        S->metadata.dataspaceMetadata = dataspaceMetadata;
+    return DBERR_OK;
+}
+
+void DatasetOptions::updateDatasetDataspaceToGlobal() {
+    for (auto &it : getDatasets()) {
+        it->metadata.dataspaceMetadata = dataspaceMetadata;
     }
 }
 
@@ -1408,12 +2761,38 @@ bool Batch::isValid() {
 void Batch::addObjectToBatch(Shape &object) {
     objects.emplace_back(object);
     objectCount += 1;
+    // recID + mbr + vertex count + vertices
+    bufferSize += sizeof(size_t) + 4 * sizeof(double) + sizeof(int) + object.getVertexCount() * 2 * sizeof(double);
 }
 
 void Batch::setDestNodeRank(int destRank) {
     this->destRank = destRank;
 }
 
+bool Batch::isFull() {
+    if (maxBufferSize > 0) {
+        return bufferSize >= maxBufferSize;
+    }
+    return objectCount >= maxObjectCount;
+}
+
+void Batch::adaptBufferSize(size_t sentBytes, double sendTime) {
+    if (!adaptive || sendTime <= 0) {
+        return;
+    }
+    double throughput = sentBytes / sendTime;
+    if (lastThroughput > 0 && throughput < lastThroughput) {
+        // last change hurt, go the other way
+        adaptDirection = -adaptDirection;
+    }
+    lastThroughput = throughput;
+    if (adaptDirection > 0) {
+        maxBufferSize = std::min(maxBufferSize * 2, (size_t) BATCH_MAX_BYTES);
+    } else {
+        maxBufferSize = std::max(maxBufferSize / 2, (size_t) BATCH_MIN_BYTES);
+    }
+}
+
 // calculate the size needed for the serialization buffer
 int Batch::calculateBufferSize() {
     int size = 0;
@@ -1433,6 +2812,7 @@ int Batch::calculateBufferSize() {
 void Batch::clear() {
     objectCount = 0;
     objects.clear();
+    bufferSize = BATCH_HEADER_BYTES;
 }
 
 DB_STATUS Batch::serialize(char **buffer, int &bufferSize) {
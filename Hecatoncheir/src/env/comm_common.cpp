@@ -5,11 +5,13 @@ namespace comm
 
     DB_STATUS probe(int sourceRank, int tag, MPI_Comm &comm, MPI_Status &status) {
         // blocking, won't stop probing until a message with this specification is found
+        double startTime = MPI_Wtime();
         int mpi_ret = MPI_Probe(sourceRank, tag, comm, &status);
         if(mpi_ret != MPI_SUCCESS) {
             logger::log_error(DBERR_COMM_PROBE_FAILED, "Blocking probe failed");
             return DBERR_COMM_PROBE_FAILED;
         }
+        telemetry::recordProbe(status.MPI_SOURCE, status.MPI_TAG, comm, MPI_Wtime() - startTime);
         return DBERR_OK;
     }
 
@@ -57,6 +59,80 @@ namespace comm
             return ret;
         }
     
+        DB_STATUS reduceDatasetMetadata(SerializedMsg<char> &msg, bool &agreed) {
+            // unpack
+            std::vector<int> messageContents;
+            DB_STATUS ret = unpack::unpackValues(msg, messageContents);
+            if (ret != DBERR_OK) {
+                logger::log_error(ret, "Failed to unpack dataset metadata reduce contents.");
+                return ret;
+            }
+            agreed = true;
+            std::vector<std::tuple<Dataset*, DatasetMetadataPart, bool>> reduced;
+            for (int i=0; i+1<messageContents.size(); i+=2) {
+                Dataset* dataset = g_config.datasetOptions.getDatasetByIdx(messageContents[i]);
+                if (dataset == nullptr) {
+                    logger::log_error(DBERR_NULL_PTR_EXCEPTION, "Get dataset by index returned nullptr at metadata reduce. Index:", messageContents[i]);
+                    return DBERR_NULL_PTR_EXCEPTION;
+                }
+                bool computeExtent = messageContents[i+1];
+                // scan this node's part of the file. A failure is not returned here, all nodes must take part in the reduction
+                DatasetMetadataPart part;
+                if (storage::reader::calculateDatasetMetadataPart(dataset, g_node_rank, g_world_size, computeExtent, part) != DBERR_OK) {
+                    part.failed = true;
+                }
+                // max for the extent (the minimums negated), sum for the counts
+                double extent[4] = {-part.xMin, -part.yMin, part.xMax, part.yMax};
+                unsigned long long counts[3] = {part.objects, part.vertices, part.failed};
+                int mpi_ret = MPI_Allreduce(MPI_IN_PLACE, extent, 4, MPI_DOUBLE, MPI_MAX, g_worker_comm);
+                if (mpi_ret != MPI_SUCCESS) {
+                    logger::log_error(DBERR_COMM_COLLECTIVE, "Dataset extent reduction failed. Index:", messageContents[i]);
+                    return DBERR_COMM_COLLECTIVE;
+                }
+                mpi_ret = MPI_Allreduce(MPI_IN_PLACE, counts, 3, MPI_UNSIGNED_LONG_LONG, MPI_SUM, g_worker_comm);
+                if (mpi_ret != MPI_SUCCESS) {
+                    logger::log_error(DBERR_COMM_COLLECTIVE, "Dataset count reduction failed. Index:", messageContents[i]);
+                    return DBERR_COMM_COLLECTIVE;
+                }
+                if (counts[2] > 0) {
+                    agreed = false;
+                    continue;
+                }
+                DatasetMetadataPart global;
+                global.xMin = -extent[0];
+                global.yMin = -extent[1];
+                global.xMax = extent[2];
+                global.yMax = extent[3];
+                global.objects = counts[0];
+                global.vertices = counts[1];
+                reduced.emplace_back(dataset, global, computeExtent);
+            }
+            if (!agreed) {
+                // the host falls back to computing the metadata on its own
+                return DBERR_OK;
+            }
+            // set the agreed metadata
+            std::vector<int> changedIndexes;
+            for (auto &[dataset, global, computeExtent] : reduced) {
+                changedIndexes.emplace_back(dataset->metadata.internalID);
+                dataset->totalObjects = global.objects;
+                dataset->totalVertices = global.vertices;
+                // with a preset extent, only the counts are used
+                if (computeExtent) {
+                    dataset->metadata.dataspaceMetadata.set(global.xMin, global.yMin, global.xMax, global.yMax);
+                }
+            }
+            // update the global dataspace and the grids
+            ret = g_config.datasetOptions.updateDataspace(changedIndexes);
+            if (ret != DBERR_OK) {
+                return ret;
+            }
+            g_config.datasetOptions.dataspaceMetadata.boundsSet = true;
+            g_config.partitioningMethod->setDistGridDataspace(g_config.datasetOptions.dataspaceMetadata);
+            g_config.partitioningMethod->setPartGridDataspace(g_config.datasetOptions.dataspaceMetadata);
+            return ret;
+        }
+
         DB_STATUS buildIndex(SerializedMsg<char> &msg) {
             // unpack
             std::vector<int> messageContents;
@@ -73,31 +149,238 @@ namespace comm
 
             // first number is the build index
             hec::IndexType indexType = (hec::IndexType) messageContents[0];
-            /** @todo parallelize for two datasets? */
+            std::vector<Dataset*> datasets;
             for (int i=1; i<messageContents.size(); i++) {
                 // get dataset to index
                 Dataset *dataset = g_config.datasetOptions.getDatasetByIdx(messageContents[i]);
-                // build index
-                ret = dataset->buildIndex(indexType);
-                if (ret != DBERR_OK) {
-                    logger::log_error(ret, "Failed to build index");
-                    return ret;
+                if (dataset == nullptr) {
+                    logger::log_error(DBERR_INVALID_PARAMETER, "No dataset with index", messageContents[i]);
+                    return DBERR_INVALID_PARAMETER;
+                }
+                // the objects must stay in place while the builds reference them
+                dataset->foldUpdates();
+                datasets.emplace_back(dataset);
+            }
+
+            // the index and the APRIL builds of all datasets are independent: index builds only reference the objects
+            // and APRIL builds only write the objects' intervals. Each is a job, all jobs run at the same time,
+            // so that the serial parts of one (partition creation, per partition sorts) overlap with the others.
+            std::vector<std::pair<Dataset*, bool>> jobs;
+            for (auto &dataset : datasets) {
+                jobs.emplace_back(dataset, false);
+                if (g_config.queryPipeline.IntermediateFilter && dataset->metadata.dataType != DT_POINT) {
+                    jobs.emplace_back(dataset, true);
                 }
-                if (g_config.queryPipeline.IntermediateFilter) {
-                    // generate APRIL
-                    ret = dataset->buildAPRIL();
+            }
+            for (auto &[dataset, isAPRIL] : jobs) {
+                if (isAPRIL) {
+                    // all datasets share the global dataspace, set the raster bounds once
+                    ret = APRIL::generation::setRasterBounds(dataset->metadata.dataspaceMetadata);
                     if (ret != DBERR_OK) {
-                        logger::log_error(ret, "Failed to create APRIL");
                         return ret;
                     }
+                    break;
+                }
+            }
+            std::vector<DB_STATUS> jobRet(jobs.size(), DBERR_OK);
+            // the jobs' own parallel loops run nested, each on its share of MAX_THREADS, 
+            // so that all of them together do not oversubscribe the cores
+            int jobCount = std::min<int>(jobs.size(), MAX_THREADS);
+            int maxActiveLevels = omp_get_max_active_levels();
+            omp_set_max_active_levels(std::max(maxActiveLevels, 2));
+            #pragma omp parallel for num_threads(std::max(1, jobCount)) schedule(static, 1)
+            for (int j=0; j<jobs.size(); j++) {
+                // jobs beyond MAX_THREADS reuse a thread of the team, after its previous job
+                int jobThreads = MAX_THREADS / jobCount + ((j % jobCount) < (MAX_THREADS % jobCount));
+                if (jobs[j].second) {
+                    jobRet[j] = jobs[j].first->createAPRIL(jobThreads);
+                } else {
+                    jobRet[j] = jobs[j].first->buildIndex(indexType, jobThreads);
+                }
+            }
+            omp_set_max_active_levels(maxActiveLevels);
+            for (int j=0; j<jobs.size(); j++) {
+                if (jobRet[j] != DBERR_OK) {
+                    logger::log_error(jobRet[j], jobs[j].second ? "Failed to create APRIL" : "Failed to build index");
+                    return jobRet[j];
+                }
+            }
+
+            return ret;
+        }
+
+        DB_STATUS insertObjects(SerializedMsg<char> &msg) {
+            int datasetID;
+            std::vector<std::pair<size_t, std::string>> objects;
+            DB_STATUS ret = unpack::unpackObjectInserts(msg, datasetID, objects);
+            if (ret != DBERR_OK) {
+                logger::log_error(ret, "Failed to unpack object inserts.");
+                return ret;
+            }
+            Dataset *dataset = g_config.datasetOptions.getDatasetByIdx(datasetID);
+            if (dataset == nullptr) {
+                logger::log_error(DBERR_INVALID_PARAMETER, "No dataset with index", datasetID);
+                return DBERR_INVALID_PARAMETER;
+            }
+            Shape object;
+            ret = shape_factory::createEmpty(dataset->metadata.dataType, object);
+            if (ret != DBERR_OK) {
+                return ret;
+            }
+            for (auto &it : objects) {
+                object.reset();
+                object.recID = it.first;
+                ret = object.setFromWKT(it.second);
+                if (ret != DBERR_OK) {
+                    logger::log_error(ret, "Invalid geometry for object", it.first);
+                    return ret;
+                }
+                object.setMBR();
+                ret = dataset->insertObject(object, g_config.queryPipeline.IntermediateFilter);
+                if (ret != DBERR_OK) {
+                    return ret;
+                }
+            }
+            return ret;
+        }
+
+        DB_STATUS deleteObjects(SerializedMsg<char> &msg) {
+            std::vector<size_t> messageContents;
+            DB_STATUS ret = unpack::unpackValues(msg, messageContents);
+            if (ret != DBERR_OK || messageContents.empty()) {
+                logger::log_error(DBERR_INVALID_PARAMETER, "Failed to unpack object deletes.");
+                return DBERR_INVALID_PARAMETER;
+            }
+            // first number is the dataset index
+            Dataset *dataset = g_config.datasetOptions.getDatasetByIdx(messageContents[0]);
+            if (dataset == nullptr) {
+                logger::log_error(DBERR_INVALID_PARAMETER, "No dataset with index", messageContents[0]);
+                return DBERR_INVALID_PARAMETER;
+            }
+            for (int i=1; i<messageContents.size(); i++) {
+                ret = dataset->removeObject(messageContents[i]);
+                if (ret != DBERR_OK) {
+                    return ret;
+                }
+            }
+            return ret;
+        }
+
+        DB_STATUS setPipeline(SerializedMsg<char> &msg) {
+            std::vector<int> messageContents;
+            DB_STATUS ret = unpack::unpackValues(msg, messageContents);
+            if (ret != DBERR_OK || messageContents.size() != 2) {
+                logger::log_error(DBERR_DESERIALIZE_FAILED, "Failed to unpack pipeline settings.");
+                return DBERR_DESERIALIZE_FAILED;
+            }
+            int rangeCacheEntries = messageContents[0];
+            int resultDelivery = messageContents[1];
+            if (resultDelivery > RD_DIRECT) {
+                logger::log_error(DBERR_INVALID_PARAMETER, "Unknown result delivery type:", resultDelivery);
+                return DBERR_INVALID_PARAMETER;
+            }
+            if (rangeCacheEntries >= 0) {
+                if (rangeCacheEntries < g_config.queryPipeline.rangeCacheEntries) {
+                    for (auto &dataset : g_config.datasetOptions.getDatasets()) {
+                        dataset->rangeCache.clear();
+                    }
                 }
+                g_config.queryPipeline.rangeCacheEntries = rangeCacheEntries;
+            }
+            if (resultDelivery >= 0) {
+                g_config.queryPipeline.resultDelivery = (ResultDeliveryType) resultDelivery;
             }
+            return ret;
+        }
 
+        DB_STATUS saveSnapshot(SerializedMsg<char> &msg) {
+            int datasetID;
+            std::string snapshotPath;
+            DB_STATUS ret = unpack::unpackSnapshotRequest(msg, datasetID, snapshotPath);
+            if (ret != DBERR_OK) {
+                logger::log_error(ret, "Failed to unpack snapshot request.");
+                return ret;
+            }
+            Dataset *dataset = g_config.datasetOptions.getDatasetByIdx(datasetID);
+            if (dataset == nullptr) {
+                logger::log_error(DBERR_INVALID_PARAMETER, "No dataset with index", datasetID);
+                return DBERR_INVALID_PARAMETER;
+            }
+            return storage::snapshot::writeSnapshot(dataset, snapshotPath);
+        }
+
+        DB_STATUS loadSnapshot(SerializedMsg<char> &msg) {
+            int datasetID;
+            std::string snapshotPath;
+            DB_STATUS ret = unpack::unpackSnapshotRequest(msg, datasetID, snapshotPath);
+            if (ret != DBERR_OK) {
+                logger::log_error(ret, "Failed to unpack snapshot request.");
+                return ret;
+            }
+            Dataset *dataset = g_config.datasetOptions.getDatasetByIdx(datasetID);
+            if (dataset == nullptr) {
+                logger::log_error(DBERR_INVALID_PARAMETER, "No dataset with index", datasetID);
+                return DBERR_INVALID_PARAMETER;
+            }
+            bool hasAPRIL = false;
+            ret = storage::snapshot::loadSnapshot(dataset, snapshotPath, hasAPRIL);
+            if (ret != DBERR_OK) {
+                return ret;
+            }
+            if (hasAPRIL) {
+                // the stored intervals are used as they are, only set the raster they refer to
+                ret = APRIL::generation::setRasterBounds(dataset->metadata.dataspaceMetadata);
+            } else if (g_config.queryPipeline.IntermediateFilter) {
+                ret = dataset->buildAPRIL();
+            }
+            if (ret != DBERR_OK) {
+                logger::log_error(ret, "Failed to set up APRIL for the loaded snapshot.");
+            }
             return ret;
         }
 
+        BaseIndex* getQueryIndex(hec::Query* query) {
+            int datasetID = -1;
+            switch (query->getQueryType()) {
+                case hec::Q_RANGE:
+                    datasetID = dynamic_cast<hec::RangeQuery*>(query)->getDatasetID();
+                    break;
+                case hec::Q_KNN:
+                    datasetID = dynamic_cast<hec::KNNQuery*>(query)->getDatasetID();
+                    break;
+                case hec::Q_DISTANCE_JOIN:
+                    datasetID = dynamic_cast<hec::DistanceJoinQuery*>(query)->getDatasetRid();
+                    break;
+                default:
+                    // predicate joins
+                    datasetID = dynamic_cast<hec::PredicateJoinQuery*>(query)->getDatasetRid();
+                    break;
+            }
+            Dataset* dataset = g_config.datasetOptions.getDatasetByIdx(datasetID);
+            if (dataset == nullptr || dataset->index == nullptr) {
+                logger::log_error(DBERR_INVALID_PARAMETER, "Query", query->getQueryID(), "names dataset", datasetID, "which is not resident or not indexed.");
+                return nullptr;
+            }
+            return dataset->index.get();
+        }
+
+        DB_STATUS evaluateOnIndex(hec::Query* query, std::unique_ptr<hec::QResultBase> &queryResult) {
+            BaseIndex* index = getQueryIndex(query);
+            if (index == nullptr) {
+                return DBERR_INVALID_PARAMETER;
+            }
+            if (query->getQueryType() == hec::Q_RANGE) {
+                // through the dataset's range cache
+                hec::RangeQuery* rangeQuery = dynamic_cast<hec::RangeQuery*>(query);
+                return g_config.datasetOptions.getDatasetByIdx(rangeQuery->getDatasetID())->evaluateRangeQuery(rangeQuery, queryResult);
+            }
+            return index->evaluateQuery(query, queryResult);
+        }
+
         DB_STATUS evaluateDJQuery(SerializedMsg<char> &msg, hec::Query** queryPtr, std::unordered_map<int, DJBatch> &borderObjectsMap, std::unique_ptr<hec::QResultBase> &queryResult) {
             DB_STATUS ret = DBERR_OK;
+            // queries read the merged contents only
+            g_config.datasetOptions.mergeIndexUpdates();
             // unpack query
             char* localBuffer = msg.data;
             *queryPtr = hec::Query::createFromBuffer(localBuffer);
@@ -113,12 +396,20 @@ namespace comm
                 return DBERR_OBJ_CREATION_FAILED;
             }
 
+            BaseIndex* index = getQueryIndex(*queryPtr);
+            hec::DistanceJoinQuery* djQuery = dynamic_cast<hec::DistanceJoinQuery*>(*queryPtr);
+            Dataset* R = g_config.datasetOptions.getDatasetByIdx(djQuery->getDatasetRid());
+            Dataset* S = g_config.datasetOptions.getDatasetByIdx(djQuery->getDatasetSid());
+            if (index == nullptr || S == nullptr) {
+                logger::log_error(DBERR_INVALID_PARAMETER, "Distance join", djQuery->getQueryID(), "names datasets that are not resident.");
+                return DBERR_INVALID_PARAMETER;
+            }
             // batches of objects that rest on border areas
             for (int i=1; i<g_world_size; i++) {
-                borderObjectsMap[i] = DJBatch(i, g_config.datasetOptions.getDatasetR()->metadata.dataType, g_config.datasetOptions.getDatasetS()->metadata.dataType);
+                borderObjectsMap[i] = DJBatch(i, R->metadata.dataType, S->metadata.dataType);
             }
             // evaluate local distances and find the border objects
-            ret = g_config.datasetOptions.getDatasetR()->index->evaluateQuery(*queryPtr, borderObjectsMap, queryResult);
+            ret = index->evaluateQuery(*queryPtr, borderObjectsMap, queryResult);
             if (ret != DBERR_OK) {
                 return ret;
             }
@@ -128,6 +419,8 @@ namespace comm
 
         DB_STATUS evaluateQuery(SerializedMsg<char> &msg, std::unique_ptr<hec::QResultBase> &queryResult) {
             DB_STATUS ret = DBERR_OK;
+            // queries read the merged contents only
+            g_config.datasetOptions.mergeIndexUpdates();
 
             // unpack query
             char* localBuffer = msg.data;
@@ -144,9 +437,10 @@ namespace comm
                 return DBERR_OBJ_CREATION_FAILED;
             }
 
-            // evaluate query based on index (stored in R dataset)
-            ret = g_config.datasetOptions.getDatasetR()->index->evaluateQuery(queryPtr, queryResult);
+            // evaluate query based on the index of its dataset
+            ret = evaluateOnIndex(queryPtr, queryResult);
             if (ret != DBERR_OK) {
+                delete queryPtr;
                 return ret;
             }
 
@@ -156,6 +450,41 @@ namespace comm
             return ret;
         }
 
+        DB_STATUS evaluateQueries(std::vector<hec::Query*> &queries, std::vector<std::unique_ptr<hec::QResultBase>> &queryResults, std::vector<DB_STATUS> &queryStatus) {
+            // queries read the merged contents only
+            g_config.datasetOptions.mergeIndexUpdates();
+            queryResults.resize(queries.size());
+            queryStatus.assign(queries.size(), DBERR_OK);
+
+            // setup query result objects
+            for (int i = 0; i < queries.size(); i++) {
+                int res = qresult_factory::createNew(queries[i], queryResults[i]);
+                if (res != 0) {
+                    logger::log_error(DBERR_OBJ_CREATION_FAILED, "Failed to create query result objects for query", queries[i]->getQueryID());
+                    queryStatus[i] = DBERR_OBJ_CREATION_FAILED;
+                }
+            }
+
+            // range and kNN queries are small, evaluate them concurrently (one per thread)
+            #pragma omp parallel for num_threads(MAX_THREADS) schedule(dynamic)
+            for (int i = 0; i < queries.size(); i++) {
+                if (queryStatus[i] != DBERR_OK || (queries[i]->getQueryType() != hec::Q_RANGE && queries[i]->getQueryType() != hec::Q_KNN)) {
+                    continue;
+                }
+                queryStatus[i] = evaluateOnIndex(queries[i], queryResults[i]);
+            }
+
+            // joins are parallel internally, evaluate them one after the other
+            for (int i = 0; i < queries.size(); i++) {
+                if (queryStatus[i] != DBERR_OK || queries[i]->getQueryType() == hec::Q_RANGE || queries[i]->getQueryType() == hec::Q_KNN) {
+                    continue;
+                }
+                queryStatus[i] = evaluateOnIndex(queries[i], queryResults[i]);
+            }
+
+            return DBERR_OK;
+        }
+
         DB_STATUS batchRangeQueries(SerializedMsg<char> &msg, std::unordered_map<int, std::unique_ptr<hec::QResultBase>> &batchResults) {
             // unpack query batch
             std::vector<hec::Query*> queryBatch;
@@ -164,88 +493,78 @@ namespace comm
                 logger::log_error(ret, "Failed to unpack query.");
                 return ret;
             }
-            
-            // holds all the final batch results
-            std::vector<std::unordered_map<int, std::unique_ptr<hec::QResultBase>>> threadLocalMaps(MAX_THREADS);
-
-            #pragma omp parallel num_threads(MAX_THREADS)
-            {
-                int tid = omp_get_thread_num();
-                auto& localResults = threadLocalMaps[tid];
-                #pragma omp for
-                for (int i = 0; i < queryBatch.size(); i++) {
-                    std::unique_ptr<hec::QResultBase> queryResult;
-                    int res = qresult_factory::createNew(queryBatch[i], queryResult);
-                    if (res != 0) {
-                        logger::log_error(DBERR_OBJ_CREATION_FAILED, "Failed to create query result object.");
-                        #pragma omp cancel for
-                        ret = DBERR_OBJ_CREATION_FAILED;
-                        continue;
-                    }
-
-                    DB_STATUS local_ret = g_config.datasetOptions.getDatasetR()->index->evaluateQuery(queryBatch[i], queryResult);
-                    if (local_ret != DBERR_OK) {
-                        #pragma omp cancel for
-                        ret = local_ret;
-                    }
+            return batchRangeQueries(queryBatch, batchResults);
+        }
 
-                    int queryID = queryBatch[i]->getQueryID();
-                    localResults[queryID] = std::move(queryResult);
+        DB_STATUS batchRangeQueries(std::vector<hec::Query*> &queryBatch, std::unordered_map<int, std::unique_ptr<hec::QResultBase>> &batchResults) {
+            DB_STATUS ret = DBERR_OK;
+            // queries read the merged contents only
+            g_config.datasetOptions.mergeIndexUpdates();
+            // setup query result objects
+            std::vector<std::unique_ptr<hec::QResultBase>> queryResults(queryBatch.size());
+            for (int i = 0; i < queryBatch.size(); i++) {
+                int res = qresult_factory::createNew(queryBatch[i], queryResults[i]);
+                if (res != 0) {
+                    logger::log_error(DBERR_OBJ_CREATION_FAILED, "Failed to create query result object.");
+                    return DBERR_OBJ_CREATION_FAILED;
                 }
             }
-            if (ret != DBERR_OK) {
-                return ret;
+
+            // the range queries of a two-layer dataset share their partition scans, if there are enough of them
+            std::unordered_map<int, std::vector<int>> sharedScans;
+            for (int i = 0; i < queryBatch.size(); i++) {
+                if (queryBatch[i]->getQueryType() != hec::Q_RANGE) {
+                    continue;
+                }
+                int datasetID = dynamic_cast<hec::RangeQuery*>(queryBatch[i])->getDatasetID();
+                Dataset* dataset = g_config.datasetOptions.getDatasetByIdx(datasetID);
+                if (dataset != nullptr && dataset->index != nullptr && dataset->index->getType() == hec::IT_TWO_LAYER) {
+                    sharedScans[datasetID].push_back(i);
+                }
             }
-            // After parallel region, merge maps
-            for (auto& localMap : threadLocalMaps) {
-                for (auto& [qid, resultPtr] : localMap) {
-                    batchResults[qid] = std::move(resultPtr);
+            std::vector<bool> sharedScan(queryBatch.size(), false);
+            for (auto it = sharedScans.begin(); it != sharedScans.end(); ) {
+                if (it->second.size() < SHARED_SCAN_MIN_QUERIES) {
+                    it = sharedScans.erase(it);
+                    continue;
+                }
+                for (auto &i : it->second) {
+                    sharedScan[i] = true;
                 }
+                it++;
             }
 
-            return ret;
-        }
-
-        DB_STATUS batchRangeQueries(std::vector<hec::Query*> &queryBatch, std::unordered_map<int, std::unique_ptr<hec::QResultBase>> &batchResults) {
-            DB_STATUS ret = DBERR_OK;
-            // holds all the final batch results
-            std::vector<std::unordered_map<int, std::unique_ptr<hec::QResultBase>>> threadLocalMaps(MAX_THREADS);
-
-            #pragma omp parallel num_threads(MAX_THREADS)
-            {
-                int tid = omp_get_thread_num();
-                auto& localResults = threadLocalMaps[tid];
-                #pragma omp for
-                for (int i = 0; i < queryBatch.size(); i++) {
-                    std::unique_ptr<hec::QResultBase> queryResult;
-                    int res = qresult_factory::createNew(queryBatch[i], queryResult);
-                    if (res != 0) {
-                        logger::log_error(DBERR_OBJ_CREATION_FAILED, "Failed to create query result object.");
-                        #pragma omp cancel for
-                        ret = DBERR_OBJ_CREATION_FAILED;
-                        continue;
-                    }
-
-                    DB_STATUS local_ret = g_config.datasetOptions.getDatasetR()->index->evaluateQuery(queryBatch[i], queryResult);
-                    if (local_ret != DBERR_OK) {
-                        #pragma omp cancel for
-                        ret = local_ret;
-                    }
-
-                    int queryID = queryBatch[i]->getQueryID();
-                    localResults[queryID] = std::move(queryResult);
+            // the rest are evaluated concurrently (one per thread)
+            #pragma omp parallel for num_threads(MAX_THREADS) schedule(dynamic)
+            for (int i = 0; i < queryBatch.size(); i++) {
+                if (sharedScan[i]) {
+                    continue;
+                }
+                DB_STATUS local_ret = evaluateOnIndex(queryBatch[i], queryResults[i]);
+                if (local_ret != DBERR_OK) {
+                    #pragma omp critical
+                    ret = local_ret;
                 }
             }
             if (ret != DBERR_OK) {
                 return ret;
             }
-            // After parallel region, merge maps
-            for (auto& localMap : threadLocalMaps) {
-                for (auto& [qid, resultPtr] : localMap) {
-                    batchResults[qid] = std::move(resultPtr);
+            for (auto &[datasetID, positions] : sharedScans) {
+                std::vector<hec::RangeQuery*> rangeQueries;
+                std::vector<hec::QResultBase*> rangeResults;
+                for (auto &i : positions) {
+                    rangeQueries.push_back(dynamic_cast<hec::RangeQuery*>(queryBatch[i]));
+                    rangeResults.push_back(queryResults[i].get());
+                }
+                ret = twolayer::range_filter::evaluateBatch(g_config.datasetOptions.getDatasetByIdx(datasetID), rangeQueries, rangeResults);
+                if (ret != DBERR_OK) {
+                    return ret;
                 }
             }
 
+            for (int i = 0; i < queryBatch.size(); i++) {
+                batchResults[queryBatch[i]->getQueryID()] = std::move(queryResults[i]);
+            }
             return ret;
         }
 
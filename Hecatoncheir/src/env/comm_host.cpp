@@ -1,5 +1,9 @@
 #include "env/comm_common.h"
 #include "env/comm_host.h"
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <sys/stat.h>
 
 namespace comm
 {
@@ -39,6 +43,21 @@ namespace comm
             }
         }
 
+        /** @brief A query that has been broadcast to the workers and whose results are still being gathered. */
+        struct InFlightQuery {
+            hec::Query* query;
+            /** @brief only used if the host merges the results (RD_HOST) */
+            std::unique_ptr<hec::QResultBase> totalResults;
+            int pendingWorkers;
+            /** @brief result chunks the workers have sent to the driver (RD_TREE, RD_DIRECT) */
+            int deliveredChunks = 0;
+            /** @brief set if the query failed on any worker */
+            bool failed = false;
+        };
+
+        /** @brief The queries currently in flight, keyed by query ID. */
+        static std::unordered_map<int, InFlightQuery> inFlightQueries;
+
         DB_STATUS gatherResponses() {
             DB_STATUS ret = DBERR_OK;
             // use threads to parallelize gathering of responses
@@ -72,6 +91,93 @@ namespace comm
             return ret;
         }
 
+        /** @brief Forwards the memory footprint request to the workers and gathers their footprints. */
+        static DB_STATUS gatherMemoryFootprints(SerializedMsg<char> &requestMsg, std::vector<hec::MemoryFootprint> &allFootprints) {
+            DB_STATUS ret = broadcast::broadcastMessage(requestMsg, MSG_MEMORY_FOOTPRINT);
+            if (ret != DBERR_OK) {
+                return ret;
+            }
+            MPI_Status status;
+            for (int i=1; i<g_world_size; i++) {
+                ret = probe(i, MSG_MEMORY_FOOTPRINT, g_worker_comm, status);
+                if (ret != DBERR_OK) {
+                    return ret;
+                }
+                SerializedMsg<char> workerMsg(MPI_CHAR);
+                ret = recv::receiveMessage(status, workerMsg.type, g_worker_comm, workerMsg);
+                if (ret != DBERR_OK) {
+                    logger::log_error(ret, "Failed to receive memory footprint from worker", i);
+                    return ret;
+                }
+                std::vector<hec::MemoryFootprint> workerFootprint;
+                ret = unpack::unpackValues(workerMsg, workerFootprint);
+                if (ret != DBERR_OK) {
+                    logger::log_error(ret, "Failed to unpack memory footprint from worker", i);
+                    return ret;
+                }
+                workerMsg.clear();
+                allFootprints.insert(allFootprints.end(), workerFootprint.begin(), workerFootprint.end());
+            }
+            return ret;
+        }
+
+        /** @brief Decides whether the dataset of the prepare message may become resident: 
+         * fewer than maxResidentDatasets are resident and, if a memory budget is set, no worker would exceed it 
+         * with its resident datasets plus its share of the new one. The share is estimated as the dataset file's size 
+         * split evenly over the workers. */
+        static DB_STATUS admitDataset(SerializedMsg<char> &msg, bool &admitted) {
+            DB_STATUS ret = DBERR_OK;
+            admitted = g_config.datasetOptions.getResidentCount() < g_config.datasetOptions.maxResidentDatasets;
+            if (!admitted || g_config.datasetOptions.residentMemoryBudget == 0) {
+                return ret;
+            }
+            // estimate the new dataset's footprint on each worker
+            DatasetMetadata datasetMetadata;
+            ret = datasetMetadata.deserialize(msg.data, msg.count);
+            if (ret != DBERR_OK) {
+                logger::log_error(ret, "Failed to deserialize the dataset metadata.");
+                return ret;
+            }
+            struct stat fileStat;
+            if (stat(datasetMetadata.path.c_str(), &fileStat) == -1) {
+                logger::log_error(DBERR_MISSING_FILE, "Could not get the size of dataset file", datasetMetadata.path);
+                return DBERR_MISSING_FILE;
+            }
+            size_t incomingBytes = (size_t) fileStat.st_size / std::max(1, g_workers_size);
+            if (incomingBytes > g_config.datasetOptions.residentMemoryBudget) {
+                logger::log_warning("Dataset", datasetMetadata.path, "needs about", incomingBytes, "bytes per worker, over the budget of", g_config.datasetOptions.residentMemoryBudget);
+                admitted = false;
+                return ret;
+            }
+            // sum the footprints of the resident datasets per worker
+            std::unordered_map<int, size_t> workerBytes;
+            for (auto &dataset : g_config.datasetOptions.getDatasets()) {
+                SerializedMsg<char> requestMsg(MPI_CHAR);
+                int datasetIndex = dataset->metadata.internalID;
+                ret = pack::packValues(requestMsg, datasetIndex);
+                if (ret != DBERR_OK) {
+                    logger::log_error(ret, "Failed to pack memory footprint request.");
+                    return ret;
+                }
+                std::vector<hec::MemoryFootprint> footprints;
+                ret = gatherMemoryFootprints(requestMsg, footprints);
+                if (ret != DBERR_OK) {
+                    return ret;
+                }
+                requestMsg.clear();
+                for (auto &it : footprints) {
+                    workerBytes[it.rank] += it.geometryBytes + it.mbrBytes + it.indexBytes + it.aprilBytes + it.mapBytes;
+                }
+            }
+            for (auto &[rank, bytes] : workerBytes) {
+                if (bytes + incomingBytes > g_config.datasetOptions.residentMemoryBudget) {
+                    logger::log_warning("Worker", rank, "holds", bytes, "bytes of resident datasets and would receive about", incomingBytes, "more, over the budget of", g_config.datasetOptions.residentMemoryBudget);
+                    admitted = false;
+                }
+            }
+            return ret;
+        }
+
         static DB_STATUS handlePrepareDatasetMessage(MPI_Status &status) {
             SerializedMsg<char> msg(MPI_CHAR);
             // receive the message
@@ -79,17 +185,26 @@ namespace comm
             if (ret != DBERR_OK) {
                 return ret;
             }
-            // broadcast it to all workers
-            ret = broadcast::broadcastMessage(msg, status.MPI_TAG);
+            int tag = status.MPI_TAG;
+            // no node prepares a dataset that is not admitted, the driver gets id -1
+            bool admitted = false;
+            ret = admitDataset(msg, admitted);
             if (ret != DBERR_OK) {
                 return ret;
             }
-
-            // perform the preparation
             int id = -1;
-            ret = comm::execute::prepareDataset(msg, id);
-            if (ret != DBERR_OK) {
-                return ret;
+            if (admitted) {
+                // broadcast it to all workers
+                ret = broadcast::broadcastMessage(msg, tag);
+                if (ret != DBERR_OK) {
+                    return ret;
+                }
+
+                // perform the preparation
+                ret = comm::execute::prepareDataset(msg, id);
+                if (ret != DBERR_OK) {
+                    return ret;
+                }
             }
 
             // free memory
@@ -166,35 +281,15 @@ namespace comm
             return ret;
         }
 
-        static DB_STATUS handlePartitionDatasetMessage(MPI_Status &status) {
-            SerializedMsg<char> msg(MPI_CHAR);
-            // receive the message
-            DB_STATUS ret = recv::receiveMessage(status, msg.type, g_global_intra_comm, msg);
-            if (ret != DBERR_OK) {
-                return ret;
-            }
-            
-            // unpack the indexes of the datasets to partition
-            std::vector<int> datasetIndexes;
-            ret = unpack::unpackValues(msg, datasetIndexes);
-            if (ret != DBERR_OK) {
-                logger::log_error(ret, "Failed to unpack dataset indexes.");
-                return ret;
-            }
-
-            // free memory
-            msg.clear();
-
-            // double check if bounds are set for all datasets
+        /** @brief Fallback of the collective metadata computation: the host scans the datasets alone
+         * and sends each dataset's metadata to the workers. */
+        static DB_STATUS calculateMetadataOnHost(std::vector<int> &datasetIndexes) {
+            DB_STATUS ret = DBERR_OK;
             for (auto &index: datasetIndexes) {
                 Dataset* dataset = g_config.datasetOptions.getDatasetByIdx(index);
-                if (dataset == nullptr) {
-                    logger::log_error(DBERR_NULL_PTR_EXCEPTION, "Get dataset by index returned nullptr at partitioning. Index:", index);
-                    return DBERR_NULL_PTR_EXCEPTION;
-                }
                 if (!dataset->metadata.dataspaceMetadata.boundsSet) {
                     // calculate all metadata for dataset
-                    ret = storage::reader::calculateDatasetMetadata(g_config.datasetOptions.getDatasetByIdx(index));
+                    ret = storage::reader::calculateDatasetMetadata(dataset);
                     if (ret != DBERR_OK) {
                         return ret;
                     }
@@ -209,17 +304,18 @@ namespace comm
                 }
             }
             // update dataspace
-            g_config.datasetOptions.updateDataspace();
+            ret = g_config.datasetOptions.updateDataspace(datasetIndexes);
+            if (ret != DBERR_OK) {
+                return ret;
+            }
             g_config.datasetOptions.dataspaceMetadata.boundsSet = true;
 
             // update the grids' dataspace metadata in the partitioning object 
             g_config.partitioningMethod->setDistGridDataspace(g_config.datasetOptions.dataspaceMetadata);
             g_config.partitioningMethod->setPartGridDataspace(g_config.datasetOptions.dataspaceMetadata);
 
-            // perform the partitioning for each dataset in the message
-            for (auto &index : datasetIndexes) {
-                // get dataset to partition
-                Dataset* dataset = g_config.datasetOptions.getDatasetByIdx((DatasetIndex) index);
+            for (auto &index: datasetIndexes) {
+                Dataset* dataset = g_config.datasetOptions.getDatasetByIdx(index);
                 // serialize dataset metadata to send
                 SerializedMsg<char> datasetInfoMsg(MPI_CHAR);
                 ret = dataset->serialize(&datasetInfoMsg.data, datasetInfoMsg.count);
@@ -232,9 +328,74 @@ namespace comm
                 if (ret != DBERR_OK) {
                     return ret;
                 }
-
                 // free message
                 datasetInfoMsg.clear();
+            }
+            return ret;
+        }
+
+        static DB_STATUS handlePartitionDatasetMessage(MPI_Status &status) {
+            SerializedMsg<char> msg(MPI_CHAR);
+            // receive the message
+            DB_STATUS ret = recv::receiveMessage(status, msg.type, g_global_intra_comm, msg);
+            if (ret != DBERR_OK) {
+                return ret;
+            }
+            
+            // unpack the indexes of the datasets to partition
+            std::vector<int> datasetIndexes;
+            ret = unpack::unpackValues(msg, datasetIndexes);
+            if (ret != DBERR_OK) {
+                logger::log_error(ret, "Failed to unpack dataset indexes.");
+                return ret;
+            }
+
+            // free memory
+            msg.clear();
+
+            // compute the datasets' metadata collectively with the workers
+            std::vector<int> reduceContents;
+            for (auto &index: datasetIndexes) {
+                Dataset* dataset = g_config.datasetOptions.getDatasetByIdx(index);
+                if (dataset == nullptr) {
+                    logger::log_error(DBERR_NULL_PTR_EXCEPTION, "Get dataset by index returned nullptr at partitioning. Index:", index);
+                    return DBERR_NULL_PTR_EXCEPTION;
+                }
+                // if the bounds are set, only the objects are counted
+                reduceContents.emplace_back(index);
+                reduceContents.emplace_back(!dataset->metadata.dataspaceMetadata.boundsSet);
+            }
+            SerializedMsg<char> reduceMsg(MPI_CHAR);
+            ret = pack::packValues(reduceMsg, reduceContents);
+            if (ret != DBERR_OK) {
+                logger::log_error(ret, "Packing dataset metadata reduce message failed.");
+                return ret;
+            }
+            ret = broadcast::broadcastMessage(reduceMsg, MSG_DATASET_METADATA_REDUCE);
+            if (ret != DBERR_OK) {
+                return ret;
+            }
+            bool agreed = false;
+            ret = comm::execute::reduceDatasetMetadata(reduceMsg, agreed);
+            if (ret != DBERR_OK) {
+                logger::log_error(ret, "Collective dataset metadata computation failed.");
+                return ret;
+            }
+            reduceMsg.clear();
+
+            if (!agreed) {
+                // some node could not read its part, calculate all metadata on the host and send it to the workers
+                logger::log_warning("Not all nodes could scan the dataset files, computing the metadata on the host.");
+                ret = calculateMetadataOnHost(datasetIndexes);
+                if (ret != DBERR_OK) {
+                    return ret;
+                }
+            }
+
+            // perform the partitioning for each dataset in the message
+            for (auto &index : datasetIndexes) {
+                // get dataset to partition
+                Dataset* dataset = g_config.datasetOptions.getDatasetByIdx((DatasetIndex) index);
 
                 // signal the begining of the partitioning
                 SerializedMsg<char> signal(MPI_CHAR);
@@ -308,6 +469,225 @@ namespace comm
             return ret;
         }
 
+        /** @brief Records the lowest worker that keeps each inserted object in the dataset's directory, 
+         * by the distribution grid as in partitioning. Objects with invalid geometries are left unknown, the workers report them. */
+        static void routeInsertedObjects(Dataset* dataset, std::vector<std::pair<size_t, std::string>> &objects) {
+            Shape object;
+            bool canParse = shape_factory::createEmpty(dataset->metadata.dataType, object) == DBERR_OK;
+            std::vector<int> partitionIDs;
+            for (auto &it : objects) {
+                dataset->objectDirectory.forget(it.first);
+                if (!canParse) {
+                    continue;
+                }
+                object.reset();
+                object.recID = it.first;
+                if (object.setFromWKT(it.second) != DBERR_OK) {
+                    continue;
+                }
+                object.setMBR();
+                partitionIDs.clear();
+                if (partitioning::getPartitionsForMBR(object.mbr, partitionIDs) != DBERR_OK) {
+                    continue;
+                }
+                int owner = g_world_size;
+                for (auto &partitionID : partitionIDs) {
+                    owner = std::min(owner, g_config.partitioningMethod->getNodeRankForPartitionID(partitionID));
+                }
+                if (owner > 0 && owner < g_world_size) {
+                    dataset->objectDirectory.setOwner(it.first, owner);
+                }
+            }
+        }
+
+        static DB_STATUS handleObjectUpdateMessage(MPI_Status &status) {
+            SerializedMsg<char> msg(MPI_CHAR);
+            // receive the message
+            DB_STATUS ret = recv::receiveMessage(status, msg.type, g_global_intra_comm, msg);
+            if (ret != DBERR_OK) {
+                return ret;
+            }
+
+            if (status.MPI_TAG == MSG_INSERT_OBJECTS) {
+                // the inserted objects may be on other workers than the ones they were partitioned to
+                int datasetID;
+                std::vector<std::pair<size_t, std::string>> objects;
+                ret = unpack::unpackObjectInserts(msg, datasetID, objects);
+                if (ret != DBERR_OK) {
+                    logger::log_error(ret, "Failed to unpack object inserts.");
+                    return ret;
+                }
+                Dataset* dataset = g_config.datasetOptions.getDatasetByIdx(datasetID);
+                if (dataset != nullptr) {
+                    routeInsertedObjects(dataset, objects);
+                }
+            }
+
+            // broadcast it, the workers keep the objects that belong to them
+            ret = broadcast::broadcastMessage(msg, status.MPI_TAG);
+            if (ret != DBERR_OK) {
+                return ret;
+            }
+
+            // free memory
+            msg.clear();
+
+            // wait for ACK from everyone
+            ret = gatherResponses();
+            if (ret != DBERR_OK) {
+                logger::log_error(ret, "Not all nodes finished successfully.");
+                return ret;
+            }
+            
+            // send ACK to the driver
+            ret = comm::send::sendResponse(DRIVER_GLOBAL_RANK, MSG_ACK, g_global_intra_comm);
+            if (ret != DBERR_OK) {
+                logger::log_error(ret, "Failed sending ACK message to driver.");
+                return ret;
+            }
+            return ret;
+        }
+
+        static DB_STATUS handleSetPipelineMessage(MPI_Status &status) {
+            SerializedMsg<char> msg(MPI_CHAR);
+            // receive the message
+            DB_STATUS ret = recv::receiveMessage(status, msg.type, g_global_intra_comm, msg);
+            if (ret != DBERR_OK) {
+                return ret;
+            }
+
+            // the host decides how it waits for results, so it applies the settings too
+            ret = comm::execute::setPipeline(msg);
+            if (ret != DBERR_OK) {
+                return ret;
+            }
+
+            // broadcast it
+            ret = broadcast::broadcastMessage(msg, status.MPI_TAG);
+            if (ret != DBERR_OK) {
+                return ret;
+            }
+
+            // free memory
+            msg.clear();
+
+            // wait for ACK from everyone
+            ret = gatherResponses();
+            if (ret != DBERR_OK) {
+                logger::log_error(ret, "Not all nodes finished successfully.");
+                return ret;
+            }
+            
+            // send ACK to the driver
+            ret = comm::send::sendResponse(DRIVER_GLOBAL_RANK, MSG_ACK, g_global_intra_comm);
+            if (ret != DBERR_OK) {
+                logger::log_error(ret, "Failed sending ACK message to driver.");
+                return ret;
+            }
+            return ret;
+        }
+
+        /** @brief Gathers the rec IDs each worker loaded from its snapshot of the dataset and rebuilds the dataset's 
+         * object directory from them, with the lowest worker that holds each object. */
+        static DB_STATUS gatherSnapshotRecIDs(int datasetID) {
+            DB_STATUS ret = DBERR_OK;
+            MPI_Status status;
+            std::vector<std::vector<size_t>> workerRecIDs(g_world_size);
+            size_t recIDCount = 0;
+            for (int i=1; i<g_world_size; i++) {
+                ret = probe(i, MPI_ANY_TAG, g_worker_comm, status);
+                if (ret != DBERR_OK) {
+                    return ret;
+                }
+                if (status.MPI_TAG != MSG_LOAD_SNAPSHOT) {
+                    // a worker that failed to load answers with a NACK
+                    recv::receiveResponse(status.MPI_SOURCE, status.MPI_TAG, g_worker_comm, status);
+                    logger::log_error(DBERR_OPERATION_FAILED, "Worker", i, "finished with error");
+                    ret = DBERR_OPERATION_FAILED;
+                    continue;
+                }
+                SerializedMsg<char> workerMsg(MPI_CHAR);
+                ret = recv::receiveMessage(status, workerMsg.type, g_worker_comm, workerMsg);
+                if (ret != DBERR_OK) {
+                    return ret;
+                }
+                ret = unpack::unpackValues(workerMsg, workerRecIDs[i]);
+                workerMsg.clear();
+                if (ret != DBERR_OK) {
+                    logger::log_error(ret, "Failed to unpack the loaded rec IDs of worker", i);
+                    return ret;
+                }
+                for (auto &recID : workerRecIDs[i]) {
+                    recIDCount = std::max(recIDCount, recID + 1);
+                }
+            }
+            if (ret != DBERR_OK) {
+                return ret;
+            }
+            Dataset* dataset = g_config.datasetOptions.getDatasetByIdx(datasetID);
+            if (dataset == nullptr) {
+                return ret;
+            }
+            dataset->objectDirectory.reset(recIDCount);
+            // the lowest rank first, a replicated object keeps it
+            for (int i=g_world_size-1; i>0; i--) {
+                for (auto &recID : workerRecIDs[i]) {
+                    dataset->objectDirectory.setOwner(recID, i);
+                }
+            }
+            return ret;
+        }
+
+        static DB_STATUS handleSnapshotMessage(MPI_Status &status) {
+            SerializedMsg<char> msg(MPI_CHAR);
+            // receive the message
+            DB_STATUS ret = recv::receiveMessage(status, msg.type, g_global_intra_comm, msg);
+            if (ret != DBERR_OK) {
+                return ret;
+            }
+
+            // broadcast it, every worker saves/loads its own snapshot file
+            ret = broadcast::broadcastMessage(msg, status.MPI_TAG);
+            if (ret != DBERR_OK) {
+                return ret;
+            }
+
+            if (status.MPI_TAG == MSG_LOAD_SNAPSHOT) {
+                // the workers answer with the rec IDs they loaded, to rebuild the object directory
+                int datasetID;
+                std::string snapshotPath;
+                ret = unpack::unpackSnapshotRequest(msg, datasetID, snapshotPath);
+                msg.clear();
+                if (ret != DBERR_OK) {
+                    logger::log_error(ret, "Failed to unpack snapshot request.");
+                    return ret;
+                }
+                ret = gatherSnapshotRecIDs(datasetID);
+                if (ret != DBERR_OK) {
+                    logger::log_error(ret, "Not all nodes finished successfully.");
+                    return ret;
+                }
+            } else {
+                // free memory
+                msg.clear();
+
+                // wait for ACK from everyone
+                ret = gatherResponses();
+                if (ret != DBERR_OK) {
+                    logger::log_error(ret, "Not all nodes finished successfully.");
+                    return ret;
+                }
+            }
+            
+            // send ACK to the driver
+            ret = comm::send::sendResponse(DRIVER_GLOBAL_RANK, MSG_ACK, g_global_intra_comm);
+            if (ret != DBERR_OK) {
+                logger::log_error(ret, "Failed sending ACK message to driver.");
+                return ret;
+            }
+            return ret;
+        }
+
         static DB_STATUS handleLoadDatasetMessage(MPI_Status &status) {
             // SerializedMsg<char> msg(MPI_CHAR);
             // // receive the message
@@ -389,53 +769,37 @@ namespace comm
             return DBERR_FEATURE_UNSUPPORTED;
         }
         
-        static DB_STATUS gatherJoinResults(hec::Query* query, std::unique_ptr<hec::QResultBase>& totalResults) {
-            if (!totalResults) {
-                logger::log_error(DBERR_NULL_PTR_EXCEPTION, "Null query result pointer while gathering join results.");
-                return DBERR_NULL_PTR_EXCEPTION;
+        /** @brief Receives an already probed delivery notice {query ID, chunks} from a worker. */
+        static DB_STATUS receiveDeliveryNotice(MPI_Status &status, int &queryID, int &chunks) {
+            SerializedMsg<char> msg(MPI_CHAR);
+            DB_STATUS ret = recv::receiveMessage(status, msg.type, g_worker_comm, msg);
+            if (ret != DBERR_OK) {
+                logger::log_error(ret, "Failed to receive delivery notice from worker", status.MPI_SOURCE);
+                return ret;
             }
-            DB_STATUS ret = DBERR_OK;
-            MPI_Status status;
-            for (int i=1; i<g_world_size; i++) {
-                ret = probe(MPI_ANY_SOURCE, MPI_ANY_TAG, g_worker_comm, status);
-                if (ret != DBERR_OK) {
-                    logger::log_error(DBERR_COMM_PROBE_FAILED, "Join result message probing failed.");
-                    return ret;
-                }
-                // check tag
-                if (status.MPI_TAG == MSG_NACK) {
-                    // something failed during query evaluation
-                    ret = recv::receiveResponse(status.MPI_SOURCE, status.MPI_TAG, g_worker_comm, status);
-                    logger::log_error(DBERR_COMM_RECEIVED_NACK, "Received response from worker", i);
-                    return DBERR_COMM_RECEIVED_NACK;
-                } else {
-                    // receive result
-                    SerializedMsg<char> msg(MPI_CHAR);
-                    ret = recv::receiveMessage(status, msg.type, g_worker_comm, msg);
-                    if (ret != DBERR_OK) {
-                        logger::log_error(ret, "Failed to receive result message from worker", i);
-                        return ret;
-                    }
-                    // unpack
-                    std::unique_ptr<hec::QResultBase> workerResult;
-                    int res = qresult_factory::createNew(query, workerResult);
-                    if (res != 0) {
-                        logger::log_error(DBERR_OBJ_CREATION_FAILED, "Failed to create query result objects.");
-                        return DBERR_OBJ_CREATION_FAILED;
-                    }
-                    workerResult->deserialize(msg.data, msg.count);
-                    // add results
-                    ret = mergeResultObjects(totalResults.get(), workerResult.get());
-                    if (ret != DBERR_OK) {
-                        logger::log_error(ret, "Merging query results failed.");
-                        return ret;
-                    }
-                    // logger::log_task("Merged results", workerResult->getResultCount(), "from worker", i);
-                    // free memory
-                    msg.clear();
-                }
+            std::vector<int> messageContents;
+            ret = unpack::unpackValues(msg, messageContents);
+            msg.clear();
+            if (ret != DBERR_OK || messageContents.size() != 2) {
+                logger::log_error(DBERR_DESERIALIZE_FAILED, "Failed to unpack delivery notice.");
+                return DBERR_DESERIALIZE_FAILED;
             }
+            queryID = messageContents[0];
+            chunks = messageContents[1];
+            telemetry::attributeLastRecv(queryID);
+            return ret;
+        }
 
+        /** @brief Lets the driver know how many result chunks the workers sent it for the query, so it knows when the result is complete. 
+         * The tag is MSG_QUERY_RESULT_DELIVERED, or MSG_QUERY_FAILED if the query failed on any worker. */
+        static DB_STATUS sendDeliveryNotice(int queryID, int chunks, int tag = MSG_QUERY_RESULT_DELIVERED) {
+            SerializedMsg<char> msg(MPI_CHAR);
+            DB_STATUS ret = pack::packValues(msg, queryID, chunks);
+            if (ret != DBERR_OK) {
+                return ret;
+            }
+            ret = send::sendMessage(msg, DRIVER_GLOBAL_RANK, tag, g_global_intra_comm);
+            msg.clear();
             return ret;
         }
 
@@ -526,77 +890,164 @@ namespace comm
             return ret;
         }
 
-        static DB_STATUS performJoinQuery(MPI_Status &status, SerializedMsg<char> &msg, hec::Query* query) {
+        /** @brief Broadcasts the query to the workers (with the given tag) and registers it as in flight, without waiting for its results. */
+        static DB_STATUS dispatchQuery(SerializedMsg<char> &msg, hec::Query* query, int tag = MSG_QUERY) {
+            DB_STATUS ret = DBERR_OK;
+            if (inFlightQueries.find(query->getQueryID()) != inFlightQueries.end()) {
+                logger::log_error(DBERR_INVALID_PARAMETER, "Query with ID", query->getQueryID(), "is already in flight.");
+                return DBERR_INVALID_PARAMETER;
+            }
+            // broadcast query to every worker
+            ret = broadcast::broadcastMessage(msg, tag);
+            if (ret != DBERR_OK) {
+                return ret;
+            }
+            InFlightQuery inFlightQuery;
+            if (g_config.queryPipeline.resultDelivery == RD_HOST) {
+                // create total query result object
+                int res = qresult_factory::createNew(query, inFlightQuery.totalResults);
+                if (res != 0) {
+                    logger::log_error(DBERR_OBJ_CREATION_FAILED, "Failed to create query result object.");
+                    return DBERR_OBJ_CREATION_FAILED;
+                }
+            }
+            inFlightQuery.query = query;
+            inFlightQuery.pendingWorkers = g_workers_size;
+            inFlightQueries[query->getQueryID()] = std::move(inFlightQuery);
+            return ret;
+        }
+
+        /** @brief Sends the in-flight query's outcome to the driver once all workers have answered, and retires it: 
+         * its total result (RD_HOST), the number of result chunks the workers delivered (RD_TREE, RD_DIRECT), 
+         * or, if it failed on any worker, a failure notice with its ID (and the chunks the driver must still drain). */
+        static DB_STATUS completeInFlightQuery(std::unordered_map<int, InFlightQuery>::iterator it) {
             DB_STATUS ret = DBERR_OK;
-            // broadcast join query to every worker
-            ret = broadcast::broadcastMessage(msg, status.MPI_TAG);
+            int queryID = it->first;
+            int prevScope = telemetry::getQueryScope();
+            telemetry::setQueryScope(queryID);
+            if (it->second.failed) {
+                logger::log_error(DBERR_COMM_RECEIVED_NACK, "Query", queryID, "failed on a worker.");
+                ret = sendDeliveryNotice(queryID, it->second.deliveredChunks, MSG_QUERY_FAILED);
+            } else if (!it->second.totalResults) {
+                ret = sendDeliveryNotice(queryID, it->second.deliveredChunks);
+            } else {
+                // serialize results to message
+                SerializedMsg<char> resultMsg(MPI_CHAR);
+                double startTime = MPI_Wtime();
+                it->second.totalResults->serialize(&resultMsg.data, resultMsg.count);
+                telemetry::recordSerialization(DRIVER_GLOBAL_RANK, MSG_QUERY_RESULT, g_global_intra_comm, MPI_Wtime() - startTime);
+                // send result to driver
+                ret = send::sendMessage(resultMsg, DRIVER_GLOBAL_RANK, MSG_QUERY_RESULT, g_global_intra_comm);
+                // free memory
+                resultMsg.clear();
+            }
+            telemetry::setQueryScope(prevScope);
             if (ret != DBERR_OK) {
                 return ret;
             }
+            delete it->second.query;
+            inFlightQueries.erase(it);
+            return ret;
+        }
 
-            // create total query result object
-            std::unique_ptr<hec::QResultBase> totalResults;
-            int res = qresult_factory::createNew(query, totalResults);
-            if (res != 0) {
-                logger::log_error(DBERR_OBJ_CREATION_FAILED, "Failed to create query result object.");
-                return DBERR_OBJ_CREATION_FAILED;
-            }
-
-            // wait for results
-            ret = gatherJoinResults(query, totalResults);
+        /** @brief Receives an already probed delivery notice (MSG_QUERY_RESULT_DELIVERED) or failure notice (MSG_QUERY_FAILED) for an in-flight query.
+         * Once all workers have answered, the driver is notified. */
+        static DB_STATUS handleInFlightDeliveryNotice(MPI_Status &status) {
+            int queryID, chunks;
+            int tag = status.MPI_TAG;
+            DB_STATUS ret = receiveDeliveryNotice(status, queryID, chunks);
             if (ret != DBERR_OK) {
-                logger::log_error(ret, "Failed while gathering results for query.");
                 return ret;
             }
-
-            // serialize results to message
-            SerializedMsg<char> resultMsg(MPI_CHAR);
-            totalResults->serialize(&resultMsg.data, resultMsg.count);
-            // send result to driver
-            ret = send::sendMessage(resultMsg, DRIVER_GLOBAL_RANK, MSG_QUERY_RESULT, g_global_intra_comm);
-            if (ret != DBERR_OK) {
+            auto it = inFlightQueries.find(queryID);
+            if (it == inFlightQueries.end()) {
+                logger::log_error(DBERR_INVALID_PARAMETER, "Received delivery notice for query with ID", queryID, "which is not in flight.");
+                return DBERR_INVALID_PARAMETER;
+            }
+            if (tag == MSG_QUERY_FAILED) {
+                it->second.failed = true;
+            }
+            it->second.deliveredChunks += chunks;
+            it->second.pendingWorkers--;
+            if (it->second.pendingWorkers > 0) {
                 return ret;
             }
-            
-            // free memory
-            resultMsg.clear();
-            return ret;
+            // all workers answered
+            return completeInFlightQuery(it);
         }
 
-        static DB_STATUS performDistanceJoinQuery(MPI_Status &status, SerializedMsg<char> &msg, hec::Query* query) {
+        /** @brief Receives an already probed worker result for an in-flight query and merges it. 
+         * Once all workers have answered, the total result is sent to the driver. */
+        static DB_STATUS handleInFlightQueryResult(MPI_Status &status) {
             DB_STATUS ret = DBERR_OK;
-            // broadcast join query to every worker
-            ret = broadcast::broadcastMessage(msg, MSG_QUERY_DJ_INIT);
+            // check tag
+            if (status.MPI_TAG == MSG_NACK) {
+                // the worker failed outside of any query's evaluation
+                ret = recv::receiveResponse(status.MPI_SOURCE, status.MPI_TAG, g_worker_comm, status);
+                logger::log_error(DBERR_COMM_RECEIVED_NACK, "Received NACK from worker", status.MPI_SOURCE);
+                return DBERR_COMM_RECEIVED_NACK;
+            } else if (status.MPI_TAG == MSG_QUERY_RESULT_DELIVERED || status.MPI_TAG == MSG_QUERY_FAILED) {
+                // the result went to the driver or the query failed on the worker, only completion is tracked here
+                return handleInFlightDeliveryNotice(status);
+            } else if (status.MPI_TAG != MSG_QUERY_RESULT) {
+                logger::log_error(DBERR_COMM_INVALID_MSG_TAG, "Unexpected message with tag", status.MPI_TAG, "while gathering query results.");
+                return DBERR_COMM_INVALID_MSG_TAG;
+            }
+            // receive result
+            SerializedMsg<char> msg(MPI_CHAR);
+            ret = recv::receiveMessage(status, msg.type, g_worker_comm, msg);
             if (ret != DBERR_OK) {
+                logger::log_error(ret, "Failed to receive result message from worker", status.MPI_SOURCE);
                 return ret;
             }
-            
-            // create query result object
-            std::unique_ptr<hec::QResultBase> totalResults;
-            int res = qresult_factory::createNew(query, totalResults);
+            // match it to its query
+            int queryID = hec::QResultBase::getQueryIDFromSerializedBuffer(msg.data, msg.count);
+            auto it = inFlightQueries.find(queryID);
+            if (it == inFlightQueries.end()) {
+                logger::log_error(DBERR_INVALID_PARAMETER, "Received result for query with ID", queryID, "which is not in flight.");
+                msg.clear();
+                return DBERR_INVALID_PARAMETER;
+            }
+            telemetry::attributeLastRecv(queryID);
+            // unpack
+            std::unique_ptr<hec::QResultBase> workerResult;
+            int res = qresult_factory::createNew(it->second.query, workerResult);
             if (res != 0) {
-                logger::log_error(DBERR_OBJ_CREATION_FAILED, "Failed to create query result object.");
+                logger::log_error(DBERR_OBJ_CREATION_FAILED, "Failed to create query result objects.");
                 return DBERR_OBJ_CREATION_FAILED;
             }
-
-            // wait for final results 
-            ret = gatherJoinResults(query, totalResults);
+            workerResult->deserialize(msg.data, msg.count);
+            msg.clear();
+            // add results
+            ret = mergeResultObjects(it->second.totalResults.get(), workerResult.get());
             if (ret != DBERR_OK) {
-                logger::log_error(ret, "Failed while gathering results for query.");
+                logger::log_error(ret, "Merging query results failed.");
                 return ret;
             }
-
-            // serialize to message
-            SerializedMsg<char> resultMsg(MPI_CHAR);
-            totalResults->serialize(&resultMsg.data, resultMsg.count);
-            // send result to driver
-            ret = send::sendMessage(resultMsg, DRIVER_GLOBAL_RANK, MSG_QUERY_RESULT, g_global_intra_comm);
-            if (ret != DBERR_OK) {
+            it->second.pendingWorkers--;
+            if (it->second.pendingWorkers > 0) {
                 return ret;
             }
-            
-            // free memory
-            resultMsg.clear();
+            // all workers answered
+            return completeInFlightQuery(it);
+        }
+
+        /** @brief Blocks until every in-flight query has been answered. 
+         * Must precede any operation that gathers worker messages on its own. */
+        static DB_STATUS drainInFlightQueries() {
+            DB_STATUS ret = DBERR_OK;
+            MPI_Status status;
+            while (!inFlightQueries.empty()) {
+                ret = probe(MPI_ANY_SOURCE, MPI_ANY_TAG, g_worker_comm, status);
+                if (ret != DBERR_OK) {
+                    logger::log_error(DBERR_COMM_PROBE_FAILED, "Query result message probing failed.");
+                    return ret;
+                }
+                ret = handleInFlightQueryResult(status);
+                if (ret != DBERR_OK) {
+                    return ret;
+                }
+            }
             return ret;
         }
 
@@ -628,6 +1079,13 @@ namespace comm
                             ret = DBERR_COMM_RECEIVED_NACK;
                             logger::log_error(ret, "Received response from controller", i);
                         }
+                    } else if (status.MPI_TAG == MSG_QUERY_FAILED) {
+                        // the query failed on the worker
+                        int queryID, chunks;
+                        local_ret = receiveDeliveryNotice(status, queryID, chunks);
+                        #pragma omp cancel for
+                        ret = DBERR_COMM_RECEIVED_NACK;
+                        logger::log_error(ret, "Query", queryID, "failed on worker", i);
                     } else {
                         // receive result
                         SerializedMsg<char> msg(MPI_CHAR);
@@ -661,40 +1119,6 @@ namespace comm
             return ret;
         }
 
-        static DB_STATUS performKnnQuery(MPI_Status &status, SerializedMsg<char> &msg, hec::Query* query) {
-            DB_STATUS ret = DBERR_OK;
-            // broadcast knn query to every worker
-            ret = broadcast::broadcastMessage(msg, status.MPI_TAG);
-            if (ret != DBERR_OK) {
-                return ret;
-            }
-            // create query result object
-            std::unique_ptr<hec::QResultBase> totalResults;
-            int res = qresult_factory::createNew(query, totalResults);
-            if (res != 0) {
-                logger::log_error(DBERR_OBJ_CREATION_FAILED, "Failed to create query result object.");
-                return DBERR_OBJ_CREATION_FAILED;
-            }
-            // wait for result
-            ret = gatherkNNResults(query, totalResults);
-            if (ret != DBERR_OK) {
-                logger::log_error(ret, "Failed while gathering results for query.");
-                return ret;
-            }
-            // serialize to message
-            SerializedMsg<char> resultMsg(MPI_CHAR);
-            totalResults->serialize(&resultMsg.data, resultMsg.count);
-            // send result to driver
-            ret = send::sendMessage(resultMsg, DRIVER_GLOBAL_RANK, MSG_QUERY_RESULT, g_global_intra_comm);
-            if (ret != DBERR_OK) {
-                return ret;
-            }
-
-            // free memory
-            resultMsg.clear();
-            return ret;
-        }
-
         static DB_STATUS handleQueryMessage(MPI_Status &status) {
             SerializedMsg<char> msg(MPI_CHAR);
             // receive the message
@@ -710,8 +1134,12 @@ namespace comm
                 logger::log_error(DBERR_DESERIALIZE_FAILED, "Failed to create query from msg buffer.");
                 return DBERR_DESERIALIZE_FAILED;
             }
+            // the query's traffic is attributed to it, until the message has been handled
+            telemetry::attributeLastRecv(query->getQueryID());
+            telemetry::setQueryScope(query->getQueryID());
             
             switch (query->getQueryType()) {
+                case hec::Q_RANGE:
                 case hec::Q_INTERSECTION_JOIN:
                 case hec::Q_INSIDE_JOIN:
                 case hec::Q_DISJOINT_JOIN:
@@ -721,26 +1149,31 @@ namespace comm
                 case hec::Q_COVERS_JOIN:
                 case hec::Q_COVERED_BY_JOIN:
                 case hec::Q_FIND_RELATION_JOIN:
-                    // perform the Join
-                    ret = performJoinQuery(status, msg, query);
+                case hec::Q_KNN:
+                    // dispatch the query, its results are gathered asynchronously
+                    ret = dispatchQuery(msg, query);
                     if (ret != DBERR_OK) {
+                        delete query;
                         return ret;
                     }
-                    break;
+                    // the query is freed once its results have been gathered
+                    msg.clear();
+                    return ret;
                 case hec::Q_DISTANCE_JOIN:
-                    // perform the distance join
-                    ret = performDistanceJoinQuery(status, msg, query);
+                    // the workers exchange border objects with each other, so nothing else may be in flight
+                    ret = drainInFlightQueries();
                     if (ret != DBERR_OK) {
+                        delete query;
                         return ret;
                     }
-                    break;
-                case hec::Q_KNN:
-                    // perform the kNN
-                    ret = performKnnQuery(status, msg, query);
+                    ret = dispatchQuery(msg, query, MSG_QUERY_DJ_INIT);
                     if (ret != DBERR_OK) {
+                        delete query;
                         return ret;
                     }
-                    break;
+                    msg.clear();
+                    // and nothing else is dispatched until it completes
+                    return drainInFlightQueries();
                 default:
                     logger::log_error(DBERR_QUERY_INVALID_TYPE, "Invalid query type:", query->getQueryType());
                     return DBERR_QUERY_INVALID_TYPE;
@@ -817,11 +1250,13 @@ namespace comm
 
             // serialize final batch results
             SerializedMsg<char> finalResultsMsg(MPI_CHAR);
+            double startTime = MPI_Wtime();
             ret = pack::packBatchResults(allResultsMap, finalResultsMsg);
             if (ret != DBERR_OK) {
                 logger::log_error(ret, "Failed to pack final results.");
                 return ret;
             }
+            telemetry::recordSerialization(DRIVER_GLOBAL_RANK, MSG_QUERY_BATCH_RESULT, g_global_intra_comm, MPI_Wtime() - startTime);
 
             // send back to driver
             ret = send::sendMessage(finalResultsMsg, DRIVER_GLOBAL_RANK, MSG_QUERY_BATCH_RESULT, g_global_intra_comm);
@@ -868,8 +1303,8 @@ namespace comm
                     logger::log_error(DBERR_SERIALIZE_FAILED, "Failed to serialize knn query to message.");
                     return DBERR_SERIALIZE_FAILED;
                 }
-                // broadcast knn query to every worker
-                ret = broadcast::broadcastMessage(queryMsg, MSG_QUERY);
+                // broadcast knn query to every worker, the results are gathered here
+                ret = broadcast::broadcastMessage(queryMsg, MSG_QUERY_HOST_GATHERED);
                 if (ret != DBERR_OK) {
                     return ret;
                 }
@@ -904,11 +1339,13 @@ namespace comm
 
             // serialize final batch results
             SerializedMsg<char> finalResultsMsg(MPI_CHAR);
+            double startTime = MPI_Wtime();
             ret = pack::packBatchResults(batchResultsMap, finalResultsMsg);
             if (ret != DBERR_OK) {
                 logger::log_error(ret, "Failed to pack final results.");
                 return ret;
             }
+            telemetry::recordSerialization(DRIVER_GLOBAL_RANK, MSG_QUERY_BATCH_RESULT, g_global_intra_comm, MPI_Wtime() - startTime);
 
             // send back to driver
             ret = send::sendMessage(finalResultsMsg, DRIVER_GLOBAL_RANK, MSG_QUERY_BATCH_RESULT, g_global_intra_comm);
@@ -923,8 +1360,217 @@ namespace comm
             return ret;
         }
 
+        /** @brief Gathers the communication counters of every rank and sends them to the driver. */
+        static DB_STATUS handleTelemetryMessage(MPI_Status &status) {
+            SerializedMsg<char> msg(MPI_CHAR);
+            // receive the message
+            DB_STATUS ret = recv::receiveMessage(status, msg.type, g_global_intra_comm, msg);
+            if (ret != DBERR_OK) {
+                return ret;
+            }
+            // forward the request to the workers
+            ret = broadcast::broadcastMessage(msg, MSG_TELEMETRY);
+            if (ret != DBERR_OK) {
+                return ret;
+            }
+            // unpack the reset flag
+            std::vector<int> messageContents;
+            ret = unpack::unpackValues(msg, messageContents);
+            if (ret != DBERR_OK || messageContents.size() != 1) {
+                logger::log_error(DBERR_DESERIALIZE_FAILED, "Failed to unpack telemetry request.");
+                return DBERR_DESERIALIZE_FAILED;
+            }
+            bool reset = messageContents[0];
+            msg.clear();
+
+            // gather the workers' counters
+            std::vector<hec::CommStats> allStats;
+            for (int i=1; i<g_world_size; i++) {
+                ret = probe(i, MSG_TELEMETRY, g_worker_comm, status);
+                if (ret != DBERR_OK) {
+                    return ret;
+                }
+                SerializedMsg<char> workerMsg(MPI_CHAR);
+                ret = recv::receiveMessage(status, workerMsg.type, g_worker_comm, workerMsg);
+                if (ret != DBERR_OK) {
+                    logger::log_error(ret, "Failed to receive telemetry from worker", i);
+                    return ret;
+                }
+                std::vector<hec::CommStats> workerStats;
+                ret = unpack::unpackValues(workerMsg, workerStats);
+                if (ret != DBERR_OK) {
+                    logger::log_error(ret, "Failed to unpack telemetry from worker", i);
+                    return ret;
+                }
+                workerMsg.clear();
+                allStats.insert(allStats.end(), workerStats.begin(), workerStats.end());
+            }
+            // add the host's own
+            std::vector<hec::CommStats> hostStats = telemetry::collect(reset);
+            allStats.insert(allStats.end(), hostStats.begin(), hostStats.end());
+
+            // send them to the driver
+            SerializedMsg<char> statsMsg(MPI_CHAR);
+            ret = pack::packValues(statsMsg, allStats);
+            if (ret != DBERR_OK) {
+                logger::log_error(ret, "Failed to pack telemetry.");
+                return ret;
+            }
+            ret = send::sendMessage(statsMsg, DRIVER_GLOBAL_RANK, MSG_TELEMETRY, g_global_intra_comm);
+            if (ret != DBERR_OK) {
+                logger::log_error(ret, "Failed sending telemetry to driver.");
+                return ret;
+            }
+            statsMsg.clear();
+            return ret;
+        }
+
+        /** @brief Gathers the workers' memory footprint of a dataset and sends it to the driver. */
+        static DB_STATUS handleMemoryFootprintMessage(MPI_Status &status) {
+            SerializedMsg<char> msg(MPI_CHAR);
+            // receive the message
+            DB_STATUS ret = recv::receiveMessage(status, msg.type, g_global_intra_comm, msg);
+            if (ret != DBERR_OK) {
+                return ret;
+            }
+            // gather the workers' footprints
+            std::vector<hec::MemoryFootprint> allFootprints;
+            ret = gatherMemoryFootprints(msg, allFootprints);
+            if (ret != DBERR_OK) {
+                return ret;
+            }
+            msg.clear();
+
+            // send them to the driver
+            SerializedMsg<char> footprintMsg(MPI_CHAR);
+            ret = pack::packValues(footprintMsg, allFootprints);
+            if (ret != DBERR_OK) {
+                logger::log_error(ret, "Failed to pack memory footprints.");
+                return ret;
+            }
+            ret = send::sendMessage(footprintMsg, DRIVER_GLOBAL_RANK, MSG_MEMORY_FOOTPRINT, g_global_intra_comm);
+            if (ret != DBERR_OK) {
+                logger::log_error(ret, "Failed sending memory footprints to driver.");
+                return ret;
+            }
+            footprintMsg.clear();
+            return ret;
+        }
+
+        /** @brief Fetches objects by rec ID and sends them to the driver. 
+         * Each rec ID is requested only from the worker the object directory names for it, 
+         * the ones it does not know (e.g. inserted objects) from all workers. */
+        static DB_STATUS handleLookupObjectsMessage(MPI_Status &status) {
+            SerializedMsg<char> msg(MPI_CHAR);
+            // receive the message
+            DB_STATUS ret = recv::receiveMessage(status, msg.type, g_global_intra_comm, msg);
+            if (ret != DBERR_OK) {
+                return ret;
+            }
+            // dataset index, with geometry, rec IDs
+            std::vector<size_t> request;
+            ret = unpack::unpackValues(msg, request);
+            if (ret != DBERR_OK || request.size() < 2) {
+                logger::log_error(DBERR_DESERIALIZE_FAILED, "Failed to unpack object lookup request.");
+                return DBERR_DESERIALIZE_FAILED;
+            }
+            msg.clear();
+
+            // route the rec IDs to their workers
+            std::vector<std::vector<size_t>> workerRequests(g_world_size);
+            for (int i=1; i<g_world_size; i++) {
+                workerRequests[i] = {request[0], request[1]};
+            }
+            Dataset* dataset = g_config.datasetOptions.getDatasetByIdx(request[0]);
+            for (size_t i=2; i<request.size(); i++) {
+                int owner = dataset != nullptr ? dataset->objectDirectory.getOwner(request[i]) : 0;
+                if (owner > 0 && owner < g_world_size) {
+                    workerRequests[owner].emplace_back(request[i]);
+                } else {
+                    for (int j=1; j<g_world_size; j++) {
+                        workerRequests[j].emplace_back(request[i]);
+                    }
+                }
+            }
+            std::vector<int> targetRanks;
+            for (int i=1; i<g_world_size; i++) {
+                if (workerRequests[i].size() > 2) {
+                    SerializedMsg<char> workerMsg(MPI_CHAR);
+                    ret = pack::packValues(workerMsg, workerRequests[i]);
+                    if (ret != DBERR_OK) {
+                        logger::log_error(ret, "Failed to pack object lookup request for worker", i);
+                        return ret;
+                    }
+                    ret = send::sendMessage(workerMsg, i, MSG_LOOKUP_OBJECTS, g_worker_comm);
+                    if (ret != DBERR_OK) {
+                        logger::log_error(ret, "Failed sending object lookup request to worker", i);
+                        return ret;
+                    }
+                    workerMsg.clear();
+                    targetRanks.emplace_back(i);
+                }
+            }
+
+            // gather the objects, a replicated object is kept once
+            std::unordered_map<size_t, hec::ObjectRecord> found;
+            for (auto &rank : targetRanks) {
+                ret = probe(rank, MSG_LOOKUP_OBJECTS, g_worker_comm, status);
+                if (ret != DBERR_OK) {
+                    return ret;
+                }
+                SerializedMsg<char> workerMsg(MPI_CHAR);
+                ret = recv::receiveMessage(status, workerMsg.type, g_worker_comm, workerMsg);
+                if (ret != DBERR_OK) {
+                    logger::log_error(ret, "Failed to receive objects from worker", rank);
+                    return ret;
+                }
+                std::vector<hec::ObjectRecord> workerRecords;
+                ret = unpack::unpackObjectRecords(workerMsg, workerRecords);
+                if (ret != DBERR_OK) {
+                    logger::log_error(ret, "Failed to unpack objects from worker", rank);
+                    return ret;
+                }
+                workerMsg.clear();
+                for (auto &it : workerRecords) {
+                    found.emplace(it.recID, std::move(it));
+                }
+            }
+
+            // in the requested order, the missing ones left out
+            std::vector<hec::ObjectRecord> records;
+            records.reserve(found.size());
+            for (size_t i=2; i<request.size(); i++) {
+                auto it = found.find(request[i]);
+                if (it != found.end()) {
+                    records.emplace_back(std::move(it->second));
+                    found.erase(it);
+                }
+            }
+            SerializedMsg<char> recordsMsg(MPI_CHAR);
+            ret = pack::packObjectRecords(records, recordsMsg);
+            if (ret != DBERR_OK) {
+                logger::log_error(ret, "Failed to pack fetched objects.");
+                return ret;
+            }
+            ret = send::sendMessage(recordsMsg, DRIVER_GLOBAL_RANK, MSG_LOOKUP_OBJECTS, g_global_intra_comm);
+            if (ret != DBERR_OK) {
+                logger::log_error(ret, "Failed sending fetched objects to driver.");
+                return ret;
+            }
+            recordsMsg.clear();
+            return ret;
+        }
+
         static DB_STATUS pullIncoming(MPI_Status status) {
             DB_STATUS ret = DBERR_OK;
+            if (status.MPI_TAG != MSG_QUERY) {
+                // every other request gathers worker messages on its own, finish the in-flight queries first
+                ret = drainInFlightQueries();
+                if (ret != DBERR_OK) {
+                    logger::log_error(ret, "Failed while gathering in-flight query results.");
+                    return ret;
+                }
+            }
             // check message tag
             switch (status.MPI_TAG) {
                 case MSG_INSTR_FIN:
@@ -989,6 +1635,29 @@ namespace comm
                         return ret;
                     }
                     break;
+                case MSG_INSERT_OBJECTS:
+                case MSG_DELETE_OBJECTS:
+                    ret = handleObjectUpdateMessage(status);
+                    if (ret != DBERR_OK) {
+                        logger::log_error(ret, "Failed while handling object update message.");
+                        return ret;
+                    }
+                    break;
+                case MSG_SET_PIPELINE:
+                    ret = handleSetPipelineMessage(status);
+                    if (ret != DBERR_OK) {
+                        logger::log_error(ret, "Failed while handling set pipeline message.");
+                        return ret;
+                    }
+                    break;
+                case MSG_SAVE_SNAPSHOT:
+                case MSG_LOAD_SNAPSHOT:
+                    ret = handleSnapshotMessage(status);
+                    if (ret != DBERR_OK) {
+                        logger::log_error(ret, "Failed while handling snapshot message.");
+                        return ret;
+                    }
+                    break;
                 case MSG_QUERY:
                     /** Initiate query */
                     ret = handleQueryMessage(status);
@@ -1013,6 +1682,30 @@ namespace comm
                         return ret;
                     }
                     break;
+                case MSG_TELEMETRY:
+                    /** Gather communication counters */
+                    ret = handleTelemetryMessage(status);
+                    if (ret != DBERR_OK) {
+                        logger::log_error(ret, "Failed while handling telemetry message.");
+                        return ret;
+                    }
+                    break;
+                case MSG_MEMORY_FOOTPRINT:
+                    /** Gather the memory footprint of a dataset */
+                    ret = handleMemoryFootprintMessage(status);
+                    if (ret != DBERR_OK) {
+                        logger::log_error(ret, "Failed while handling memory footprint message.");
+                        return ret;
+                    }
+                    break;
+                case MSG_LOOKUP_OBJECTS:
+                    /** Fetch objects by rec ID */
+                    ret = handleLookupObjectsMessage(status);
+                    if (ret != DBERR_OK) {
+                        logger::log_error(ret, "Failed while handling object lookup message.");
+                        return ret;
+                    }
+                    break;
                 default:
                     // unkown instruction
                     logger::log_error(DBERR_COMM_WRONG_MESSAGE_ORDER, "Didn't expect message with tag", status.MPI_TAG);
@@ -1042,27 +1735,171 @@ namespace comm
             return ret;
         }
 
+        /** @brief While queries are in flight, the host blocks on the worker communicator alone and a watcher thread 
+         * waits for the next driver message in its place. Each wait is requested by the host. When the watcher finds
+         * a driver message, it keeps its status and wakes the host up with a MSG_DRIVER_PENDING message to itself. */
+        namespace driver_watch
+        {
+            enum WatchState {
+                WS_IDLE,
+                /** @brief the watcher waits for a driver message */
+                WS_REQUESTED,
+                /** @brief the host has been woken up, the driver message has not been received yet */
+                WS_READY,
+            };
+
+            /** @brief only changed by the host's thread */
+            static WatchState state = WS_IDLE;
+            static std::thread watcher;
+            static std::mutex mutex;
+            static std::condition_variable requestedCondition;
+            static bool probeRequested = false;
+            static bool stopRequested = false;
+            static MPI_Status driverStatus;
+            static DB_STATUS watcherRet = DBERR_OK;
+
+            static void watch() {
+                while (true) {
+                    {
+                        std::unique_lock<std::mutex> lock(mutex);
+                        requestedCondition.wait(lock, []{ return probeRequested || stopRequested; });
+                        if (stopRequested) {
+                            return;
+                        }
+                        probeRequested = false;
+                    }
+                    MPI_Status status;
+                    DB_STATUS ret = probe(DRIVER_GLOBAL_RANK, MPI_ANY_TAG, g_global_intra_comm, status);
+                    {
+                        std::lock_guard<std::mutex> lock(mutex);
+                        driverStatus = status;
+                        watcherRet = ret;
+                    }
+                    // host-internal, kept out of the telemetry
+                    int mpi_ret = MPI_Send(NULL, 0, MPI_CHAR, HOST_LOCAL_RANK, MSG_DRIVER_PENDING, g_worker_comm);
+                    if (mpi_ret != MPI_SUCCESS) {
+                        logger::log_error(DBERR_COMM_SEND, "Failed to wake up the host for a driver message.");
+                    }
+                }
+            }
+
+            static DB_STATUS start() {
+                // the watcher's probe runs concurrently with the host's MPI calls
+                int provided;
+                MPI_Query_thread(&provided);
+                if (provided < MPI_THREAD_MULTIPLE) {
+                    logger::log_error(DBERR_MPI_INIT_FAILED, "The host requires MPI_THREAD_MULTIPLE support.");
+                    return DBERR_MPI_INIT_FAILED;
+                }
+                watcher = std::thread(watch);
+                return DBERR_OK;
+            }
+
+            /** @brief Stops the watcher. A watcher still waiting for a driver message can't be interrupted, it is left behind. */
+            static void stop() {
+                {
+                    std::lock_guard<std::mutex> lock(mutex);
+                    stopRequested = true;
+                }
+                requestedCondition.notify_one();
+                if (state == WS_REQUESTED) {
+                    watcher.detach();
+                } else {
+                    watcher.join();
+                }
+            }
+
+            /** @brief Has the watcher wait for the next driver message, unless it already does or has found it. */
+            static void request() {
+                if (state != WS_IDLE) {
+                    return;
+                }
+                state = WS_REQUESTED;
+                {
+                    std::lock_guard<std::mutex> lock(mutex);
+                    probeRequested = true;
+                }
+                requestedCondition.notify_one();
+            }
+
+            /** @brief Receives the watcher's wake-up message, blocking until the watcher has found a driver message. */
+            static DB_STATUS receiveWakeUp() {
+                MPI_Status status;
+                int mpi_ret = MPI_Recv(NULL, 0, MPI_CHAR, HOST_LOCAL_RANK, MSG_DRIVER_PENDING, g_worker_comm, &status);
+                if (mpi_ret != MPI_SUCCESS) {
+                    logger::log_error(DBERR_COMM_RECV, "Failed to receive the host's wake-up message.");
+                    return DBERR_COMM_RECV;
+                }
+                state = WS_READY;
+                return DBERR_OK;
+            }
+
+            /** @brief Hands over the status of the driver message found by the watcher. */
+            static DB_STATUS takeDriverStatus(MPI_Status &status) {
+                std::lock_guard<std::mutex> lock(mutex);
+                status = driverStatus;
+                state = WS_IDLE;
+                return watcherRet;
+            }
+        }
+
         DB_STATUS listen() {
             MPI_Status status;
-            DB_STATUS ret = DBERR_OK;
+            DB_STATUS ret = driver_watch::start();
+            if (ret != DBERR_OK) {
+                return ret;
+            }
             // continuously listen for driver messages until termination is requested
             while(true){
-                // check for DRIVER messages  
-                // logger::log_task("Probing for messages from driver...");
-                ret = probe(DRIVER_GLOBAL_RANK, MPI_ANY_TAG, g_global_intra_comm, status);
-                if (ret != DBERR_OK){
-                    return ret;
+                // new driver messages are accepted unless the in-flight limit is reached
+                bool accept = inFlightQueries.size() < MAX_INFLIGHT_QUERIES;
+                if (inFlightQueries.empty() && driver_watch::state == driver_watch::WS_REQUESTED) {
+                    // the watcher is already waiting for the driver, wait for it
+                    ret = driver_watch::receiveWakeUp();
+                    if (ret != DBERR_OK) {
+                        break;
+                    }
+                }
+                if (accept && driver_watch::state == driver_watch::WS_READY) {
+                    ret = driver_watch::takeDriverStatus(status);
+                } else if (inFlightQueries.empty()) {
+                    // check for DRIVER messages
+                    ret = probe(DRIVER_GLOBAL_RANK, MPI_ANY_TAG, g_global_intra_comm, status);
+                } else {
+                    // queries are in flight: gather worker results, until the watcher finds a driver message that can be accepted
+                    if (accept) {
+                        driver_watch::request();
+                    }
+                    ret = probe(MPI_ANY_SOURCE, MPI_ANY_TAG, g_worker_comm, status);
+                    if (ret != DBERR_OK) {
+                        break;
+                    }
+                    if (status.MPI_TAG == MSG_DRIVER_PENDING) {
+                        ret = driver_watch::receiveWakeUp();
+                    } else {
+                        ret = handleInFlightQueryResult(status);
+                    }
+                    if (ret != DBERR_OK) {
+                        break;
+                    }
+                    continue;
+                }
+                if (ret != DBERR_OK) {
+                    break;
                 }
                 // driver has sent a message, propagate to everyone
                 ret = host::pullIncoming(status);
+                // whatever follows no longer belongs to the handled request's query
+                telemetry::setQueryScope(NO_QUERY_SCOPE);
                 if (ret == DB_FIN) {
                     // it was a termination message
                     break;
                 } else if (ret != DBERR_OK) {
                     // something went wrong
-                    return ret;
+                    break;
                 }
             }
+            driver_watch::stop();
             return ret;
         }
     }
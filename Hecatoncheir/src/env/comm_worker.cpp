@@ -17,11 +17,13 @@ namespace comm
                 SerializedMsg<char> msg(MPI_CHAR);
                 // logger::log_success("Sending batch of size", batch->objectCount);
                 // serialize (@todo: add try/catch for segfauls, mem access etc...)   
+                double startTime = MPI_Wtime();
                 ret = batch->serialize(&msg.data, msg.count);
                 if (ret != DBERR_OK) {
                     logger::log_error(DBERR_BATCH_FAILED, "Batch serialization failed");
                     return DBERR_BATCH_FAILED;
                 }
+                telemetry::recordSerialization(batch->destRank, batch->tag, *batch->comm, MPI_Wtime() - startTime);
                 ret = comm::send::sendMessage(msg, batch->destRank, batch->tag, *batch->comm);
                 if (ret != DBERR_OK) {
                     logger::log_error(ret, "Sending serialized geometry batch failed");
@@ -316,137 +318,390 @@ STOP_LISTENING:
         {
             #define NO_OBJECTS 0
 
-            static DB_STATUS distanceJoinHandleMessage(MPI_Status &status, std::vector<std::pair<size_t,size_t>> &exchangeCount, int &trackingCounter) {
-                DB_STATUS ret = DBERR_OK;
-        
-                SerializedMsg<char> msg(MPI_CHAR);
-                // receive the message
-                ret = recv::receiveMessage(status, msg.type, g_worker_comm, msg);
-                if (ret != DBERR_OK) {
-                    return ret;
+            /** @brief Upper bound on the (serialized) bytes of border replicas a node keeps. The least recently used pairs are evicted first. */
+            #define BORDER_REPLICA_CACHE_BYTES (256UL * 1024 * 1024)
+
+            /** @brief The border objects this node received in the last distance join of a dataset pair. */
+            struct BorderReplicas {
+                double epsilon;
+                std::vector<DJBatch> batches;
+                size_t bytes;
+                unsigned long long lastUse;
+            };
+
+            /** @brief Received border replicas, one entry per (R, S) dataset pair: the ones of the last join that exchanged border objects.
+             * Each node evicts by its own byte count, so in phase 1 every node reports the epsilon of its entry, and the entries 
+             * are only used if all nodes hold the replicas of the same join (see getCacheIdentity).
+             */
+            static std::map<std::pair<int,int>, BorderReplicas> g_borderReplicaCache;
+            /** @brief Total bytes of the cached border replicas. */
+            static size_t g_borderReplicaCacheBytes = 0;
+            /** @brief Increases on every cache access, to order the entries by last use. */
+            static unsigned long long g_borderReplicaCacheClock = 0;
+
+            /** @brief Drops all cached border replicas. Must be called whenever a dataset, its partitioning or the dataspace changes. */
+            static void invalidateBorderReplicas() {
+                g_borderReplicaCache.clear();
+                g_borderReplicaCacheBytes = 0;
+            }
+
+            /** @brief Drops the cached border replicas of the joins that involve the given dataset. */
+            static void invalidateBorderReplicas(int datasetID) {
+                for (auto it = g_borderReplicaCache.begin(); it != g_borderReplicaCache.end();) {
+                    if (it->first.first == datasetID || it->first.second == datasetID) {
+                        g_borderReplicaCacheBytes -= it->second.bytes;
+                        it = g_borderReplicaCache.erase(it);
+                    } else {
+                        it++;
+                    }
                 }
-                // unpack message
-                std::vector<size_t> values;
-                ret = unpack::unpackValues(msg, values);
-                if (ret != DBERR_OK) {
-                    return ret;
+            }
+
+            /** @brief The cache identity a node reports in phase 1 if it holds no replicas that cover the join. */
+            #define NO_CACHED_REPLICAS ULLONG_MAX
+
+            /** @brief Returns the identity of the cached replicas that phase 1 compares across the nodes: the bits of their epsilon, 
+             * or NO_CACHED_REPLICAS. The border objects and the send direction of every node pair only depend on the epsilon 
+             * (any change of the datasets drops the entries on all nodes), so equal epsilons mean the same exchange. */
+            static unsigned long long getCacheIdentity(const BorderReplicas* replicas) {
+                if (replicas == nullptr) {
+                    return NO_CACHED_REPLICAS;
+                }
+                unsigned long long identity;
+                memcpy(&identity, &replicas->epsilon, sizeof(double));
+                return identity;
+            }
+
+            /** @brief Returns the cached replicas that cover the given join, i.e. of the same pair with an epsilon >= the join's, or nullptr. */
+            static BorderReplicas* getCachedBorderReplicas(hec::DistanceJoinQuery* query) {
+                auto it = g_borderReplicaCache.find(std::make_pair(query->getDatasetRid(), query->getDatasetSid()));
+                if (it == g_borderReplicaCache.end() || query->getDistanceValue() > it->second.epsilon) {
+                    return nullptr;
+                }
+                it->second.lastUse = ++g_borderReplicaCacheClock;
+                return &it->second;
+            }
+
+            /** @brief Replaces the cached replicas of the pair with the ones received for the given join, if they fit in BORDER_REPLICA_CACHE_BYTES. 
+             * Every node replaces its entry after each exchange, even one that covers more, so that all entries come from the same join. */
+            static void cacheBorderReplicas(hec::DistanceJoinQuery* query, std::vector<DJBatch> &batches) {
+                auto key = std::make_pair(query->getDatasetRid(), query->getDatasetSid());
+                auto it = g_borderReplicaCache.find(key);
+                if (it != g_borderReplicaCache.end()) {
+                    g_borderReplicaCacheBytes -= it->second.bytes;
+                    g_borderReplicaCache.erase(it);
+                }
+                size_t bytes = 0;
+                for (auto &batch : batches) {
+                    bytes += batch.calculateBufferSize();
+                }
+                if (bytes > BORDER_REPLICA_CACHE_BYTES) {
+                    return;
+                }
+                // evict the least recently used pairs until the replicas fit
+                while (g_borderReplicaCacheBytes + bytes > BORDER_REPLICA_CACHE_BYTES) {
+                    auto lru = g_borderReplicaCache.begin();
+                    for (auto candidate = g_borderReplicaCache.begin(); candidate != g_borderReplicaCache.end(); candidate++) {
+                        if (candidate->second.lastUse < lru->second.lastUse) {
+                            lru = candidate;
+                        }
+                    }
+                    g_borderReplicaCacheBytes -= lru->second.bytes;
+                    g_borderReplicaCache.erase(lru);
+                }
+                g_borderReplicaCache[key] = BorderReplicas{query->getDistanceValue(), std::move(batches), bytes, ++g_borderReplicaCacheClock};
+                g_borderReplicaCacheBytes += bytes;
+            }
+
+            /** @brief Evaluates the join on the cached replicas instead of exchanging border objects. */
+            static DB_STATUS evaluateCachedBorderReplicas(hec::Query* query, BorderReplicas* replicas, const std::unique_ptr<hec::QResultBase> &queryResult) {
+                DB_STATUS ret = DBERR_OK;
+                for (auto &batch : replicas->batches) {
+                    // objects beyond the join's epsilon are filtered by the batch evaluation
+                    ret = execute::getQueryIndex(query)->evaluateDJBatch(query, batch, queryResult);
+                    if (ret != DBERR_OK) {
+                        return ret;
+                    }
                 }
-                // free memory
-                msg.clear();
-                // set to exchange map
-                exchangeCount[status.MPI_SOURCE].second = values[0] + values[1];
-                // increase tracking counter
-                trackingCounter++;
                 return ret;
             }
 
             /** @brief Phase 1 of DJ trafficking comprises of figuring out which node will send objects to which other nodes.
+             * The border object counts are exchanged through posted receives and sends, and handled in the order they arrive.
+             * Sets the send (first) and receive (second) count of every node in exchangeCount.
+             * @param[in] cacheIdentity The identity of this node's cached border replicas that cover the join (see getCacheIdentity).
+             * @param[out] allCached Whether every node holds covering replicas of the same identity, in which case the exchange is skipped.
+             */
+            static DB_STATUS distanceJoinPhase1(std::unordered_map<int, DJBatch> &borderObjectsMap, std::vector<std::pair<size_t,size_t>> &exchangeCount, unsigned long long cacheIdentity, bool &allCached) {
+                allCached = cacheIdentity != NO_CACHED_REPLICAS;
+                // {R objects, S objects, cache identity} per node
+                std::vector<std::array<unsigned long long, 3>> sendCounts(g_world_size);
+                std::vector<std::array<unsigned long long, 3>> recvCounts(g_world_size);
+                std::vector<MPI_Request> recvRequests;
+                std::vector<MPI_Request> sendRequests;
+                std::vector<int> recvRanks;
+                for (int nodeRank=1; nodeRank<g_world_size; nodeRank++) {
+                    // pair<send,receive>
+                    exchangeCount[nodeRank] = std::pair<size_t,size_t>(borderObjectsMap[nodeRank].objectsR.size() + borderObjectsMap[nodeRank].objectsS.size(), NO_OBJECTS);
+                    if (nodeRank == g_node_rank) {
+                        continue;
+                    }
+                    // post the receive first, so the peer's count lands directly in place
+                    MPI_Request request;
+                    int mpi_ret = MPI_Irecv(recvCounts[nodeRank].data(), 3, MPI_UNSIGNED_LONG_LONG, nodeRank, MSG_QUERY_DJ_COUNT, g_worker_comm, &request);
+                    if (mpi_ret != MPI_SUCCESS) {
+                        logger::log_error(DBERR_COMM_RECV, "Posting border object count receive failed. Node:", nodeRank);
+                        return DBERR_COMM_RECV;
+                    }
+                    recvRequests.emplace_back(request);
+                    recvRanks.emplace_back(nodeRank);
+                    // send this node's count
+                    sendCounts[nodeRank] = {borderObjectsMap[nodeRank].objectsR.size(), borderObjectsMap[nodeRank].objectsS.size(), cacheIdentity};
+                    mpi_ret = MPI_Isend(sendCounts[nodeRank].data(), 3, MPI_UNSIGNED_LONG_LONG, nodeRank, MSG_QUERY_DJ_COUNT, g_worker_comm, &request);
+                    if (mpi_ret != MPI_SUCCESS) {
+                        logger::log_error(DBERR_COMM_SEND, "Border object count send failed. Node:", nodeRank);
+                        return DBERR_COMM_SEND;
+                    }
+                    telemetry::recordSend(nodeRank, MSG_QUERY_DJ_COUNT, g_worker_comm, 3, MPI_UNSIGNED_LONG_LONG, 0);
+                    sendRequests.emplace_back(request);
+                }
+                // handle the counts as they arrive
+                for (int handled=0; handled<recvRequests.size(); handled++) {
+                    int index;
+                    MPI_Status status;
+                    double startTime = MPI_Wtime();
+                    int mpi_ret = MPI_Waitany(recvRequests.size(), recvRequests.data(), &index, &status);
+                    if (mpi_ret != MPI_SUCCESS || index == MPI_UNDEFINED) {
+                        logger::log_error(DBERR_COMM_RECV, "Waiting for border object counts failed.");
+                        return DBERR_COMM_RECV;
+                    }
+                    int nodeRank = recvRanks[index];
+                    telemetry::recordRecv(nodeRank, MSG_QUERY_DJ_COUNT, g_worker_comm, 3, MPI_UNSIGNED_LONG_LONG, MPI_Wtime() - startTime);
+                    exchangeCount[nodeRank].second = recvCounts[nodeRank][0] + recvCounts[nodeRank][1];
+                    allCached = allCached && recvCounts[nodeRank][2] == cacheIdentity;
+                }
+                // the send buffers go out of scope
+                int mpi_ret = MPI_Waitall(sendRequests.size(), sendRequests.data(), MPI_STATUSES_IGNORE);
+                if (mpi_ret != MPI_SUCCESS) {
+                    logger::log_error(DBERR_COMM_SEND, "Waiting for border object count sends failed.");
+                    return DBERR_COMM_SEND;
+                }
+                return DBERR_OK;
+            }
+
+            /** @brief Returns whether this node sends its border objects to nodeRank (otherwise, it receives nodeRank's).
+             * For each exchange, the node that has to send the LEAST number of elements performs the send.
+             * Special case: send=receive, the node with the lowest rank sends.
              */
-            static DB_STATUS distanceJoinPhase1(std::vector<std::pair<size_t,size_t>> &exchangeCount) {
+            static bool isSender(const std::vector<std::pair<size_t,size_t>> &exchangeCount, int nodeRank) {
+                return (exchangeCount[nodeRank].first < exchangeCount[nodeRank].second) || (exchangeCount[nodeRank].first == exchangeCount[nodeRank].second && g_node_rank < nodeRank);
+            }
+        
+            /** @brief Phase 2 of DJ sends data among the nodes.
+             * The sends are non-blocking, so that this node can start evaluating received batches right away.
+             * @param[out] sendRequests The posted sends, completed by distanceJoinCompleteSends().
+             * @param[out] sendBuffers The serialized batches, that must outlive their sends.
+             */
+            static DB_STATUS distanceJoinPhase2(const std::vector<std::pair<size_t,size_t>> &exchangeCount, std::unordered_map<int, DJBatch> &borderObjectsMap, std::vector<MPI_Request> &sendRequests, std::vector<SerializedMsg<char>> &sendBuffers) {
                 DB_STATUS ret = DBERR_OK;
-                MPI_Status status;
-                // track responses
-                int trackingCounter = 0;
-                // must receive N-1 messages at this stage
-                int trackingGoal = g_workers_size - 1;  
-                while (trackingCounter != trackingGoal) {
-                    // probe blockingly for messages by any worker
-                    ret = probe(MPI_ANY_SOURCE, MSG_QUERY_DJ_COUNT, g_worker_comm, status);
-                    if (ret != DBERR_OK) {
-                        return ret;
+                for (int nodeRank=1; nodeRank<g_world_size; nodeRank++) {
+                    if (nodeRank == g_node_rank || !isSender(exchangeCount, nodeRank)) {
+                        continue;
                     }
-                    // found message
-                    ret = distanceJoinHandleMessage(status, exchangeCount, trackingCounter);
+                    // serialize batch
+                    SerializedMsg<char> batchMsg(MPI_CHAR);
+                    double startTime = MPI_Wtime();
+                    ret = borderObjectsMap[nodeRank].serialize(&batchMsg.data, batchMsg.count);
                     if (ret != DBERR_OK) {
                         return ret;
                     }
+                    telemetry::recordSerialization(nodeRank, MSG_QUERY_DJ_BATCH, g_worker_comm, MPI_Wtime() - startTime);
+                    sendBuffers.emplace_back(batchMsg);
+                    // send batch
+                    MPI_Request request;
+                    int mpi_ret = MPI_Isend(batchMsg.data, batchMsg.count, batchMsg.type, nodeRank, MSG_QUERY_DJ_BATCH, g_worker_comm, &request);
+                    if (mpi_ret != MPI_SUCCESS) {
+                        logger::log_error(DBERR_COMM_SEND, "Sending border object batch failed. Node:", nodeRank);
+                        return DBERR_COMM_SEND;
+                    }
+                    telemetry::recordSend(nodeRank, MSG_QUERY_DJ_BATCH, g_worker_comm, batchMsg.count, batchMsg.type, 0);
+                    sendRequests.emplace_back(request);
                 }
                 return ret;
             }
-        
-            /** @brief Phase 2 of DJ sends data among the nodes.
-             * Behavior: for each exchange, the node that has to send the LEAST number of elements perform the send.
+
+            /** @brief Phase 3 of DJ receives the batches that were send in phase 2 and evaluates the rest of the DJ.
+             * Behavior: all nodes have posted what they need to send. Batches are evaluated in the order they arrive.
+             * @param[out] receivedBatches The evaluated batches, kept for reuse by later joins.
              */
-            static DB_STATUS distanceJoinPhase2(const std::vector<std::pair<size_t,size_t>> &exchangeCount, std::unordered_map<int, DJBatch> &borderObjectsMap) {
+            static DB_STATUS distanceJoinPhase3(const std::vector<std::pair<size_t,size_t>> &exchangeCount, hec::Query* query, const std::unique_ptr<hec::QResultBase> &queryResult, std::vector<DJBatch> &receivedBatches) {
                 DB_STATUS ret = DBERR_OK;
-                int messageFound = false;
                 MPI_Status status;
-        
+                // RECEIVER OF BATCH - opposite of the check in DJ phase 2
+                int expectedBatches = 0;
                 for (int nodeRank=1; nodeRank<g_world_size; nodeRank++) {
-                    if (nodeRank != g_node_rank) {
-                        // SENDER OF BATCH - only send to those nodes that have more object than this node to send back
-                        /** special case: send=receive. then the node with the lowest rank will SEND */
-                        if ((exchangeCount[nodeRank].first < exchangeCount[nodeRank].second) || (exchangeCount[nodeRank].first == exchangeCount[nodeRank].second && g_node_rank < nodeRank)) {                       
-                            SerializedMsg<char> requestRankMsg(MPI_CHAR);
-                            // pack node rank
-                            ret = pack::packValues(requestRankMsg, nodeRank);
-                            if (ret != DBERR_OK) {
-                                return ret;
-                            }
-                            // serialize batch
-                            SerializedMsg<char> batchMsg(MPI_CHAR);
-                            ret = borderObjectsMap[nodeRank].serialize(&batchMsg.data, batchMsg.count);
-                            if (ret != DBERR_OK) {
-                                return ret;
-                            }
-                            // send batch
-                            ret = send::sendMessage(batchMsg, nodeRank, MSG_QUERY_DJ_BATCH, g_worker_comm);
-                            if (ret != DBERR_OK) {
-                                return ret;
-                            }
-                            // free memory
-                            batchMsg.clear();
-                        }
+                    if (nodeRank != g_node_rank && !isSender(exchangeCount, nodeRank)) {
+                        expectedBatches++;
                     }
                 }
+                for (int received=0; received<expectedBatches; received++) {
+                    // wait for the next batch, from whichever node it comes first
+                    ret = probe(MPI_ANY_SOURCE, MSG_QUERY_DJ_BATCH, g_worker_comm, status);
+                    if (ret != DBERR_OK) {
+                        return ret;
+                    }
+                    // receive the batch
+                    SerializedMsg<char> batchMsg(MPI_CHAR);
+                    ret = recv::receiveMessage(status, batchMsg.type, g_worker_comm, batchMsg);
+                    if (ret != DBERR_OK) {
+                        return ret;
+                    }
+                    // unpack batch
+                    DJBatch batch;
+                    ret = batch.deserialize(batchMsg.data, batchMsg.count);
+                    if (ret != DBERR_OK) {
+                        return ret;
+                    }
+                    // free memory
+                    batchMsg.clear();
+
+                    // evaluate the distance join on the newly received objects
+                    // logger::log_success("Received", batch.objectsR.size(), "objects R and", batch.objectsS.size(), "objects S.");
+                    ret = execute::getQueryIndex(query)->evaluateDJBatch(query, batch, queryResult);
+                    if (ret != DBERR_OK) {
+                        return ret;
+                    }
+                    receivedBatches.emplace_back(std::move(batch));
+                }
                 return ret;
             }
 
-            /** @brief Phase 3 of DJ receives the batches that were send in phase 2 and evaluates the rest of the DJ.
-             * Behavior: all nodes have sent what they need to send. Now its receivin' time.
-             * Received batches are forwarded to the local AGENT for evaluation.
+            /** @brief Completes the sends posted in phase 2 and frees their buffers. */
+            static DB_STATUS distanceJoinCompleteSends(std::vector<MPI_Request> &sendRequests, std::vector<SerializedMsg<char>> &sendBuffers) {
+                int mpi_ret = MPI_Waitall(sendRequests.size(), sendRequests.data(), MPI_STATUSES_IGNORE);
+                for (auto &buffer : sendBuffers) {
+                    buffer.clear();
+                }
+                sendBuffers.clear();
+                sendRequests.clear();
+                if (mpi_ret != MPI_SUCCESS) {
+                    logger::log_error(DBERR_COMM_SEND, "Waiting for border object batch sends failed.");
+                    return DBERR_COMM_SEND;
+                }
+                return DBERR_OK;
+            }
+        }
+
+        /** @brief Delivery of a worker's query result to the driver, according to the configured result delivery type. */
+        namespace result_delivery
+        {
+            /** @brief Serializes the result and sends it with the given tag. */
+            static DB_STATUS sendResult(hec::QResultBase* result, int destRank, int tag, MPI_Comm &comm) {
+                SerializedMsg<char> resultMsg(MPI_CHAR);
+                double startTime = MPI_Wtime();
+                result->serialize(&resultMsg.data, resultMsg.count);
+                telemetry::recordSerialization(destRank, tag, comm, MPI_Wtime() - startTime);
+                DB_STATUS ret = send::sendMessage(resultMsg, destRank, tag, comm);
+                resultMsg.clear();
+                return ret;
+            }
+
+            /** @brief Lets the host know how many result chunks this worker sent to the driver for the query, 
+             * with MSG_QUERY_RESULT_DELIVERED or, if the query failed on this worker, MSG_QUERY_FAILED. */
+            static DB_STATUS notifyHost(int queryID, int chunks, int tag) {
+                SerializedMsg<char> msg(MPI_CHAR);
+                DB_STATUS ret = pack::packValues(msg, queryID, chunks);
+                if (ret != DBERR_OK) {
+                    return ret;
+                }
+                ret = send::sendMessage(msg, HOST_LOCAL_RANK, tag, g_worker_comm);
+                msg.clear();
+                return ret;
+            }
+
+            /** @brief Binary tree merge: in round s, worker i receives from worker i+s if i%2s == 0, or sends to worker i-s if i%2s == s. 
+             * Workers are numbered from 0 (node rank 1). Worker 0 ends up holding the total result.
+             * @param[out] isRoot Whether this worker holds the total result.
              */
-            static DB_STATUS distanceJoinPhase3(const std::vector<std::pair<size_t,size_t>> &exchangeCount, hec::Query* query, const std::unique_ptr<hec::QResultBase> &queryResult) {
+            static DB_STATUS mergeTree(hec::QResultBase* result, bool &isRoot) {
                 DB_STATUS ret = DBERR_OK;
                 MPI_Status status;
-                for (int nodeRank=1; nodeRank<g_world_size; nodeRank++) {
-                    if (nodeRank != g_node_rank) {
-                        // RECEIVER OF BATCH - opposite of the check in DJ phase 2
-                        // its expected that a batch from nodeRank has already be sent to this node
-                        // special case: send=receive, the node with the highest rank will RECEIVE
-                        if ((exchangeCount[nodeRank].first > exchangeCount[nodeRank].second) || (exchangeCount[nodeRank].first == exchangeCount[nodeRank].second && g_node_rank > nodeRank)) {
-                            // probe for the batch message from nodeRank
-                            ret = probe(nodeRank, MSG_QUERY_DJ_BATCH, g_worker_comm, status);
-                            if (ret != DBERR_OK) {
-                                return ret;
-                            }
-                            // receive the batch
-                            SerializedMsg<char> batchMsg(MPI_CHAR);
-                            ret = recv::receiveMessage(status, batchMsg.type, g_worker_comm, batchMsg);
-                            if (ret != DBERR_OK) {
-                                return ret;
-                            }
-                            // unpack batch
-                            DJBatch batch;
-                            ret = batch.deserialize(batchMsg.data, batchMsg.count);
-                            if (ret != DBERR_OK) {
-                                return ret;
-                            }
-
-                            // evaluate the distance join on the newly received objects
-                            // logger::log_success("Received", batch.objectsR.size(), "objects R and", batch.objectsS.size(), "objects S.");
-                            ret = g_config.datasetOptions.getDatasetR()->index->evaluateDJBatch(query, batch, queryResult);
-                            if (ret != DBERR_OK) {
-                                return ret;
-                            }
-
-                            // free memory
-                            batchMsg.clear();
-                        }
+                int index = g_node_rank - 1;
+                for (int step = 1; step < g_workers_size; step *= 2) {
+                    if (index % (2 * step) == step) {
+                        // send to parent and drop out of the tree
+                        isRoot = false;
+                        return sendResult(result, index - step + 1, MSG_QUERY_RESULT_MERGE, g_worker_comm);
+                    }
+                    int childRank = index + step + 1;
+                    if (childRank > g_workers_size) {
+                        continue;
+                    }
+                    // every worker delivers its results in the order the queries were broadcast, so the child's next result is for this query
+                    ret = probe(childRank, MSG_QUERY_RESULT_MERGE, g_worker_comm, status);
+                    if (ret != DBERR_OK) {
+                        return ret;
+                    }
+                    SerializedMsg<char> msg(MPI_CHAR);
+                    ret = recv::receiveMessage(status, msg.type, g_worker_comm, msg);
+                    if (ret != DBERR_OK) {
+                        return ret;
+                    }
+                    std::unique_ptr<hec::QResultBase> childResult(result->cloneEmpty());
+                    childResult->deserialize(msg.data, msg.count);
+                    msg.clear();
+                    ret = mergeResultObjects(result, childResult.get());
+                    if (ret != DBERR_OK) {
+                        logger::log_error(ret, "Merging query results failed.");
+                        return ret;
                     }
                 }
+                isRoot = true;
                 return ret;
             }
+
+            /** @brief Delivers this worker's result for a query. If the query failed on this worker (queryStatus), 
+             * the host is notified with MSG_QUERY_FAILED instead, so that only this query fails. In the merge tree, 
+             * a failed worker still passes on an empty result, so that its parent is not left waiting. */
+            static DB_STATUS deliverResult(hec::Query* query, std::unique_ptr<hec::QResultBase> &result, ResultDeliveryType resultDelivery, DB_STATUS queryStatus) {
+                DB_STATUS ret = DBERR_OK;
+                bool isRoot = false;
+                bool failed = queryStatus != DBERR_OK;
+                int noticeTag = failed ? MSG_QUERY_FAILED : MSG_QUERY_RESULT_DELIVERED;
+                if (failed && result) {
+                    // drop whatever was evaluated before the failure
+                    result.reset(result->cloneEmpty());
+                }
+                if (failed && (resultDelivery != RD_TREE || !result)) {
+                    // nothing to deliver (a result object that could not be created fails on every worker, so no merge tree waits for it)
+                    return notifyHost(query->getQueryID(), 0, MSG_QUERY_FAILED);
+                }
+                switch (resultDelivery) {
+                    case RD_HOST:
+                        // the host merges
+                        return sendResult(result.get(), HOST_LOCAL_RANK, MSG_QUERY_RESULT, g_worker_comm);
+                    case RD_TREE:
+                        // merge among the workers, only the root sends to the driver
+                        ret = mergeTree(result.get(), isRoot);
+                        if (ret != DBERR_OK) {
+                            return ret;
+                        }
+                        if (!isRoot) {
+                            return notifyHost(query->getQueryID(), 0, noticeTag);
+                        }
+                        // fallthrough
+                    case RD_DIRECT:
+                        // the driver merges
+                        ret = sendResult(result.get(), DRIVER_GLOBAL_RANK, MSG_QUERY_RESULT_CHUNK, g_global_intra_comm);
+                        if (ret != DBERR_OK) {
+                            return ret;
+                        }
+                        return notifyHost(query->getQueryID(), 1, noticeTag);
+                    default:
+                        logger::log_error(DBERR_INVALID_PARAMETER, "Unknown result delivery type:", resultDelivery);
+                        return DBERR_INVALID_PARAMETER;
+                }
+            }
         }
 
         /**
@@ -529,6 +784,7 @@ STOP_LISTENING:
         }
 
         static DB_STATUS handlePrepareDatasetMessage(MPI_Status &status) {
+            // a new dataset takes a free ID, whose replicas were dropped when it was unloaded
             SerializedMsg<char> msg(MPI_CHAR);
 
             // receive the message
@@ -567,6 +823,8 @@ STOP_LISTENING:
 
             // unload datasets
             for (auto &datasetID : messageContents) {
+                // the joins of the other resident datasets keep their cached border objects
+                distance_join::invalidateBorderReplicas(datasetID);
                 ret = g_config.datasetOptions.unloadDataset(datasetID);
                 if (ret != DBERR_OK) {
                     return ret;
@@ -583,6 +841,8 @@ STOP_LISTENING:
         }
 
         static DB_STATUS handleDatasetInfoMessage(MPI_Status &status) {
+            // the data changes, cached distance join border objects are stale
+            distance_join::invalidateBorderReplicas();
             SerializedMsg<char> msg(MPI_CHAR);
             // receive the message
             DB_STATUS ret = recv::receiveMessage(status, msg.type, g_worker_comm, msg);
@@ -616,7 +876,31 @@ STOP_LISTENING:
             return ret;
         }
 
+        static DB_STATUS handleDatasetMetadataReduceMessage(MPI_Status &status) {
+            // the data changes, cached distance join border objects are stale
+            distance_join::invalidateBorderReplicas();
+            SerializedMsg<char> msg(MPI_CHAR);
+            // receive the message
+            DB_STATUS ret = recv::receiveMessage(status, msg.type, g_worker_comm, msg);
+            if (ret != DBERR_OK) {
+                return ret;
+            }
+            // take part in the collective computation.
+            // if not agreed, the host sends the metadata with MSG_DATASET_METADATA instead
+            bool agreed = false;
+            ret = comm::execute::reduceDatasetMetadata(msg, agreed);
+            if (ret != DBERR_OK) {
+                logger::log_error(ret, "Collective dataset metadata computation failed.");
+                return ret;
+            }
+            // free memory
+            msg.clear();
+            return ret;
+        }
+
         static DB_STATUS handlePartitionDatasetMessage(MPI_Status &status) {
+            // the data changes, cached distance join border objects are stale
+            distance_join::invalidateBorderReplicas();
             SerializedMsg<char> msg(MPI_CHAR);
             // receive the message
             DB_STATUS ret = recv::receiveMessage(status, msg.type, g_worker_comm, msg);
@@ -674,6 +958,8 @@ STOP_LISTENING:
         }
 
         static DB_STATUS handleBuildIndexMessage(MPI_Status &status) {
+            // the data changes, cached distance join border objects are stale
+            distance_join::invalidateBorderReplicas();
             SerializedMsg<char> msg(MPI_CHAR);
             // receive the message
             DB_STATUS ret = recv::receiveMessage(status, msg.type, g_worker_comm, msg);
@@ -696,7 +982,116 @@ STOP_LISTENING:
             return ret;
         }
 
+        static DB_STATUS handleObjectUpdateMessage(MPI_Status &status) {
+            // the data changes, cached distance join border objects are stale
+            distance_join::invalidateBorderReplicas();
+            SerializedMsg<char> msg(MPI_CHAR);
+            // receive the message
+            DB_STATUS ret = recv::receiveMessage(status, msg.type, g_worker_comm, msg);
+            if (ret != DBERR_OK) {
+                return ret;
+            }
+
+            // apply the updates (merged into the index before the next query)
+            if (status.MPI_TAG == MSG_INSERT_OBJECTS) {
+                ret = comm::execute::insertObjects(msg);
+            } else {
+                ret = comm::execute::deleteObjects(msg);
+            }
+            if (ret != DBERR_OK) {
+                return ret;
+            }
+
+            // send ACK back that the updates have been applied successfully
+            ret = send::sendResponse(HOST_LOCAL_RANK, MSG_ACK, g_worker_comm);
+            if (ret != DBERR_OK) {
+                logger::log_error(ret, "Send ACK failed.");
+            }
+
+            return ret;
+        }
+
+        static DB_STATUS handleSetPipelineMessage(MPI_Status &status) {
+            SerializedMsg<char> msg(MPI_CHAR);
+            // receive the message
+            DB_STATUS ret = recv::receiveMessage(status, msg.type, g_worker_comm, msg);
+            if (ret != DBERR_OK) {
+                return ret;
+            }
+
+            ret = comm::execute::setPipeline(msg);
+            if (ret != DBERR_OK) {
+                return ret;
+            }
+
+            // send ACK back that the settings have been applied
+            ret = send::sendResponse(HOST_LOCAL_RANK, MSG_ACK, g_worker_comm);
+            if (ret != DBERR_OK) {
+                logger::log_error(ret, "Send ACK failed.");
+            }
+
+            return ret;
+        }
+
+        static DB_STATUS handleSnapshotMessage(MPI_Status &status) {
+            // a load replaces the data, cached distance join border objects are stale
+            distance_join::invalidateBorderReplicas();
+            SerializedMsg<char> msg(MPI_CHAR);
+            // receive the message
+            DB_STATUS ret = recv::receiveMessage(status, msg.type, g_worker_comm, msg);
+            if (ret != DBERR_OK) {
+                return ret;
+            }
+
+            if (status.MPI_TAG == MSG_SAVE_SNAPSHOT) {
+                ret = comm::execute::saveSnapshot(msg);
+            } else {
+                ret = comm::execute::loadSnapshot(msg);
+            }
+            if (ret != DBERR_OK) {
+                return ret;
+            }
+
+            if (status.MPI_TAG == MSG_LOAD_SNAPSHOT) {
+                // answer with the loaded rec IDs, the host rebuilds its object directory from them
+                int datasetID;
+                std::string snapshotPath;
+                ret = unpack::unpackSnapshotRequest(msg, datasetID, snapshotPath);
+                if (ret != DBERR_OK) {
+                    return ret;
+                }
+                Dataset *dataset = g_config.datasetOptions.getDatasetByIdx(datasetID);
+                std::vector<size_t> recIDs;
+                recIDs.reserve(dataset->objects.size());
+                for (auto &object : dataset->objects) {
+                    recIDs.emplace_back(object.recID);
+                }
+                SerializedMsg<char> recIDMsg(MPI_CHAR);
+                ret = pack::packValues(recIDMsg, recIDs);
+                if (ret != DBERR_OK) {
+                    logger::log_error(ret, "Failed to pack the loaded rec IDs.");
+                    return ret;
+                }
+                ret = send::sendMessage(recIDMsg, HOST_LOCAL_RANK, MSG_LOAD_SNAPSHOT, g_worker_comm);
+                recIDMsg.clear();
+                if (ret != DBERR_OK) {
+                    logger::log_error(ret, "Sending the loaded rec IDs failed.");
+                }
+                return ret;
+            }
+
+            // send ACK back that the snapshot has been saved successfully
+            ret = send::sendResponse(HOST_LOCAL_RANK, MSG_ACK, g_worker_comm);
+            if (ret != DBERR_OK) {
+                logger::log_error(ret, "Send ACK failed.");
+            }
+
+            return ret;
+        }
+
         static DB_STATUS handleLoadDatasetMessage(MPI_Status &status) {
+            // the data changes, cached distance join border objects are stale
+            distance_join::invalidateBorderReplicas();
             SerializedMsg<char> msg(MPI_CHAR);
             // receive the message
             DB_STATUS ret = recv::receiveMessage(status, msg.type, g_worker_comm, msg);
@@ -748,6 +1143,8 @@ STOP_LISTENING:
         }
 
         static DB_STATUS handleGlobalDataspaceMessage(MPI_Status &status) {
+            // the data changes, cached distance join border objects are stale
+            distance_join::invalidateBorderReplicas();
             SerializedMsg<double> msg(MPI_DOUBLE);
             // receive the message
             DB_STATUS ret = recv::receiveMessage(status, msg.type, g_worker_comm, msg);
@@ -771,38 +1168,80 @@ STOP_LISTENING:
             return ret;
         }
 
-        static DB_STATUS handleQueryMessage(MPI_Status &status) {
+        /** @brief Receives an already probed query message and unpacks the query. */
+        static DB_STATUS receiveQuery(MPI_Status &status, std::vector<hec::Query*> &queries) {
             SerializedMsg<char> msg(MPI_CHAR);
             // receive the message
             DB_STATUS ret = recv::receiveMessage(status, msg.type, g_worker_comm, msg);
             if (ret != DBERR_OK) {
                 return ret;
             }
+            // unpack query
+            char* localBuffer = msg.data;
+            hec::Query* query = hec::Query::createFromBuffer(localBuffer);
+            if (query == nullptr) {
+                logger::log_error(DBERR_DESERIALIZE_FAILED, "Failed to create query from msg buffer.");
+                return DBERR_DESERIALIZE_FAILED;
+            }
+            telemetry::attributeLastRecv(query->getQueryID());
+            queries.emplace_back(query);
+            // free message memory
+            msg.clear();
+            return ret;
+        }
 
-            // evaluate and store results in the result object (pointer)
-            // logger::log_task("Evaluating query...");
-            std::unique_ptr<hec::QResultBase> queryResult;
-            ret = execute::evaluateQuery(msg, queryResult);
+        /** @brief Evaluates the probed query, along with any other queries queued with the same tag.
+         * Queries with the MSG_QUERY_HOST_GATHERED tag always return their results to the host. */
+        static DB_STATUS handleQueryMessage(MPI_Status &status) {
+            int queryTag = status.MPI_TAG;
+            ResultDeliveryType resultDelivery = (queryTag == MSG_QUERY_HOST_GATHERED) ? RD_HOST : g_config.queryPipeline.resultDelivery;
+            std::vector<hec::Query*> queries;
+            DB_STATUS ret = receiveQuery(status, queries);
             if (ret != DBERR_OK) {
                 return ret;
             }
 
-            // free message memory
-            msg.clear();
-
-            // pack results to send
-            SerializedMsg<char> resultMsg(MPI_CHAR);
-            queryResult->serialize(&resultMsg.data, resultMsg.count);
+            // the host may have several queries in flight, pull the ones already queued so they are evaluated together
+            int messageFound = 1;
+            while (queries.size() < MAX_INFLIGHT_QUERIES) {
+                MPI_Status nextStatus;
+                ret = probe(HOST_LOCAL_RANK, queryTag, g_worker_comm, nextStatus, messageFound);
+                if (ret != DBERR_OK) {
+                    return ret;
+                }
+                if (!messageFound) {
+                    break;
+                }
+                ret = receiveQuery(nextStatus, queries);
+                if (ret != DBERR_OK) {
+                    return ret;
+                }
+            }
 
-            // send results
-            // logger::log_task("Sending", queryResult->getResultCount(), "query results.");
-            ret = send::sendMessage(resultMsg, HOST_LOCAL_RANK, MSG_QUERY_RESULT, g_worker_comm);
+            // evaluate and store results in the result objects
+            // logger::log_task("Evaluating", queries.size(), "queries...");
+            std::vector<std::unique_ptr<hec::QResultBase>> queryResults;
+            std::vector<DB_STATUS> queryStatus;
+            ret = execute::evaluateQueries(queries, queryResults, queryStatus);
             if (ret != DBERR_OK) {
                 return ret;
             }
 
-            // free message memory
-            resultMsg.clear();
+            // send results, the host matches them to their queries by ID
+            for (int i=0; i<queries.size(); i++) {
+                telemetry::setQueryScope(queries[i]->getQueryID());
+                // send results
+                // logger::log_task("Sending", queryResults[i]->getResultCount(), "query results.");
+                if (queryStatus[i] != DBERR_OK) {
+                    logger::log_error(queryStatus[i], "Query", queries[i]->getQueryID(), "failed.");
+                }
+                ret = result_delivery::deliverResult(queries[i], queryResults[i], resultDelivery, queryStatus[i]);
+                if (ret != DBERR_OK) {
+                    return ret;
+                }
+                // free memory
+                delete queries[i];
+            }
 
             return ret;
         }
@@ -819,78 +1258,87 @@ STOP_LISTENING:
             // batches of objects that rest on border areas
             std::unordered_map<int, DJBatch> borderObjectsMap;
             // keep the query reference
-            hec::Query* queryPtr;
+            hec::Query* queryPtr = nullptr;
             // evaluate DJ and buffer border objects
             ret = execute::evaluateDJQuery(msg, &queryPtr, borderObjectsMap, queryResult);
             if (ret != DBERR_OK) {
+                if (queryPtr == nullptr) {
+                    return ret;
+                }
+                // every worker rejects the query the same way before the exchange, so only this query fails
+                logger::log_error(ret, "Distance join", queryPtr->getQueryID(), "failed.");
+                ret = result_delivery::deliverResult(queryPtr, queryResult, g_config.queryPipeline.resultDelivery, ret);
+                delete queryPtr;
                 return ret;
             }
+            // the border object exchange and the result belong to the query
+            telemetry::attributeLastRecv(queryPtr->getQueryID());
+            telemetry::setQueryScope(queryPtr->getQueryID());
             // free message memory
             msg.clear();
 
-            // initialize exchange count map (send)
-            // and send exchange count to other workers
-            std::vector<std::pair<size_t,size_t>> exchangeCount(g_world_size);
-            for (int i=1; i<g_world_size; i++) {
-                // pair<send,receive>
-                exchangeCount[i] = std::pair<int,int>(borderObjectsMap[i].objectsR.size() + borderObjectsMap[i].objectsS.size(), NO_OBJECTS);  
-                if (i != g_node_rank) {
-                    // pack border object count for this node
-                    SerializedMsg<char> borderObjectSizesMsg(MPI_CHAR);
-                    ret = pack::packDJBatchSize(borderObjectsMap[i], borderObjectSizesMsg);
-                    if (ret != DBERR_OK) {
-                        return ret;
-                    }
-    
-                    // send
-                    ret = send::sendMessage(borderObjectSizesMsg, i, MSG_QUERY_DJ_COUNT, g_worker_comm);
-                    if (ret != DBERR_OK) {
-                        return ret;
-                    }
-                    // free memory
-                    borderObjectSizesMsg.clear();
-                }
+            hec::DistanceJoinQuery* distanceQuery = dynamic_cast<hec::DistanceJoinQuery*>(queryPtr);
+            if (distanceQuery == nullptr) {
+                logger::log_error(DBERR_INVALID_PARAMETER, "Distance join message does not contain a distance join query.");
+                return DBERR_INVALID_PARAMETER;
             }
+            distance_join::BorderReplicas* replicas = distance_join::getCachedBorderReplicas(distanceQuery);
 
-            
             // phase 1 - figure out who needs to send which data to whom. 
-            // Sets exchange (receive) count for all workers
-            ret = distance_join::distanceJoinPhase1(exchangeCount);
+            // Sets exchange (send, receive) count for all workers
+            std::vector<std::pair<size_t,size_t>> exchangeCount(g_world_size);
+            bool allCached = false;
+            ret = distance_join::distanceJoinPhase1(borderObjectsMap, exchangeCount, distance_join::getCacheIdentity(replicas), allCached);
             if (ret != DBERR_OK) {
                 logger::log_error(ret, "Distance Join Phase 1 failed.");
                 return ret;
             }
+
+            // a join of the same pair with a smaller or equal epsilon needs no exchange, if every node holds the replicas of that join
+            if (allCached) {
+                ret = distance_join::evaluateCachedBorderReplicas(queryPtr, replicas, queryResult);
+                if (ret != DBERR_OK) {
+                    logger::log_error(ret, "Distance Join on cached border objects failed.");
+                    return ret;
+                }
+                ret = result_delivery::deliverResult(queryPtr, queryResult, g_config.queryPipeline.resultDelivery, DBERR_OK);
+                delete queryPtr;
+                return ret;
+            }
     
-            // phase 2 - send border object data to those workers necessary
-            ret = distance_join::distanceJoinPhase2(exchangeCount, borderObjectsMap);
+            // phase 2 - post the border object data sends to those workers necessary
+            std::vector<MPI_Request> sendRequests;
+            std::vector<SerializedMsg<char>> sendBuffers;
+            ret = distance_join::distanceJoinPhase2(exchangeCount, borderObjectsMap, sendRequests, sendBuffers);
             if (ret != DBERR_OK) {
                 logger::log_error(ret, "Distance Join Phase 2 failed.");
+                distance_join::distanceJoinCompleteSends(sendRequests, sendBuffers);
                 return ret;
             }
 
-            // phase 3 - receive data that was sent to this worker and evaluate
-            ret = distance_join::distanceJoinPhase3(exchangeCount, queryPtr, queryResult);
+            // phase 3 - receive data that was sent to this worker and evaluate, while the sends progress
+            std::vector<DJBatch> receivedBatches;
+            ret = distance_join::distanceJoinPhase3(exchangeCount, queryPtr, queryResult, receivedBatches);
             if (ret != DBERR_OK) {
                 logger::log_error(ret, "Distance Join Phase 3 failed.");
+                distance_join::distanceJoinCompleteSends(sendRequests, sendBuffers);
                 return ret;
             }
+            ret = distance_join::distanceJoinCompleteSends(sendRequests, sendBuffers);
+            if (ret != DBERR_OK) {
+                return ret;
+            }
+            // keep the received border objects for later joins of the same pair, in place of any cached ones on every node
+            distance_join::cacheBorderReplicas(distanceQuery, receivedBatches);
 
+            // send results
+            ret = result_delivery::deliverResult(queryPtr, queryResult, g_config.queryPipeline.resultDelivery, DBERR_OK);
             // free query memory
             delete queryPtr;
-
-            // pack results to send
-            SerializedMsg<char> resultMsg(MPI_CHAR);
-            queryResult->serialize(&resultMsg.data, resultMsg.count);
-
-            // send results
-            ret = send::sendMessage(resultMsg, HOST_LOCAL_RANK, MSG_QUERY_RESULT, g_worker_comm);
             if (ret != DBERR_OK) {
                 return ret;
             }
 
-            // free message memory
-            resultMsg.clear();
-
             return ret;
         }
 
@@ -915,11 +1363,13 @@ STOP_LISTENING:
             
             // Pack results
             SerializedMsg<char> batchResultMsg(MPI_CHAR);
+            double startTime = MPI_Wtime();
             ret = pack::packBatchResults(batchResults, batchResultMsg);
             if (ret != DBERR_OK) {
                 logger::log_error(ret, "Failed to pack batch results.");
                 return ret;
             }
+            telemetry::recordSerialization(HOST_LOCAL_RANK, MSG_QUERY_BATCH_RESULT, g_worker_comm, MPI_Wtime() - startTime);
 
             // Send results
             ret = send::sendMessage(batchResultMsg, HOST_LOCAL_RANK, MSG_QUERY_BATCH_RESULT, g_worker_comm);
@@ -934,6 +1384,130 @@ STOP_LISTENING:
             return ret;
         }
 
+        /** @brief Sends this worker's communication counters to the host. */
+        static DB_STATUS handleTelemetryMessage(MPI_Status &status) {
+            SerializedMsg<char> msg(MPI_CHAR);
+            // receive the message
+            DB_STATUS ret = recv::receiveMessage(status, msg.type, g_worker_comm, msg);
+            if (ret != DBERR_OK) {
+                return ret;
+            }
+            // unpack the reset flag
+            std::vector<int> messageContents;
+            ret = unpack::unpackValues(msg, messageContents);
+            if (ret != DBERR_OK || messageContents.size() != 1) {
+                logger::log_error(DBERR_DESERIALIZE_FAILED, "Failed to unpack telemetry request.");
+                return DBERR_DESERIALIZE_FAILED;
+            }
+            msg.clear();
+            // pack and send the counters
+            std::vector<hec::CommStats> stats = telemetry::collect(messageContents[0]);
+            SerializedMsg<char> statsMsg(MPI_CHAR);
+            ret = pack::packValues(statsMsg, stats);
+            if (ret != DBERR_OK) {
+                logger::log_error(ret, "Failed to pack telemetry.");
+                return ret;
+            }
+            ret = send::sendMessage(statsMsg, HOST_LOCAL_RANK, MSG_TELEMETRY, g_worker_comm);
+            if (ret != DBERR_OK) {
+                return ret;
+            }
+            statsMsg.clear();
+            return ret;
+        }
+
+        /** @brief Sends this worker's memory footprint of the requested dataset to the host. */
+        static DB_STATUS handleMemoryFootprintMessage(MPI_Status &status) {
+            SerializedMsg<char> msg(MPI_CHAR);
+            // receive the message
+            DB_STATUS ret = recv::receiveMessage(status, msg.type, g_worker_comm, msg);
+            if (ret != DBERR_OK) {
+                return ret;
+            }
+            // unpack the dataset index
+            std::vector<int> messageContents;
+            ret = unpack::unpackValues(msg, messageContents);
+            if (ret != DBERR_OK || messageContents.size() != 1) {
+                logger::log_error(DBERR_DESERIALIZE_FAILED, "Failed to unpack memory footprint request.");
+                return DBERR_DESERIALIZE_FAILED;
+            }
+            msg.clear();
+            // a dataset that is not loaded holds no memory
+            std::vector<hec::MemoryFootprint> footprint(1);
+            footprint[0].rank = g_global_rank;
+            footprint[0].datasetID = messageContents[0];
+            Dataset* dataset = g_config.datasetOptions.getDatasetByIdx(messageContents[0]);
+            if (dataset != nullptr) {
+                dataset->measureMemory(footprint[0]);
+            }
+            // pack and send it
+            SerializedMsg<char> footprintMsg(MPI_CHAR);
+            ret = pack::packValues(footprintMsg, footprint);
+            if (ret != DBERR_OK) {
+                logger::log_error(ret, "Failed to pack memory footprint.");
+                return ret;
+            }
+            ret = send::sendMessage(footprintMsg, HOST_LOCAL_RANK, MSG_MEMORY_FOOTPRINT, g_worker_comm);
+            if (ret != DBERR_OK) {
+                return ret;
+            }
+            footprintMsg.clear();
+            return ret;
+        }
+
+        /** @brief Sends the requested objects this worker holds (rec ID, MBR and, if requested, WKT) to the host. */
+        static DB_STATUS handleLookupObjectsMessage(MPI_Status &status) {
+            SerializedMsg<char> msg(MPI_CHAR);
+            // receive the message
+            DB_STATUS ret = recv::receiveMessage(status, msg.type, g_worker_comm, msg);
+            if (ret != DBERR_OK) {
+                return ret;
+            }
+            // dataset index, with geometry, rec IDs
+            std::vector<size_t> request;
+            ret = unpack::unpackValues(msg, request);
+            if (ret != DBERR_OK || request.size() < 2) {
+                logger::log_error(DBERR_DESERIALIZE_FAILED, "Failed to unpack object lookup request.");
+                return DBERR_DESERIALIZE_FAILED;
+            }
+            msg.clear();
+            // a dataset that is not loaded holds no objects
+            std::vector<hec::ObjectRecord> records;
+            Dataset* dataset = g_config.datasetOptions.getDatasetByIdx(request[0]);
+            if (dataset != nullptr) {
+                bool withGeometry = request[1];
+                for (size_t i=2; i<request.size(); i++) {
+                    Shape* object = dataset->findObject(request[i]);
+                    if (object == nullptr) {
+                        continue;
+                    }
+                    hec::ObjectRecord record;
+                    record.recID = object->recID;
+                    record.xMin = object->mbr.pMin.x;
+                    record.yMin = object->mbr.pMin.y;
+                    record.xMax = object->mbr.pMax.x;
+                    record.yMax = object->mbr.pMax.y;
+                    if (withGeometry) {
+                        record.wkt = object->getWKT();
+                    }
+                    records.emplace_back(std::move(record));
+                }
+            }
+            // pack and send them
+            SerializedMsg<char> recordsMsg(MPI_CHAR);
+            ret = pack::packObjectRecords(records, recordsMsg);
+            if (ret != DBERR_OK) {
+                logger::log_error(ret, "Failed to pack fetched objects.");
+                return ret;
+            }
+            ret = send::sendMessage(recordsMsg, HOST_LOCAL_RANK, MSG_LOOKUP_OBJECTS, g_worker_comm);
+            if (ret != DBERR_OK) {
+                return ret;
+            }
+            recordsMsg.clear();
+            return ret;
+        }
+
         /**
         @brief pulls incoming message sent by the local controller 
          * (the one probed last, whose metadata is stored in the status parameter)
@@ -975,6 +1549,12 @@ STOP_LISTENING:
                         return ret;
                     }
                     break;
+                case MSG_DATASET_METADATA_REDUCE:
+                    ret = handleDatasetMetadataReduceMessage(status);
+                    if (ret != DBERR_OK) {
+                        return ret;
+                    }
+                    break;
                 case MSG_PARTITION_DATASET:
                     // logger::log_success("MSG_PARTITION_DATASET");
                     ret = handlePartitionDatasetMessage(status);
@@ -998,6 +1578,29 @@ STOP_LISTENING:
                         return ret;
                     }
                     break;
+                case MSG_INSERT_OBJECTS:
+                case MSG_DELETE_OBJECTS:
+                    ret = handleObjectUpdateMessage(status);
+                    if (ret != DBERR_OK) {
+                        logger::log_error(ret, "Failed while handling object update message.");
+                        return ret;
+                    }
+                    break;
+                case MSG_SET_PIPELINE:
+                    ret = handleSetPipelineMessage(status);
+                    if (ret != DBERR_OK) {
+                        logger::log_error(ret, "Failed while handling set pipeline message.");
+                        return ret;
+                    }
+                    break;
+                case MSG_SAVE_SNAPSHOT:
+                case MSG_LOAD_SNAPSHOT:
+                    ret = handleSnapshotMessage(status);
+                    if (ret != DBERR_OK) {
+                        logger::log_error(ret, "Failed while handling snapshot message.");
+                        return ret;
+                    }
+                    break;
                 case MSG_GLOBAL_DATASPACE:
                     // logger::log_success("MSG_GLOBAL_DATASPACE");
                     ret = handleGlobalDataspaceMessage(status);
@@ -1007,6 +1610,7 @@ STOP_LISTENING:
                     }
                     break;
                 case MSG_QUERY:
+                case MSG_QUERY_HOST_GATHERED:
                     ret = handleQueryMessage(status);
                     if (ret != DBERR_OK) {
                         return ret;
@@ -1029,6 +1633,24 @@ STOP_LISTENING:
                     logger::log_error(DBERR_FEATURE_UNSUPPORTED, "Unsupported batch KNN on agent.");
                     return DBERR_FEATURE_UNSUPPORTED;
                     break;
+                case MSG_TELEMETRY:
+                    ret = handleTelemetryMessage(status);
+                    if (ret != DBERR_OK) {
+                        return ret;
+                    }
+                    break;
+                case MSG_MEMORY_FOOTPRINT:
+                    ret = handleMemoryFootprintMessage(status);
+                    if (ret != DBERR_OK) {
+                        return ret;
+                    }
+                    break;
+                case MSG_LOOKUP_OBJECTS:
+                    ret = handleLookupObjectsMessage(status);
+                    if (ret != DBERR_OK) {
+                        return ret;
+                    }
+                    break;
                 default:
                     logger::log_error(DBERR_COMM_WRONG_MESSAGE_ORDER, "Didn't expect message with tag", status.MPI_TAG);
                     return DBERR_COMM_WRONG_MESSAGE_ORDER;
@@ -1048,6 +1670,8 @@ STOP_LISTENING:
                 }
                 // pull the probed message
                 ret = pullIncoming(status);
+                // whatever follows no longer belongs to the handled request's query
+                telemetry::setQueryScope(NO_QUERY_SCOPE);
                 if (ret == DB_FIN) {
                     goto STOP_LISTENING;
                 } else if(ret != DBERR_OK){
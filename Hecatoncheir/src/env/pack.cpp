@@ -58,7 +58,9 @@ namespace pack
         sysMetadataMsg.count += 2*sizeof(int);                  // dist + part partitions per dimension
         sysMetadataMsg.count += sizeof(int);                  // partitioning type
         sysMetadataMsg.count += sizeof(int) + g_config.dirPaths.dataPath.length() * sizeof(char);   // data directory path length + string
-        sysMetadataMsg.count += 3 * sizeof(int);              // MBRFilter, IFilter, Refinement
+        sysMetadataMsg.count += 5 * sizeof(int);              // MBRFilter, IFilter, Refinement, adaptiveSweep, rangeCacheEntries
+        sysMetadataMsg.count += sizeof(ResultDeliveryType);   // result delivery
+        sysMetadataMsg.count += sizeof(int) + sizeof(size_t); // max resident datasets, resident memory budget
         
         // allocate space
         sysMetadataMsg.data = (char*) malloc(sysMetadataMsg.count * sizeof(char));
@@ -96,6 +98,17 @@ namespace pack
         localBuffer += sizeof(int);
         *reinterpret_cast<int*>(localBuffer) = g_config.queryPipeline.Refinement;
         localBuffer += sizeof(int);
+        *reinterpret_cast<int*>(localBuffer) = g_config.queryPipeline.adaptiveSweep;
+        localBuffer += sizeof(int);
+        *reinterpret_cast<int*>(localBuffer) = g_config.queryPipeline.rangeCacheEntries;
+        localBuffer += sizeof(int);
+        *reinterpret_cast<ResultDeliveryType*>(localBuffer) = g_config.queryPipeline.resultDelivery;
+        localBuffer += sizeof(ResultDeliveryType);
+
+        *reinterpret_cast<int*>(localBuffer) = g_config.datasetOptions.maxResidentDatasets;
+        localBuffer += sizeof(int);
+        *reinterpret_cast<size_t*>(localBuffer) = g_config.datasetOptions.residentMemoryBudget;
+        localBuffer += sizeof(size_t);
 
         return DBERR_OK;
     }
@@ -161,6 +174,78 @@ namespace pack
         return ret;
     }
 
+    DB_STATUS packObjectInserts(int datasetID, const std::vector<std::pair<size_t, std::string>> &objects, SerializedMsg<char> &msg) {
+        // dataset id + object count + (rec id, WKT length, WKT) per object
+        msg.count = sizeof(int) + sizeof(size_t);
+        for (auto &it : objects) {
+            msg.count += sizeof(size_t) + sizeof(int) + it.second.size();
+        }
+        msg.data = (char*) malloc(msg.count);
+        if (msg.data == nullptr) {
+            logger::log_error(DBERR_MALLOC_FAILED, "Malloc for pack object inserts failed");
+            return DBERR_MALLOC_FAILED;
+        }
+        char* localBuffer = msg.data;
+        *reinterpret_cast<int*>(localBuffer) = datasetID;
+        localBuffer += sizeof(int);
+        *reinterpret_cast<size_t*>(localBuffer) = objects.size();
+        localBuffer += sizeof(size_t);
+        for (auto &it : objects) {
+            *reinterpret_cast<size_t*>(localBuffer) = it.first;
+            localBuffer += sizeof(size_t);
+            *reinterpret_cast<int*>(localBuffer) = it.second.size();
+            localBuffer += sizeof(int);
+            std::memcpy(localBuffer, it.second.data(), it.second.size());
+            localBuffer += it.second.size();
+        }
+        return DBERR_OK;
+    }
+
+    DB_STATUS packObjectRecords(const std::vector<hec::ObjectRecord> &records, SerializedMsg<char> &msg) {
+        // object count + (rec id, MBR, WKT length, WKT) per object
+        msg.count = sizeof(size_t);
+        for (auto &it : records) {
+            msg.count += sizeof(size_t) + 4 * sizeof(double) + sizeof(int) + it.wkt.size();
+        }
+        msg.data = (char*) malloc(msg.count);
+        if (msg.data == nullptr) {
+            logger::log_error(DBERR_MALLOC_FAILED, "Malloc for pack object records failed");
+            return DBERR_MALLOC_FAILED;
+        }
+        char* localBuffer = msg.data;
+        *reinterpret_cast<size_t*>(localBuffer) = records.size();
+        localBuffer += sizeof(size_t);
+        for (auto &it : records) {
+            *reinterpret_cast<size_t*>(localBuffer) = it.recID;
+            localBuffer += sizeof(size_t);
+            double mbr[4] = {it.xMin, it.yMin, it.xMax, it.yMax};
+            std::memcpy(localBuffer, mbr, 4 * sizeof(double));
+            localBuffer += 4 * sizeof(double);
+            *reinterpret_cast<int*>(localBuffer) = it.wkt.size();
+            localBuffer += sizeof(int);
+            std::memcpy(localBuffer, it.wkt.data(), it.wkt.size());
+            localBuffer += it.wkt.size();
+        }
+        return DBERR_OK;
+    }
+
+    DB_STATUS packSnapshotRequest(int datasetID, const std::string &snapshotPath, SerializedMsg<char> &msg) {
+        // dataset id + path length + path
+        msg.count = sizeof(int) + sizeof(int) + snapshotPath.size();
+        msg.data = (char*) malloc(msg.count);
+        if (msg.data == nullptr) {
+            logger::log_error(DBERR_MALLOC_FAILED, "Malloc for pack snapshot request failed");
+            return DBERR_MALLOC_FAILED;
+        }
+        char* localBuffer = msg.data;
+        *reinterpret_cast<int*>(localBuffer) = datasetID;
+        localBuffer += sizeof(int);
+        *reinterpret_cast<int*>(localBuffer) = snapshotPath.size();
+        localBuffer += sizeof(int);
+        std::memcpy(localBuffer, snapshotPath.data(), snapshotPath.size());
+        return DBERR_OK;
+    }
+
     DB_STATUS packBatchResults(std::unordered_map<int, std::unique_ptr<hec::QResultBase>> &batchResults, SerializedMsg<char> &msg) {       
         DB_STATUS ret = DBERR_OK;
         // count total size
@@ -391,6 +476,17 @@ namespace unpack
         localBuffer += sizeof(int);
         g_config.queryPipeline.Refinement = *reinterpret_cast<const int*>(localBuffer);
         localBuffer += sizeof(int);
+        g_config.queryPipeline.adaptiveSweep = *reinterpret_cast<const int*>(localBuffer);
+        localBuffer += sizeof(int);
+        g_config.queryPipeline.rangeCacheEntries = *reinterpret_cast<const int*>(localBuffer);
+        localBuffer += sizeof(int);
+        g_config.queryPipeline.resultDelivery = *reinterpret_cast<const ResultDeliveryType*>(localBuffer);
+        localBuffer += sizeof(ResultDeliveryType);
+        // dataset residency
+        g_config.datasetOptions.maxResidentDatasets = *reinterpret_cast<const int*>(localBuffer);
+        localBuffer += sizeof(int);
+        g_config.datasetOptions.residentMemoryBudget = *reinterpret_cast<const size_t*>(localBuffer);
+        localBuffer += sizeof(size_t);
 
         return DBERR_OK;
     }
@@ -417,18 +513,11 @@ namespace unpack
         g_config.approximationMetadata.aprilConfig.partitions = partitions;
         g_config.approximationMetadata.type = AT_APRIL;
 
-        if (auto* datasetR = g_config.datasetOptions.getDatasetR()) {
-            datasetR->approxType = AT_APRIL;
-            datasetR->aprilConfig.setN(N);
-            datasetR->aprilConfig.compression = compression;
-            datasetR->aprilConfig.partitions = partitions;
-        }
-
-        if (auto* datasetS = g_config.datasetOptions.getDatasetS()) {
-            datasetS->approxType = AT_APRIL;
-            datasetS->aprilConfig.setN(N);
-            datasetS->aprilConfig.compression = compression;
-            datasetS->aprilConfig.partitions = partitions;
+        for (auto &dataset : g_config.datasetOptions.getDatasets()) {
+            dataset->approxType = AT_APRIL;
+            dataset->aprilConfig.setN(N);
+            dataset->aprilConfig.compression = compression;
+            dataset->aprilConfig.partitions = partitions;
         }
 
         return DBERR_OK;
@@ -455,6 +544,93 @@ namespace unpack
         return ret;
     }
 
+    DB_STATUS unpackObjectInserts(SerializedMsg<char> &msg, int &datasetID, std::vector<std::pair<size_t, std::string>> &objects) {
+        const char* localBuffer = msg.data;
+        const char* end = msg.data + msg.count;
+        if (msg.count < sizeof(int) + sizeof(size_t)) {
+            logger::log_error(DBERR_INVALID_PARAMETER, "Serialized message too small for object inserts");
+            return DBERR_INVALID_PARAMETER;
+        }
+        datasetID = *reinterpret_cast<const int*>(localBuffer);
+        localBuffer += sizeof(int);
+        size_t objectCount = *reinterpret_cast<const size_t*>(localBuffer);
+        localBuffer += sizeof(size_t);
+        objects.reserve(objectCount);
+        for (size_t i=0; i<objectCount; i++) {
+            if (localBuffer + sizeof(size_t) + sizeof(int) > end) {
+                logger::log_error(DBERR_DESERIALIZE_FAILED, "Object inserts message is truncated");
+                return DBERR_DESERIALIZE_FAILED;
+            }
+            size_t recID = *reinterpret_cast<const size_t*>(localBuffer);
+            localBuffer += sizeof(size_t);
+            int length = *reinterpret_cast<const int*>(localBuffer);
+            localBuffer += sizeof(int);
+            if (length < 0 || localBuffer + length > end) {
+                logger::log_error(DBERR_DESERIALIZE_FAILED, "Object inserts message is truncated");
+                return DBERR_DESERIALIZE_FAILED;
+            }
+            objects.emplace_back(recID, std::string(localBuffer, length));
+            localBuffer += length;
+        }
+        return DBERR_OK;
+    }
+
+    DB_STATUS unpackObjectRecords(SerializedMsg<char> &msg, std::vector<hec::ObjectRecord> &records) {
+        const char* localBuffer = msg.data;
+        const char* end = msg.data + msg.count;
+        if (msg.count < sizeof(size_t)) {
+            logger::log_error(DBERR_INVALID_PARAMETER, "Serialized message too small for object records");
+            return DBERR_INVALID_PARAMETER;
+        }
+        size_t objectCount = *reinterpret_cast<const size_t*>(localBuffer);
+        localBuffer += sizeof(size_t);
+        records.reserve(records.size() + objectCount);
+        for (size_t i=0; i<objectCount; i++) {
+            if (localBuffer + sizeof(size_t) + 4 * sizeof(double) + sizeof(int) > end) {
+                logger::log_error(DBERR_DESERIALIZE_FAILED, "Object records message is truncated");
+                return DBERR_DESERIALIZE_FAILED;
+            }
+            hec::ObjectRecord record;
+            record.recID = *reinterpret_cast<const size_t*>(localBuffer);
+            localBuffer += sizeof(size_t);
+            double mbr[4];
+            std::memcpy(mbr, localBuffer, 4 * sizeof(double));
+            localBuffer += 4 * sizeof(double);
+            record.xMin = mbr[0];
+            record.yMin = mbr[1];
+            record.xMax = mbr[2];
+            record.yMax = mbr[3];
+            int length = *reinterpret_cast<const int*>(localBuffer);
+            localBuffer += sizeof(int);
+            if (length < 0 || localBuffer + length > end) {
+                logger::log_error(DBERR_DESERIALIZE_FAILED, "Object records message is truncated");
+                return DBERR_DESERIALIZE_FAILED;
+            }
+            record.wkt.assign(localBuffer, length);
+            localBuffer += length;
+            records.emplace_back(std::move(record));
+        }
+        return DBERR_OK;
+    }
+
+    DB_STATUS unpackSnapshotRequest(SerializedMsg<char> &msg, int &datasetID, std::string &snapshotPath) {
+        const char* localBuffer = msg.data;
+        if (msg.count < 2 * (int) sizeof(int)) {
+            logger::log_error(DBERR_INVALID_PARAMETER, "Serialized message too small for snapshot request");
+            return DBERR_INVALID_PARAMETER;
+        }
+        datasetID = *reinterpret_cast<const int*>(localBuffer);
+        localBuffer += sizeof(int);
+        int length = *reinterpret_cast<const int*>(localBuffer);
+        localBuffer += sizeof(int);
+        if (length <= 0 || localBuffer + length > msg.data + msg.count) {
+            logger::log_error(DBERR_DESERIALIZE_FAILED, "Invalid snapshot path in snapshot request");
+            return DBERR_DESERIALIZE_FAILED;
+        }
+        snapshotPath.assign(localBuffer, length);
+        return DBERR_OK;
+    }
+
     DB_STATUS unpackShape(SerializedMsg<char> &msg, Shape &shape) {
         DB_STATUS ret = DBERR_OK;
 
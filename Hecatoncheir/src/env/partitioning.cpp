@@ -61,15 +61,18 @@ namespace partitioning
             batch.destRank = i;
             batch.comm = &g_worker_comm;
             batch.maxObjectCount = g_config.partitioningMethod->getBatchSize();
+            batch.maxBufferSize = g_config.partitioningMethod->getBatchBytes();
+            batch.adaptive = g_config.partitioningMethod->isAdaptiveBatching() && batch.maxBufferSize > 0;
             batchMap[i] = batch;
         }
         return DBERR_OK;
     }
 
-    /** @brief Assigns a geometry to the appropriate batches based on overlapping partition IDs.
+    /** @brief Assigns a geometry to the appropriate batches based on overlapping partition IDs 
+     * and records the lowest receiving worker in the object directory.
      * If the batch is full after the insertion, it is sent and cleared before returning.
      */
-    static DB_STATUS assignObjectToBatches(Shape &object, std::unordered_map<int,Batch> &batchMap, int &batchesSent) {
+    static DB_STATUS assignObjectToBatches(Shape &object, std::unordered_map<int,Batch> &batchMap, int &batchesSent, ObjectDirectory &objectDirectory) {
         // find partition IDs and the class of the geometry in each distribution partition
         std::vector<int> partitionIDs;
         DB_STATUS ret = partitioning::getPartitionsForMBR(object.mbr, partitionIDs);
@@ -86,9 +89,14 @@ namespace partitioning
             bitVector[nodeRank] = true;
         }
         // add to nodes' batches
+        bool ownerSet = false;
         for (int nodeRank=1; nodeRank<bitVector.size(); nodeRank++) {
             if (bitVector.at(nodeRank)) {
                 // if it has been marked
+                if (!ownerSet) {
+                    objectDirectory.setOwner(object.recID, nodeRank);
+                    ownerSet = true;
+                }
                 // add geometry to batch
                 auto it = batchMap.find(nodeRank);
                 if (it == batchMap.end()) {
@@ -99,11 +107,14 @@ namespace partitioning
                 it->second.addObjectToBatch(object);
 
                 // if batch is full, send and reset
-                if (it->second.objectCount >= it->second.maxObjectCount) {
+                if (it->second.isFull()) {
+                    size_t sentBytes = it->second.bufferSize;
+                    double startTime = MPI_Wtime();
                     ret = comm::worker::serializeAndSendGeometryBatch(&it->second);
                     if (ret != DBERR_OK) {
                         return ret;
                     }
+                    it->second.adaptBufferSize(sentBytes, MPI_Wtime() - startTime);
                     // reset
                     it->second.clear();
                     // count batch 
@@ -286,7 +297,7 @@ namespace partitioning
                         object.correctGeometry();
                         object.setMBR(xMin, yMin, xMax, yMax);
                         // assign to appropriate batches
-                        local_ret = assignObjectToBatches(object, batchMap, batchesSent);
+                        local_ret = assignObjectToBatches(object, batchMap, batchesSent, dataset->objectDirectory);
                         if (local_ret != DBERR_OK) {
                             #pragma omp cancel parallel
                             ret = local_ret;
@@ -539,7 +550,7 @@ namespace partitioning
                         // set the MBR
                         object.setMBR();
                         // assign to appropriate batches
-                        local_ret = assignObjectToBatches(object, batchMap, batchesSent);
+                        local_ret = assignObjectToBatches(object, batchMap, batchesSent, dataset->objectDirectory);
                         if (local_ret != DBERR_OK) {
                             #pragma omp cancel parallel
                             ret = local_ret;
@@ -684,7 +695,7 @@ namespace partitioning
                         if (local_ret == DBERR_OK) {
                             totalValidObjects++;
                             object.setMBR();
-                            local_ret = assignObjectToBatches(object, batchMap, batchesSent);
+                            local_ret = assignObjectToBatches(object, batchMap, batchesSent, dataset->objectDirectory);
                             if (local_ret != DBERR_OK) {
                                 #pragma omp cancel parallel
                             }
@@ -755,6 +766,8 @@ namespace partitioning
             return DBERR_NULL_PTR_EXCEPTION;
         }
         DB_STATUS ret;
+        // rec IDs are line numbers, the directory is filled while the objects are assigned to workers
+        dataset->objectDirectory.reset(dataset->totalObjects);
         // time
         switch (dataset->metadata.fileType) {
             // perform the partitioning
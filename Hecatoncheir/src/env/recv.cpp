@@ -11,11 +11,13 @@ namespace comm
                 return DBERR_INVALID_PARAMETER;
             }
             // receive response
+            double startTime = MPI_Wtime();
             int mpi_ret = MPI_Recv(NULL, 0, MPI_CHAR, sourceRank, sourceTag, comm, &status);
             if (mpi_ret != MPI_SUCCESS) {
                 logger::log_error(DBERR_COMM_RECV, "Failed to receive response with tag ", sourceTag);
                 return DBERR_COMM_RECV;
             }
+            telemetry::recordRecv(status.MPI_SOURCE, sourceTag, comm, 0, MPI_CHAR, MPI_Wtime() - startTime);
             return DBERR_OK;
         }
 
@@ -26,11 +28,13 @@ namespace comm
                 return DBERR_COMM_INVALID_MSG_TAG;
             }
             // receive response
+            double startTime = MPI_Wtime();
             int mpi_ret = MPI_Recv(&result, 1, MPI_UNSIGNED_LONG_LONG, sourceRank, sourceTag, comm, &status);
             if (mpi_ret != MPI_SUCCESS) {
                 logger::log_error(DBERR_COMM_RECV, "Failed to receive query result message with tag ", sourceTag);
                 return DBERR_COMM_RECV;
             }
+            telemetry::recordRecv(status.MPI_SOURCE, sourceTag, comm, 1, MPI_UNSIGNED_LONG_LONG, MPI_Wtime() - startTime);
             return DBERR_OK;
         }
 
@@ -41,11 +45,13 @@ namespace comm
                 return DBERR_COMM_WRONG_MSG_FORMAT;
             }
             // receive msg
+            double startTime = MPI_Wtime();
             int mpi_ret = MPI_Recv(NULL, 0, MPI_CHAR, sourceRank, sourceTag, comm, &status);
             if (mpi_ret != MPI_SUCCESS) {
                 logger::log_error(DBERR_COMM_RECV, "Failed to receive message with tag ", sourceTag);
                 return DBERR_COMM_RECV;
             }
+            telemetry::recordRecv(status.MPI_SOURCE, sourceTag, comm, 0, MPI_CHAR, MPI_Wtime() - startTime);
             
             return DBERR_OK;
         }
@@ -9,11 +9,13 @@ namespace comm
                 logger::log_error(DBERR_INVALID_PARAMETER, "Response tag must be either ACK or NACK");
                 return DBERR_COMM_INVALID_MSG_TAG;
             }
+            double startTime = MPI_Wtime();
             int mpi_ret = MPI_Send(NULL, 0, MPI_CHAR, destRank, tag, comm);
             if (mpi_ret != MPI_SUCCESS) {
                 logger::log_error(DBERR_COMM_SEND, "Send response failed. Tag:", tag);
                 return DBERR_COMM_SEND;
             }
+            telemetry::recordSend(destRank, tag, comm, 0, MPI_CHAR, MPI_Wtime() - startTime);
             return DBERR_OK;
         }
 
@@ -22,11 +24,13 @@ namespace comm
                 logger::log_error(DBERR_INVALID_PARAMETER, "Inappropriate tag for query result message. Current tag:", tag);
                 return DBERR_COMM_INVALID_MSG_TAG;
             }
+            double startTime = MPI_Wtime();
             int mpi_ret = MPI_Send(&result, 1, MPI_UNSIGNED_LONG_LONG, destRank, tag, comm);
             if (mpi_ret != MPI_SUCCESS) {
                 logger::log_error(DBERR_COMM_SEND, "Send result failed. Tag:", tag);
                 return DBERR_COMM_SEND;
             }
+            telemetry::recordSend(destRank, tag, comm, 1, MPI_UNSIGNED_LONG_LONG, MPI_Wtime() - startTime);
             return DBERR_OK;
         }
 
@@ -37,11 +41,13 @@ namespace comm
                 return DBERR_COMM_INVALID_MSG_TAG;
             }
             // send the message
+            double startTime = MPI_Wtime();
             int mpi_ret = MPI_Send(NULL, 0, MPI_CHAR, destRank, tag, comm);
             if (mpi_ret != MPI_SUCCESS) {
                 logger::log_error(DBERR_COMM_SEND, "Send message with tag", tag);
                 return DBERR_COMM_SEND;
             }
+            telemetry::recordSend(destRank, tag, comm, 0, MPI_CHAR, MPI_Wtime() - startTime);
             return DBERR_OK;
         }
 
@@ -0,0 +1,159 @@
+#include "env/telemetry.h"
+
+#include <map>
+#include <tuple>
+
+namespace comm
+{
+    namespace telemetry
+    {
+        /** @brief (query ID, tag, peer) */
+        typedef std::tuple<int,int,int> StatsKey;
+
+        static std::map<StatsKey, hec::CommStats> stats;
+        static int queryScope = NO_QUERY_SCOPE;
+
+        /** @brief The last receive recorded by each thread, so that it can be re-attributed. */
+        struct LastRecv {
+            bool valid = false;
+            StatsKey key;
+            size_t bytes = 0;
+            double time = 0;
+        };
+        static thread_local LastRecv lastRecv;
+
+        /** @brief Translates a rank of the given communicator to a global rank. 
+         * Workers are offset by one in the worker communicator, since the driver is not a member. */
+        static int toGlobalRank(int rank, MPI_Comm comm) {
+            if (comm == g_worker_comm) {
+                return rank + 1;
+            }
+            return rank;
+        }
+
+        /** @brief Returns the entry for the given key. Must be called inside the telemetry critical section. */
+        static hec::CommStats& getEntry(const StatsKey &key) {
+            auto it = stats.find(key);
+            if (it == stats.end()) {
+                hec::CommStats entry;
+                entry.rank = g_global_rank;
+                entry.queryID = std::get<0>(key);
+                entry.tag = std::get<1>(key);
+                entry.peer = std::get<2>(key);
+                it = stats.insert(std::make_pair(key, entry)).first;
+            }
+            return it->second;
+        }
+
+        static hec::CommStats& getEntry(int peer, int tag, MPI_Comm comm) {
+            return getEntry(std::make_tuple(queryScope, tag, toGlobalRank(peer, comm)));
+        }
+
+        static size_t getBytes(int count, MPI_Datatype dataType) {
+            int typeSize = 0;
+            MPI_Type_size(dataType, &typeSize);
+            return (size_t) count * typeSize;
+        }
+
+        void setQueryScope(int queryID) {
+            #pragma omp critical(telemetry)
+            {
+                queryScope = queryID;
+            }
+        }
+
+        int getQueryScope() {
+            int queryID;
+            #pragma omp critical(telemetry)
+            {
+                queryID = queryScope;
+            }
+            return queryID;
+        }
+
+        void recordSend(int destRank, int tag, MPI_Comm comm, int count, MPI_Datatype dataType, double time) {
+            size_t bytes = getBytes(count, dataType);
+            #pragma omp critical(telemetry)
+            {
+                hec::CommStats &entry = getEntry(destRank, tag, comm);
+                entry.sentMessages++;
+                entry.sentBytes += bytes;
+                entry.sendTime += time;
+            }
+        }
+
+        void recordRecv(int sourceRank, int tag, MPI_Comm comm, int count, MPI_Datatype dataType, double time) {
+            size_t bytes = getBytes(count, dataType);
+            #pragma omp critical(telemetry)
+            {
+                hec::CommStats &entry = getEntry(sourceRank, tag, comm);
+                entry.recvMessages++;
+                entry.recvBytes += bytes;
+                entry.recvTime += time;
+                lastRecv.valid = true;
+                lastRecv.key = std::make_tuple(entry.queryID, entry.tag, entry.peer);
+                lastRecv.bytes = bytes;
+                lastRecv.time = time;
+            }
+        }
+
+        void attributeLastRecv(int queryID) {
+            if (!lastRecv.valid || std::get<0>(lastRecv.key) == queryID) {
+                return;
+            }
+            #pragma omp critical(telemetry)
+            {
+                auto it = stats.find(lastRecv.key);
+                if (it != stats.end()) {
+                    // take it out of its previous entry
+                    it->second.recvMessages--;
+                    it->second.recvBytes -= lastRecv.bytes;
+                    it->second.recvTime -= lastRecv.time;
+                    // and add it to the query's
+                    hec::CommStats &entry = getEntry(std::make_tuple(queryID, std::get<1>(lastRecv.key), std::get<2>(lastRecv.key)));
+                    entry.recvMessages++;
+                    entry.recvBytes += lastRecv.bytes;
+                    entry.recvTime += lastRecv.time;
+                }
+            }
+            lastRecv.valid = false;
+        }
+
+        void recordProbe(int sourceRank, int tag, MPI_Comm comm, double time) {
+            #pragma omp critical(telemetry)
+            {
+                hec::CommStats &entry = getEntry(sourceRank, tag, comm);
+                entry.probeTime += time;
+            }
+        }
+
+        void recordSerialization(int destRank, int tag, MPI_Comm comm, double time) {
+            #pragma omp critical(telemetry)
+            {
+                hec::CommStats &entry = getEntry(destRank, tag, comm);
+                entry.serializationTime += time;
+            }
+        }
+
+        std::vector<hec::CommStats> collect(bool reset) {
+            std::vector<hec::CommStats> result;
+            #pragma omp critical(telemetry)
+            {
+                result.reserve(stats.size());
+                for (auto &it : stats) {
+                    const hec::CommStats &entry = it.second;
+                    // skip entries left empty by re-attribution
+                    if (entry.sentMessages == 0 && entry.recvMessages == 0 && entry.probeTime == 0 && entry.serializationTime == 0) {
+                        continue;
+                    }
+                    result.emplace_back(entry);
+                }
+                if (reset) {
+                    stats.clear();
+                    lastRecv.valid = false;
+                }
+            }
+            return result;
+        }
+    }
+}
@@ -267,6 +267,136 @@ namespace storage
             return DBERR_OK;
         }
 
+        /** @brief The number of byte ranges a rank's part of a dataset file is split into, shared among its threads. 
+         * Fixed, so that the scanned lines do not depend on the thread count. */
+        #define METADATA_SCAN_SUBRANGES 256
+
+        /** @brief Scans the lines that begin in the byte range [from, to) of the mapped dataset file.
+         * Every line is counted as an object (valid or not). Parses the objects only if computeExtent is set.
+         */
+        static DB_STATUS scanDatasetFileRange(Dataset* dataset, const char* fileData, size_t fileSize, size_t from, size_t to, bool computeExtent, DatasetMetadataPart &part) {
+            // move to the start of the first line that begins in the range
+            size_t position = from;
+            if (position > 0 && fileData[position-1] != '\n') {
+                const char* lineEnd = static_cast<const char*>(memchr(fileData + position, '\n', fileSize - position));
+                position = (lineEnd == nullptr) ? fileSize : (lineEnd - fileData) + 1;
+            }
+            Shape object;
+            if (computeExtent && dataset->metadata.fileType == hec::FT_WKT) {
+                DB_STATUS ret = shape_factory::createEmpty(dataset->metadata.dataType, object);
+                if (ret != DBERR_OK) {
+                    return ret;
+                }
+            }
+            std::string line;
+            std::string token;
+            while (position < to) {
+                const char* lineEnd = static_cast<const char*>(memchr(fileData + position, '\n', fileSize - position));
+                size_t lineLength = (lineEnd == nullptr) ? fileSize - position : (lineEnd - fileData) - position;
+                bool isHeader = (position == 0 && dataset->metadata.fileType == hec::FT_CSV);
+                // same as wc -l, count the line terminators (the csv header is not an object)
+                if (lineEnd != nullptr && !isHeader) {
+                    part.objects++;
+                }
+                if (computeExtent && !isHeader) {
+                    line.assign(fileData + position, lineLength);
+                    std::stringstream ss(line);
+                    if (dataset->metadata.fileType == hec::FT_WKT) {
+                        // first column is the wkt geometry
+                        std::getline(ss, token, '\t');
+                        object.reset();
+                        DB_STATUS ret = object.setFromWKT(token);
+                        if (ret == DBERR_OK) {
+                            object.setMBR();
+                            part.xMin = std::min(part.xMin, object.mbr.pMin.x);
+                            part.yMin = std::min(part.yMin, object.mbr.pMin.y);
+                            part.xMax = std::max(part.xMax, object.mbr.pMax.x);
+                            part.yMax = std::max(part.yMax, object.mbr.pMax.y);
+                            part.vertices += object.getVertexCount();
+                        } else if (ret != DBERR_INVALID_GEOMETRY) {
+                            // lines of a different geometry type are ignored, anything else is an error
+                            return ret;
+                        }
+                    } else {
+                        // csv: recID, followed by the "x y" coordinates
+                        std::getline(ss, token, ',');
+                        while (std::getline(ss, token, ',')) {
+                            std::stringstream coordStream(token);
+                            std::getline(coordStream, token, ' ');
+                            double x = std::stof(token);
+                            std::getline(coordStream, token, ' ');
+                            double y = std::stof(token);
+                            part.xMin = std::min(part.xMin, x);
+                            part.yMin = std::min(part.yMin, y);
+                            part.xMax = std::max(part.xMax, x);
+                            part.yMax = std::max(part.yMax, y);
+                            part.vertices++;
+                        }
+                    }
+                }
+                position += lineLength + 1;
+            }
+            return DBERR_OK;
+        }
+
+        DB_STATUS calculateDatasetMetadataPart(Dataset* dataset, int partIndex, int partCount, bool computeExtent, DatasetMetadataPart &part) {
+            if (dataset->metadata.fileType != hec::FT_WKT && dataset->metadata.fileType != hec::FT_CSV) {
+                logger::log_error(DBERR_FEATURE_UNSUPPORTED, "Unsupported data file type:", dataset->metadata.fileType);
+                return DBERR_FEATURE_UNSUPPORTED;
+            }
+            int fd = open(dataset->metadata.path.c_str(), O_RDONLY);
+            if (fd == -1) {
+                logger::log_error(DBERR_MISSING_FILE, "Could not open dataset file at", dataset->metadata.path);
+                return DBERR_MISSING_FILE;
+            }
+            struct stat fileStat;
+            if (fstat(fd, &fileStat) == -1) {
+                close(fd);
+                logger::log_error(DBERR_OPERATION_FAILED, "Could not get file stats through fstat syscall.");
+                return DBERR_OPERATION_FAILED;
+            }
+            size_t fileSize = fileStat.st_size;
+            if (fileSize == 0) {
+                close(fd);
+                return DBERR_OK;
+            }
+            char* fileData = static_cast<char*>(mmap(nullptr, fileSize, PROT_READ, MAP_PRIVATE, fd, 0));
+            if (fileData == MAP_FAILED) {
+                close(fd);
+                logger::log_error(DBERR_OPERATION_FAILED, "MMAP failed for file of dataset with index", dataset->metadata.internalID);
+                return DBERR_OPERATION_FAILED;
+            }
+            // the file is split in equal byte ranges among the ranks only, since their thread counts may differ
+            size_t partFrom = (fileSize * partIndex) / partCount;
+            size_t partTo = (fileSize * (partIndex + 1)) / partCount;
+            DB_STATUS ret = DBERR_OK;
+            #pragma omp parallel num_threads(MAX_THREADS)
+            {
+                DatasetMetadataPart threadPart;
+                DB_STATUS local_ret = DBERR_OK;
+                // the rank's range is split further, in ranges shared among however many threads the team has
+                #pragma omp for schedule(dynamic)
+                for (int r=0; r<METADATA_SCAN_SUBRANGES; r++) {
+                    size_t from = partFrom + ((partTo - partFrom) * r) / METADATA_SCAN_SUBRANGES;
+                    size_t to = partFrom + ((partTo - partFrom) * (r + 1)) / METADATA_SCAN_SUBRANGES;
+                    DB_STATUS range_ret = scanDatasetFileRange(dataset, fileData, fileSize, from, to, computeExtent, threadPart);
+                    if (range_ret != DBERR_OK) {
+                        local_ret = range_ret;
+                    }
+                }
+                #pragma omp critical(dataset_metadata_part)
+                {
+                    if (local_ret != DBERR_OK) {
+                        ret = local_ret;
+                    }
+                    part.merge(threadPart);
+                }
+            }
+            munmap(fileData, fileSize);
+            close(fd);
+            return ret;
+        }
+
         DB_STATUS calculateDatasetMetadata(Dataset* dataset) {
             DB_STATUS ret = DBERR_OK;
             switch (dataset->metadata.fileType) {
@@ -0,0 +1,502 @@
+#include "storage/snapshot.h"
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <omp.h>
+
+/** @brief Bytes buffered by the snapshot writer before they are written out. */
+#define SNAPSHOT_WRITE_BUFFER_BYTES (1 << 22)
+
+#define FNV_OFFSET_BASIS 0xcbf29ce484222325ULL
+#define FNV_PRIME 0x100000001b3ULL
+
+static_assert(sizeof(storage::snapshot::SnapshotHeader) % 8 == 0, "The snapshot header must keep the payload 8-byte aligned.");
+
+namespace storage
+{
+    namespace snapshot
+    {
+        static inline uint64_t updateChecksum(uint64_t checksum, const char* data, size_t words) {
+            for (size_t i=0; i<words; i++) {
+                uint64_t word;
+                std::memcpy(&word, data + i * sizeof(uint64_t), sizeof(uint64_t));
+                checksum = (checksum ^ word) * FNV_PRIME;
+            }
+            return checksum;
+        }
+
+        static inline uint64_t paddedBytes(uint64_t bytes) {
+            return (bytes + 7) & ~((uint64_t) 7);
+        }
+
+        /** @brief Buffered writer of the snapshot payload, that keeps its size and checksum. */
+        struct PayloadWriter {
+            FILE* outFile;
+            std::vector<char> buffer;
+            uint64_t bytes = 0;
+            uint64_t checksum = FNV_OFFSET_BASIS;
+            bool failed = false;
+
+            PayloadWriter(FILE* outFile) : outFile(outFile) {
+                buffer.reserve(SNAPSHOT_WRITE_BUFFER_BYTES + 4096);
+            }
+
+            void write(const void* data, size_t size) {
+                const char* bytePtr = static_cast<const char*>(data);
+                buffer.insert(buffer.end(), bytePtr, bytePtr + size);
+                bytes += size;
+                if (buffer.size() >= SNAPSHOT_WRITE_BUFFER_BYTES) {
+                    flush();
+                }
+            }
+
+            /** @brief Pads the payload with zeros to a multiple of 8 bytes. */
+            void pad() {
+                static const char zeros[8] = {0};
+                if (bytes % 8 != 0) {
+                    write(zeros, 8 - bytes % 8);
+                }
+            }
+
+            /** @brief Writes out the whole 64-bit words of the buffer (all of it, once padded). */
+            void flush() {
+                size_t words = buffer.size() / sizeof(uint64_t);
+                checksum = updateChecksum(checksum, buffer.data(), words);
+                if (fwrite(buffer.data(), sizeof(uint64_t), words, outFile) != words) {
+                    failed = true;
+                }
+                buffer.erase(buffer.begin(), buffer.begin() + words * sizeof(uint64_t));
+            }
+        };
+
+        std::string getNodeSnapshotPath(const std::string &snapshotPath) {
+            return snapshotPath + "." + std::to_string(g_node_rank);
+        }
+
+        DB_STATUS writeSnapshot(Dataset* dataset, const std::string &snapshotPath) {
+            DB_STATUS ret = DBERR_OK;
+            if (dataset->index == nullptr) {
+                logger::log_error(DBERR_INVALID_OPERATION, "Snapshots require a built index. Dataset index:", dataset->metadata.internalID);
+                return DBERR_INVALID_OPERATION;
+            }
+            // the snapshot holds the merged contents
+            dataset->index->mergeUpdates();
+
+            // the live objects: the stored ones that were not removed and the inserted ones
+            std::vector<Shape*> liveObjects;
+            std::vector<uint32_t> storedPositions(dataset->objects.size(), UINT32_MAX);
+            std::vector<uint32_t> insertedPositions(dataset->insertedObjects.size(), UINT32_MAX);
+            for (size_t i=0; i<dataset->objects.size(); i++) {
+                if (dataset->removedObjectIDs.find(dataset->objects[i].recID) == dataset->removedObjectIDs.end()) {
+                    storedPositions[i] = liveObjects.size();
+                    liveObjects.push_back(&dataset->objects[i]);
+                }
+            }
+            for (size_t i=0; i<dataset->insertedObjects.size(); i++) {
+                Shape &object = dataset->insertedObjects[i];
+                auto insertedIt = dataset->insertedObjectMap.find(object.recID);
+                if (insertedIt != dataset->insertedObjectMap.end() && insertedIt->second == dataset->objects.size() + i) {
+                    insertedPositions[i] = liveObjects.size();
+                    liveObjects.push_back(&object);
+                }
+            }
+            if (liveObjects.size() >= UINT32_MAX) {
+                logger::log_error(DBERR_OUT_OF_BOUNDS, "Too many objects for a snapshot:", liveObjects.size());
+                return DBERR_OUT_OF_BOUNDS;
+            }
+            // the position of an object handle's object among the live ones
+            auto getPosition = [&](ObjectHandle handle) -> uint32_t {
+                if (handle < dataset->objects.size()) {
+                    return storedPositions[handle];
+                }
+                return handle - dataset->objects.size() < insertedPositions.size() ? insertedPositions[handle - dataset->objects.size()] : UINT32_MAX;
+            };
+
+            SnapshotHeader header;
+            std::memset(&header, 0, sizeof(SnapshotHeader));
+            header.magic = SNAPSHOT_MAGIC;
+            header.version = SNAPSHOT_VERSION;
+            header.indexType = dataset->index->getType();
+            header.dataType = dataset->metadata.dataType;
+            header.nodeRank = g_node_rank;
+            header.worldSize = g_world_size;
+            header.globalPPD = g_config.partitioningMethod->getGlobalPPD();
+            header.distributionPPD = g_config.partitioningMethod->getDistributionPPD();
+            header.aprilN = dataset->aprilConfig.getN();
+            header.hasAPRIL = g_config.queryPipeline.IntermediateFilter && dataset->metadata.dataType != DT_POINT;
+            header.classCount = header.indexType == hec::IT_TWO_LAYER ? 4 : 1;
+            header.xMinGlobal = g_config.datasetOptions.dataspaceMetadata.xMinGlobal;
+            header.yMinGlobal = g_config.datasetOptions.dataspaceMetadata.yMinGlobal;
+            header.xMaxGlobal = g_config.datasetOptions.dataspaceMetadata.xMaxGlobal;
+            header.yMaxGlobal = g_config.datasetOptions.dataspaceMetadata.yMaxGlobal;
+            header.objectCount = liveObjects.size();
+
+            std::string path = getNodeSnapshotPath(snapshotPath);
+            FILE* outFile = fopen(path.c_str(), "wb");
+            if (outFile == NULL) {
+                logger::log_error(DBERR_OPEN_FILE_FAILED, "Could not create snapshot file at", path);
+                return DBERR_OPEN_FILE_FAILED;
+            }
+            // placeholder, the counts and checksum are known at the end
+            if (fwrite(&header, sizeof(SnapshotHeader), 1, outFile) != 1) {
+                fclose(outFile);
+                logger::log_error(DBERR_DISK_WRITE_FAILED, "Failed to write snapshot header to", path);
+                return DBERR_DISK_WRITE_FAILED;
+            }
+            PayloadWriter writer(outFile);
+
+            // rec IDs and MBRs
+            for (auto &it : liveObjects) {
+                uint64_t recID = it->recID;
+                writer.write(&recID, sizeof(uint64_t));
+            }
+            for (auto &it : liveObjects) {
+                double mbr[4] = {it->mbr.pMin.x, it->mbr.pMin.y, it->mbr.pMax.x, it->mbr.pMax.y};
+                writer.write(mbr, sizeof(mbr));
+            }
+            // vertex offsets and coordinates
+            uint64_t vertexOffset = 0;
+            writer.write(&vertexOffset, sizeof(uint64_t));
+            for (auto &it : liveObjects) {
+                vertexOffset += it->getVertexCount();
+                writer.write(&vertexOffset, sizeof(uint64_t));
+            }
+            header.vertexCount = vertexOffset;
+            for (auto &it : liveObjects) {
+                double* bufferPtr;
+                int bufferElementCount;
+                ret = it->serializeCoordinates(&bufferPtr, bufferElementCount);
+                if (ret != DBERR_OK) {
+                    fclose(outFile);
+                    logger::log_error(ret, "Serializing coordinates failed for object", it->recID);
+                    return ret;
+                }
+                writer.write(bufferPtr, bufferElementCount * sizeof(double));
+                free(bufferPtr);
+            }
+            // APRIL: the A-lists of all objects, followed by their F-lists
+            uint64_t intervalOffset = 0;
+            writer.write(&intervalOffset, sizeof(uint64_t));
+            for (auto &it : liveObjects) {
+                intervalOffset += header.hasAPRIL ? it->aprilData.intervalsALL.size() : 0;
+                writer.write(&intervalOffset, sizeof(uint64_t));
+            }
+            writer.write(&intervalOffset, sizeof(uint64_t));
+            for (auto &it : liveObjects) {
+                intervalOffset += header.hasAPRIL ? it->aprilData.intervalsFULL.size() : 0;
+                writer.write(&intervalOffset, sizeof(uint64_t));
+            }
+            header.intervalCount = intervalOffset;
+            if (header.hasAPRIL) {
+                for (auto &it : liveObjects) {
+                    writer.write(it->aprilData.intervalsALL.data(), it->aprilData.intervalsALL.size() * sizeof(uint32_t));
+                }
+                for (auto &it : liveObjects) {
+                    writer.write(it->aprilData.intervalsFULL.data(), it->aprilData.intervalsFULL.size() * sizeof(uint32_t));
+                }
+            }
+            writer.pad();
+            // partition IDs, class offsets and the object positions of the classes
+            std::vector<PartitionBase*>* partitions = dataset->index->getPartitions();
+            header.partitionCount = partitions->size();
+            for (auto &it : *partitions) {
+                int32_t partitionID = it->partitionID;
+                writer.write(&partitionID, sizeof(int32_t));
+            }
+            writer.pad();
+            uint64_t entryOffset = 0;
+            writer.write(&entryOffset, sizeof(uint64_t));
+            for (auto &it : *partitions) {
+                for (int c=0; c<header.classCount; c++) {
+                    ObjectList* contents = it->getContents((TwoLayerClass) c);
+                    entryOffset += contents == nullptr ? 0 : contents->size();
+                    writer.write(&entryOffset, sizeof(uint64_t));
+                }
+            }
+            header.entryCount = entryOffset;
+            for (auto &it : *partitions) {
+                for (int c=0; c<header.classCount; c++) {
+                    ObjectList* contents = it->getContents((TwoLayerClass) c);
+                    if (contents == nullptr) {
+                        continue;
+                    }
+                    for (size_t k=0; k<contents->size(); k++) {
+                        uint32_t position = getPosition(contents->handles[k]);
+                        if (position == UINT32_MAX) {
+                            fclose(outFile);
+                            logger::log_error(DBERR_INVALID_KEY, "Partition", it->partitionID, "holds an object that is not stored in the dataset:", (*contents)[k]->recID);
+                            return DBERR_INVALID_KEY;
+                        }
+                        writer.write(&position, sizeof(uint32_t));
+                    }
+                }
+            }
+            writer.pad();
+            writer.flush();
+
+            // final header
+            header.payloadBytes = writer.bytes;
+            header.checksum = writer.checksum;
+            if (writer.failed || fseek(outFile, 0, SEEK_SET) != 0 || fwrite(&header, sizeof(SnapshotHeader), 1, outFile) != 1) {
+                fclose(outFile);
+                logger::log_error(DBERR_DISK_WRITE_FAILED, "Failed to write snapshot file", path);
+                return DBERR_DISK_WRITE_FAILED;
+            }
+            if (fclose(outFile) != 0) {
+                logger::log_error(DBERR_DISK_WRITE_FAILED, "Failed to close snapshot file", path);
+                return DBERR_DISK_WRITE_FAILED;
+            }
+            return ret;
+        }
+
+        /** @brief Checks that the snapshot is intact and that it was saved for this node and configuration. */
+        static DB_STATUS validateSnapshot(Dataset* dataset, const SnapshotHeader* header, const char* payload, size_t payloadBytes) {
+            if (header->magic != SNAPSHOT_MAGIC) {
+                logger::log_error(DBERR_DESERIALIZE_FAILED, "Not a snapshot file.");
+                return DBERR_DESERIALIZE_FAILED;
+            }
+            if (header->version != SNAPSHOT_VERSION) {
+                logger::log_error(DBERR_DESERIALIZE_FAILED, "Unsupported snapshot version", header->version, "expected", SNAPSHOT_VERSION);
+                return DBERR_DESERIALIZE_FAILED;
+            }
+            if (header->payloadBytes != payloadBytes || payloadBytes % 8 != 0) {
+                logger::log_error(DBERR_DESERIALIZE_FAILED, "Snapshot payload size mismatch:", payloadBytes, "bytes instead of", header->payloadBytes);
+                return DBERR_DESERIALIZE_FAILED;
+            }
+            if (updateChecksum(FNV_OFFSET_BASIS, payload, payloadBytes / sizeof(uint64_t)) != header->checksum) {
+                logger::log_error(DBERR_DESERIALIZE_FAILED, "Snapshot checksum mismatch, the file is corrupted.");
+                return DBERR_DESERIALIZE_FAILED;
+            }
+            if (header->nodeRank != g_node_rank || header->worldSize != g_world_size) {
+                logger::log_error(DBERR_INVALID_PARAMETER, "Snapshot was saved by node", header->nodeRank, "of", header->worldSize, "nodes.");
+                return DBERR_INVALID_PARAMETER;
+            }
+            if (header->globalPPD != g_config.partitioningMethod->getGlobalPPD() || header->distributionPPD != g_config.partitioningMethod->getDistributionPPD()) {
+                logger::log_error(DBERR_INVALID_PARAMETER, "Snapshot was saved for a different partitioning: global PPD", header->globalPPD, "distribution PPD", header->distributionPPD);
+                return DBERR_INVALID_PARAMETER;
+            }
+            if (header->dataType != dataset->metadata.dataType) {
+                logger::log_error(DBERR_INVALID_DATATYPE, "Snapshot data type", header->dataType, "does not match the dataset's", dataset->metadata.dataType);
+                return DBERR_INVALID_DATATYPE;
+            }
+            if (header->hasAPRIL && header->aprilN != dataset->aprilConfig.getN()) {
+                logger::log_error(DBERR_INVALID_PARAMETER, "Snapshot APRIL was built with order", header->aprilN, "instead of", dataset->aprilConfig.getN());
+                return DBERR_INVALID_PARAMETER;
+            }
+            int expectedClassCount = header->indexType == hec::IT_TWO_LAYER ? 4 : 1;
+            if ((header->indexType != hec::IT_TWO_LAYER && header->indexType != hec::IT_UNIFORM_GRID && header->indexType != hec::IT_RTREE) || header->classCount != expectedClassCount) {
+                logger::log_error(DBERR_INVALID_INDEX_TYPE, "Invalid snapshot index type", header->indexType);
+                return DBERR_INVALID_INDEX_TYPE;
+            }
+            // every element takes at least 4 bytes, which also keeps the section sizes below from overflowing
+            if (header->objectCount > payloadBytes || header->vertexCount > payloadBytes || header->intervalCount > payloadBytes
+                || header->partitionCount > payloadBytes || header->entryCount > payloadBytes) {
+                logger::log_error(DBERR_DESERIALIZE_FAILED, "Snapshot counts exceed the payload size.");
+                return DBERR_DESERIALIZE_FAILED;
+            }
+            uint64_t expectedBytes = header->objectCount * sizeof(uint64_t)
+                                   + header->objectCount * 4 * sizeof(double)
+                                   + (header->objectCount + 1) * sizeof(uint64_t)
+                                   + header->vertexCount * 2 * sizeof(double)
+                                   + 2 * (header->objectCount + 1) * sizeof(uint64_t)
+                                   + paddedBytes(header->intervalCount * sizeof(uint32_t))
+                                   + paddedBytes(header->partitionCount * sizeof(int32_t))
+                                   + (header->partitionCount * header->classCount + 1) * sizeof(uint64_t)
+                                   + paddedBytes(header->entryCount * sizeof(uint32_t));
+            if (expectedBytes != payloadBytes) {
+                logger::log_error(DBERR_DESERIALIZE_FAILED, "Snapshot sections do not match the payload size.");
+                return DBERR_DESERIALIZE_FAILED;
+            }
+            return DBERR_OK;
+        }
+
+        /** @brief Checks that the offsets are non-decreasing, starting at first and ending at last. */
+        static bool validOffsets(const uint64_t* offsets, size_t count, uint64_t first, uint64_t last) {
+            if (offsets[0] != first || offsets[count] != last) {
+                return false;
+            }
+            for (size_t i=0; i<count; i++) {
+                if (offsets[i] > offsets[i+1]) {
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        /** @brief Restores the dataset from the validated snapshot payload. */
+        static DB_STATUS restoreSnapshot(Dataset* dataset, const SnapshotHeader* header, const char* payload) {
+            DB_STATUS ret = DBERR_OK;
+            size_t objectCount = header->objectCount;
+            // sections
+            const uint64_t* recIDs = reinterpret_cast<const uint64_t*>(payload);
+            const double* mbrs = reinterpret_cast<const double*>(recIDs + objectCount);
+            const uint64_t* vertexOffsets = reinterpret_cast<const uint64_t*>(mbrs + 4 * objectCount);
+            const double* coords = reinterpret_cast<const double*>(vertexOffsets + objectCount + 1);
+            const uint64_t* allOffsets = reinterpret_cast<const uint64_t*>(coords + 2 * header->vertexCount);
+            const uint64_t* fullOffsets = allOffsets + objectCount + 1;
+            const uint32_t* intervals = reinterpret_cast<const uint32_t*>(fullOffsets + objectCount + 1);
+            const int32_t* partitionIDs = reinterpret_cast<const int32_t*>(reinterpret_cast<const char*>(intervals) + paddedBytes(header->intervalCount * sizeof(uint32_t)));
+            const uint64_t* classOffsets = reinterpret_cast<const uint64_t*>(reinterpret_cast<const char*>(partitionIDs) + paddedBytes(header->partitionCount * sizeof(int32_t)));
+            const uint32_t* entries = reinterpret_cast<const uint32_t*>(classOffsets + header->partitionCount * header->classCount + 1);
+            // offsets and positions
+            size_t classTotal = header->partitionCount * header->classCount;
+            if (!validOffsets(vertexOffsets, objectCount, 0, header->vertexCount) || !validOffsets(allOffsets, objectCount, 0, fullOffsets[0])
+                || !validOffsets(fullOffsets, objectCount, allOffsets[objectCount], header->intervalCount) || !validOffsets(classOffsets, classTotal, 0, header->entryCount)) {
+                logger::log_error(DBERR_DESERIALIZE_FAILED, "Invalid snapshot offsets.");
+                return DBERR_DESERIALIZE_FAILED;
+            }
+            for (size_t e=0; e<header->entryCount; e++) {
+                if (entries[e] >= objectCount) {
+                    logger::log_error(DBERR_DESERIALIZE_FAILED, "Invalid object position in snapshot:", entries[e]);
+                    return DBERR_DESERIALIZE_FAILED;
+                }
+            }
+
+            // the global dataspace with this dataset placed in it must be the one of the partitioning,
+            // checked before any dataset or global bounds are touched so that a rejected snapshot changes nothing
+            double xMin = header->xMinGlobal, yMin = header->yMinGlobal, xMax = header->xMaxGlobal, yMax = header->yMaxGlobal;
+            for (auto &it : g_config.datasetOptions.getDatasets()) {
+                if (it == dataset) {
+                    continue;
+                }
+                const DataspaceMetadata &other = it->metadata.dataspaceMetadata;
+                xMin = std::min(xMin, other.xMinGlobal);
+                yMin = std::min(yMin, other.yMinGlobal);
+                xMax = std::max(xMax, other.xMaxGlobal);
+                yMax = std::max(yMax, other.yMaxGlobal);
+            }
+            if (xMin != header->xMinGlobal || yMin != header->yMinGlobal || xMax != header->xMaxGlobal || yMax != header->yMaxGlobal) {
+                logger::log_error(DBERR_INVALID_PARAMETER, "Snapshot was built for a different global dataspace than the one of the loaded datasets.");
+                return DBERR_INVALID_PARAMETER;
+            }
+
+            // the global dataspace of the partitioning
+            DataspaceMetadata &dataspace = dataset->metadata.dataspaceMetadata;
+            dataspace.xMinGlobal = header->xMinGlobal;
+            dataspace.yMinGlobal = header->yMinGlobal;
+            dataspace.xMaxGlobal = header->xMaxGlobal;
+            dataspace.yMaxGlobal = header->yMaxGlobal;
+            dataspace.xExtent = dataspace.xMaxGlobal - dataspace.xMinGlobal;
+            dataspace.yExtent = dataspace.yMaxGlobal - dataspace.yMinGlobal;
+            dataspace.maxExtent = std::max(dataspace.xExtent, dataspace.yExtent);
+            dataspace.boundsSet = true;
+            g_config.datasetOptions.updateDataspace();
+            DataspaceMetadata &global = g_config.datasetOptions.dataspaceMetadata;
+            global.boundsSet = true;
+            g_config.partitioningMethod->setDistGridDataspace(global);
+            g_config.partitioningMethod->setPartGridDataspace(global);
+
+            // objects
+            dataset->clear();
+            Shape object;
+            ret = shape_factory::createEmpty(dataset->metadata.dataType, object);
+            if (ret != DBERR_OK) {
+                return ret;
+            }
+            dataset->objects.resize(objectCount, object);
+            #pragma omp parallel for num_threads(MAX_THREADS)
+            for (size_t i=0; i<objectCount; i++) {
+                Shape &restored = dataset->objects[i];
+                restored.recID = recIDs[i];
+                restored.setMBR(mbrs[4*i], mbrs[4*i + 1], mbrs[4*i + 2], mbrs[4*i + 3]);
+                for (uint64_t v=vertexOffsets[i]; v<vertexOffsets[i+1]; v++) {
+                    restored.addPoint(coords[2*v], coords[2*v + 1]);
+                }
+                restored.aprilData.intervalsALL.assign(intervals + allOffsets[i], intervals + allOffsets[i+1]);
+                restored.aprilData.intervalsFULL.assign(intervals + fullOffsets[i], intervals + fullOffsets[i+1]);
+            }
+            dataset->objectPosMap.reserve(objectCount);
+            for (size_t i=0; i<objectCount; i++) {
+                dataset->objectPosMap[recIDs[i]] = i;
+            }
+            dataset->totalObjects = objectCount;
+
+            // index, the contents keep their indexed order
+            switch (header->indexType) {
+                case hec::IT_TWO_LAYER:
+                    dataset->index = std::make_unique<TwoLayerIndex>();
+                    break;
+                case hec::IT_RTREE:
+                    dataset->index = std::make_unique<RTreeIndex>();
+                    break;
+                case hec::IT_UNIFORM_GRID:
+                    dataset->index = std::make_unique<UniformGridIndex>();
+                    break;
+            }
+            dataset->index->setObjectStore(&dataset->objects, &dataset->insertedObjects);
+            std::vector<PartitionBase*> restoredPartitions(header->partitionCount);
+            for (size_t p=0; p<header->partitionCount; p++) {
+                restoredPartitions[p] = dataset->index->getOrCreatePartition(partitionIDs[p]);
+                if (restoredPartitions[p] == nullptr) {
+                    logger::log_error(DBERR_INVALID_PARTITION, "Invalid partition ID in snapshot:", partitionIDs[p]);
+                    return DBERR_INVALID_PARTITION;
+                }
+            }
+            #pragma omp parallel for num_threads(MAX_THREADS) schedule(dynamic)
+            for (size_t p=0; p<header->partitionCount; p++) {
+                for (int c=0; c<header->classCount; c++) {
+                    uint64_t first = classOffsets[p * header->classCount + c];
+                    uint64_t last = classOffsets[p * header->classCount + c + 1];
+                    if (first == last) {
+                        continue;
+                    }
+                    ObjectList* contents = restoredPartitions[p]->getContents((TwoLayerClass) c);
+                    contents->reserve(contents->size() + (last - first));
+                    for (uint64_t e=first; e<last; e++) {
+                        contents->push_back(entries[e]);
+                    }
+                }
+            }
+            if (header->indexType == hec::IT_RTREE) {
+                // the trees are not stored, bulk load them
+                dataset->index->sortPartitionsOnY();
+            }
+            dataset->index->buildMBRArrays();
+            return ret;
+        }
+
+        DB_STATUS loadSnapshot(Dataset* dataset, const std::string &snapshotPath, bool &hasAPRIL) {
+            std::string path = getNodeSnapshotPath(snapshotPath);
+            int fd = open(path.c_str(), O_RDONLY);
+            if (fd == -1) {
+                logger::log_error(DBERR_MISSING_FILE, "Could not open snapshot file at", path);
+                return DBERR_MISSING_FILE;
+            }
+            struct stat fileStat;
+            if (fstat(fd, &fileStat) == -1) {
+                close(fd);
+                logger::log_error(DBERR_OPERATION_FAILED, "Could not get file stats through fstat syscall.");
+                return DBERR_OPERATION_FAILED;
+            }
+            size_t fileSize = fileStat.st_size;
+            if (fileSize < sizeof(SnapshotHeader)) {
+                close(fd);
+                logger::log_error(DBERR_DESERIALIZE_FAILED, "Snapshot file is too small:", path);
+                return DBERR_DESERIALIZE_FAILED;
+            }
+            char* fileData = static_cast<char*>(mmap(nullptr, fileSize, PROT_READ, MAP_PRIVATE, fd, 0));
+            if (fileData == MAP_FAILED) {
+                close(fd);
+                logger::log_error(DBERR_MMAP_FAILED, "MMAP failed for snapshot file", path);
+                return DBERR_MMAP_FAILED;
+            }
+            // read once, front to back
+            madvise(fileData, fileSize, MADV_SEQUENTIAL);
+
+            const SnapshotHeader* header = reinterpret_cast<const SnapshotHeader*>(fileData);
+            const char* payload = fileData + sizeof(SnapshotHeader);
+            DB_STATUS ret = validateSnapshot(dataset, header, payload, fileSize - sizeof(SnapshotHeader));
+            if (ret == DBERR_OK) {
+                ret = restoreSnapshot(dataset, header, payload);
+                hasAPRIL = header->hasAPRIL;
+            }
+            if (ret != DBERR_OK) {
+                logger::log_error(ret, "Failed to load snapshot", path);
+            }
+            munmap(fileData, fileSize);
+            close(fd);
+            return ret;
+        }
+    }
+}
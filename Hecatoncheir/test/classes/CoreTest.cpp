@@ -1,4 +1,5 @@
 #include <CoreTest.h>
+#include "../include/storage/read.h"
 
 void CoreTest::prepare() {
     
@@ -60,6 +61,46 @@ void CoreTest::test3() {
     ASSERT_EQ(DBERR_OK, ret);
 }
 
+void CoreTest::test4() {
+    // metadata of the sample files, scanned in parts and as a whole (the host's fallback)
+    std::vector<std::pair<std::string, DataType>> files = {
+        {"/test/samples/data_sample_polygons_1.wkt", DT_POLYGON},
+        {"/test/samples/data_sample_linestrings.wkt", DT_LINESTRING},
+        {"/test/samples/data_sample_points.wkt", DT_POINT}
+    };
+    for (auto &[file, dataType] : files) {
+        DatasetMetadata metadata;
+        metadata.path = std::string(HECATONCHEIR_DIR) + file;
+        metadata.fileType = hec::FT_WKT;
+        metadata.dataType = dataType;
+        Dataset dataset(metadata);
+        int ret = storage::reader::calculateDatasetMetadata(&dataset);
+        ASSERT_EQ(DBERR_OK, ret);
+        for (int partCount : {1, 2, 3, 7}) {
+            std::vector<DatasetMetadataPart> parts(partCount);
+            std::vector<DB_STATUS> partRets(partCount, DBERR_OK);
+            // the parts are scanned from inside a parallel region, so each part's team has fewer threads than MAX_THREADS
+            #pragma omp parallel for num_threads(2)
+            for (int p=0; p<partCount; p++) {
+                partRets[p] = storage::reader::calculateDatasetMetadataPart(&dataset, p, partCount, true, parts[p]);
+            }
+            DatasetMetadataPart total;
+            for (int p=0; p<partCount; p++) {
+                ASSERT_EQ(DBERR_OK, partRets[p]);
+                total.merge(parts[p]);
+            }
+            ASSERT_EQ(total.objects, dataset.totalObjects);
+            // set() pads the bounds the same way for both
+            DataspaceMetadata dataspace;
+            dataspace.set(total.xMin, total.yMin, total.xMax, total.yMax);
+            ASSERT_EQ(dataspace.xMinGlobal, dataset.metadata.dataspaceMetadata.xMinGlobal);
+            ASSERT_EQ(dataspace.yMinGlobal, dataset.metadata.dataspaceMetadata.yMinGlobal);
+            ASSERT_EQ(dataspace.xMaxGlobal, dataset.metadata.dataspaceMetadata.xMaxGlobal);
+            ASSERT_EQ(dataspace.yMaxGlobal, dataset.metadata.dataspaceMetadata.yMaxGlobal);
+        }
+    }
+}
+
 void CoreTest::run() {
     // perform any preparation
     current_test_name = "CoreTest::prepare";  // Set global name
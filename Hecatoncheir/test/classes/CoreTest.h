@@ -8,12 +8,15 @@ private:
     std::vector<std::pair<std::string, TestFunc>> tests = {
         {"test1", [this]() { test1(); }},
         {"test2", [this]() { test2(); }},
-        {"test3", [this]() { test3(); }}
+        {"test3", [this]() { test3(); }},
+        {"test4", [this]() { test4(); }}
     };
 protected:
     void test1();
     void test2();
     void test3();
+    /** @brief The dataset metadata scanned in parts (as the nodes do collectively) match the ones the host scans alone */
+    void test4();
     /** @brief Performs any preparation required for the test */
     void prepare();
     /** @brief Performs any termination tasks for the test */
@@ -1,4 +1,9 @@
 #include <QueryTest.h>
+#include <fstream>
+#include <array>
+#include <filesystem>
+#include <stdlib.h>
+#include "../include/env/comm_def.h"
 
 void QueryTest::prepare() {
 
@@ -265,6 +270,1104 @@ void QueryTest::test7() {
     ASSERT_EQ(DBERR_OK, ret);
 }
 
+void QueryTest::test8() {
+    // prepare datasets
+    std::string polygonsR = std::string(HECATONCHEIR_DIR) + "/test/samples/data_sample_polygons_1.wkt";
+    std::string polygonsS = std::string(HECATONCHEIR_DIR) + "/test/samples/data_sample_polygons_2.wkt";
+    int datasetRID = hec::prepareDataset(polygonsR, "WKT", "POLYGON", false);
+    int datasetSID = hec::prepareDataset(polygonsS, "WKT", "POLYGON", false);
+    ASSERT_EQ(0, datasetRID);
+    ASSERT_EQ(1, datasetSID);
+    // partition datasets
+    int ret = hec::partition({datasetRID, datasetSID});
+    ASSERT_EQ(DBERR_OK, ret);
+    // index
+    ret = hec::buildIndex({datasetRID, datasetSID}, hec::IT_TWO_LAYER);
+    ASSERT_EQ(DBERR_OK, ret);
+    // issue both queries before waiting for any
+    hec::PredicateJoinQuery findRelationQuery(datasetRID, datasetSID, 0, hec::spatialQueries.FIND_RELATION(), hec::queryResultTypes.COUNT());
+    hec::PredicateJoinQuery intersectionJoinQuery(datasetRID, datasetSID, 1, hec::Q_INTERSECTION_JOIN, hec::QR_COLLECT);
+    hec::QueryHandle handle0 = hec::queryAsync(&findRelationQuery);
+    hec::QueryHandle handle1 = hec::queryAsync(&intersectionJoinQuery);
+    ASSERT_EQ(handle0, 0);
+    ASSERT_EQ(handle1, 1);
+    // same ID may not be in flight twice
+    hec::QueryHandle duplicate = hec::queryAsync(&intersectionJoinQuery);
+    ASSERT_EQ(duplicate, -1);
+    // a query that fails on the workers fails alone
+    hec::RangeQuery missingDatasetQuery(7, 2, "POLYGON ((-96 49,-93 49,-93 52,-96 52,-96 49))", hec::QR_COUNT);
+    hec::QueryHandle handle2 = hec::queryAsync(&missingDatasetQuery);
+    ASSERT_EQ(handle2, 2);
+    ASSERT_EQ(hec::wait(handle2), nullptr);
+    // wait in reverse order
+    hec::QResultBase* result1 = hec::wait(handle1);
+    ASSERT_NE(result1, nullptr);
+    std::vector<size_t> results = result1->getResultList();
+    int resultsSize = results.size()/2;
+    ASSERT_EQ(resultsSize, 5);
+    hec::QResultBase* result0 = hec::wait(handle0);
+    ASSERT_NE(result0, nullptr);
+    results = result0->getResultList();
+    ASSERT_EQ(results[TR_INTERSECT], 4);
+    ASSERT_EQ(results[TR_INSIDE], 1);
+    // free memory
+    delete result0;
+    delete result1;
+    // unload datasets
+    ret = hec::unloadDataset(datasetRID);
+    ASSERT_EQ(DBERR_OK, ret);
+    ret = hec::unloadDataset(datasetSID);
+    ASSERT_EQ(DBERR_OK, ret);
+}
+
+void QueryTest::test9() {
+    // prepare datasets
+    std::string polygonsR = std::string(HECATONCHEIR_DIR) + "/test/samples/data_sample_polygons_1.wkt";
+    std::string polygonsS = std::string(HECATONCHEIR_DIR) + "/test/samples/data_sample_polygons_2.wkt";
+    int datasetRID = hec::prepareDataset(polygonsR, "WKT", "POLYGON", false);
+    int datasetSID = hec::prepareDataset(polygonsS, "WKT", "POLYGON", false);
+    ASSERT_EQ(0, datasetRID);
+    ASSERT_EQ(1, datasetSID);
+    // partition datasets
+    int ret = hec::partition({datasetRID, datasetSID});
+    ASSERT_EQ(DBERR_OK, ret);
+    // index
+    ret = hec::buildIndex({datasetRID, datasetSID}, hec::IT_TWO_LAYER);
+    ASSERT_EQ(DBERR_OK, ret);
+    // start counting from here
+    hec::getCommStats(true);
+    // run the query
+    hec::PredicateJoinQuery intersectionJoinQuery(datasetRID, datasetSID, 5, hec::Q_INTERSECTION_JOIN, hec::QR_COLLECT);
+    hec::QResultBase* result = hec::query(&intersectionJoinQuery);
+    ASSERT_NE(result, nullptr);
+    delete result;
+    // check the query's traffic
+    std::vector<hec::CommStats> stats = hec::getCommStats(false);
+    ASSERT_NE(stats.size(), 0);
+    size_t driverQueriesSent = 0, driverResultsReceived = 0, workerResultsSent = 0;
+    for (auto &it : stats) {
+        if (it.queryID != 5) {
+            continue;
+        }
+        if (it.rank == DRIVER_GLOBAL_RANK && it.tag == MSG_QUERY) {
+            driverQueriesSent += it.sentMessages;
+        } else if (it.rank == DRIVER_GLOBAL_RANK && (it.tag == MSG_QUERY_RESULT || it.tag == MSG_QUERY_RESULT_CHUNK)) {
+            driverResultsReceived += it.recvMessages;
+            ASSERT_NE(it.recvBytes, 0);
+        } else if (it.rank > HOST_GLOBAL_RANK && (it.tag == MSG_QUERY_RESULT || it.tag == MSG_QUERY_RESULT_DELIVERED) && it.peer == HOST_GLOBAL_RANK) {
+            workerResultsSent += it.sentMessages;
+        }
+    }
+    ASSERT_EQ(driverQueriesSent, 1);
+    // the default host delivery sends the driver one merged result
+    ASSERT_EQ(driverResultsReceived, 1);
+    // every worker (the host excluded) reports to the host, with its partial result or with a delivery notice
+    ASSERT_EQ(workerResultsSent, g_workers_size - 1);
+    // unload datasets
+    ret = hec::unloadDataset(datasetRID);
+    ASSERT_EQ(DBERR_OK, ret);
+    ret = hec::unloadDataset(datasetSID);
+    ASSERT_EQ(DBERR_OK, ret);
+}
+
+void QueryTest::test10() {
+    // prepare dataset
+    std::string pointsR = std::string(HECATONCHEIR_DIR) + "/test/samples/data_sample_points.wkt";
+    std::string pointsS = std::string(HECATONCHEIR_DIR) + "/test/samples/query_sample_points.wkt";
+    int datasetRID = hec::prepareDataset(pointsR, "WKT", "POINT", false);
+    int datasetSID = hec::prepareDataset(pointsS, "WKT", "POINT", false);
+    ASSERT_EQ(0, datasetRID);
+    ASSERT_EQ(1, datasetSID);
+    // partition datasets
+    int ret = hec::partition({datasetRID, datasetSID});
+    ASSERT_EQ(DBERR_OK, ret);
+    // index
+    ret = hec::buildIndex({datasetRID, datasetSID}, hec::IT_UNIFORM_GRID);
+    ASSERT_EQ(DBERR_OK, ret);
+
+    // larger epsilon first, exchanges the border objects
+    hec::DistanceJoinQuery largeQuery(datasetRID, datasetSID, 0, hec::QR_COLLECT, 15.3);
+    hec::QResultBase* result = hec::query(&largeQuery);
+    ASSERT_NE(result, nullptr);
+    size_t largeResultsSize = result->getResultList().size()/2;
+    ASSERT_EQ(true, (largeResultsSize >= 5));
+    delete result;
+    hec::getCommStats(true);
+
+    // smaller epsilon, answered from the cached border objects
+    hec::DistanceJoinQuery smallQuery(datasetRID, datasetSID, 1, hec::QR_COLLECT, 7.65);
+    result = hec::query(&smallQuery);
+    ASSERT_NE(result, nullptr);
+    ASSERT_EQ(result->getResultList().size()/2, 5);
+    delete result;
+    // the workers only agreed on the cache hit, no border objects were exchanged among them
+    std::vector<hec::CommStats> stats = hec::getCommStats(true);
+    for (auto &it : stats) {
+        ASSERT_NE(it.tag, MSG_QUERY_DJ_BATCH);
+    }
+
+    // unload datasets
+    ret = hec::unloadDataset(datasetRID);
+    ASSERT_EQ(DBERR_OK, ret);
+    ret = hec::unloadDataset(datasetSID);
+    ASSERT_EQ(DBERR_OK, ret);
+}
+
+void QueryTest::test11() {
+    // prepare datasets
+    std::string polygonsR = std::string(HECATONCHEIR_DIR) + "/test/samples/data_sample_polygons_1.wkt";
+    std::string polygonsS = std::string(HECATONCHEIR_DIR) + "/test/samples/data_sample_polygons_2.wkt";
+    int datasetRID = hec::prepareDataset(polygonsR, "WKT", "POLYGON", false);
+    int datasetSID = hec::prepareDataset(polygonsS, "WKT", "POLYGON", false);
+    ASSERT_EQ(0, datasetRID);
+    ASSERT_EQ(1, datasetSID);
+    // partition datasets
+    int ret = hec::partition({datasetRID, datasetSID});
+    ASSERT_EQ(DBERR_OK, ret);
+    // index
+    ret = hec::buildIndex({datasetRID, datasetSID}, hec::IT_RTREE);
+    ASSERT_EQ(DBERR_OK, ret);
+    // run join (same results as the two-layer index)
+    hec::PredicateJoinQuery findRelationQuery(datasetRID, datasetSID, 0, hec::spatialQueries.FIND_RELATION(), hec::queryResultTypes.COUNT());
+    hec::QResultBase* result = hec::query(&findRelationQuery);
+    ASSERT_NE(result, nullptr);
+    std::vector<size_t> results = result->getResultList();
+    ASSERT_EQ(results[TR_DISJOINT], 0);
+    ASSERT_EQ(results[TR_INTERSECT], 4);
+    ASSERT_EQ(results[TR_INSIDE], 1);
+    ASSERT_EQ(results[TR_CONTAINS], 0);
+    ASSERT_EQ(results[TR_COVERED_BY], 0);
+    ASSERT_EQ(results[TR_COVERS], 0);
+    ASSERT_EQ(results[TR_EQUAL], 0);
+    ASSERT_EQ(results[TR_MEET], 0);
+    delete result;
+    // range over the whole dataspace, each polygon once although it is stored in every partition it overlaps
+    hec::RangeQuery rangeQuery(datasetSID, 1, "POLYGON ((-180 -90,180 -90,180 90,-180 90,-180 -90))", hec::QR_COLLECT);
+    result = hec::query(&rangeQuery);
+    ASSERT_NE(result, nullptr);
+    std::vector<size_t> rangeIDs = result->getResultList();
+    std::sort(rangeIDs.begin(), rangeIDs.end());
+    ASSERT_EQ((std::unique(rangeIDs.begin(), rangeIDs.end()) == rangeIDs.end()), true);
+    ASSERT_EQ(rangeIDs.size(), 11);
+    delete result;
+    hec::RangeQuery countQuery(datasetSID, 2, "POLYGON ((-180 -90,180 -90,180 90,-180 90,-180 -90))", hec::QR_COUNT);
+    result = hec::query(&countQuery);
+    ASSERT_NE(result, nullptr);
+    ASSERT_EQ(result->getResultCount(), 11);
+    delete result;
+    // distance joins on polygons are rejected (only this query fails)
+    hec::DistanceJoinQuery distanceQuery(datasetRID, datasetSID, 3, hec::QR_COLLECT, 7.65);
+    result = hec::query(&distanceQuery);
+    ASSERT_EQ(result, nullptr);
+    hec::RangeQuery laterQuery(datasetSID, 4, "POLYGON ((-180 -90,180 -90,180 90,-180 90,-180 -90))", hec::QR_COLLECT);
+    result = hec::query(&laterQuery);
+    ASSERT_NE(result, nullptr);
+    ASSERT_EQ(result->getResultList().size(), 11);
+    delete result;
+    ret = hec::unloadDataset(datasetRID);
+    ASSERT_EQ(DBERR_OK, ret);
+    ret = hec::unloadDataset(datasetSID);
+    ASSERT_EQ(DBERR_OK, ret);
+
+    // knn on points (same results as the uniform grid index)
+    std::string points = std::string(HECATONCHEIR_DIR) + "/test/samples/data_sample_points.wkt";
+    int datasetPID = hec::prepareDataset(points, "WKT", "POINT", false);
+    ASSERT_EQ(0, datasetPID);
+    ret = hec::partition({datasetPID});
+    ASSERT_EQ(DBERR_OK, ret);
+    ret = hec::buildIndex({datasetPID}, hec::IT_RTREE);
+    ASSERT_EQ(DBERR_OK, ret);
+    std::string queriesPath = std::string(HECATONCHEIR_DIR) + "/test/samples/query_sample_points.wkt";
+    std::vector<hec::Query *> batch = hec::loadKNNQueriesFromFile(queriesPath, "WKT", datasetPID, 2);
+    int batchSize = batch.size();
+    ASSERT_EQ(batchSize, 2);
+    std::unordered_map<int, std::unique_ptr<hec::QResultBase>> knnResults = hec::query(batch, hec::Q_KNN);
+    std::vector<size_t> ids = knnResults[0]->getResultList();
+    int totalIds = ids.size();
+    ASSERT_EQ(totalIds, 2);
+    ASSERT_EQ(ids[0], 33);
+    ASSERT_EQ(ids[1], 31);
+    ids = knnResults[1]->getResultList();
+    totalIds = ids.size();
+    ASSERT_EQ(totalIds, 2);
+    ASSERT_EQ(ids[0], 53);
+    ASSERT_EQ(ids[1], 58);
+    // free memory
+    delete batch[0];
+    delete batch[1];
+    batch.clear();
+    knnResults.clear();
+    ret = hec::unloadDataset(datasetPID);
+    ASSERT_EQ(DBERR_OK, ret);
+}
+
+void QueryTest::test12() {
+    // points on the uniform grid
+    std::string points = std::string(HECATONCHEIR_DIR) + "/test/samples/data_sample_points.wkt";
+    int datasetPID = hec::prepareDataset(points, "WKT", "POINT", false);
+    ASSERT_EQ(0, datasetPID);
+    int ret = hec::partition({datasetPID});
+    ASSERT_EQ(DBERR_OK, ret);
+    ret = hec::buildIndex({datasetPID}, hec::IT_UNIFORM_GRID);
+    ASSERT_EQ(DBERR_OK, ret);
+    std::string window = "POLYGON ((-86.746881 32.515601,-86.746899 32.515601,-86.746899 32.515631,-86.746881 32.515631,-86.746881 32.515601))";
+    hec::RangeQuery pointQuery(datasetPID, 0, window, hec::QR_COLLECT);
+    hec::QResultBase* result = hec::query(&pointQuery);
+    ASSERT_NE(result, nullptr);
+    std::vector<size_t> ids = result->getResultList();
+    int totalIds = ids.size();
+    ASSERT_EQ(totalIds, 1);
+    ASSERT_EQ(ids[0], 11);
+    delete result;
+    // insert a point in the window
+    std::vector<std::pair<size_t, std::string>> pointInserts = {{1000, "POINT (-86.74689 32.51561)"}};
+    ret = hec::insertObjects(datasetPID, pointInserts);
+    ASSERT_EQ(DBERR_OK, ret);
+    result = hec::query(&pointQuery);
+    ASSERT_NE(result, nullptr);
+    ids = result->getResultList();
+    std::sort(ids.begin(), ids.end());
+    totalIds = ids.size();
+    ASSERT_EQ(totalIds, 2);
+    ASSERT_EQ(ids[0], 11);
+    ASSERT_EQ(ids[1], 1000);
+    delete result;
+    // delete the original point, then the inserted one
+    std::vector<size_t> pointDeletes = {11};
+    ret = hec::deleteObjects(datasetPID, pointDeletes);
+    ASSERT_EQ(DBERR_OK, ret);
+    result = hec::query(&pointQuery);
+    ASSERT_NE(result, nullptr);
+    ids = result->getResultList();
+    totalIds = ids.size();
+    ASSERT_EQ(totalIds, 1);
+    ASSERT_EQ(ids[0], 1000);
+    delete result;
+    pointDeletes = {1000};
+    ret = hec::deleteObjects(datasetPID, pointDeletes);
+    ASSERT_EQ(DBERR_OK, ret);
+    result = hec::query(&pointQuery);
+    ASSERT_NE(result, nullptr);
+    ASSERT_EQ(result->getResultCount(), 0);
+    delete result;
+    ret = hec::unloadDataset(datasetPID);
+    ASSERT_EQ(DBERR_OK, ret);
+
+    // polygons on the two-layer index
+    std::string polygons = std::string(HECATONCHEIR_DIR) + "/test/samples/data_sample_polygons_2.wkt";
+    int datasetRID = hec::prepareDataset(polygons, "WKT", "POLYGON", false);
+    ASSERT_EQ(0, datasetRID);
+    ret = hec::partition({datasetRID});
+    ASSERT_EQ(DBERR_OK, ret);
+    ret = hec::buildIndex({datasetRID}, hec::IT_TWO_LAYER);
+    ASSERT_EQ(DBERR_OK, ret);
+    hec::RangeQuery emptyAreaQuery(datasetRID, 1, "POLYGON ((-96 49,-93 49,-93 52,-96 52,-96 49))", hec::QR_COLLECT);
+    hec::RangeQuery firstPolygonQuery(datasetRID, 2, "POLYGON ((-100.25 64.9,-100.05 64.9,-100.05 65.2,-100.25 65.2,-100.25 64.9))", hec::QR_COLLECT);
+    result = hec::query(&emptyAreaQuery);
+    ASSERT_NE(result, nullptr);
+    ASSERT_EQ(result->getResultCount(), 0);
+    delete result;
+    result = hec::query(&firstPolygonQuery);
+    ASSERT_NE(result, nullptr);
+    ids = result->getResultList();
+    totalIds = ids.size();
+    ASSERT_EQ(totalIds, 1);
+    ASSERT_EQ(ids[0], 0);
+    delete result;
+    // insert a polygon in the empty area and delete the first polygon
+    std::vector<std::pair<size_t, std::string>> polygonInserts = {{1000, "POLYGON ((-95 50,-94 50,-94 51,-95 51,-95 50))"}};
+    ret = hec::insertObjects(datasetRID, polygonInserts);
+    ASSERT_EQ(DBERR_OK, ret);
+    std::vector<size_t> polygonDeletes = {0};
+    ret = hec::deleteObjects(datasetRID, polygonDeletes);
+    ASSERT_EQ(DBERR_OK, ret);
+    // the updates survive a rebuild of the index
+    for (int rebuild=0; rebuild<2; rebuild++) {
+        if (rebuild) {
+            ret = hec::buildIndex({datasetRID}, hec::IT_TWO_LAYER);
+            ASSERT_EQ(DBERR_OK, ret);
+        }
+        result = hec::query(&emptyAreaQuery);
+        ASSERT_NE(result, nullptr);
+        ids = result->getResultList();
+        totalIds = ids.size();
+        ASSERT_EQ(totalIds, 1);
+        ASSERT_EQ(ids[0], 1000);
+        delete result;
+        result = hec::query(&firstPolygonQuery);
+        ASSERT_NE(result, nullptr);
+        ASSERT_EQ(result->getResultCount(), 0);
+        delete result;
+    }
+    ret = hec::unloadDataset(datasetRID);
+    ASSERT_EQ(DBERR_OK, ret);
+}
+
+void QueryTest::test13() {
+    // a dense cluster of points overloads a uniform grid cell, which gets subdivided
+    std::string points = std::string(HECATONCHEIR_DIR) + "/test/samples/data_sample_points.wkt";
+    int datasetPID = hec::prepareDataset(points, "WKT", "POINT", false);
+    ASSERT_EQ(0, datasetPID);
+    int ret = hec::partition({datasetPID});
+    ASSERT_EQ(DBERR_OK, ret);
+    ret = hec::buildIndex({datasetPID}, hec::IT_UNIFORM_GRID);
+    ASSERT_EQ(DBERR_OK, ret);
+    // 64x64 lattice with a 0.00001 step, next to point 11
+    std::vector<std::pair<size_t, std::string>> cluster;
+    for (int j=0; j<64; j++) {
+        for (int i=0; i<64; i++) {
+            cluster.emplace_back(100000 + i + j*64, "POINT (" + std::to_string(-86.747 + i * 0.00001) + " " + std::to_string(32.515 + j * 0.00001) + ")");
+        }
+    }
+    ret = hec::insertObjects(datasetPID, cluster);
+    ASSERT_EQ(DBERR_OK, ret);
+    // lattice columns 10..29 and rows 5..14
+    std::string window = "POLYGON ((" + std::to_string(-86.747 + 0.000095) + " " + std::to_string(32.515 + 0.000045) + "," 
+                                      + std::to_string(-86.747 + 0.000295) + " " + std::to_string(32.515 + 0.000045) + ","
+                                      + std::to_string(-86.747 + 0.000295) + " " + std::to_string(32.515 + 0.000145) + ","
+                                      + std::to_string(-86.747 + 0.000095) + " " + std::to_string(32.515 + 0.000145) + ","
+                                      + std::to_string(-86.747 + 0.000095) + " " + std::to_string(32.515 + 0.000045) + "))";
+    hec::RangeQuery rangeQuery(datasetPID, 0, window, hec::QR_COLLECT);
+    hec::QResultBase* result = hec::query(&rangeQuery);
+    ASSERT_NE(result, nullptr);
+    std::vector<size_t> ids = result->getResultList();
+    int totalIds = ids.size();
+    ASSERT_EQ(totalIds, 200);
+    std::sort(ids.begin(), ids.end());
+    ASSERT_EQ(ids[0], (100000 + 10 + 5*64));
+    ASSERT_EQ(ids[199], (100000 + 29 + 14*64));
+    delete result;
+    // the 3 nearest lattice points to a point next to (30,30)
+    std::string qPoint = "POINT (" + std::to_string(-86.747 + 0.000301) + " " + std::to_string(32.515 + 0.000303) + ")";
+    hec::KNNQuery knnQuery(datasetPID, 1, qPoint, 3);
+    result = hec::query(&knnQuery);
+    ASSERT_NE(result, nullptr);
+    ids = result->getResultList();
+    totalIds = ids.size();
+    ASSERT_EQ(totalIds, 3);
+    std::sort(ids.begin(), ids.end());
+    ASSERT_EQ(ids[0], (100000 + 30 + 30*64));
+    ASSERT_EQ(ids[1], (100000 + 31 + 30*64));
+    ASSERT_EQ(ids[2], (100000 + 30 + 31*64));
+    delete result;
+    ret = hec::unloadDataset(datasetPID);
+    ASSERT_EQ(DBERR_OK, ret);
+}
+
+void QueryTest::test14() {
+    // save a built two-layer index with an inserted polygon, restore it into a fresh dataset
+    std::string polygons = std::string(HECATONCHEIR_DIR) + "/test/samples/data_sample_polygons_2.wkt";
+    // every node writes its own file next to this prefix, in a fresh directory
+    char snapshotDir[] = "/tmp/hecatoncheir_test_XXXXXX";
+    char* createdDir = mkdtemp(snapshotDir);
+    ASSERT_NE(createdDir, nullptr);
+    std::string snapshotPath = std::string(snapshotDir) + "/snapshot";
+    int datasetRID = hec::prepareDataset(polygons, "WKT", "POLYGON", false);
+    ASSERT_EQ(0, datasetRID);
+    int ret = hec::partition({datasetRID});
+    ASSERT_EQ(DBERR_OK, ret);
+    ret = hec::buildIndex({datasetRID}, hec::IT_TWO_LAYER);
+    ASSERT_EQ(DBERR_OK, ret);
+    std::vector<std::pair<size_t, std::string>> polygonInserts = {{1000, "POLYGON ((-95 50,-94 50,-94 51,-95 51,-95 50))"}};
+    ret = hec::insertObjects(datasetRID, polygonInserts);
+    ASSERT_EQ(DBERR_OK, ret);
+    ret = hec::saveSnapshot(datasetRID, snapshotPath);
+    ASSERT_EQ(DBERR_OK, ret);
+    ret = hec::unloadDataset(datasetRID);
+    ASSERT_EQ(DBERR_OK, ret);
+
+    datasetRID = hec::prepareDataset(polygons, "WKT", "POLYGON", false);
+    ASSERT_EQ(0, datasetRID);
+    ret = hec::loadSnapshot(datasetRID, snapshotPath);
+    ASSERT_EQ(DBERR_OK, ret);
+    hec::RangeQuery insertedQuery(datasetRID, 0, "POLYGON ((-96 49,-93 49,-93 52,-96 52,-96 49))", hec::QR_COLLECT);
+    hec::RangeQuery firstPolygonQuery(datasetRID, 1, "POLYGON ((-100.25 64.9,-100.05 64.9,-100.05 65.2,-100.25 65.2,-100.25 64.9))", hec::QR_COLLECT);
+    hec::QResultBase* result = hec::query(&insertedQuery);
+    ASSERT_NE(result, nullptr);
+    std::vector<size_t> ids = result->getResultList();
+    int totalIds = ids.size();
+    ASSERT_EQ(totalIds, 1);
+    ASSERT_EQ(ids[0], 1000);
+    delete result;
+    result = hec::query(&firstPolygonQuery);
+    ASSERT_NE(result, nullptr);
+    ids = result->getResultList();
+    totalIds = ids.size();
+    ASSERT_EQ(totalIds, 1);
+    ASSERT_EQ(ids[0], 0);
+    delete result;
+    // the host's object directory is rebuilt from the loaded objects
+    std::vector<hec::ObjectRecord> records = hec::lookupObjects(datasetRID, {1000, 0}, false);
+    ASSERT_EQ(records.size(), 2);
+    ASSERT_EQ(records[0].recID, 1000);
+    ASSERT_EQ(records[1].recID, 0);
+    ret = hec::unloadDataset(datasetRID);
+    ASSERT_EQ(DBERR_OK, ret);
+    std::filesystem::remove_all(snapshotDir);
+}
+
+void QueryTest::test15() {
+    // memory footprint of a built two-layer index, per worker
+    std::string polygons = std::string(HECATONCHEIR_DIR) + "/test/samples/data_sample_polygons_2.wkt";
+    int datasetRID = hec::prepareDataset(polygons, "WKT", "POLYGON", false);
+    ASSERT_EQ(0, datasetRID);
+    int ret = hec::partition({datasetRID});
+    ASSERT_EQ(DBERR_OK, ret);
+    ret = hec::buildIndex({datasetRID}, hec::IT_TWO_LAYER);
+    ASSERT_EQ(DBERR_OK, ret);
+    std::vector<hec::MemoryFootprint> footprints = hec::getMemoryFootprint(datasetRID);
+    // every worker (the host excluded) reports
+    ASSERT_EQ(footprints.size(), g_workers_size - 1);
+    size_t objectCount = 0, indexEntryCount = 0, geometryBytes = 0, indexBytes = 0;
+    for (auto &it : footprints) {
+        ASSERT_EQ(it.datasetID, datasetRID);
+        ASSERT_NE(it.rank, HOST_GLOBAL_RANK);
+        objectCount += it.objectCount;
+        indexEntryCount += it.indexEntryCount;
+        geometryBytes += it.geometryBytes;
+        indexBytes += it.indexBytes;
+        // with objects, the MBRs are accounted for
+        ASSERT_EQ((it.objectCount == 0 || it.mbrBytes >= it.objectCount * sizeof(MBR)), true);
+    }
+    // objects that span several nodes are replicated, and every object has an index entry
+    ASSERT_EQ((objectCount >= 11), true);
+    ASSERT_EQ((indexEntryCount >= objectCount), true);
+    ASSERT_NE(geometryBytes, 0);
+    ASSERT_NE(indexBytes, 0);
+    ret = hec::unloadDataset(datasetRID);
+    ASSERT_EQ(DBERR_OK, ret);
+}
+
+void QueryTest::test16() {
+    // three resident datasets, the third one a copy of the first
+    std::string polygonsR = std::string(HECATONCHEIR_DIR) + "/test/samples/data_sample_polygons_1.wkt";
+    std::string polygonsS = std::string(HECATONCHEIR_DIR) + "/test/samples/data_sample_polygons_2.wkt";
+    int datasetRID = hec::prepareDataset(polygonsR, "WKT", "POLYGON", false);
+    int datasetSID = hec::prepareDataset(polygonsS, "WKT", "POLYGON", false);
+    int datasetTID = hec::prepareDataset(polygonsR, "WKT", "POLYGON", false);
+    ASSERT_EQ(0, datasetRID);
+    ASSERT_EQ(1, datasetSID);
+    ASSERT_EQ(2, datasetTID);
+    int ret = hec::partition({datasetRID, datasetSID, datasetTID});
+    ASSERT_EQ(DBERR_OK, ret);
+    ret = hec::buildIndex({datasetRID, datasetSID, datasetTID}, hec::IT_TWO_LAYER);
+    ASSERT_EQ(DBERR_OK, ret);
+    // both pairs give the same relations, without reloading
+    for (auto &datasetID : {datasetRID, datasetTID}) {
+        hec::PredicateJoinQuery findRelationQuery(datasetID, datasetSID, 0, hec::spatialQueries.FIND_RELATION(), hec::queryResultTypes.COUNT());
+        hec::QResultBase* result = hec::query(&findRelationQuery);
+        ASSERT_NE(result, nullptr);
+        std::vector<size_t> results = result->getResultList();
+        ASSERT_EQ(results[TR_INTERSECT], 4);
+        ASSERT_EQ(results[TR_INSIDE], 1);
+        delete result;
+    }
+    // the freed ID is reused, and a dataset within the global dataspace is partitioned on its own
+    ret = hec::unloadDataset(datasetRID);
+    ASSERT_EQ(DBERR_OK, ret);
+    datasetRID = hec::prepareDataset(polygonsR, "WKT", "POLYGON", false);
+    ASSERT_EQ(0, datasetRID);
+    ret = hec::partition({datasetRID});
+    ASSERT_EQ(DBERR_OK, ret);
+    ret = hec::buildIndex({datasetRID}, hec::IT_TWO_LAYER);
+    ASSERT_EQ(DBERR_OK, ret);
+    hec::PredicateJoinQuery findRelationQuery(datasetRID, datasetSID, 0, hec::spatialQueries.FIND_RELATION(), hec::queryResultTypes.COUNT());
+    hec::QResultBase* result = hec::query(&findRelationQuery);
+    ASSERT_NE(result, nullptr);
+    std::vector<size_t> results = result->getResultList();
+    ASSERT_EQ(results[TR_INTERSECT], 4);
+    ASSERT_EQ(results[TR_INSIDE], 1);
+    delete result;
+    // unload datasets
+    for (auto &datasetID : {datasetRID, datasetSID, datasetTID}) {
+        ret = hec::unloadDataset(datasetID);
+        ASSERT_EQ(DBERR_OK, ret);
+    }
+}
+
+void QueryTest::test17() {
+    // the same polygons on both indexes
+    std::string polygons = std::string(HECATONCHEIR_DIR) + "/test/samples/data_sample_polygons_2.wkt";
+    int datasetTLID = hec::prepareDataset(polygons, "WKT", "POLYGON", false);
+    int datasetRTID = hec::prepareDataset(polygons, "WKT", "POLYGON", false);
+    ASSERT_EQ(0, datasetTLID);
+    ASSERT_EQ(1, datasetRTID);
+    int ret = hec::partition({datasetTLID, datasetRTID});
+    ASSERT_EQ(DBERR_OK, ret);
+    ret = hec::buildIndex({datasetTLID}, hec::IT_TWO_LAYER);
+    ASSERT_EQ(DBERR_OK, ret);
+    ret = hec::buildIndex({datasetRTID}, hec::IT_RTREE);
+    ASSERT_EQ(DBERR_OK, ret);
+    // small windows, most of them over empty parts of the partitions
+    int queryID = 0;
+    size_t totalResults = 0;
+    for (double x = -101.1; x < -99.5; x += 0.2) {
+        for (double y = 64.8; y < 65.7; y += 0.2) {
+            std::string window = "POLYGON ((" + std::to_string(x) + " " + std::to_string(y) + "," + std::to_string(x + 0.1) + " " + std::to_string(y) + "," + 
+                                 std::to_string(x + 0.1) + " " + std::to_string(y + 0.1) + "," + std::to_string(x) + " " + std::to_string(y + 0.1) + "," + 
+                                 std::to_string(x) + " " + std::to_string(y) + "))";
+            std::vector<size_t> ids[2];
+            int datasetIDs[2] = {datasetTLID, datasetRTID};
+            for (int i=0; i<2; i++) {
+                hec::RangeQuery rangeQuery(datasetIDs[i], queryID++, window, hec::QR_COLLECT);
+                hec::QResultBase* result = hec::query(&rangeQuery);
+                ASSERT_NE(result, nullptr);
+                ids[i] = result->getResultList();
+                std::sort(ids[i].begin(), ids[i].end());
+                delete result;
+            }
+            ASSERT_EQ((ids[0] == ids[1]), true);
+            totalResults += ids[0].size();
+        }
+    }
+    ASSERT_NE(totalResults, 0);
+    // unload datasets
+    ret = hec::unloadDataset(datasetTLID);
+    ASSERT_EQ(DBERR_OK, ret);
+    ret = hec::unloadDataset(datasetRTID);
+    ASSERT_EQ(DBERR_OK, ret);
+}
+
+void QueryTest::test18() {
+    // fetch polygons by rec ID, the missing ones left out
+    std::string polygons = std::string(HECATONCHEIR_DIR) + "/test/samples/data_sample_polygons_2.wkt";
+    int datasetRID = hec::prepareDataset(polygons, "WKT", "POLYGON", false);
+    ASSERT_EQ(0, datasetRID);
+    int ret = hec::partition({datasetRID});
+    ASSERT_EQ(DBERR_OK, ret);
+    ret = hec::buildIndex({datasetRID}, hec::IT_TWO_LAYER);
+    ASSERT_EQ(DBERR_OK, ret);
+    std::vector<hec::ObjectRecord> records = hec::lookupObjects(datasetRID, {10, 0, 999, 5}, false);
+    ASSERT_EQ(records.size(), 3);
+    ASSERT_EQ(records[0].recID, 10);
+    ASSERT_EQ(records[1].recID, 0);
+    ASSERT_EQ(records[2].recID, 5);
+    // the MBR of the first polygon
+    ASSERT_EQ((std::abs(records[1].xMin - (-100.20)) < 1e-9 && std::abs(records[1].yMin - 64.85) < 1e-9), true);
+    ASSERT_EQ((std::abs(records[1].xMax - (-100.09)) < 1e-9 && std::abs(records[1].yMax - 65.25) < 1e-9), true);
+    ASSERT_EQ(records[1].wkt.empty(), true);
+    // with its geometry
+    records = hec::lookupObjects(datasetRID, {0}, true);
+    ASSERT_EQ(records.size(), 1);
+    ASSERT_EQ(records[0].wkt.rfind("POLYGON", 0), 0);
+    // an inserted object is found on any worker, a deleted one is not
+    std::vector<std::pair<size_t, std::string>> polygonInserts = {{1000, "POLYGON ((-95 50,-94 50,-94 51,-95 51,-95 50))"}};
+    ret = hec::insertObjects(datasetRID, polygonInserts);
+    ASSERT_EQ(DBERR_OK, ret);
+    std::vector<size_t> polygonDeletes = {5};
+    ret = hec::deleteObjects(datasetRID, polygonDeletes);
+    ASSERT_EQ(DBERR_OK, ret);
+    records = hec::lookupObjects(datasetRID, {5, 1000}, false);
+    ASSERT_EQ(records.size(), 1);
+    ASSERT_EQ(records[0].recID, 1000);
+    ASSERT_EQ(records[0].xMin, -95);
+    ASSERT_EQ(records[0].yMax, 51);
+    ret = hec::unloadDataset(datasetRID);
+    ASSERT_EQ(DBERR_OK, ret);
+}
+
+void QueryTest::test19() {
+    // vertical bars, each one of S overlapping the right half of the same one of R only
+    int barCount = 40;
+    std::string barsR = "/tmp/hecatoncheir_test_bars_R.wkt";
+    std::string barsS = "/tmp/hecatoncheir_test_bars_S.wkt";
+    std::ofstream fileR(barsR), fileS(barsS);
+    for (int i=0; i<barCount; i++) {
+        std::string xR[2] = {std::to_string(i * 0.01), std::to_string(i * 0.01 + 0.004)};
+        std::string xS[2] = {std::to_string(i * 0.01 + 0.002), std::to_string(i * 0.01 + 0.006)};
+        fileR << "POLYGON ((" << xR[0] << " 0," << xR[1] << " 0," << xR[1] << " 1," << xR[0] << " 1," << xR[0] << " 0))\n";
+        fileS << "POLYGON ((" << xS[0] << " 0," << xS[1] << " 0," << xS[1] << " 0.8," << xS[0] << " 0.8," << xS[0] << " 0))\n";
+    }
+    fileR.close();
+    fileS.close();
+    int datasetRID = hec::prepareDataset(barsR, "WKT", "POLYGON", false);
+    int datasetSID = hec::prepareDataset(barsS, "WKT", "POLYGON", false);
+    ASSERT_EQ(0, datasetRID);
+    ASSERT_EQ(1, datasetSID);
+    int ret = hec::partition({datasetRID, datasetSID});
+    ASSERT_EQ(DBERR_OK, ret);
+    ret = hec::buildIndex({datasetRID, datasetSID}, hec::IT_TWO_LAYER);
+    ASSERT_EQ(DBERR_OK, ret);
+    // every pair is found once, with the same rec IDs
+    hec::PredicateJoinQuery intersectionJoinQuery(datasetRID, datasetSID, 0, hec::Q_INTERSECTION_JOIN, hec::QR_COLLECT);
+    hec::QResultBase* result = hec::query(&intersectionJoinQuery);
+    ASSERT_NE(result, nullptr);
+    std::vector<size_t> results = result->getResultList();
+    ASSERT_EQ(results.size(), 2 * barCount);
+    for (size_t i=0; i<results.size(); i+=2) {
+        ASSERT_EQ(results[i], results[i+1]);
+    }
+    delete result;
+    hec::PredicateJoinQuery findRelationQuery(datasetRID, datasetSID, 1, hec::spatialQueries.FIND_RELATION(), hec::queryResultTypes.COUNT());
+    result = hec::query(&findRelationQuery);
+    ASSERT_NE(result, nullptr);
+    results = result->getResultList();
+    ASSERT_EQ(results[TR_INTERSECT], barCount);
+    ASSERT_EQ(results[TR_INSIDE], 0);
+    ASSERT_EQ(results[TR_DISJOINT], 0);
+    delete result;
+    ret = hec::unloadDataset(datasetRID);
+    ASSERT_EQ(DBERR_OK, ret);
+    ret = hec::unloadDataset(datasetSID);
+    ASSERT_EQ(DBERR_OK, ret);
+    std::remove(barsR.c_str());
+    std::remove(barsS.c_str());
+}
+
+void QueryTest::test20() {
+    // the same polygons on both indexes
+    std::string polygons = std::string(HECATONCHEIR_DIR) + "/test/samples/data_sample_polygons_2.wkt";
+    int datasetTLID = hec::prepareDataset(polygons, "WKT", "POLYGON", false);
+    int datasetRTID = hec::prepareDataset(polygons, "WKT", "POLYGON", false);
+    ASSERT_EQ(0, datasetTLID);
+    ASSERT_EQ(1, datasetRTID);
+    int ret = hec::partition({datasetTLID, datasetRTID});
+    ASSERT_EQ(DBERR_OK, ret);
+    ret = hec::buildIndex({datasetTLID}, hec::IT_TWO_LAYER);
+    ASSERT_EQ(DBERR_OK, ret);
+    ret = hec::buildIndex({datasetRTID}, hec::IT_RTREE);
+    ASSERT_EQ(DBERR_OK, ret);
+    // windows around all the small polygons, across some of them, around the two large ones and inside one
+    std::vector<std::string> windows = {"POLYGON ((-101.5 64,-99 64,-99 66,-101.5 66,-101.5 64))", 
+                                        "POLYGON ((-100.45 64.9,-99.75 64.9,-99.75 65.3,-100.45 65.3,-100.45 64.9))",
+                                        "POLYGON ((-90 44,-83 44,-83 57,-90 57,-90 44))",
+                                        "POLYGON ((-100.15 65,-100.12 65,-100.12 65.2,-100.15 65.2,-100.15 65))"};
+    // 0: only compared with the R-tree
+    std::vector<size_t> expectedCounts = {10, 0, 1, 0};
+    int queryID = 0;
+    for (int w=0; w<windows.size(); w++) {
+        std::vector<size_t> ids[2];
+        int datasetIDs[2] = {datasetTLID, datasetRTID};
+        for (int i=0; i<2; i++) {
+            hec::RangeQuery rangeQuery(datasetIDs[i], queryID++, windows[w], hec::QR_COLLECT);
+            hec::QResultBase* result = hec::query(&rangeQuery);
+            ASSERT_NE(result, nullptr);
+            ids[i] = result->getResultList();
+            std::sort(ids[i].begin(), ids[i].end());
+            delete result;
+        }
+        ASSERT_EQ((ids[0] == ids[1]), true);
+        if (expectedCounts[w] > 0) {
+            ASSERT_EQ(ids[0].size(), expectedCounts[w]);
+        }
+        ASSERT_NE(ids[0].size(), 0);
+    }
+    // unload datasets
+    ret = hec::unloadDataset(datasetTLID);
+    ASSERT_EQ(DBERR_OK, ret);
+    ret = hec::unloadDataset(datasetRTID);
+    ASSERT_EQ(DBERR_OK, ret);
+}
+
+void QueryTest::test21() {
+    // right triangles with the right angle at the bottom left, 0.004 wide and 1 tall
+    int triangleCount = 40;
+    std::string triangles = "/tmp/hecatoncheir_test_triangles.wkt";
+    std::ofstream file(triangles);
+    for (int i=0; i<triangleCount; i++) {
+        std::string x[2] = {std::to_string(i * 0.01), std::to_string(i * 0.01 + 0.004)};
+        file << "POLYGON ((" << x[0] << " 0," << x[1] << " 0," << x[0] << " 1," << x[0] << " 0))\n";
+    }
+    file.close();
+    int datasetRID = hec::prepareDataset(triangles, "WKT", "POLYGON", false);
+    ASSERT_EQ(0, datasetRID);
+    int ret = hec::partition({datasetRID});
+    ASSERT_EQ(DBERR_OK, ret);
+    ret = hec::buildIndex({datasetRID}, hec::IT_TWO_LAYER);
+    ASSERT_EQ(DBERR_OK, ret);
+    // the range cache is off by default
+    ret = hec::setRangeCache(16);
+    ASSERT_EQ(DBERR_OK, ret);
+    // a pan across overlapping windows, zoom-ins inside them, the whole dataspace and a window inside it
+    std::vector<std::array<double, 4>> windows;
+    for (int k=0; k<5; k++) {
+        windows.push_back({0.0505 + 0.013 * k, 0.5, 0.1505 + 0.013 * k, 0.6});
+    }
+    for (int k=0; k<5; k++) {
+        windows.push_back({0.0705 + 0.013 * k, 0.52, 0.1205 + 0.013 * k, 0.58});
+    }
+    windows.push_back({-1, -1, 2, 2});
+    windows.push_back({0.2005, 0.1, 0.3005, 0.9});
+    auto toWKT = [](const std::array<double, 4> &w) {
+        std::string x[2] = {std::to_string(w[0]), std::to_string(w[2])};
+        std::string y[2] = {std::to_string(w[1]), std::to_string(w[3])};
+        return "POLYGON ((" + x[0] + " " + y[0] + "," + x[1] + " " + y[0] + "," + x[1] + " " + y[1] + "," + x[0] + " " + y[1] + "," + x[0] + " " + y[0] + "))";
+    };
+    int queryID = 0;
+    for (int pass=0; pass<2; pass++) {
+        for (auto &w : windows) {
+            // the hypotenuse of triangle i is at x = 0.01i + 0.004(1-y)
+            size_t expected = 0;
+            for (int i=0; i<triangleCount; i++) {
+                if (w[0] <= i * 0.01 + 0.004 * (1 - std::max(w[1], 0.0)) && w[2] >= i * 0.01) {
+                    expected++;
+                }
+            }
+            hec::RangeQuery countQuery(datasetRID, queryID++, toWKT(w), hec::QR_COUNT);
+            hec::QResultBase* result = hec::query(&countQuery);
+            ASSERT_NE(result, nullptr);
+            ASSERT_EQ(result->getResultCount(), expected);
+            delete result;
+            hec::RangeQuery collectQuery(datasetRID, queryID++, toWKT(w), hec::QR_COLLECT);
+            result = hec::query(&collectQuery);
+            ASSERT_NE(result, nullptr);
+            std::vector<size_t> ids = result->getResultList();
+            std::sort(ids.begin(), ids.end());
+            ASSERT_EQ((std::unique(ids.begin(), ids.end()) == ids.end()), true);
+            ASSERT_EQ(ids.size(), expected);
+            delete result;
+        }
+    }
+    // the cached windows see the inserted and deleted objects
+    std::vector<std::pair<size_t, std::string>> polygonInserts = {{1000, "POLYGON ((0.105 0.4,0.106 0.4,0.106 0.7,0.105 0.7,0.105 0.4))"}};
+    ret = hec::insertObjects(datasetRID, polygonInserts);
+    ASSERT_EQ(DBERR_OK, ret);
+    std::vector<size_t> polygonDeletes = {10};
+    ret = hec::deleteObjects(datasetRID, polygonDeletes);
+    ASSERT_EQ(DBERR_OK, ret);
+    hec::RangeQuery rangeQuery(datasetRID, queryID++, toWKT(windows[5]), hec::QR_COLLECT);
+    hec::QResultBase* result = hec::query(&rangeQuery);
+    ASSERT_NE(result, nullptr);
+    std::vector<size_t> ids = result->getResultList();
+    ASSERT_EQ((std::find(ids.begin(), ids.end(), 1000) != ids.end()), true);
+    ASSERT_EQ((std::find(ids.begin(), ids.end(), 10) == ids.end()), true);
+    delete result;
+    ret = hec::setRangeCache(0);
+    ASSERT_EQ(DBERR_OK, ret);
+    ret = hec::unloadDataset(datasetRID);
+    ASSERT_EQ(DBERR_OK, ret);
+    std::remove(triangles.c_str());
+}
+
+void QueryTest::test22() {
+    // the same polygons on both indexes
+    std::string polygons = std::string(HECATONCHEIR_DIR) + "/test/samples/data_sample_polygons_2.wkt";
+    int datasetTLID = hec::prepareDataset(polygons, "WKT", "POLYGON", false);
+    int datasetRTID = hec::prepareDataset(polygons, "WKT", "POLYGON", false);
+    ASSERT_EQ(0, datasetTLID);
+    ASSERT_EQ(1, datasetRTID);
+    int ret = hec::partition({datasetTLID, datasetRTID});
+    ASSERT_EQ(DBERR_OK, ret);
+    ret = hec::buildIndex({datasetTLID}, hec::IT_TWO_LAYER);
+    ASSERT_EQ(DBERR_OK, ret);
+    ret = hec::buildIndex({datasetRTID}, hec::IT_RTREE);
+    ASSERT_EQ(DBERR_OK, ret);
+    // overlapping windows over the small polygons, the whole dataspace and a triangle across the small polygons
+    std::vector<std::string> windows;
+    for (double x = -101.1; x < -99.5; x += 0.15) {
+        for (double y = 64.8; y < 65.7; y += 0.15) {
+            windows.push_back("POLYGON ((" + std::to_string(x) + " " + std::to_string(y) + "," + std::to_string(x + 0.3) + " " + std::to_string(y) + "," + 
+                              std::to_string(x + 0.3) + " " + std::to_string(y + 0.3) + "," + std::to_string(x) + " " + std::to_string(y + 0.3) + "," + 
+                              std::to_string(x) + " " + std::to_string(y) + "))");
+        }
+    }
+    windows.push_back("POLYGON ((-180 -90,180 -90,180 90,-180 90,-180 -90))");
+    windows.push_back("POLYGON ((-101.5 64,-99 64,-101.5 66,-101.5 64))");
+    // one batch on the two-layer index (shared scans), one query at a time on the R-tree
+    std::vector<hec::Query*> batch;
+    for (int w=0; w<windows.size(); w++) {
+        batch.push_back(new hec::RangeQuery(datasetTLID, w, windows[w], hec::QR_COLLECT));
+    }
+    std::unordered_map<int, std::unique_ptr<hec::QResultBase>> results = hec::query(batch, hec::Q_RANGE);
+    ASSERT_EQ(results.size(), windows.size());
+    size_t totalResults = 0;
+    for (int w=0; w<windows.size(); w++) {
+        ASSERT_NE(results[w].get(), nullptr);
+        std::vector<size_t> batchIDs = results[w]->getResultList();
+        std::sort(batchIDs.begin(), batchIDs.end());
+        hec::RangeQuery rangeQuery(datasetRTID, windows.size() + w, windows[w], hec::QR_COLLECT);
+        hec::QResultBase* result = hec::query(&rangeQuery);
+        ASSERT_NE(result, nullptr);
+        std::vector<size_t> ids = result->getResultList();
+        std::sort(ids.begin(), ids.end());
+        delete result;
+        ASSERT_EQ((batchIDs == ids), true);
+        totalResults += ids.size();
+    }
+    ASSERT_NE(totalResults, 0);
+    ASSERT_EQ(results[windows.size() - 2]->getResultList().size(), 11);
+    for (auto &query : batch) {
+        delete query;
+    }
+    // unload datasets
+    ret = hec::unloadDataset(datasetTLID);
+    ASSERT_EQ(DBERR_OK, ret);
+    ret = hec::unloadDataset(datasetRTID);
+    ASSERT_EQ(DBERR_OK, ret);
+}
+
+void QueryTest::test23() {
+    std::string polygons = std::string(HECATONCHEIR_DIR) + "/test/samples/data_sample_polygons_2.wkt";
+    int datasetTLID = hec::prepareDataset(polygons, "WKT", "POLYGON", false);
+    int datasetRTID = hec::prepareDataset(polygons, "WKT", "POLYGON", false);
+    ASSERT_EQ(0, datasetTLID);
+    ASSERT_EQ(1, datasetRTID);
+    int ret = hec::partition({datasetTLID, datasetRTID});
+    ASSERT_EQ(DBERR_OK, ret);
+    ret = hec::buildIndex({datasetTLID}, hec::IT_TWO_LAYER);
+    ASSERT_EQ(DBERR_OK, ret);
+    ret = hec::buildIndex({datasetRTID}, hec::IT_RTREE);
+    ASSERT_EQ(DBERR_OK, ret);
+    int queryID = 0;
+    auto collect = [&](int datasetID, const std::string &wkt) {
+        hec::RangeQuery rangeQuery(datasetID, queryID++, wkt, hec::QR_COLLECT);
+        hec::QResultBase* result = hec::query(&rangeQuery);
+        std::vector<size_t> ids;
+        if (result != nullptr) {
+            ids = result->getResultList();
+            delete result;
+        }
+        std::sort(ids.begin(), ids.end());
+        return ids;
+    };
+    // an L-shaped window over the small polygons (inside the dataspace, so that it is rasterized) and the two rectangles it is made of
+    std::string lWindow = "POLYGON ((-100.95 64.9,-99.5 64.9,-99.5 65.1,-100.6 65.1,-100.6 65.6,-100.95 65.6,-100.95 64.9))";
+    std::string bottom = "POLYGON ((-100.95 64.9,-99.5 64.9,-99.5 65.1,-100.95 65.1,-100.95 64.9))";
+    std::string left = "POLYGON ((-100.95 65.1,-100.6 65.1,-100.6 65.6,-100.95 65.6,-100.95 65.1))";
+    std::vector<size_t> lIDs = collect(datasetTLID, lWindow);
+    ASSERT_NE(lIDs.size(), 0);
+    ASSERT_EQ((collect(datasetRTID, lWindow) == lIDs), true);
+    std::vector<size_t> bottomIDs = collect(datasetTLID, bottom);
+    std::vector<size_t> leftIDs = collect(datasetTLID, left);
+    std::vector<size_t> unionIDs;
+    std::set_union(bottomIDs.begin(), bottomIDs.end(), leftIDs.begin(), leftIDs.end(), std::back_inserter(unionIDs));
+    ASSERT_EQ((unionIDs == lIDs), true);
+    // a star window across the small polygons
+    std::string star = "POLYGON ((-100.3 64.9,-100.1 65.1,-99.55 65.2,-100.0 65.35,-99.9 65.6,-100.3 65.45,-100.7 65.6,-100.6 65.35,-100.95 65.2,-100.5 65.1,-100.3 64.9))";
+    std::vector<size_t> starIDs = collect(datasetTLID, star);
+    ASSERT_EQ((collect(datasetRTID, star) == starIDs), true);
+    // unload datasets
+    ret = hec::unloadDataset(datasetTLID);
+    ASSERT_EQ(DBERR_OK, ret);
+    ret = hec::unloadDataset(datasetRTID);
+    ASSERT_EQ(DBERR_OK, ret);
+}
+
+void QueryTest::test24() {
+    std::string polygons = std::string(HECATONCHEIR_DIR) + "/test/samples/data_sample_polygons_2.wkt";
+    int datasetTLID = hec::prepareDataset(polygons, "WKT", "POLYGON", false);
+    int datasetRTID = hec::prepareDataset(polygons, "WKT", "POLYGON", false);
+    ASSERT_EQ(0, datasetTLID);
+    ASSERT_EQ(1, datasetRTID);
+    int ret = hec::partition({datasetTLID, datasetRTID});
+    ASSERT_EQ(DBERR_OK, ret);
+    ret = hec::buildIndex({datasetTLID}, hec::IT_TWO_LAYER);
+    ASSERT_EQ(DBERR_OK, ret);
+    ret = hec::buildIndex({datasetRTID}, hec::IT_RTREE);
+    ASSERT_EQ(DBERR_OK, ret);
+    int queryID = 0;
+    auto count = [&](int datasetID, const std::string &wkt) {
+        hec::RangeQuery rangeQuery(datasetID, queryID++, wkt, hec::QR_COUNT);
+        hec::QResultBase* result = hec::query(&rangeQuery);
+        size_t resultCount = (result != nullptr) ? result->getResultCount() : -1;
+        delete result;
+        return resultCount;
+    };
+    auto collect = [&](int datasetID, const std::string &wkt) {
+        hec::RangeQuery rangeQuery(datasetID, queryID++, wkt, hec::QR_COLLECT);
+        hec::QResultBase* result = hec::query(&rangeQuery);
+        size_t resultCount = (result != nullptr) ? result->getResultList().size() : -1;
+        delete result;
+        return resultCount;
+    };
+    auto box = [](double xMin, double yMin, double xMax, double yMax) {
+        return "POLYGON ((" + std::to_string(xMin) + " " + std::to_string(yMin) + "," + std::to_string(xMax) + " " + std::to_string(yMin) + "," + 
+               std::to_string(xMax) + " " + std::to_string(yMax) + "," + std::to_string(xMin) + " " + std::to_string(yMax) + "," + 
+               std::to_string(xMin) + " " + std::to_string(yMin) + "))";
+    };
+    // growing windows from the small polygons' corner up to the whole dataspace, and a triangle
+    std::vector<std::string> windows;
+    for (double extent = 0.2; extent < 40; extent *= 1.7) {
+        windows.push_back(box(-101.05, 64.8 - extent, -101.05 + extent, 64.8 + extent));
+    }
+    windows.push_back("POLYGON ((-180 -90,180 -90,180 90,-180 90,-180 -90))");
+    windows.push_back("POLYGON ((-101.5 40,-80 40,-101.5 66,-101.5 40))");
+    for (auto &window : windows) {
+        size_t expected = collect(datasetRTID, window);
+        ASSERT_EQ(count(datasetTLID, window), expected);
+        ASSERT_EQ(count(datasetRTID, window), expected);
+        ASSERT_EQ(collect(datasetTLID, window), expected);
+    }
+    ASSERT_EQ(count(datasetTLID, windows[windows.size() - 2]), 11);
+    ret = hec::unloadDataset(datasetTLID);
+    ASSERT_EQ(DBERR_OK, ret);
+    ret = hec::unloadDataset(datasetRTID);
+    ASSERT_EQ(DBERR_OK, ret);
+
+    // points on the uniform grid, against the points inside each window in the file
+    std::string points = std::string(HECATONCHEIR_DIR) + "/test/samples/data_sample_points.wkt";
+    int datasetPID = hec::prepareDataset(points, "WKT", "POINT", false);
+    ASSERT_EQ(0, datasetPID);
+    ret = hec::partition({datasetPID});
+    ASSERT_EQ(DBERR_OK, ret);
+    ret = hec::buildIndex({datasetPID}, hec::IT_UNIFORM_GRID);
+    ASSERT_EQ(DBERR_OK, ret);
+    std::vector<std::pair<double, double>> coords;
+    std::ifstream file(points);
+    std::string line;
+    while (std::getline(file, line)) {
+        double x, y;
+        if (sscanf(line.c_str(), "POINT (%lf %lf)", &x, &y) == 2) {
+            coords.emplace_back(x, y);
+        }
+    }
+    ASSERT_EQ(coords.size(), 100);
+    for (double extent = 0.013; extent < 0.5; extent *= 1.9) {
+        // bounds with 4 decimals, so that the WKT holds them exactly
+        double step = std::round(extent * 1e4) / 1e4;
+        double xMin = -86.6713 - step, yMin = 32.5217 - step, xMax = -86.6713 + step, yMax = 32.5217 + step;
+        size_t expected = 0;
+        for (auto &[x, y] : coords) {
+            if (x >= xMin && x <= xMax && y >= yMin && y <= yMax) {
+                expected++;
+            }
+        }
+        ASSERT_EQ(count(datasetPID, box(xMin, yMin, xMax, yMax)), expected);
+        ASSERT_EQ(collect(datasetPID, box(xMin, yMin, xMax, yMax)), expected);
+    }
+    ASSERT_EQ(count(datasetPID, box(-87, 32, -86, 33)), 100);
+    ret = hec::unloadDataset(datasetPID);
+    ASSERT_EQ(DBERR_OK, ret);
+}
+
+void QueryTest::test25() {
+    std::string polygonsR = std::string(HECATONCHEIR_DIR) + "/test/samples/data_sample_polygons_1.wkt";
+    std::string polygonsS = std::string(HECATONCHEIR_DIR) + "/test/samples/data_sample_polygons_2.wkt";
+    int datasetRID = hec::prepareDataset(polygonsR, "WKT", "POLYGON", false);
+    int datasetSID = hec::prepareDataset(polygonsS, "WKT", "POLYGON", false);
+    ASSERT_EQ(0, datasetRID);
+    ASSERT_EQ(1, datasetSID);
+    int ret = hec::partition({datasetRID, datasetSID});
+    ASSERT_EQ(DBERR_OK, ret);
+    ret = hec::buildIndex({datasetRID, datasetSID}, hec::IT_TWO_LAYER);
+    ASSERT_EQ(DBERR_OK, ret);
+    int queryID = 0;
+    std::vector<std::string> resultDeliveries = {"HOST", "TREE", "DIRECT"};
+    // (R, S) pairs of a join result, sorted
+    auto sortedPairs = [](hec::QResultBase* result) {
+        std::vector<size_t> ids = result->getResultList();
+        std::vector<std::pair<size_t, size_t>> pairs;
+        for (size_t i=0; i+1<ids.size(); i+=2) {
+            pairs.emplace_back(ids[i], ids[i+1]);
+        }
+        std::sort(pairs.begin(), pairs.end());
+        return pairs;
+    };
+    std::vector<std::pair<size_t, size_t>> hostJoinPairs;
+    std::vector<size_t> hostRangeIDs;
+    for (auto &resultDelivery : resultDeliveries) {
+        ret = hec::setResultDelivery(resultDelivery);
+        ASSERT_EQ(DBERR_OK, ret);
+        // a join, then a count join and a range query in flight at the same time
+        hec::PredicateJoinQuery joinQuery(datasetRID, datasetSID, queryID++, hec::Q_INTERSECTION_JOIN, hec::QR_COLLECT);
+        hec::PredicateJoinQuery countQuery(datasetRID, datasetSID, queryID++, hec::Q_INTERSECTION_JOIN, hec::QR_COUNT);
+        hec::RangeQuery rangeQuery(datasetSID, queryID++, "POLYGON ((-180 -90,180 -90,180 90,-180 90,-180 -90))", hec::QR_COLLECT);
+        hec::QResultBase* result = hec::query(&joinQuery);
+        ASSERT_NE(result, nullptr);
+        std::vector<std::pair<size_t, size_t>> joinPairs = sortedPairs(result);
+        delete result;
+        hec::QueryHandle countHandle = hec::queryAsync(&countQuery);
+        hec::QueryHandle rangeHandle = hec::queryAsync(&rangeQuery);
+        result = hec::wait(rangeHandle);
+        ASSERT_NE(result, nullptr);
+        std::vector<size_t> rangeIDs = result->getResultList();
+        std::sort(rangeIDs.begin(), rangeIDs.end());
+        delete result;
+        result = hec::wait(countHandle);
+        ASSERT_NE(result, nullptr);
+        ASSERT_EQ(result->getResultCount(), 5);
+        delete result;
+        if (resultDelivery == "HOST") {
+            ASSERT_EQ(joinPairs.size(), 5);
+            ASSERT_EQ(rangeIDs.size(), 11);
+            hostJoinPairs = joinPairs;
+            hostRangeIDs = rangeIDs;
+        }
+        // the workers' partial results are merged elsewhere, but the totals are the same
+        ASSERT_EQ((joinPairs == hostJoinPairs), true);
+        ASSERT_EQ((rangeIDs == hostRangeIDs), true);
+    }
+    ret = hec::unloadDataset(datasetRID);
+    ASSERT_EQ(DBERR_OK, ret);
+    ret = hec::unloadDataset(datasetSID);
+    ASSERT_EQ(DBERR_OK, ret);
+
+    // distance joins between points
+    std::string pointsR = std::string(HECATONCHEIR_DIR) + "/test/samples/data_sample_points.wkt";
+    std::string pointsS = std::string(HECATONCHEIR_DIR) + "/test/samples/query_sample_points.wkt";
+    datasetRID = hec::prepareDataset(pointsR, "WKT", "POINT", false);
+    datasetSID = hec::prepareDataset(pointsS, "WKT", "POINT", false);
+    ASSERT_EQ(0, datasetRID);
+    ASSERT_EQ(1, datasetSID);
+    ret = hec::partition({datasetRID, datasetSID});
+    ASSERT_EQ(DBERR_OK, ret);
+    ret = hec::buildIndex({datasetRID, datasetSID}, hec::IT_UNIFORM_GRID);
+    ASSERT_EQ(DBERR_OK, ret);
+    std::vector<std::pair<size_t, size_t>> hostDistancePairs;
+    for (auto &resultDelivery : resultDeliveries) {
+        ret = hec::setResultDelivery(resultDelivery);
+        ASSERT_EQ(DBERR_OK, ret);
+        hec::DistanceJoinQuery distanceQuery(datasetRID, datasetSID, queryID++, hec::QR_COLLECT, 7.65);
+        hec::QResultBase* result = hec::query(&distanceQuery);
+        ASSERT_NE(result, nullptr);
+        std::vector<std::pair<size_t, size_t>> distancePairs = sortedPairs(result);
+        delete result;
+        if (resultDelivery == "HOST") {
+            ASSERT_EQ(distancePairs.size(), 5);
+            hostDistancePairs = distancePairs;
+        }
+        ASSERT_EQ((distancePairs == hostDistancePairs), true);
+    }
+    // back to the configured delivery
+    ret = hec::setResultDelivery("HOST");
+    ASSERT_EQ(DBERR_OK, ret);
+    ret = hec::unloadDataset(datasetRID);
+    ASSERT_EQ(DBERR_OK, ret);
+    ret = hec::unloadDataset(datasetSID);
+    ASSERT_EQ(DBERR_OK, ret);
+}
+
+void QueryTest::test26() {
+    // the same points twice, so that a distance join over the whole dataspace pairs up all of them
+    std::string points = std::string(HECATONCHEIR_DIR) + "/test/samples/data_sample_points.wkt";
+    int datasetRID = hec::prepareDataset(points, "WKT", "POINT", false);
+    int datasetSID = hec::prepareDataset(points, "WKT", "POINT", false);
+    ASSERT_EQ(0, datasetRID);
+    ASSERT_EQ(1, datasetSID);
+    int ret = hec::partition({datasetRID, datasetSID});
+    ASSERT_EQ(DBERR_OK, ret);
+    ret = hec::buildIndex({datasetRID, datasetSID}, hec::IT_UNIFORM_GRID);
+    ASSERT_EQ(DBERR_OK, ret);
+    int queryID = 0;
+    for (std::string resultDelivery : {"TREE", "DIRECT"}) {
+        ret = hec::setResultDelivery(resultDelivery);
+        ASSERT_EQ(DBERR_OK, ret);
+        // 100x100 pairs of 16 bytes, sent by the workers to the driver with a rendezvous send
+        hec::DistanceJoinQuery distanceQuery(datasetRID, datasetSID, queryID++, hec::QR_COLLECT, 1.0);
+        hec::QueryHandle handle = hec::queryAsync(&distanceQuery);
+        // the host only answers once the workers delivered, so the driver must receive the chunks meanwhile
+        std::vector<hec::CommStats> stats = hec::getCommStats(false);
+        ASSERT_NE(stats.size(), 0);
+        // and a query batch, answered after the join too
+        hec::RangeQuery rangeQuery(datasetRID, queryID, "POLYGON ((-180 -90,180 -90,180 90,-180 90,-180 -90))", hec::QR_COUNT);
+        std::vector<hec::Query*> batch = {&rangeQuery};
+        std::unordered_map<int, std::unique_ptr<hec::QResultBase>> batchResults = hec::query(batch, hec::Q_RANGE);
+        ASSERT_EQ(batchResults.size(), 1);
+        ASSERT_EQ(batchResults[queryID]->getResultCount(), 100);
+        queryID++;
+        hec::QResultBase* result = hec::wait(handle);
+        ASSERT_NE(result, nullptr);
+        ASSERT_EQ(result->getResultCount(), 10000);
+        delete result;
+    }
+    ret = hec::setResultDelivery("HOST");
+    ASSERT_EQ(DBERR_OK, ret);
+    ret = hec::unloadDataset(datasetRID);
+    ASSERT_EQ(DBERR_OK, ret);
+    ret = hec::unloadDataset(datasetSID);
+    ASSERT_EQ(DBERR_OK, ret);
+}
+
 void QueryTest::run() {
     // prepare
     current_test_name = "QueryTest::prepare";  // Set global name
@@ -12,7 +12,26 @@ private:
         {"test4", [this]() { test4(); }},
         {"test5", [this]() { test5(); }},
         {"test6", [this]() { test6(); }},
-        {"test7", [this]() { test7(); }}
+        {"test7", [this]() { test7(); }},
+        {"test8", [this]() { test8(); }},
+        {"test9", [this]() { test9(); }},
+        {"test10", [this]() { test10(); }},
+        {"test11", [this]() { test11(); }},
+        {"test12", [this]() { test12(); }},
+        {"test13", [this]() { test13(); }},
+        {"test14", [this]() { test14(); }},
+        {"test15", [this]() { test15(); }},
+        {"test16", [this]() { test16(); }},
+        {"test17", [this]() { test17(); }},
+        {"test18", [this]() { test18(); }},
+        {"test19", [this]() { test19(); }},
+        {"test20", [this]() { test20(); }},
+        {"test21", [this]() { test21(); }},
+        {"test22", [this]() { test22(); }},
+        {"test23", [this]() { test23(); }},
+        {"test24", [this]() { test24(); }},
+        {"test25", [this]() { test25(); }},
+        {"test26", [this]() { test26(); }}
     };
 protected:
     /** @brief Spatial find relation count join between polygons */
@@ -29,6 +48,44 @@ protected:
     void test6();
     /** @brief Distance join collect on points */
     void test7();
+    /** @brief Two joins in flight at the same time (async) between polygons */
+    void test8();
+    /** @brief Communication counters of a join query between polygons */
+    void test9();
+    /** @brief Repeated distance joins on points, reusing the border objects of a larger epsilon */
+    void test10();
+    /** @brief Find relation join and range queries between polygons, a rejected polygon distance join and batch knn on points, on the R-tree index */
+    void test11();
+    /** @brief Range queries after inserting and deleting objects on built uniform grid and two-layer indexes */
+    void test12();
+    /** @brief Range and knn queries on points after inserting a dense cluster that subdivides a uniform grid cell */
+    void test13();
+    /** @brief Saving a built two-layer index with an inserted polygon to a snapshot, and loading it into a fresh dataset */
+    void test14();
+    /** @brief Memory footprint of a built two-layer index, reported by every worker */
+    void test15();
+    /** @brief Joins between pairs of three resident datasets, and reuse of an unloaded dataset's ID */
+    void test16();
+    /** @brief Range queries over a grid of small windows give the same results on the two-layer and the R-tree index */
+    void test17();
+    /** @brief Fetching polygons by rec ID, before and after inserting and deleting objects */
+    void test18();
+    /** @brief Joins between tall, thin polygons, whose partition pairs are swept on X */
+    void test19();
+    /** @brief Rectangle windows that contain whole partition classes give the same results on the two-layer and the R-tree index */
+    void test20();
+    /** @brief Panning and zooming rectangle windows, answered from the range cache, before and after updates */
+    void test21();
+    /** @brief A batch of range queries on the two-layer index, evaluated with shared scans, gives the same results as single queries on the R-tree */
+    void test22();
+    /** @brief Concave polygon windows, filtered with their APRIL, give the same results on both indexes and as their convex pieces */
+    void test23();
+    /** @brief Count range queries, answered from partition summaries where the window covers them, match the collected results */
+    void test24();
+    /** @brief Joins, range and distance join results are the same with host, tree and direct result delivery */
+    void test25();
+    /** @brief Blocking calls while an async join delivers a result larger than the eager send limit from the workers */
+    void test26();
 
     /** @brief Performs any preparation required for the test */
     void prepare();